@@ -12,6 +12,7 @@
 //(8 %)圖學相關功能的使用，必須在程式碼中以註解清楚標明
 // ✓ (1%) 針對特定物件實現 Billboards 的功能
         //在Model.cpp中setBillboard等計算Billboard的功能，從主函式設定camera pos和view Matrix傳回函式使用
+        //大量的告示牌由 CBillboardBatch 在 vertex shader 中展開，一次 instanced draw 描繪（'y' 鍵加入一萬個）
 // ✓ (1%) 使用到  Mipmapped 的功能 （有具體的說明在程式碼中）
         //在Model.cpp中LoadTexture()中生成midmapp
 // ✓ (2%) 有房間使用到 Light Map 的功能 （有具體的說明在程式碼中）
@@ -21,7 +22,14 @@
 // ✓ (2%) 有物件使用到 Environment Map 的功能 (有具體的說明在程式碼中）
         // 在Model.cpp中LoadCubeMapFromFiles讀取6張cube map的貼圖，RenderMesh()和ProcessMaterials綁到shader上
 //(6%) 其他你覺得可以展示的技術，包含物理或是數學的運算
-    //(3%)發射子彈並且在牆壁上留下彈孔
+// ✓ (3%)發射子彈並且在牆壁上留下彈孔
+        //'f' 鍵發射子彈：CProjectilePool 以批次射線做連續碰撞偵測，打中的事件由 handleProjectileHits() 處理
+        //打中牆壁時在 g_decals 加入彈孔，CDecalRenderer 把所有貼花投影到深度上一次畫出（'u' 鍵一次加入一萬個）
+        //同時由 g_particles 噴出火花與灰塵，CParticleRenderer 以 instanced billboard 描繪（'v' 鍵一次產生二十萬個）
+    //家具等模型載入時以 CMeshSimplify 產生 LOD，依投影到螢幕上的誤差選擇（'m' 鍵切換門檻或關閉，'i' 鍵輸出三角形數量）
+    //遠處的家具以 CImpostorRenderer 的八面體 impostor 取代，每個實體只畫一個四邊形（'x' 鍵切換）
+    //網格在載入時分成約 128 個三角形的叢集，CClusterCuller 每個 frame 剔除視錐外與背對攝影機的叢集（'z' 鍵切換）
+    //模型與 CShape 的頂點以 CVertexQuantize 壓縮成 16 bytes（'1' 鍵切換回 float 頂點比較 frame 時間）
     //(3%)可以破壞房間內的擺設
 //(4%) 創意分數
 // ✓ //玩家模型跟著鏡頭移動旋轉
@@ -33,6 +41,8 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <chrono>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -56,6 +66,23 @@
 #include "models/CSphere.h"
 #include "common/CLightManager.h"
 #include "common/CollisionManager.h"
+#include "common/CRigidBodyPool.h"
+#include "common/CDebrisPool.h"
+#include "common/CProjectilePool.h"
+#include "common/RoomGrid.h"
+#include "common/CShadowManager.h"
+#include "common/CReflectionProbe.h"
+#include "common/CIrradianceVolume.h"
+#include "common/COITRenderer.h"
+#include "common/CDecalBuffer.h"
+#include "common/CDecalRenderer.h"
+#include "common/CParticleSystem.h"
+#include "common/CParticleRenderer.h"
+#include "common/CBillboardBatch.h"
+#include "common/CImpostorRenderer.h"
+#include "common/CClusterCuller.h"
+#include "common/CParallel.h"
+#include "common/SceneObject.h"
 
 #include "Model.h"
 
@@ -66,8 +93,96 @@
 #define SCREEN_WIDTH  800
 #define SCREEN_HEIGHT 800 
 #define ROW_NUM 30
+#define CAMERA_FAR_PLANE 100.0f
 
 CollisionManager g_collisionManager;
+// 投射物、粒子與叢集剔除每個 frame 的多執行緒工作共用，啟動時建立一次
+CThreadPool g_threadPool(hardwareThreadCount());
+CShadowManager g_shadowManager;
+CReflectionProbeManager g_probeManager;
+CIrradianceVolume g_irradianceVolume;      // 移動物件的間接光（tools/ProbeBaker 產生）
+COITRenderer g_oitRenderer;                // 所有模型的透明網格（玻璃窗、alpha 貼圖）
+std::vector<SceneObject> g_sceneObjects; // 每個 frame 由 update() 重建
+
+// 空白鍵打壞視線前方的家具：模型不再描繪，碰撞代理移除，換成預先破碎（Model::LoadFracture）的碎片
+// 碎片的剛體在 g_rigidBodies，g_debris 依碎片整理模型矩陣後以 instanced draw 描繪，打壞時不配置記憶體
+#define FRACTURE_PIECES 12
+#define MASS_BREAK_COUNT 50        // 'k' 鍵同時打壞的家具數量
+#define BREAK_TIMING_FRAMES 120    // 'k'、'j' 鍵之後記錄的 frame 數
+CRigidBodyPool g_rigidBodies;
+CDebrisPool g_debris;
+GLuint g_debrisInstanceVBO = 0;
+std::vector<int> g_fractureSources;     // models[] 對應的 g_debris 種類，-1 表示不能打壞
+std::vector<Model*> g_fractureModels;   // g_debris 的種類對應的模型
+std::vector<bool> g_brokenModels;
+std::vector<bool> g_brokenGridFurniture;
+
+// 'f' 鍵發射子彈：g_projectiles 在 update() 中前進並以批次射線檢測碰撞，打中的事件由 handleProjectileHits() 取出，
+// 玩家的子彈打中家具時打壞它；'j' 鍵往四面八方一次發射 PROJECTILE_STRESS_COUNT 個（只產生事件，不打壞家具）
+#define PROJECTILE_SPEED 60.0f
+#define PROJECTILE_STRESS_COUNT 100000
+#define PROJECTILE_TAG_PLAYER 0
+#define PROJECTILE_TAG_STRESS 1
+CProjectilePool g_projectiles;
+
+// 彈孔與撞擊痕跡：g_decals 為固定容量的環狀緩衝區，滿了之後覆蓋最舊的；'u' 鍵一次加入 DECAL_STRESS_COUNT 個
+#define DECAL_STRESS_COUNT 10000
+#define DECAL_STRESS_RANGE 40.0f
+CDecalBuffer g_decals;
+CDecalRenderer g_decalRenderer;
+
+// 粒子：子彈打中牆壁的火花與灰塵（emitBurst），以及跟著 g_light 與電風扇（models[10]）的發射器
+// 'v' 鍵在視線前方一次產生 PARTICLE_STRESS_COUNT 個火花
+#define PARTICLE_CAPACITY 262144
+#define PARTICLE_STRESS_COUNT 200000
+#define FAN_MODEL_INDEX 10
+CParticleSystem g_particles(PARTICLE_CAPACITY);
+CParticleRenderer g_particleRenderer;
+ParticleEmitterDesc g_sparkBurst, g_dustBurst;
+int g_lightEmitter = -1, g_fanEmitter = -1;
+
+// 告示牌：--room-grid 時每個房間一個，'y' 鍵切換 BILLBOARD_STRESS_COUNT 個三種 BillboardType 混合的告示牌
+#define BILLBOARD_STRESS_COUNT 10000
+CBillboardBatch g_billboards;
+std::vector<BillboardDesc> g_roomSigns;
+bool g_billboardStress = false;
+
+// 網格 LOD：Model 載入時以 CMeshSimplify 產生（存在 .lcache），update() 依實體與攝影機的距離換算模型空間每單位的像素數，
+// 每個不透明網格使用誤差不超過門檻的最粗略一層；'m' 鍵依序切換 g_lodPixelErrors 的門檻，0 為關閉 LOD
+// 預設 2 像素時家具的 LOD 1 在 60 公尺以內切換（遠平面為 100 公尺，tools/LodBenchmark 檢查）
+const float g_lodPixelErrors[] = { 2.0f, 4.0f, 0.0f };
+int g_lodSetting = 0;
+size_t g_trianglesDrawn = 0, g_trianglesFullDetail = 0;   // 上一個 frame 的不透明網格
+
+// 家具 impostor：載入時烘焙 g_impostorModels 的八面體 impostor，包圍球上最近的點比 IMPOSTOR_SWITCH_DISTANCE 遠
+// 的實體以一個四邊形描繪；'x' 鍵切換以比較 frame 時間與三角形數量
+// 家具的半徑有 3 ~ 7.5 公尺，以貼圖集的一個像素對應螢幕的一個像素為準時要到 100 ~ 230 公尺才切換（超過遠平面），
+// 所以改以遠平面的比例切換：40 公尺時畫面約放大 2.4 ~ 5.6 倍（tools/ImpostorBenchmark），六個房間的場景中另一端的家具會使用 impostor
+#define IMPOSTOR_SWITCH_DISTANCE (CAMERA_FAR_PLANE * 0.4f)
+const int g_impostorModels[] = { 1, 2, 3, 4, 5 };   // 桌子、沙發、床、馬桶、書桌
+CImpostorRenderer g_impostors;
+std::vector<int> g_impostorOf;   // models[] 的索引 -> impostor 編號，-1 表示沒有
+bool g_impostorsEnabled = true;
+
+// 叢集剔除：描繪不透明網格之前以多執行緒剔除視錐外與法向量錐背對攝影機的叢集，剩下的範圍以 glMultiDrawElements 送出
+// 'z' 鍵依序切換 g_clusterModes（視錐 + 背面、只有視錐、關閉：每個網格一次 glDrawElements），'i' 鍵輸出送出的三角形
+const char* const g_clusterModes[] = { "frustum + backface", "frustum only", "off" };
+int g_clusterMode = 0;
+CClusterCuller g_clusterCuller;
+std::vector<int> g_clusterItems;   // g_sceneObjects 的每個實體在 g_clusterCuller 中的第一個項目，-1 表示不剔除
+
+// 頂點格式：預設為量化的 16 bytes 頂點，--float-vertices 或 '1' 鍵改用 float 頂點（重新上傳所有模型的頂點緩衝區）
+VertexFormat g_vertexFormat = VertexFormat::QUANTIZED;
+
+// 'k'、'j' 鍵之後的 frame 時間
+std::string g_frameTimingLabel;
+int g_breakTimingFrames = 0;
+float g_breakTimingSum = 0.0f, g_breakTimingMax = 0.0f;
+
+// --room-grid CxR：以程序產生的房間格子取代六個房間的碰撞牆，並在每個房間擺放家具實體（碰撞與描繪的規模測試）
+bool g_useRoomGrid = false;
+RoomGridConfig g_roomGridConfig;
+std::vector<FurnitureInstance> g_gridFurniture;
 
 //CTeapot  g_teapot(5);
 CTorusKnot g_tknot(4);
@@ -173,6 +288,15 @@ std::vector<std::string> modelPaths = {
 
 void renderModel(const std::string& modelName, const glm::mat4& modelMatrix);
 void adjustShaderEffects(float normalStrength, float specularStrength, float specularPower);
+glm::mat4 computeModelMatrix(size_t i);
+void uploadIrradianceSH(const SceneObject& obj);
+void printRenderStats();
+void renderDebris();
+std::string propColliderName(size_t i);
+std::string gridColliderName(size_t k);
+void startFrameTiming(const std::string& label);
+void setupParticles();
+float projectedPixelsPerUnit(const SceneObject& obj);
 
 //----------------------------------------------------------------------------
 void loadScene(void)
@@ -217,14 +341,112 @@ void loadScene(void)
             std::cout << "Failed to load: " << path << std::endl;
         }
     }
-    models[0]->SetLightMap("room.001", "models/textures/Room001_lightmap.png", 0.5);
-    models[6]->SetLightMap("garden", "models/textures/garden_lightmap.png", 0.1);
-    models[7]->SetEnvironmentMapFromFiles("wood", "models/textures/Sunny", 1.0);
-    models[8]->SetEnvironmentMapFromFiles("wood", "models/textures/cubic2", 1.0);
+    g_brokenModels.assign(models.size(), false);
+    // 可以打壞的家具與木頭方塊預先破碎（結果存在 .fcache），碎片的模型矩陣每個 frame 寫入 g_debrisInstanceVBO
+    g_fractureSources.assign(models.size(), -1);
+    for (size_t i : { 1, 2, 3, 4, 5, 7, 8 }) {
+        if (!models[i]->LoadFracture(FRACTURE_PIECES)) continue;
+        g_fractureSources[i] = g_debris.addSource(models[i]->GetFractureChunks());
+        g_fractureModels.push_back(models[i].get());
+    }
+    glGenBuffers(1, &g_debrisInstanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, g_debrisInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, g_debris.getCapacity() * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // 有 tools/LightmapBaker 的輸出時使用烘焙的 Light Map，固定的光源（g_light2 ~ g_light6）不再逐像素計算
+    // g_light 可以用 'l' 鍵移動，不參與烘焙
+    bool roomBaked = models[0]->SetBakedLightMap("room.001", "models/textures/Room001_baked.png", 2.0f);
+    bool gardenBaked = models[6]->SetBakedLightMap("garden", "models/textures/garden_baked.png", 2.0f);
+    if (!roomBaked) models[0]->SetLightMap("room.001", "models/textures/Room001_lightmap.png", 0.5);
+    if (!gardenBaked) models[6]->SetLightMap("garden", "models/textures/garden_lightmap.png", 0.1);
+    // 移動的物件（機器人、電風扇、Billboard）改由 Irradiance Volume 取得固定光源的光
+    bool volumeLoaded = g_irradianceVolume.load("models/irradiance.irr");
+    if (roomBaked || gardenBaked || volumeLoaded) {
+        // 只影響使用烘焙 Light Map 或 Irradiance Volume 的物件，其他物件仍然逐像素計算這些光源
+        g_light2->setBaked(true);
+        g_light3->setBaked(true);
+        g_light4->setBaked(true);
+        g_light5->setBaked(true);
+        g_light6->setBaked(true);
+    }
+    // 兩個木頭方塊改用動態反射探針，反射出實際的房間（取代 Sunny、cubic2 固定貼圖）
+    // 兩個探針合計每個 frame 只更新一個面
+    g_probeManager.init();
+    g_probeManager.setFacesPerFrame(1);
+    int probe7 = g_probeManager.addProbe(7, 128);
+    int probe8 = g_probeManager.addProbe(8, 128);
+    if (probe7 >= 0 && probe8 >= 0) {
+        models[7]->SetEnvironmentMapTexture("wood", g_probeManager.getCubeMap(probe7), 1.0);
+        models[8]->SetEnvironmentMapTexture("wood", g_probeManager.getCubeMap(probe8), 1.0);
+    } else {
+        models[7]->SetEnvironmentMapFromFiles("wood", "models/textures/Sunny", 1.0);
+        models[8]->SetEnvironmentMapFromFiles("wood", "models/textures/cubic2", 1.0);
+    }
+    models[10]->setSelfRotateMode(true, 2.0f);
+    models[11]->setBillboard(true, BillboardType::SPHERICAL);
+
+    // 家具（桌子、沙發、床、馬桶、書桌）與兩個木頭方塊由網格產生的碰撞代理加入障礙物，攝影機不再穿過
+    int proxyCount = 0;
+    for (size_t i : { 1, 2, 3, 4, 5, 7, 8 }) {
+        proxyCount += g_collisionManager.addModelProxies(models[i]->GetCollisionProxies(), computeModelMatrix(i),
+                                                         propColliderName(i));
+    }
+    if (g_useRoomGrid) {
+        std::vector<FurnitureFootprint> footprints;
+        for (int i : { 1, 2, 3, 4, 5 }) {
+            footprints.push_back({ i, models[i]->getBoundsMin(), models[i]->getBoundsMax(), 0.7f });
+        }
+        RoomGrid grid = generateRoomGrid(g_roomGridConfig, footprints);
+        g_collisionManager.setWalls(grid.walls);
+        g_gridFurniture = grid.furniture;
+        g_brokenGridFurniture.assign(g_gridFurniture.size(), false);
+        for (size_t k = 0; k < g_gridFurniture.size(); ++k) {
+            const FurnitureInstance& furniture = g_gridFurniture[k];
+            proxyCount += g_collisionManager.addModelProxies(models[furniture.model]->GetCollisionProxies(), furniture.world,
+                                                             gridColliderName(k));
+        }
+        for (const glm::vec3& center : grid.roomCenters) {
+            BillboardDesc sign;
+            sign.position = glm::vec3(center.x, g_roomGridConfig.origin.y + 3.0f, center.z);
+            sign.size = glm::vec2(2.0f, 2.0f);
+            sign.type = BillboardType::CYLINDRICAL;
+            g_roomSigns.push_back(sign);
+        }
+        std::cout << "Room grid: " << grid.roomCenters.size() << " rooms, " << grid.doors.size() << " doors, "
+                  << grid.unmergedWallCount << " wall segments merged into " << grid.walls.size() << " colliders, "
+                  << g_gridFurniture.size() << " furniture instances" << std::endl;
+    }
+    std::cout << "Collision proxies registered: " << proxyCount << " ("
+              << g_collisionManager.getOrientedObstacleCount() << " oriented)" << std::endl;
+
+    // 陰影：六個點光源都投射陰影，靜態物件的深度只會在光源移動時重建
+    g_shadowManager.init(1024);
+    g_shadowManager.addLight(g_light);
+    g_shadowManager.addLight(g_light2);
+    g_shadowManager.addLight(g_light3);
+    g_shadowManager.addLight(g_light4);
+    g_shadowManager.addLight(g_light5);
+    g_shadowManager.addLight(g_light6);
+    
+    // 透明網格預設使用 Weighted Blended OIT，'t' 鍵切換為排序後 alpha blending 以比較效能
+    g_oitRenderer.init();
+    g_decalRenderer.init();
+    g_projectiles.setThreadPool(&g_threadPool);
+    g_collisionManager.prepareClearance();   // 投射物的距離格點在載入時建立，第一次發射時不會停頓
+    g_clusterCuller.setThreadPool(&g_threadPool);
+    setupParticles();
+    g_particleRenderer.init();
+    g_billboards.init("models/textures/sign_color.png");
+    for (const BillboardDesc& sign : g_roomSigns) g_billboards.add(sign);
+    g_impostors.init();
+    g_impostorOf.assign(models.size(), -1);
+    for (int index : g_impostorModels) {
+        if (index < static_cast<int>(models.size())) g_impostorOf[index] = g_impostors.bake(models[index].get());
+    }
     
 	CCamera::getInstance().updateView(g_eyeloc); // 設定 eye 位置
     CCamera::getInstance().updateCenter(glm::vec3(0,4,0));
-	CCamera::getInstance().updatePerspective(45.0f, (float)SCREEN_WIDTH / SCREEN_HEIGHT, 0.1f, 100.0f);
+	CCamera::getInstance().updatePerspective(45.0f, (float)SCREEN_WIDTH / SCREEN_HEIGHT, 0.1f, CAMERA_FAR_PLANE);
     glm::mat4 mxView = CCamera::getInstance().getViewMatrix();
 	glm::mat4 mxProj = CCamera::getInstance().getProjectionMatrix();
 
@@ -283,6 +505,12 @@ void render(void)
     glUniform3fv(glGetUniformLocation(g_shadingProg, "lightPos"), 1, glm::value_ptr(g_light->getPos()));
 //    g_light.drawRaw();
     lightManager.updateAllLightsToShader();
+    
+    // 更新陰影貼圖（只重畫需要的面），再綁定給主要 shader
+    g_shadowManager.render(g_sceneObjects);
+    g_shadowManager.bindToShader(g_shadingProg, lightManager);
+    // 依預算更新反射探針的 cube map 面
+    g_probeManager.render(g_sceneObjects, lightManager);
         
     // 繪製光源視覺表示
     lightManager.draw();
@@ -290,61 +518,466 @@ void render(void)
     
     g_centerloc.drawRaw();
     
-    //繪製obj model
+    //繪製obj model：先畫所有不透明網格，透明網格不分模型一起交給 COITRenderer
     GLint modelLoc = glGetUniformLocation(g_shadingProg, "mxModel");
-    for (size_t i = 0; i < models.size(); ++i) {
-        glm::mat4 modelMatrix = modelMatrices[i];
-        modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-        modelMatrix = glm::scale(modelMatrix, glm::vec3(0.7f));
-//        if (i == 1) {
-//            modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-//            modelMatrix = glm::scale(modelMatrix, glm::vec3(0.7f));
-//        }
-//        if (i == 2) {
-//            modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
-//            modelMatrix = glm::scale(modelMatrix, glm::vec3(0.7f));
-//        }
-        
-        if (i == 7) {
-            modelMatrix = glm::translate(modelMatrix, glm::vec3(-1.0f, 1.5f, -6.0f));
-            modelMatrix = glm::scale(modelMatrix, glm::vec3(1.3f));
+    auto setupObject = [modelLoc](const SceneObject& obj) {
+        if (modelLoc != -1) {
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(obj.world));
         }
-        else if (i == 8) {
-            modelMatrix = glm::translate(modelMatrix, glm::vec3(3.0f, 1.5f, -6.0f));
-            modelMatrix = glm::scale(modelMatrix, glm::vec3(1.3f));
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        uploadIrradianceSH(obj);
+    };
+    float lodPixelError = g_lodPixelErrors[g_lodSetting];
+    g_trianglesDrawn = g_trianglesFullDetail = 0;
+    g_impostors.clearInstances();
+    auto useImpostor = [](const SceneObject& obj) {
+        if (!g_impostorsEnabled || obj.impostor < 0) return false;
+        glm::vec3 center = (obj.worldMin + obj.worldMax) * 0.5f;
+        float radius = glm::length(obj.worldMax - obj.worldMin) * 0.5f;
+        return glm::length(center - g_eyeloc) - radius > IMPOSTOR_SWITCH_DISTANCE;
+    };
+    // 所有實體的 LOD 0 網格一起以多執行緒剔除叢集
+    bool clusterCulling = g_clusterMode != 2;
+    g_clusterItems.assign(g_sceneObjects.size(), -1);
+    if (clusterCulling) {
+        g_clusterCuller.setBackfaceCulling(g_clusterMode == 0);
+        g_clusterCuller.begin(CCamera::getInstance().getViewProjectionMatrix(), g_eyeloc);
+        for (size_t k = 0; k < g_sceneObjects.size(); ++k) {
+            const SceneObject& obj = g_sceneObjects[k];
+            if (useImpostor(obj)) continue;
+            g_clusterItems[k] = obj.model->AddClusterItems(g_clusterCuller, obj.world,
+                                                           lodPixelError > 0.0f ? obj.lodPixelsPerUnit : 0.0f, lodPixelError);
         }
-        else if (i == 9 ){
-            if (models[9]->isFollowingCamera()) {
-                // 取得模型自己計算的矩陣，然後加上縮放
-                modelMatrix = models[9]->getModelMatrix();
-                modelMatrix = glm::scale(modelMatrix, glm::vec3(0.07f));
-                // 可以加上額外的旋轉
-                modelMatrix = glm::rotate(modelMatrix, glm::radians(270.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-            } else {
-//                // 如果不跟隨攝影機，使用原來的固定位置
-                modelMatrix = glm::translate(modelMatrix, glm::vec3(5.0f, 1.15f, 5.0f));
-                modelMatrix = glm::scale(modelMatrix, glm::vec3(0.07f));
-                modelMatrix = glm::rotate(modelMatrix, glm::radians(270.0f), glm::vec3(0.0f, 1.5f, 0.0f));
-            }
+        g_clusterCuller.cull(g_threadPool.getThreadCount());
+    }
+    for (size_t k = 0; k < g_sceneObjects.size(); ++k) {
+        const SceneObject& obj = g_sceneObjects[k];
+        if (useImpostor(obj)) {
+            g_impostors.addInstance(obj.impostor, obj.world);
+            g_trianglesDrawn += 2;
+            g_trianglesFullDetail += obj.model->GetOpaqueTriangleCount();
+            continue;
         }
-        else if(i == 10){
-            modelMatrix = glm::translate(modelMatrix, glm::vec3(-30.0f, 17.0f, -8.0f));
-            modelMatrix = modelMatrix * models[i]->getModelMatrix();
-            models[10]->setSelfRotateMode(true, 2.0f);
+        setupObject(obj);
+        g_trianglesDrawn += obj.model->RenderOpaque(g_shadingProg, lodPixelError > 0.0f ? obj.lodPixelsPerUnit : 0.0f,
+                                                    lodPixelError, clusterCulling ? &g_clusterCuller : nullptr,
+                                                    g_clusterItems[k]);
+        g_trianglesFullDetail += obj.model->GetOpaqueTriangleCount();
+    }
+    g_impostors.render(CCamera::getInstance().getViewMatrix(), CCamera::getInstance().getProjectionMatrix(), g_eyeloc,
+                       g_light->getPos());
+    glUseProgram(g_shadingProg);
+    renderDebris();
+    // 貼花投影在不透明物件上，必須在透明網格之前
+    g_decalRenderer.render(g_decals, CCamera::getInstance().getViewMatrix(), CCamera::getInstance().getProjectionMatrix(),
+                           g_eyeloc, g_light->getPos());
+    g_billboards.render(CCamera::getInstance().getViewMatrix(), CCamera::getInstance().getProjectionMatrix(), g_eyeloc);
+    glUseProgram(g_shadingProg);
+    g_oitRenderer.render(g_sceneObjects, g_shadingProg, g_eyeloc, setupObject);
+    g_particleRenderer.render(g_particles, CCamera::getInstance().getViewProjectionMatrix(), g_eyeloc);
+    glUseProgram(g_shadingProg);
+    glUniform1i(glGetUniformLocation(g_shadingProg, "uUseIrradianceSH"), 0);
+}
+
+// 移動物件在包圍盒中心對 Irradiance Volume 取樣，整個物件使用同一組球諧係數
+void uploadIrradianceSH(const SceneObject& obj)
+{
+    glm::vec3 sh[SH_COEFF_COUNT];
+    bool useSH = !obj.isStatic && g_irradianceVolume.sample((obj.worldMin + obj.worldMax) * 0.5f, sh);
+    if (useSH) {
+        glUniform3fv(glGetUniformLocation(g_shadingProg, "uSH"), SH_COEFF_COUNT, glm::value_ptr(sh[0]));
+    }
+    glUniform1i(glGetUniformLocation(g_shadingProg, "uUseIrradianceSH"), useSH ? 1 : 0);
+}
+
+// 打壞的家具碎片：update() 已依碎片排序好模型矩陣，上傳後每個模型的每個碎片一次 instanced draw
+void renderDebris()
+{
+    if (g_debris.getInstanceCount() == 0) return;
+    glBindBuffer(GL_ARRAY_BUFFER, g_debrisInstanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, g_debris.getInstanceCount() * sizeof(glm::mat4),
+                    g_debris.getInstanceMatrices().data());
+    glUniform1i(glGetUniformLocation(g_shadingProg, "uUseIrradianceSH"), 0);
+    for (int source = 0; source < g_debris.getSourceCount(); ++source) {
+        g_fractureModels[source]->RenderFractureInstanced(g_shadingProg, g_debrisInstanceVBO, g_debris.getRanges(source));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// 家具碰撞代理的名稱，打壞時以此為前綴移除（每個網格的名稱為 name + " (Mesh k)"）
+std::string propColliderName(size_t i)
+{
+    return "Prop " + std::to_string(i) + ": " + modelPaths[i];
+}
+
+// 房間格子的家具實體（同一個房間可能有兩個相同的模型，以索引區分）
+std::string gridColliderName(size_t k)
+{
+    const FurnitureInstance& furniture = g_gridFurniture[k];
+    return "Grid " + std::to_string(k) + ": " + modelPaths[furniture.model] + " in Room " + std::to_string(furniture.room + 1);
+}
+
+// 把以 world 擺放的 models[model] 換成碎片，從 impact 向外飛散；碎片池或剛體池已滿時不打壞並回傳 false
+bool breakFurniture(size_t model, const glm::mat4& world, const std::string& colliderName, const glm::vec3& impact)
+{
+    if (g_fractureSources[model] < 0 ||
+        g_debris.breakObject(g_fractureSources[model], world, impact, 4.0f, g_rigidBodies) == 0) {
+        return false;
+    }
+    g_collisionManager.removeObstacles(colliderName + " (");
+    // 原本放在家具上（或靠著它）睡眠中的碎片失去支撐
+    glm::vec3 bmin, bmax;
+    transformAABB(models[model]->getBoundsMin(), models[model]->getBoundsMax(), world, bmin, bmax);
+    g_rigidBodies.wakeInRadius((bmin + bmax) * 0.5f, glm::length(bmax - bmin) * 0.5f + 0.5f);
+    return true;
+}
+
+// 空白鍵：打壞視線前方最近的家具（桌子、沙發、床、馬桶、書桌、木頭方塊），以網格 BVH 判斷是否打中
+// 牆壁比家具近時不處理；碎片從打中的點向外飛散
+void breakPropInFront()
+{
+    glm::vec3 forward = glm::normalize(g_centerloc.getPos() - g_eyeloc);
+    float nearest = 30.0f;
+    int target = -1;
+    ModelRayHit hit, targetHit;
+    for (int i : { 1, 2, 3, 4, 5, 7, 8 }) {
+        if (g_brokenModels[i] || !models[i]->Raycast(computeModelMatrix(i), g_eyeloc, forward, nearest, hit)) continue;
+        nearest = hit.t;
+        target = i;
+        targetHit = hit;
+    }
+    RaycastHit wallHit;
+    if (target < 0 || (g_collisionManager.raycastHit(g_eyeloc, forward, nearest, 0.0f, wallHit) &&
+                       wallHit.type == ColliderType::WALL)) {
+        return;
+    }
+    if (!breakFurniture(target, computeModelMatrix(target), propColliderName(target), targetHit.point)) {
+        std::cout << "Cannot break " << modelPaths[target] << " (no fracture or debris pool full)" << std::endl;
+        return;
+    }
+    g_brokenModels[target] = true;
+    g_shadowManager.invalidateAll();
+    std::cout << "Broke " << modelPaths[target] << " into " << models[target]->GetFractureChunks().size()
+              << " chunks (" << g_debris.getPieceCount() << " pieces, " << g_rigidBodies.getActiveCount() << " bodies)"
+              << std::endl;
+}
+
+// 'k' 鍵：同時打壞離攝影機最近的 MASS_BREAK_COUNT 個家具（房間內的家具與 --room-grid 的家具實體），
+// 輸出打壞所花的時間，之後 BREAK_TIMING_FRAMES 個 frame 的平均與最長時間由 update() 輸出
+void breakManyFurniture()
+{
+    struct Candidate {
+        float distance;
+        int model;
+        int grid;   // g_gridFurniture 的索引，-1 表示 models[model] 本身
+    };
+    std::vector<Candidate> candidates;
+    for (int i : { 1, 2, 3, 4, 5, 7, 8 }) {
+        if (g_brokenModels[i]) continue;
+        glm::vec3 center = glm::vec3(computeModelMatrix(i) * glm::vec4((models[i]->getBoundsMin() + models[i]->getBoundsMax()) * 0.5f, 1.0f));
+        candidates.push_back({ glm::length(center - g_eyeloc), i, -1 });
+    }
+    for (size_t k = 0; k < g_gridFurniture.size(); ++k) {
+        if (g_brokenGridFurniture[k]) continue;
+        glm::vec3 center = (g_gridFurniture[k].worldMin + g_gridFurniture[k].worldMax) * 0.5f;
+        candidates.push_back({ glm::length(center - g_eyeloc), g_gridFurniture[k].model, static_cast<int>(k) });
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+
+    auto start = std::chrono::steady_clock::now();
+    int broken = 0;
+    for (const Candidate& c : candidates) {
+        if (broken == MASS_BREAK_COUNT) break;
+        bool grid = c.grid >= 0;
+        glm::mat4 world = grid ? g_gridFurniture[c.grid].world : computeModelMatrix(c.model);
+        glm::vec3 center = glm::vec3(world * glm::vec4((models[c.model]->getBoundsMin() + models[c.model]->getBoundsMax()) * 0.5f, 1.0f));
+        // 從靠近攝影機的一側打中
+        glm::vec3 impact = center + glm::normalize(g_eyeloc - center) * 0.5f;
+        if (!breakFurniture(c.model, world, grid ? gridColliderName(c.grid) : propColliderName(c.model), impact)) continue;
+        if (grid) g_brokenGridFurniture[c.grid] = true;
+        else g_brokenModels[c.model] = true;
+        broken++;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    g_shadowManager.invalidateAll();
+    std::cout << "Broke " << broken << " objects in " << ms << " ms (" << g_debris.getPieceCount() << " pieces, "
+              << g_rigidBodies.getActiveCount() << " bodies)" << std::endl;
+    startFrameTiming("breaking");
+}
+
+void startFrameTiming(const std::string& label)
+{
+    g_frameTimingLabel = label;
+    g_breakTimingFrames = BREAK_TIMING_FRAMES;
+    g_breakTimingSum = g_breakTimingMax = 0.0f;
+}
+
+// 'f' 鍵：從攝影機沿視線方向發射一顆子彈
+void fireProjectile()
+{
+    ProjectileDesc desc;
+    desc.position = g_eyeloc;
+    desc.velocity = glm::normalize(g_centerloc.getPos() - g_eyeloc) * PROJECTILE_SPEED;
+    desc.tag = PROJECTILE_TAG_PLAYER;
+    if (!g_projectiles.spawn(desc)) std::cout << "Projectile pool full" << std::endl;
+}
+
+// 'j' 鍵：從攝影機往隨機方向發射 PROJECTILE_STRESS_COUNT 個投射物，一半受重力，輸出之後的 frame 時間
+void fireProjectileStress()
+{
+    int fired = 0;
+    for (int i = 0; i < PROJECTILE_STRESS_COUNT; ++i) {
+        float z = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+        float a = static_cast<float>(rand()) / RAND_MAX * 6.2831853f;
+        float r = std::sqrt(1.0f - z * z);
+        ProjectileDesc desc;
+        desc.position = g_eyeloc;
+        desc.velocity = glm::vec3(r * std::cos(a), z, r * std::sin(a)) * (10.0f + 50.0f * rand() / RAND_MAX);
+        desc.gravityScale = (i & 1) ? 1.0f : 0.0f;
+        desc.lifetime = 5.0f;
+        desc.tag = PROJECTILE_TAG_STRESS;
+        if (!g_projectiles.spawn(desc)) break;
+        fired++;
+    }
+    std::cout << "Fired " << fired << " projectiles (" << g_projectiles.getCount() << " active)" << std::endl;
+    startFrameTiming("firing " + std::to_string(fired) + " projectiles");
+}
+
+// 取出投射物打中的事件：玩家的子彈打中牆壁時留下彈孔，打中家具（碰撞代理的名稱以 propColliderName / gridColliderName
+// 開頭）時打壞它，打不壞的障礙物留下撞擊痕跡
+// 事件的 colliderId 在障礙物移除後失效，先取得所有事件的名稱再打壞
+void handleProjectileHits()
+{
+    struct Target {
+        std::string name;
+        glm::vec3 position, normal;
+    };
+    std::vector<Target> targets;
+    ProjectileHit hit;
+    while (g_projectiles.popHit(hit)) {
+        if (hit.tag != PROJECTILE_TAG_PLAYER) continue;
+        if (hit.type == ColliderType::WALL) {
+            DecalDesc decal;
+            decal.position = hit.position;
+            decal.normal = hit.normal;
+            decal.rotation = static_cast<float>(rand()) / RAND_MAX * 6.2831853f;
+            g_decals.add(decal);
+            g_sparkBurst.position = g_dustBurst.position = hit.position + hit.normal * 0.02f;
+            g_sparkBurst.direction = g_dustBurst.direction = hit.normal;
+            g_particles.emitBurst(g_sparkBurst, 40);
+            g_particles.emitBurst(g_dustBurst, 12);
+            continue;
         }
-        else if(i == 11){
-            modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 1.0f, -12.0f));
-            modelMatrix = modelMatrix * models[i]->getModelMatrix();
-            models[11]->setBillboard(true, BillboardType::SPHERICAL);
+        targets.push_back({ g_collisionManager.getColliderName(hit.type, hit.colliderId), hit.position, hit.normal });
+    }
+    bool broke = false;
+    for (const auto& target : targets) {
+        int index = -1;
+        if (std::sscanf(target.name.c_str(), "Prop %d:", &index) == 1) {
+            if (g_brokenModels[index] ||
+                !breakFurniture(index, computeModelMatrix(index), propColliderName(index), target.position)) {
+                continue;
+            }
+            g_brokenModels[index] = true;
+            std::cout << "Shot " << modelPaths[index] << std::endl;
+        } else if (std::sscanf(target.name.c_str(), "Grid %d:", &index) == 1) {
+            const FurnitureInstance& furniture = g_gridFurniture[index];
+            if (g_brokenGridFurniture[index] ||
+                !breakFurniture(furniture.model, furniture.world, gridColliderName(index), target.position)) {
+                continue;
+            }
+            g_brokenGridFurniture[index] = true;
+            std::cout << "Shot " << gridColliderName(index) << std::endl;
+        } else {
+            DecalDesc decal;
+            decal.position = target.position;
+            decal.normal = target.normal;
+            decal.size = 0.3f;
+            decal.rotation = static_cast<float>(rand()) / RAND_MAX * 6.2831853f;
+            decal.type = DecalType::IMPACT;
+            g_decals.add(decal);
+            continue;
         }
-        
-        
-        if (modelLoc != -1) {
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelMatrix));
+        broke = true;
+    }
+    if (broke) g_shadowManager.invalidateAll();
+}
+
+// 粒子的 style 與發射器：火花為相加混合、受重力並在地面反彈；灰塵緩慢擴散；
+// 光源周圍的光點與電風扇吹出的灰塵由 update() 每個 frame 設定發射器的位置
+void setupParticles()
+{
+    g_particles.setThreadPool(&g_threadPool);
+    g_particles.setFloor(0.0f, 0.35f, 0.6f);
+
+    ParticleStyle spark;
+    spark.colorStart = glm::vec4(1.0f, 0.85f, 0.4f, 1.0f);
+    spark.colorEnd = glm::vec4(0.9f, 0.2f, 0.05f, 0.0f);
+    spark.sizeStart = 0.04f;
+    spark.sizeEnd = 0.015f;
+    spark.additive = true;
+    ParticleStyle dust;
+    dust.colorStart = glm::vec4(0.6f, 0.58f, 0.55f, 0.5f);
+    dust.colorEnd = glm::vec4(0.6f, 0.58f, 0.55f, 0.0f);
+    dust.sizeStart = 0.1f;
+    dust.sizeEnd = 0.4f;
+    ParticleStyle mote;
+    mote.colorStart = glm::vec4(1.0f, 0.95f, 0.7f, 0.8f);
+    mote.colorEnd = glm::vec4(1.0f, 0.95f, 0.7f, 0.0f);
+    mote.sizeStart = mote.sizeEnd = 0.03f;
+    mote.additive = true;
+
+    g_sparkBurst.style = g_particles.addStyle(spark);
+    g_sparkBurst.spread = 0.9f;
+    g_sparkBurst.speedMin = 2.0f;
+    g_sparkBurst.speedMax = 7.0f;
+    g_sparkBurst.lifetimeMin = 0.3f;
+    g_sparkBurst.lifetimeMax = 0.9f;
+
+    g_dustBurst.style = g_particles.addStyle(dust);
+    g_dustBurst.spread = 0.6f;
+    g_dustBurst.speedMin = 0.3f;
+    g_dustBurst.speedMax = 1.2f;
+    g_dustBurst.lifetimeMin = 0.8f;
+    g_dustBurst.lifetimeMax = 1.6f;
+    g_dustBurst.gravityScale = 0.05f;
+    g_dustBurst.damping = 2.0f;
+
+    ParticleEmitterDesc motes;
+    motes.style = g_particles.addStyle(mote);
+    motes.spread = 1.0f;
+    motes.positionJitter = 0.6f;
+    motes.speedMin = 0.02f;
+    motes.speedMax = 0.15f;
+    motes.lifetimeMin = 2.0f;
+    motes.lifetimeMax = 4.0f;
+    motes.gravityScale = 0.0f;
+    motes.rate = 40.0f;
+    g_lightEmitter = g_particles.addEmitter(motes);
+
+    ParticleEmitterDesc fanDust = g_dustBurst;
+    fanDust.direction = glm::vec3(0.0f, 0.0f, 1.0f);
+    fanDust.spread = 0.35f;
+    fanDust.positionJitter = 0.3f;
+    fanDust.speedMin = 1.0f;
+    fanDust.speedMax = 2.0f;
+    fanDust.lifetimeMin = 1.5f;
+    fanDust.lifetimeMax = 3.0f;
+    fanDust.damping = 0.8f;
+    fanDust.rate = 25.0f;
+    g_fanEmitter = g_particles.addEmitter(fanDust);
+}
+
+// 'v' 鍵：在視線前方 3 公尺處一次產生 PARTICLE_STRESS_COUNT 個火花，輸出之後的 frame 時間
+void spawnParticleStress()
+{
+    glm::vec3 forward = glm::normalize(g_centerloc.getPos() - g_eyeloc);
+    ParticleEmitterDesc burst = g_sparkBurst;
+    burst.position = g_eyeloc + forward * 3.0f;
+    burst.direction = glm::vec3(0.0f, 1.0f, 0.0f);
+    burst.spread = 2.0f;
+    burst.lifetimeMin = 1.5f;
+    burst.lifetimeMax = 3.0f;
+    auto start = std::chrono::steady_clock::now();
+    int emitted = g_particles.emitBurst(burst, PARTICLE_STRESS_COUNT);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Emitted " << emitted << " particles in " << ms << " ms (" << g_particles.getCount() << " active)"
+              << std::endl;
+    startFrameTiming("emitting " + std::to_string(emitted) + " particles");
+}
+
+// 'y' 鍵：在攝影機周圍 40 公尺內加入 BILLBOARD_STRESS_COUNT 個告示牌（三種 BillboardType 輪流），再按一次移除
+void toggleBillboardStress()
+{
+    g_billboardStress = !g_billboardStress;
+    g_billboards.clear();
+    for (const BillboardDesc& sign : g_roomSigns) g_billboards.add(sign);
+    if (g_billboardStress) {
+        for (int i = 0; i < BILLBOARD_STRESS_COUNT; ++i) {
+            BillboardDesc sign;
+            float angle = static_cast<float>(rand()) / RAND_MAX * 6.2831853f;
+            float distance = 2.0f + 38.0f * std::sqrt(static_cast<float>(rand()) / RAND_MAX);
+            sign.position = glm::vec3(g_eyeloc.x + std::cos(angle) * distance, 0.0f, g_eyeloc.z + std::sin(angle) * distance);
+            sign.size = glm::vec2(0.6f + 0.8f * rand() / RAND_MAX);
+            sign.type = static_cast<BillboardType>(i % 3);
+            // 直立的告示牌放在地面上，其餘浮在空中
+            sign.pivot = (sign.type == BillboardType::CYLINDRICAL) ? glm::vec2(0.5f, 0.0f) : glm::vec2(0.5f);
+            if (sign.type != BillboardType::CYLINDRICAL) sign.position.y = 1.0f + 6.0f * rand() / RAND_MAX;
+            sign.color = glm::vec4(0.6f + 0.4f * rand() / RAND_MAX, 0.6f + 0.4f * rand() / RAND_MAX, 0.6f + 0.4f * rand() / RAND_MAX, 1.0f);
+            g_billboards.add(sign);
+        }
+    }
+    std::cout << "Billboards: " << g_billboards.getCount() << " (" << (g_billboardStress ? "stress on" : "stress off")
+              << ")" << std::endl;
+    startFrameTiming(std::to_string(g_billboards.getCount()) + " billboards");
+}
+
+// 'u' 鍵：從攝影機往隨機方向對場景做 DECAL_STRESS_COUNT 次射線檢測，在打中的位置加入隨機種類的貼花
+void spawnDecalStress()
+{
+    auto start = std::chrono::steady_clock::now();
+    int added = 0;
+    RaycastHit hit;
+    for (int i = 0; i < DECAL_STRESS_COUNT; ++i) {
+        float z = static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f;
+        float a = static_cast<float>(rand()) / RAND_MAX * 6.2831853f;
+        float r = std::sqrt(1.0f - z * z);
+        glm::vec3 direction(r * std::cos(a), z, r * std::sin(a));
+        if (!g_collisionManager.raycastHit(g_eyeloc, direction, DECAL_STRESS_RANGE, 0.0f, hit)) continue;
+        DecalDesc decal;
+        decal.position = hit.point;
+        decal.normal = hit.normal;
+        decal.type = static_cast<DecalType>(rand() % 4);
+        decal.size = (decal.type == DecalType::BULLET_HOLE) ? 0.15f : 0.3f + 0.4f * rand() / RAND_MAX;
+        decal.rotation = static_cast<float>(rand()) / RAND_MAX * 6.2831853f;
+        g_decals.add(decal);
+        added++;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Added " << added << " decals in " << ms << " ms (" << g_decals.getLiveCount() << " live, "
+              << g_decals.getRecycledCount() << " recycled)" << std::endl;
+    startFrameTiming("adding " + std::to_string(added) + " decals");
+}
+
+// 每個 model 的世界矩陣（所有模型都先縮放 0.7）
+glm::mat4 computeModelMatrix(size_t i)
+{
+    glm::mat4 modelMatrix = modelMatrices[i];
+    modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 0.0f, 0.0f));
+    modelMatrix = glm::scale(modelMatrix, glm::vec3(0.7f));
+
+    if (i == 7) {
+        modelMatrix = glm::translate(modelMatrix, glm::vec3(-1.0f, 1.5f, -6.0f));
+        modelMatrix = glm::scale(modelMatrix, glm::vec3(1.3f));
+    }
+    else if (i == 8) {
+        modelMatrix = glm::translate(modelMatrix, glm::vec3(3.0f, 1.5f, -6.0f));
+        modelMatrix = glm::scale(modelMatrix, glm::vec3(1.3f));
+        modelMatrix = glm::rotate(modelMatrix, glm::radians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+    else if (i == 9 ){
+        if (models[9]->isFollowingCamera()) {
+            // 取得模型自己計算的矩陣，然後加上縮放
+            modelMatrix = models[9]->getModelMatrix();
+            modelMatrix = glm::scale(modelMatrix, glm::vec3(0.07f));
+            // 可以加上額外的旋轉
+            modelMatrix = glm::rotate(modelMatrix, glm::radians(270.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        } else {
+            // 如果不跟隨攝影機，使用原來的固定位置
+            modelMatrix = glm::translate(modelMatrix, glm::vec3(5.0f, 1.15f, 5.0f));
+            modelMatrix = glm::scale(modelMatrix, glm::vec3(0.07f));
+            modelMatrix = glm::rotate(modelMatrix, glm::radians(270.0f), glm::vec3(0.0f, 1.5f, 0.0f));
         }
-        models[i]->Render(g_shadingProg);
     }
+    else if(i == 10){
+        modelMatrix = glm::translate(modelMatrix, glm::vec3(-30.0f, 17.0f, -8.0f));
+        modelMatrix = modelMatrix * models[i]->getModelMatrix();
+    }
+    else if(i == 11){
+        modelMatrix = glm::translate(modelMatrix, glm::vec3(0.0f, 1.0f, -12.0f));
+        modelMatrix = modelMatrix * models[i]->getModelMatrix();
+    }
+    return modelMatrix;
 }
 //----------------------------------------------------------------------------
 
@@ -360,15 +993,191 @@ void update(float dt)
     models[9]->update(dt);
     models[10]->update(dt);
     models[11]->update(dt);
+    g_projectiles.update(dt, g_collisionManager);
+    handleProjectileHits();
+    // 發射器跟著光源與電風扇移動，風往電風扇的前方（模型的 z 軸）吹
+    g_particles.setEmitterPosition(g_lightEmitter, g_light->getPos());
+    glm::mat4 fanWorld = computeModelMatrix(FAN_MODEL_INDEX);
+    g_particles.setEmitterPosition(g_fanEmitter, glm::vec3(fanWorld[3]));
+    g_particles.setEmitterDirection(g_fanEmitter, glm::normalize(glm::vec3(fanWorld[2])));
+    g_particles.setEmitterEnabled(g_fanEmitter, !g_brokenModels[FAN_MODEL_INDEX]);
+    g_particles.update(dt);
+    g_rigidBodies.update(dt, g_collisionManager);
+    g_debris.buildInstances(g_rigidBodies);
+    if (g_breakTimingFrames > 0) {
+        g_breakTimingSum += dt;
+        g_breakTimingMax = std::max(g_breakTimingMax, dt);
+        if (--g_breakTimingFrames == 0) {
+            std::cout << "Frame time after " << g_frameTimingLabel << ": avg "
+                      << g_breakTimingSum * 1000.0f / BREAK_TIMING_FRAMES << " ms, max " << g_breakTimingMax * 1000.0f
+                      << " ms over " << BREAK_TIMING_FRAMES << " frames (" << g_rigidBodies.getStats().awake
+                      << " bodies awake, " << g_projectiles.getCount() << " projectiles, " << g_particles.getCount()
+                      << " particles)" << std::endl;
+        }
+    }
+
+    // 重建場景物件清單：機器人、電風扇、Billboard 會移動，其餘為靜態；打壞的家具不再描繪
+    g_sceneObjects.clear();
+    for (size_t i = 0; i < models.size(); ++i) {
+        if (g_brokenModels[i]) continue;
+        SceneObject obj;
+        obj.model = models[i].get();
+        obj.world = computeModelMatrix(i);
+        obj.isStatic = !(i == 9 || i == 10 || i == 11);
+        obj.id = static_cast<int>(i);
+        obj.impostor = g_impostorOf.empty() ? -1 : g_impostorOf[i];
+        transformAABB(obj.model->getBoundsMin(), obj.model->getBoundsMax(), obj.world, obj.worldMin, obj.worldMax);
+        obj.lodPixelsPerUnit = projectedPixelsPerUnit(obj);
+        g_sceneObjects.push_back(obj);
+    }
+    // 房間格子的家具實體共用 models[] 的網格，只有世界矩陣不同
+    for (size_t k = 0; k < g_gridFurniture.size(); ++k) {
+        if (g_brokenGridFurniture[k]) continue;
+        const FurnitureInstance& furniture = g_gridFurniture[k];
+        SceneObject obj;
+        obj.model = models[furniture.model].get();
+        obj.world = furniture.world;
+        obj.impostor = g_impostorOf.empty() ? -1 : g_impostorOf[furniture.model];
+        transformAABB(obj.model->getBoundsMin(), obj.model->getBoundsMax(), obj.world, obj.worldMin, obj.worldMax);
+        obj.lodPixelsPerUnit = projectedPixelsPerUnit(obj);
+        g_sceneObjects.push_back(obj);
+    }
+}
+
+// 包圍球上離攝影機最近的點的距離下，模型空間每單位在螢幕上的像素數（世界矩陣取最大的縮放）
+// 攝影機在包圍球內時回傳 0（使用原本的網格）
+float projectedPixelsPerUnit(const SceneObject& obj)
+{
+    glm::vec3 center = (obj.worldMin + obj.worldMax) * 0.5f;
+    float radius = glm::length(obj.worldMax - obj.worldMin) * 0.5f;
+    float distance = glm::length(center - g_eyeloc) - radius;
+    if (distance <= 0.0f) return 0.0f;
+    float scale = std::max(glm::length(glm::vec3(obj.world[0])),
+                           std::max(glm::length(glm::vec3(obj.world[1])), glm::length(glm::vec3(obj.world[2]))));
+    // proj[1][1] = 1 / tan(fovy / 2)
+    float focal = CCamera::getInstance().getProjectionMatrix()[1][1] * SCREEN_HEIGHT * 0.5f;
+    return focal * scale / distance;
+}
+
+// 'm' 鍵：切換 LOD 的螢幕誤差門檻（2 像素、4 像素、關閉），輸出之後的 frame 時間
+void cycleLodThreshold()
+{
+    g_lodSetting = (g_lodSetting + 1) % (sizeof(g_lodPixelErrors) / sizeof(g_lodPixelErrors[0]));
+    float pixelError = g_lodPixelErrors[g_lodSetting];
+    std::string label = pixelError > 0.0f ? "LOD " + std::to_string(static_cast<int>(pixelError)) + " px" : "LOD off";
+    std::cout << "Mesh " << label << std::endl;
+    startFrameTiming(label);
+}
+
+// 'x' 鍵：切換遠處家具的 impostor，輸出之後的 frame 時間
+void toggleImpostors()
+{
+    g_impostorsEnabled = !g_impostorsEnabled;
+    std::string label = g_impostorsEnabled ? "impostors on" : "impostors off";
+    std::cout << "Furniture " << label << std::endl;
+    startFrameTiming(label);
+}
+
+// 'z' 鍵：切換叢集剔除（視錐 + 背面、只有視錐、關閉），輸出之後的 frame 時間
+void cycleClusterCulling()
+{
+    g_clusterMode = (g_clusterMode + 1) % (sizeof(g_clusterModes) / sizeof(g_clusterModes[0]));
+    std::string label = std::string("cluster culling ") + g_clusterModes[g_clusterMode];
+    std::cout << "Mesh " << label << std::endl;
+    startFrameTiming(label);
+}
+
+// '1' 鍵：切換模型與 CShape 的頂點格式（量化 / float），輸出之後的 frame 時間
+void toggleVertexFormat()
+{
+    g_vertexFormat = (g_vertexFormat == VertexFormat::QUANTIZED) ? VertexFormat::FLOAT : VertexFormat::QUANTIZED;
+    for (auto& model : models) model->SetVertexFormat(g_vertexFormat);
+    // 還沒上傳的 CShape 不受影響，之後以 CShape::setDefaultVertexFormat 的格式上傳
+    CShape::setDefaultVertexFormat(g_vertexFormat);
+    g_tknot.setVertexFormat(g_vertexFormat);
+    g_sphere.setVertexFormat(g_vertexFormat);
+    g_centerloc.setVertexFormat(g_vertexFormat);
+    for (int i = 0; i < ROW_NUM; i++) {
+        for (int j = 0; j < ROW_NUM; j++) g_floor[i][j].setVertexFormat(g_vertexFormat);
+    }
+    for (int i = 0; i < lightManager.getLightCount(); i++) lightManager.getLight(i)->setVertexFormat(g_vertexFormat);
+    std::string label = g_vertexFormat == VertexFormat::QUANTIZED ? "quantized vertices" : "float vertices";
+    std::cout << "Models and shapes use " << label << std::endl;
+    startFrameTiming(label);
+}
+
+void printRenderStats()
+{
+    g_shadowManager.printStats();
+    g_probeManager.printStats();
+    g_oitRenderer.printStats();
+    g_decalRenderer.printStats();
+    g_particleRenderer.printStats();
+    g_billboards.printStats();
+    g_impostors.printStats();
+    if (g_clusterMode != 2) g_clusterCuller.printStats();
+    else std::cout << "Cluster culling: off" << std::endl;
+    float pixelError = g_lodPixelErrors[g_lodSetting];
+    std::cout << "Mesh LOD: ";
+    if (pixelError > 0.0f) std::cout << "on, screen-space error threshold " << pixelError << " px";
+    else std::cout << "off";
+    std::cout << "; opaque triangles " << g_trianglesDrawn << " drawn, " << g_trianglesFullDetail << " at full detail ("
+              << (g_trianglesFullDetail > 0 ? 100.0 * g_trianglesDrawn / g_trianglesFullDetail : 100.0) << "%)" << std::endl;
+    size_t modelBytes = 0, modelFloatBytes = 0, modelIndexBytes = 0, modelUint32IndexBytes = 0;
+    for (const auto& model : models) {
+        modelBytes += model->GetVertexBufferBytes();
+        modelFloatBytes += model->GetFloatVertexBufferBytes();
+        modelIndexBytes += model->GetIndexBufferBytes();
+        modelUint32IndexBytes += model->GetUint32IndexBufferBytes();
+    }
+    std::cout << "Vertex buffers: models " << modelBytes / 1024 << " KB (float " << modelFloatBytes / 1024 << " KB), shapes "
+              << CShape::getUploadedVertexBytes() / 1024.0 << " KB (float " << CShape::getUploadedFloatVertexBytes() / 1024.0
+              << " KB)" << std::endl;
+    std::cout << "Index buffers: models " << modelIndexBytes / 1024 << " KB (32-bit " << modelUint32IndexBytes / 1024
+              << " KB), shapes " << CShape::getUploadedIndexBytes() / 1024.0 << " KB (32-bit "
+              << CShape::getUploadedUint32IndexBytes() / 1024.0 << " KB)" << std::endl;
 }
 
 void releaseAll()
 {
 //    g_modelManager.cleanup();
+    g_shadowManager.release();
+    g_probeManager.release();
+    g_oitRenderer.release();
+    g_decalRenderer.release();
+    g_particleRenderer.release();
+    g_billboards.release();
+    g_impostors.release();
+    if (g_debrisInstanceVBO != 0) glDeleteBuffers(1, &g_debrisInstanceVBO);
     lightManager.clearLights();
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // 房間格子的規模測試：--room-grid CxR [--furniture N] [--door-chance P] [--no-merge]
+    // 頂點格式的比較：--float-vertices
+    g_roomGridConfig.furniturePerRoom = 3;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--room-grid" && hasValue &&
+            std::sscanf(argv[i + 1], "%dx%d", &g_roomGridConfig.cols, &g_roomGridConfig.rows) == 2) {
+            g_useRoomGrid = true;
+            i++;
+        }
+        else if (arg == "--furniture" && hasValue) g_roomGridConfig.furniturePerRoom = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--door-chance" && hasValue) g_roomGridConfig.doorChance = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--no-merge") g_roomGridConfig.mergeWalls = false;
+        else if (arg == "--float-vertices") g_vertexFormat = VertexFormat::FLOAT;
+        else {
+            std::cout << "Usage: Homework [--room-grid CxR] [--furniture N] [--door-chance P] [--no-merge] [--float-vertices]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    Model::SetDefaultVertexFormat(g_vertexFormat);
+    CShape::setDefaultVertexFormat(g_vertexFormat);
+
     // ------- 檢查與建立視窗  ---------------  
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -0,0 +1,16 @@
+// billboard_fragshader.glsl
+// 貼圖乘上 billboard 的顏色，alpha 低於 0.5 的像素捨棄
+#version 330 core
+
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uTexture;
+
+out vec4 FragColor;
+
+void main() {
+    vec4 color = texture(uTexture, vTexCoord) * vColor;
+    if (color.a < 0.5) discard;
+    FragColor = vec4(color.rgb, 1.0);
+}
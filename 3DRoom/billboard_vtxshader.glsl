@@ -0,0 +1,50 @@
+// billboard_vtxshader.glsl
+// CBillboardBatch：每個 billboard 一個四邊形（triangle strip 的 4 個頂點由 gl_VertexID 產生），
+// 依 BillboardType 在這裡算出四邊形的兩個軸，與 Model::calculateBillboardMatrix 的三種算法相同
+#version 330 core
+
+layout(location = 0) in vec4 aCenterType;   // xyz = 中心, w = 0 SPHERICAL, 1 CYLINDRICAL, 2 SCREEN_ALIGNED
+layout(location = 1) in vec4 aSizePivot;    // xy = 寬高, zw = 中心在四邊形上的位置（0 ~ 1）
+layout(location = 2) in vec4 aAtlas;
+layout(location = 3) in vec4 aColor;
+
+uniform mat4 uViewProj;
+uniform vec3 uViewPos;
+uniform vec3 uCameraRight;   // view matrix 的第一列
+uniform vec3 uCameraUp;      // view matrix 的第二列
+uniform vec3 uUp;            // CYLINDRICAL 的旋轉軸
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main() {
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec3 center = aCenterType.xyz;
+    int type = int(aCenterType.w + 0.5);
+
+    vec3 right;
+    vec3 up;
+    if (type == 2) {
+        // calculateScreenAlignedBillboard：直接使用攝影機的座標軸
+        right = uCameraRight;
+        up = uCameraUp;
+    } else {
+        vec3 axis = (type == 1) ? uUp : vec3(0.0, 1.0, 0.0);
+        vec3 forward = uViewPos - center;
+        // calculateCylindricalBillboard：攝影機的方向投影到與旋轉軸垂直的平面
+        if (type == 1) forward -= axis * dot(forward, axis);
+        float forwardLength = length(forward);
+        forward = (forwardLength > 1e-5) ? forward / forwardLength : -cross(uCameraRight, uCameraUp);
+        right = cross(axis, forward);
+        float rightLength = length(right);
+        // 攝影機在正上方或正下方時 right 退化，改用攝影機的右方
+        right = (rightLength > 1e-4) ? right / rightLength : uCameraRight;
+        up = (type == 1) ? axis : cross(forward, right);
+    }
+
+    vec2 local = (corner - aSizePivot.zw) * aSizePivot.xy;
+    vec3 world = center + right * local.x + up * local.y;
+    vTexCoord = aAtlas.xy + corner * aAtlas.zw;
+    vColor = aColor;
+    gl_Position = uViewProj * vec4(world, 1.0);
+}
@@ -0,0 +1,10 @@
+//  BillboardType.h
+//  Model::setBillboard 與 CBillboardBatch 共用的 Billboard 種類
+
+#pragma once
+
+enum class BillboardType {
+    SPHERICAL,    // 完全面向攝影機（所有軸都對齊）
+    CYLINDRICAL,  // 只繞Y軸旋轉（保持直立）
+    SCREEN_ALIGNED // 與螢幕平面對齊
+};
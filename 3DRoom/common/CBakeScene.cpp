@@ -0,0 +1,194 @@
+//  CBakeScene.cpp
+#include "CBakeScene.h"
+#include <cmath>
+#include <iostream>
+
+#include "../tiny_obj_loader.h"
+#include "../stb_image.h"
+
+#define BAKE_RAY_EPSILON 1e-3f
+
+static std::string directoryOf(const std::string& filepath) {
+    size_t pos = filepath.find_last_of("/\\");
+    return (pos == std::string::npos) ? std::string(".") : filepath.substr(0, pos);
+}
+
+// 漫反射貼圖的平均顏色（與 f_phong 相同，不做 gamma 轉換）
+static glm::vec3 averageTextureColor(const std::string& path) {
+    int w, h, n;
+    unsigned char* data = stbi_load(path.c_str(), &w, &h, &n, 3);
+    if (data == nullptr) return glm::vec3(1.0f);
+    double sum[3] = { 0.0, 0.0, 0.0 };
+    size_t count = static_cast<size_t>(w) * h;
+    for (size_t i = 0; i < count; i++) {
+        sum[0] += data[i * 3 + 0];
+        sum[1] += data[i * 3 + 1];
+        sum[2] += data[i * 3 + 2];
+    }
+    stbi_image_free(data);
+    double inv = 1.0 / (255.0 * count);
+    return glm::vec3(float(sum[0] * inv), float(sum[1] * inv), float(sum[2] * inv));
+}
+
+int CBakeScene::addModel(const std::string& objPath, const glm::mat4& world) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> objMaterials;
+    std::string warn, err;
+    std::string directory = directoryOf(objPath);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &objMaterials, &warn, &err, objPath.c_str(), directory.c_str()) ||
+        attrib.vertices.empty()) {
+        std::cerr << "Bake: failed to load " << objPath << " " << err << std::endl;
+        return -1;
+    }
+
+    int instance = static_cast<int>(_materialBase.size());
+    int base = static_cast<int>(_materials.size());
+    _materialBase.push_back(base);
+    for (const auto& objMat : objMaterials) {
+        BakeMaterial mat;
+        mat.name = objMat.name;
+        mat.albedo = glm::vec3(objMat.diffuse[0], objMat.diffuse[1], objMat.diffuse[2]);
+        if (!objMat.diffuse_texname.empty()) {
+            mat.albedo *= averageTextureColor(directory + "/" + objMat.diffuse_texname);
+        }
+        // 與 Model::IsTransparent 相同的判斷
+        float alpha = (objMat.dissolve <= 0.0f) ? 1.0f : objMat.dissolve;
+        mat.transparent = (alpha < 1.0f) || !objMat.alpha_texname.empty();
+        _materials.push_back(mat);
+    }
+
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+    for (const auto& shape : shapes) {
+        // 與 Model::ProcessMesh 相同，整個 shape 使用第一個面的材質
+        int material = -1;
+        if (!shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] >= 0) {
+            material = base + shape.mesh.material_ids[0];
+        }
+        for (size_t f = 0; f + 2 < shape.mesh.indices.size(); f += 3) {
+            BakeTriangle tri;
+            for (int i = 0; i < 3; i++) {
+                const auto& index = shape.mesh.indices[f + i];
+                glm::vec3 p(0.0f), n(0.0f, 1.0f, 0.0f);
+                glm::vec2 uv(0.0f);
+                if (index.vertex_index >= 0) {
+                    p = glm::vec3(attrib.vertices[3 * index.vertex_index + 0],
+                                  attrib.vertices[3 * index.vertex_index + 1],
+                                  attrib.vertices[3 * index.vertex_index + 2]);
+                }
+                if (index.normal_index >= 0) {
+                    n = glm::vec3(attrib.normals[3 * index.normal_index + 0],
+                                  attrib.normals[3 * index.normal_index + 1],
+                                  attrib.normals[3 * index.normal_index + 2]);
+                }
+                if (index.texcoord_index >= 0) {
+                    uv = glm::vec2(attrib.texcoords[2 * index.texcoord_index + 0],
+                                   attrib.texcoords[2 * index.texcoord_index + 1]);
+                }
+                tri.p[i] = glm::vec3(world * glm::vec4(p, 1.0f));
+                tri.n[i] = glm::normalize(normalMatrix * n);
+                tri.uv[i] = uv;
+            }
+            glm::vec3 fn = glm::cross(tri.p[1] - tri.p[0], tri.p[2] - tri.p[0]);
+            float len = glm::length(fn);
+            if (len < 1e-12f) continue; // 退化三角形
+            tri.faceNormal = fn / len;
+            // 面法向量朝向與頂點法向量一致
+            if (glm::dot(tri.faceNormal, tri.n[0] + tri.n[1] + tri.n[2]) < 0.0f) tri.faceNormal = -tri.faceNormal;
+            tri.material = material;
+            tri.instance = instance;
+            _triangles.push_back(tri);
+        }
+    }
+    std::cout << "Bake: loaded " << objPath << " (" << _triangles.size() << " triangles total)" << std::endl;
+    return instance;
+}
+
+void CBakeScene::buildBVH() {
+    std::vector<glm::vec3> positions;
+    positions.reserve(_triangles.size() * 3);
+    _bvhToTriangle.clear();
+    for (size_t i = 0; i < _triangles.size(); i++) {
+        const BakeTriangle& tri = _triangles[i];
+        if (tri.material >= 0 && _materials[tri.material].transparent) continue;
+        positions.push_back(tri.p[0]);
+        positions.push_back(tri.p[1]);
+        positions.push_back(tri.p[2]);
+        _bvhToTriangle.push_back(static_cast<int>(i));
+    }
+    _bvh.build(positions);
+    std::cout << "Bake: BVH " << _bvh.getTriangleCount() << " triangles, "
+              << _bvh.getNodeCount() << " nodes" << std::endl;
+}
+
+int CBakeScene::findMaterial(int instance, const std::string& materialName) const {
+    if (instance < 0 || instance >= static_cast<int>(_materialBase.size())) return -1;
+    int first = _materialBase[instance];
+    int last = (instance + 1 < static_cast<int>(_materialBase.size())) ? _materialBase[instance + 1]
+                                                                       : static_cast<int>(_materials.size());
+    for (int i = first; i < last; i++) {
+        if (_materials[i].name == materialName) return i;
+    }
+    return -1;
+}
+
+bool CBakeScene::intersect(const glm::vec3& origin, const glm::vec3& dir, float tMax, BVHHit& hit, int& triangle) const {
+    if (!_bvh.intersect(origin, dir, tMax, hit)) return false;
+    triangle = _bvhToTriangle[hit.triangle];
+    return true;
+}
+
+glm::vec3 CBakeScene::directLight(const glm::vec3& p, const glm::vec3& n) const {
+    glm::vec3 result(0.0f);
+    for (const BakeLight& light : _lights) {
+        glm::vec3 toLight = light.position - p;
+        float dist = glm::length(toLight);
+        if (dist < 1e-4f) continue;
+        glm::vec3 L = toLight / dist;
+        float cosTheta = glm::dot(n, L);
+        if (cosTheta <= 0.0f) continue;
+        if (_bvh.occluded(p + n * BAKE_RAY_EPSILON, L, dist - 2.0f * BAKE_RAY_EPSILON)) continue;
+        float attenuation = 1.0f / (light.constant + light.linear * dist + light.quadratic * dist * dist);
+        result += light.diffuse * (cosTheta * attenuation);
+    }
+    return result;
+}
+
+glm::vec3 CBakeScene::sampleCosineHemisphere(const glm::vec3& n, BakeRandom& rng) {
+    float r1 = rng.nextFloat();
+    float r2 = rng.nextFloat();
+    float r = std::sqrt(r1);
+    float phi = 6.2831853f * r2;
+    glm::vec3 up = std::fabs(n.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 t = glm::normalize(glm::cross(up, n));
+    glm::vec3 b = glm::cross(n, t);
+    return glm::normalize(t * (r * std::cos(phi)) + b * (r * std::sin(phi)) + n * std::sqrt(std::max(0.0f, 1.0f - r1)));
+}
+
+glm::vec3 CBakeScene::traceRadiance(const glm::vec3& origin, const glm::vec3& dir, int bounces, BakeRandom& rng) const {
+    // 漫反射表面：餘弦取樣時 BRDF 與 pdf 相消，throughput 每次只乘上 albedo
+    glm::vec3 radiance(0.0f);
+    glm::vec3 throughput(1.0f);
+    glm::vec3 o = origin, d = dir;
+    for (int bounce = 0; bounce < bounces; bounce++) {
+        BVHHit hit;
+        int triIndex;
+        if (!intersect(o, d, 1e30f, hit, triIndex)) break;
+        const BakeTriangle& tri = _triangles[triIndex];
+        // 打到背面（牆壁外側等）視為不反射光
+        if (glm::dot(tri.faceNormal, d) > 0.0f) break;
+
+        float w = 1.0f - hit.u - hit.v;
+        glm::vec3 p = tri.p[0] * w + tri.p[1] * hit.u + tri.p[2] * hit.v;
+        glm::vec3 n = glm::normalize(tri.n[0] * w + tri.n[1] * hit.u + tri.n[2] * hit.v);
+        if (glm::dot(n, tri.faceNormal) < 0.0f) n = tri.faceNormal;
+        glm::vec3 albedo = (tri.material >= 0) ? _materials[tri.material].albedo : glm::vec3(0.8f);
+
+        throughput *= albedo;
+        radiance += throughput * directLight(p + tri.faceNormal * BAKE_RAY_EPSILON, n);
+
+        o = p + tri.faceNormal * BAKE_RAY_EPSILON;
+        d = sampleCosineHemisphere(n, rng);
+    }
+    return radiance;
+}
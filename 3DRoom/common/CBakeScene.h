@@ -0,0 +1,84 @@
+//  CBakeScene.h
+//  烘焙工具使用的 CPU 端場景：直接用 tinyobj 讀取 OBJ（不建立任何 OpenGL 資源），
+//  把所有靜態模型轉到世界座標後建立 CTriangleBVH，並提供直接光與路徑追蹤的計算
+//  光照的單位與 f_phong.glsl 相同：表面顏色 = 材質 diffuse * 貼圖 * 收到的光
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CTriangleBVH.h"
+
+// 烘焙用的點光源（數值需與執行時的 CLight 相同，diffuse 已乘上 intensity）
+struct BakeLight {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 diffuse = glm::vec3(1.0f);
+    float constant = 1.0f, linear = 0.09f, quadratic = 0.032f;
+};
+
+struct BakeMaterial {
+    std::string name;
+    glm::vec3 albedo = glm::vec3(0.8f);   // Kd * 漫反射貼圖平均顏色
+    bool transparent = false;             // 透明材質（玻璃）不遮擋光線
+};
+
+struct BakeTriangle {
+    glm::vec3 p[3];     // 世界座標
+    glm::vec3 n[3];     // 世界座標法向量
+    glm::vec2 uv[3];
+    glm::vec3 faceNormal;
+    int material = -1;  // 在 CBakeScene 的材質表中的索引
+    int instance = -1;  // addModel 的回傳值
+};
+
+// 每個像素（texel）各自一個亂數產生器，結果與執行緒數量無關
+struct BakeRandom {
+    uint32_t state;
+    explicit BakeRandom(uint32_t seed) : state(seed * 747796405u + 2891336453u) { next(); }
+    uint32_t next() {
+        // PCG-RXS-M-XS 32
+        uint32_t s = state;
+        state = s * 747796405u + 2891336453u;
+        uint32_t w = ((s >> ((s >> 28u) + 4u)) ^ s) * 277803737u;
+        return (w >> 22u) ^ w;
+    }
+    float nextFloat() { return (next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+class CBakeScene {
+public:
+    // 載入 OBJ 並以 world 轉換到世界座標，回傳 instance id，失敗回傳 -1
+    int addModel(const std::string& objPath, const glm::mat4& world);
+    void addLight(const BakeLight& light) { _lights.push_back(light); }
+    // 所有模型加入後呼叫
+    void buildBVH();
+
+    const std::vector<BakeTriangle>& getTriangles() const { return _triangles; }
+    const std::vector<BakeMaterial>& getMaterials() const { return _materials; }
+    const std::vector<BakeLight>& getLights() const { return _lights; }
+    const CTriangleBVH& getBVH() const { return _bvh; }
+
+    // 找出 instance 中名稱為 materialName 的材質，找不到回傳 -1
+    int findMaterial(int instance, const std::string& materialName) const;
+
+    // 最近的不透明交點，回傳三角形在 getTriangles() 中的索引
+    bool intersect(const glm::vec3& origin, const glm::vec3& dir, float tMax, BVHHit& hit, int& triangle) const;
+
+    // 點 p（法向量 n）收到所有光源的直接光（含陰影光線）
+    glm::vec3 directLight(const glm::vec3& p, const glm::vec3& n) const;
+    // 從 origin 沿 dir 看到的光（路徑追蹤，bounces 為最多的反彈次數）
+    glm::vec3 traceRadiance(const glm::vec3& origin, const glm::vec3& dir, int bounces, BakeRandom& rng) const;
+    // 法向量 n 半球上的餘弦分佈取樣
+    static glm::vec3 sampleCosineHemisphere(const glm::vec3& n, BakeRandom& rng);
+
+private:
+    std::vector<BakeTriangle> _triangles;
+    std::vector<BakeMaterial> _materials;
+    std::vector<BakeLight>    _lights;
+    std::vector<int>          _materialBase;  // 每個 instance 第一個材質的索引
+    std::vector<int>          _bvhToTriangle; // BVH 三角形索引 -> _triangles 索引（略過透明三角形）
+    CTriangleBVH _bvh;
+};
@@ -0,0 +1,139 @@
+//  CBillboardBatch.cpp
+#include "CBillboardBatch.h"
+#include "CShaderPool.h"
+#include "../stb_image.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <iostream>
+
+CBillboardBatch::CBillboardBatch() {}
+
+CBillboardBatch::~CBillboardBatch() {
+    // GL 資源需由 release() 在 context 存在時釋放
+}
+
+void CBillboardBatch::init(const std::string& texturePath) {
+    _shader = CShaderPool::getInstance().getShader("billboard_vtxshader.glsl", "billboard_fragshader.glsl");
+    glUseProgram(_shader);
+    glUniform1i(glGetUniformLocation(_shader, "uTexture"), 0);
+
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_vbo);
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    for (int i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribPointer(i, 4, GL_FLOAT, GL_FALSE, sizeof(BillboardInstance), (void*)(i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // 與 Model::LoadTexture 相同：上下翻轉，RGBA 並產生 mipmap
+    int width = 0, height = 0, components = 0;
+    unsigned char* data = nullptr;
+    if (!texturePath.empty()) {
+        stbi_set_flip_vertically_on_load(true);
+        data = stbi_load(texturePath.c_str(), &width, &height, &components, 4);
+        if (data == nullptr) std::cout << "Failed to load billboard texture: " << texturePath << std::endl;
+    }
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    glGenTextures(1, &_texture);
+    glBindTexture(GL_TEXTURE_2D, _texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, data ? width : 1, data ? height : 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 data ? data : white);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (data != nullptr) stbi_image_free(data);
+}
+
+void CBillboardBatch::release() {
+    if (_vao != 0) glDeleteVertexArrays(1, &_vao);
+    if (_vbo != 0) glDeleteBuffers(1, &_vbo);
+    if (_texture != 0) glDeleteTextures(1, &_texture);
+    _vao = _vbo = _texture = 0;
+    _bufferCapacity = 0;
+    _dirty = !_instances.empty();
+}
+
+static BillboardInstance toInstance(const BillboardDesc& desc) {
+    BillboardInstance instance;
+    instance.centerType = glm::vec4(desc.position, static_cast<float>(desc.type));
+    instance.sizePivot = glm::vec4(desc.size.x, desc.size.y, desc.pivot.x, desc.pivot.y);
+    instance.atlas = desc.atlas;
+    instance.color = desc.color;
+    return instance;
+}
+
+int CBillboardBatch::add(const BillboardDesc& desc) {
+    _instances.push_back(toInstance(desc));
+    _dirty = true;
+    return static_cast<int>(_instances.size()) - 1;
+}
+
+void CBillboardBatch::set(int id, const BillboardDesc& desc) {
+    _instances[id] = toInstance(desc);
+    _dirty = true;
+}
+
+void CBillboardBatch::setPosition(int id, const glm::vec3& position) {
+    _instances[id].centerType = glm::vec4(position, _instances[id].centerType.w);
+    _dirty = true;
+}
+
+void CBillboardBatch::clear() {
+    _instances.clear();
+    _dirty = true;
+}
+
+// 數量超過 buffer 的容量時以兩倍重新配置，否則只更新使用中的部分
+void CBillboardBatch::upload() {
+    int count = getCount();
+    size_t bytes = count * sizeof(BillboardInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    if (count > _bufferCapacity) {
+        _bufferCapacity = std::max(count, _bufferCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, _bufferCapacity * sizeof(BillboardInstance), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (count > 0) glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, _instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    _uploadedBytes = static_cast<int>(bytes);
+    _dirty = false;
+}
+
+void CBillboardBatch::render(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& viewPos) {
+    _uploadedBytes = 0;
+    _draws = 0;
+    if (_shader == 0) return;
+    if (_dirty) upload();
+    if (_instances.empty()) return;
+
+    glm::mat4 viewProj = proj * view;
+    glUseProgram(_shader);
+    glUniformMatrix4fv(glGetUniformLocation(_shader, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    glUniform3fv(glGetUniformLocation(_shader, "uViewPos"), 1, glm::value_ptr(viewPos));
+    glUniform3f(glGetUniformLocation(_shader, "uCameraRight"), view[0][0], view[1][0], view[2][0]);
+    glUniform3f(glGetUniformLocation(_shader, "uCameraUp"), view[0][1], view[1][1], view[2][1]);
+    glUniform3fv(glGetUniformLocation(_shader, "uUp"), 1, glm::value_ptr(_up));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _texture);
+
+    // 四邊形兩面都可能看到（SCREEN_ALIGNED 以外的 billboard 從背後看時）
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_CULL_FACE);
+    glBindVertexArray(_vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, getCount());
+    glBindVertexArray(0);
+    if (cullEnabled) glEnable(GL_CULL_FACE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    _draws = 1;
+}
+
+void CBillboardBatch::printStats() const {
+    std::cout << "Billboards: " << getCount() << " in " << _draws << " draw, " << _uploadedBytes
+              << " bytes uploaded this frame" << std::endl;
+}
@@ -0,0 +1,72 @@
+//  CBillboardBatch.h
+//  大量的 billboard（告示牌、sprite）以一次 instanced draw 描繪：每個 billboard 只有中心、大小、種類、貼圖範圍與顏色，
+//  面向攝影機的四邊形在 billboard_vtxshader.glsl 中展開（BillboardType 的三種算法與 Model::calculateBillboardMatrix 相同），
+//  CPU 不需要每個 frame 計算矩陣，也不需要把攝影機傳給每個 billboard
+//  instance 資料只在新增或修改之後重新上傳；所有 billboard 共用一張貼圖（可以是多個 sprite 的貼圖集）
+//  貼圖的 alpha 低於 0.5 的像素捨棄（alpha test），因此寫入深度、不需要排序
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "BillboardType.h"
+
+struct BillboardDesc {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec2 size = glm::vec2(1.0f);             // 寬、高（世界單位）
+    glm::vec2 pivot = glm::vec2(0.5f);            // position 在四邊形上的位置：(0.5, 0.5) 為中心，(0.5, 0) 為底邊中點
+    glm::vec4 atlas = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);  // 貼圖範圍 (u, v, 寬, 高)
+    glm::vec4 color = glm::vec4(1.0f);            // 乘上貼圖的顏色
+    BillboardType type = BillboardType::SPHERICAL;
+};
+
+// 與 billboard_vtxshader.glsl 的 instance attribute 相同排列（4 個 vec4）
+struct BillboardInstance {
+    glm::vec4 centerType;      // xyz = position, w = BillboardType
+    glm::vec4 sizePivot;       // xy = size, zw = pivot
+    glm::vec4 atlas;
+    glm::vec4 color;
+};
+
+class CBillboardBatch {
+public:
+    CBillboardBatch();
+    ~CBillboardBatch();
+
+    // texturePath 為空字串或讀取失敗時使用白色貼圖
+    void init(const std::string& texturePath);
+    void release();
+
+    // 回傳 billboard 的編號（clear 之前不會改變）
+    int add(const BillboardDesc& desc);
+    void set(int id, const BillboardDesc& desc);
+    void setPosition(int id, const glm::vec3& position);
+    void clear();
+    int getCount() const { return static_cast<int>(_instances.size()); }
+
+    // CYLINDRICAL 的旋轉軸（與 Model::setBillboardUpVector 相同）
+    void setUpVector(const glm::vec3& up) { _up = glm::normalize(up); }
+
+    // 在不透明物件之後、透明物件之前呼叫
+    void render(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& viewPos);
+
+    int getUploadedBytes() const { return _uploadedBytes; }
+    void printStats() const;
+
+private:
+    void upload();
+
+    std::vector<BillboardInstance> _instances;
+    bool _dirty = false;
+    glm::vec3 _up = glm::vec3(0.0f, 1.0f, 0.0f);
+
+    GLuint _shader = 0;
+    GLuint _vao = 0, _vbo = 0;
+    GLuint _texture = 0;
+    int _bufferCapacity = 0;       // _vbo 可以容納的 billboard 數
+    int _uploadedBytes = 0;        // 這個 frame 上傳的資料
+    int _draws = 0;
+};
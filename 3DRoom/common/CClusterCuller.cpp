@@ -0,0 +1,122 @@
+//  CClusterCuller.cpp
+#include "CClusterCuller.h"
+#include "CParallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+CClusterCuller::CClusterCuller() : _eye(0.0f), _backface(true), _frustum(true) {
+    for (glm::vec4& plane : _planes) plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+void CClusterCuller::begin(const glm::mat4& viewProj, const glm::vec3& eye) {
+    // Gribb-Hartmann：與 SceneObject.h 的 aabbInFrustum 相同，正規化後可以直接與球的半徑比較
+    glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+    const glm::vec4 planes[6] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+    for (int i = 0; i < 6; i++) {
+        float length = glm::length(glm::vec3(planes[i]));
+        _planes[i] = length > 0.0f ? planes[i] / length : planes[i];
+    }
+    _eye = eye;
+    _items.clear();
+}
+
+int CClusterCuller::add(const std::vector<MeshCluster>* clusters, const glm::mat4& world) {
+    Item item;
+    item.clusters = (clusters != nullptr && !clusters->empty()) ? clusters : nullptr;
+    item.world = world;
+    _items.push_back(item);
+    return static_cast<int>(_items.size()) - 1;
+}
+
+void CClusterCuller::cullItem(Item& item) {
+    item.rangeCount = 0;
+    item.frustumCulled = item.backfaceCulled = 0;
+    item.trianglesTotal = item.trianglesSubmitted = 0;
+    if (item.clusters == nullptr) return;
+
+    // 攝影機轉到模型空間判斷法向量錐，包圍球轉到世界座標判斷視錐
+    glm::vec3 eyeLocal = glm::vec3(glm::inverse(item.world) * glm::vec4(_eye, 1.0f));
+    float scale = std::max(glm::length(glm::vec3(item.world[0])),
+                           std::max(glm::length(glm::vec3(item.world[1])), glm::length(glm::vec3(item.world[2]))));
+    ClusterDrawRange* ranges = _ranges.data() + item.rangeOffset;
+    for (const MeshCluster& cluster : *item.clusters) {
+        item.trianglesTotal += cluster.indexCount / 3;
+        if (_frustum) {
+            glm::vec3 center = glm::vec3(item.world * glm::vec4(cluster.center, 1.0f));
+            float radius = cluster.radius * scale;
+            bool outside = false;
+            for (const glm::vec4& plane : _planes) {
+                if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                    outside = true;
+                    break;
+                }
+            }
+            if (outside) {
+                item.frustumCulled++;
+                continue;
+            }
+        }
+        if (_backface && clusterBackfacing(cluster, eyeLocal)) {
+            item.backfaceCulled++;
+            continue;
+        }
+        item.trianglesSubmitted += cluster.indexCount / 3;
+        // 索引相鄰的叢集合併成一個範圍
+        if (item.rangeCount > 0 &&
+            ranges[item.rangeCount - 1].indexStart + ranges[item.rangeCount - 1].indexCount == cluster.indexStart) {
+            ranges[item.rangeCount - 1].indexCount += cluster.indexCount;
+        } else {
+            ranges[item.rangeCount].indexStart = cluster.indexStart;
+            ranges[item.rangeCount].indexCount = cluster.indexCount;
+            item.rangeCount++;
+        }
+    }
+}
+
+void CClusterCuller::cull(int numThreads) {
+    auto start = std::chrono::steady_clock::now();
+    size_t capacity = 0;
+    for (Item& item : _items) {
+        item.rangeOffset = capacity;
+        if (item.clusters != nullptr) capacity += item.clusters->size();
+    }
+    if (_ranges.size() < capacity) _ranges.resize(capacity);
+
+    parallelFor(_pool, 0, static_cast<int>(_items.size()), numThreads, CLUSTER_CULL_GRAIN,
+                [this](int i) { cullItem(_items[i]); });
+
+    _stats = ClusterCullStats();
+    _stats.threads = _pool != nullptr ? std::max(1, std::min(numThreads, _pool->getThreadCount())) : 1;
+    for (const Item& item : _items) {
+        if (item.clusters == nullptr) continue;
+        _stats.items++;
+        _stats.clusters += item.clusters->size();
+        _stats.frustumCulled += item.frustumCulled;
+        _stats.backfaceCulled += item.backfaceCulled;
+        _stats.ranges += item.rangeCount;
+        _stats.trianglesTotal += item.trianglesTotal;
+        _stats.trianglesSubmitted += item.trianglesSubmitted;
+    }
+    _stats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const ClusterDrawRange* CClusterCuller::getRanges(int item, int& count) const {
+    count = static_cast<int>(_items[item].rangeCount);
+    return _ranges.data() + _items[item].rangeOffset;
+}
+
+void CClusterCuller::printStats() const {
+    std::cout << "Cluster culling (" << (_frustum ? "frustum" : "") << (_frustum && _backface ? " + " : "")
+              << (_backface ? "backface cones" : "") << "): " << _stats.items << " meshes, " << _stats.clusters
+              << " clusters, " << _stats.frustumCulled << " outside frustum, " << _stats.backfaceCulled
+              << " back-facing" << std::endl;
+    std::cout << "  triangles " << _stats.trianglesSubmitted << " of " << _stats.trianglesTotal << " submitted ("
+              << (_stats.trianglesTotal > 0 ? 100.0 * _stats.trianglesSubmitted / _stats.trianglesTotal : 100.0)
+              << "%) in " << _stats.ranges << " ranges, cull " << _stats.cpuMs << " ms on " << _stats.threads
+              << " threads" << std::endl;
+}
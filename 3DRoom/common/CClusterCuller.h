@@ -0,0 +1,81 @@
+//  CClusterCuller.h
+//  每個 frame 以叢集為單位做視錐與法向量錐剔除，相鄰的叢集合併成 glMultiDrawElements 的描繪範圍
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CMeshCluster.h"
+
+class CThreadPool;
+
+#define CLUSTER_CULL_GRAIN 16          // parallelFor 每次領取的項目數
+
+// 索引的範圍（indices 中的位置與數量）
+struct ClusterDrawRange {
+    uint32_t indexStart = 0;
+    uint32_t indexCount = 0;
+};
+
+// 最近一次 cull 的統計
+struct ClusterCullStats {
+    int items = 0;                     // 有叢集的項目（網格實體）
+    size_t clusters = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    size_t ranges = 0;                 // 合併後的描繪範圍（glMultiDrawElements 的數量）
+    size_t trianglesTotal = 0;
+    size_t trianglesSubmitted = 0;
+    double cpuMs = 0.0;
+    int threads = 1;
+};
+
+class CClusterCuller {
+public:
+    CClusterCuller();
+
+    void setBackfaceCulling(bool enable) { _backface = enable; }
+    void setFrustumCulling(bool enable) { _frustum = enable; }
+    bool getBackfaceCulling() const { return _backface; }
+    bool getFrustumCulling() const { return _frustum; }
+
+    // 每個 frame：設定攝影機並清除所有項目
+    void begin(const glm::mat4& viewProj, const glm::vec3& eye);
+    // 回傳項目編號；clusters 為 nullptr（沒有叢集、透明或使用 LOD 的網格）時這個項目不剔除，由呼叫端描繪整個網格
+    // clusters 必須在 cull 與描繪結束前保持有效；world 為等比例縮放（叢集的法向量錐在模型空間判斷）
+    int add(const std::vector<MeshCluster>* clusters, const glm::mat4& world);
+    // 項目由 pool 的執行緒處理（最多 numThreads 個），沒有設定 pool 時在呼叫端依序處理
+    void setThreadPool(CThreadPool* pool) { _pool = pool; }
+    void cull(int numThreads);
+
+    int getItemCount() const { return static_cast<int>(_items.size()); }
+    bool isClustered(int item) const { return _items[item].clusters != nullptr; }
+    // 項目剩下的描繪範圍，count 為 0 時整個網格都被剔除
+    const ClusterDrawRange* getRanges(int item, int& count) const;
+
+    const ClusterCullStats& getStats() const { return _stats; }
+    void printStats() const;
+
+private:
+    struct Item {
+        const std::vector<MeshCluster>* clusters = nullptr;
+        glm::mat4 world = glm::mat4(1.0f);
+        size_t rangeOffset = 0;        // 在 _ranges 中的起點（預留叢集數量的空間）
+        uint32_t rangeCount = 0;
+        uint32_t frustumCulled = 0, backfaceCulled = 0;
+        size_t trianglesTotal = 0, trianglesSubmitted = 0;
+    };
+
+    void cullItem(Item& item);
+
+    glm::vec4 _planes[6];              // 世界座標的視錐平面（正規化，內側為正）
+    glm::vec3 _eye;
+    bool _backface, _frustum;
+    std::vector<Item> _items;
+    std::vector<ClusterDrawRange> _ranges;
+    ClusterCullStats _stats;
+    CThreadPool* _pool = nullptr;
+};
@@ -0,0 +1,87 @@
+//  CDebrisPool.cpp
+#include "CDebrisPool.h"
+#include "CRigidBodyPool.h"
+#include <algorithm>
+#include <cmath>
+
+CDebrisPool::CDebrisPool(int capacity)
+    : _capacity(std::max(1, capacity)) {
+    _pieces.resize(_capacity);
+    _matrices.resize(_capacity);
+}
+
+int CDebrisPool::addSource(const std::vector<FractureChunk>& chunks) {
+    Source source;
+    source.firstChunk = static_cast<int>(_chunkCenter.size());
+    source.chunkCount = static_cast<int>(chunks.size());
+    for (const FractureChunk& chunk : chunks) {
+        _chunkCenter.push_back((chunk.boundsMin + chunk.boundsMax) * 0.5f);
+        _chunkHalf.push_back((chunk.boundsMax - chunk.boundsMin) * 0.5f);
+        _chunkVolume.push_back(chunk.volume);
+    }
+    _ranges.resize(_chunkCenter.size());
+    _sources.push_back(source);
+    return static_cast<int>(_sources.size()) - 1;
+}
+
+int CDebrisPool::breakObject(int source, const glm::mat4& world, const glm::vec3& impact, float speed,
+                             CRigidBodyPool& bodies, float density) {
+    if (source < 0 || source >= static_cast<int>(_sources.size())) return 0;
+    const Source& s = _sources[source];
+    if (s.chunkCount == 0 || _pieceCount + s.chunkCount > _capacity ||
+        bodies.getActiveCount() + s.chunkCount > bodies.getCapacity()) {
+        return 0;
+    }
+
+    // 世界空間的包圍盒：中心以矩陣轉換，半邊長乘上矩陣各元素的絕對值
+    glm::mat3 linear(world);
+    glm::mat3 absLinear;
+    for (int c = 0; c < 3; ++c) {
+        for (int r = 0; r < 3; ++r) absLinear[c][r] = std::fabs(linear[c][r]);
+    }
+    float volumeScale = std::fabs(glm::determinant(linear));
+    for (int k = 0; k < s.chunkCount; ++k) {
+        int chunk = s.firstChunk + k;
+        RigidBodyDesc desc;
+        desc.shape = RigidBodyShape::BOX;
+        desc.position = glm::vec3(world * glm::vec4(_chunkCenter[chunk], 1.0f));
+        desc.halfExtents = glm::max(absLinear * _chunkHalf[chunk] * DEBRIS_BODY_SHRINK, glm::vec3(0.02f));
+        glm::vec3 away = desc.position - impact;
+        float length = glm::length(away);
+        away = (length > 1e-4f) ? away / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        desc.velocity = (away + glm::vec3(0.0f, 0.5f, 0.0f)) * speed;
+        desc.mass = std::max(density * _chunkVolume[chunk] * volumeScale, 1e-3f);
+        int body = bodies.spawn(desc);
+
+        Piece& piece = _pieces[_pieceCount++];
+        piece.chunk = chunk;
+        piece.body = body;
+        piece.world = world;
+        piece.spawnPosition = desc.position;
+    }
+    return s.chunkCount;
+}
+
+void CDebrisPool::clear(CRigidBodyPool& bodies) {
+    for (int i = 0; i < _pieceCount; ++i) bodies.release(_pieces[i].body);
+    _pieceCount = 0;
+}
+
+void CDebrisPool::buildInstances(const CRigidBodyPool& bodies) {
+    for (DebrisInstanceRange& range : _ranges) range.count = 0;
+    for (int i = 0; i < _pieceCount; ++i) _ranges[_pieces[i].chunk].count++;
+    int first = 0;
+    for (DebrisInstanceRange& range : _ranges) {
+        range.first = first;
+        first += range.count;
+        range.count = 0;
+    }
+    for (int i = 0; i < _pieceCount; ++i) {
+        const Piece& piece = _pieces[i];
+        DebrisInstanceRange& range = _ranges[piece.chunk];
+        glm::vec3 offset = bodies.getPosition(piece.body) - piece.spawnPosition;
+        glm::mat4 matrix = piece.world;
+        matrix[3] += glm::vec4(offset, 0.0f);   // 平移加在世界矩陣的左邊
+        _matrices[range.first + range.count++] = matrix;
+    }
+}
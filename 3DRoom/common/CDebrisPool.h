@@ -0,0 +1,71 @@
+//  CDebrisPool.h
+//  打壞的物件換成 CMeshFracture 的碎片，每個碎片一個 CRigidBodyPool 剛體，依碎片排序後以 instanced draw 描繪
+
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CMeshFracture.h"
+
+class CRigidBodyPool;
+
+#define DEBRIS_DEFAULT_CAPACITY 4096
+#define DEBRIS_BODY_SHRINK 0.8f     // 碎片的包圍盒彼此重疊，剛體縮小一些，避免一開始就互相推擠
+
+// 一個碎片的實體在 getInstanceMatrices() 中的範圍
+struct DebrisInstanceRange {
+    int first = 0;
+    int count = 0;
+};
+
+class CDebrisPool {
+public:
+    explicit CDebrisPool(int capacity = DEBRIS_DEFAULT_CAPACITY);
+
+    // 登錄一種可以打壞的物件（例如一個 Model 的碎片），回傳種類編號；載入時呼叫
+    int addSource(const std::vector<FractureChunk>& chunks);
+
+    // 把以 world 擺放的物件換成碎片，從 impact 向外以 speed 飛散
+    // 碎片池或剛體池的空間不足時不產生任何碎片並回傳 0，否則回傳碎片數量
+    int breakObject(int source, const glm::mat4& world, const glm::vec3& impact, float speed,
+                    CRigidBodyPool& bodies, float density = 1.0f);
+    // 釋放所有碎片與它們的剛體
+    void clear(CRigidBodyPool& bodies);
+
+    // 依種類、碎片排序每個碎片目前的模型矩陣（counting sort，使用預先配置的陣列）
+    void buildInstances(const CRigidBodyPool& bodies);
+    const std::vector<glm::mat4>& getInstanceMatrices() const { return _matrices; }
+    int getInstanceCount() const { return _pieceCount; }
+    // source 每個碎片一個範圍
+    const DebrisInstanceRange* getRanges(int source) const { return &_ranges[_sources[source].firstChunk]; }
+
+    int getSourceCount() const { return static_cast<int>(_sources.size()); }
+    int getChunkCount(int source) const { return _sources[source].chunkCount; }
+    int getCapacity() const { return _capacity; }
+    int getPieceCount() const { return _pieceCount; }
+
+private:
+    struct Source {
+        int firstChunk;
+        int chunkCount;
+    };
+    // 執行中的碎片
+    struct Piece {
+        int chunk;               // _chunkCenter 等陣列的索引
+        int body;
+        glm::mat4 world;         // 打壞時物件的世界矩陣
+        glm::vec3 spawnPosition; // 剛體的初始位置
+    };
+
+    int _capacity;
+    std::vector<Source> _sources;
+    // 所有種類的碎片（模型空間）
+    std::vector<glm::vec3> _chunkCenter, _chunkHalf;
+    std::vector<float> _chunkVolume;
+
+    std::vector<Piece> _pieces;             // 容量 _capacity，前 _pieceCount 個使用中
+    int _pieceCount = 0;
+    std::vector<glm::mat4> _matrices;       // 容量 _capacity
+    std::vector<DebrisInstanceRange> _ranges;   // 每個碎片一個
+};
@@ -0,0 +1,62 @@
+//  CDecalBuffer.cpp
+#include "CDecalBuffer.h"
+#include <algorithm>
+#include <cmath>
+
+CDecalBuffer::CDecalBuffer(int capacity) {
+    _instances.resize(std::max(1, capacity));
+}
+
+int CDecalBuffer::add(const DecalDesc& desc) {
+    int capacity = getCapacity();
+    int slot = _next;
+    _next = (_next + 1) % capacity;
+    _live = std::min(_live + 1, capacity);
+    _added++;
+    if (_dirtyCount == 0) _dirtyFirst = slot;
+    _dirtyCount = std::min(_dirtyCount + 1, capacity);
+
+    // 表面上的兩個軸：與法向量最不平行的座標軸叉積後，再繞法向量旋轉
+    glm::vec3 n = glm::normalize(desc.normal);
+    glm::vec3 helper = (std::fabs(n.y) < 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 u = glm::normalize(glm::cross(helper, n));
+    glm::vec3 v = glm::cross(n, u);
+    float c = std::cos(desc.rotation), s = std::sin(desc.rotation);
+    glm::vec3 x = u * c + v * s;
+    glm::vec3 y = glm::cross(n, x);
+
+    // toWorld 的三個行向量為 x * size、y * size、n * depth，平移為 position；toDecal 為它的反矩陣
+    glm::vec3 scale(desc.size, desc.size, desc.depth);
+    const glm::vec3 axes[3] = { x, y, n };
+    DecalInstance& instance = _instances[slot];
+    for (int r = 0; r < 3; ++r) {
+        instance.toWorld[r] = glm::vec4(axes[0][r] * scale.x, axes[1][r] * scale.y, axes[2][r] * scale.z,
+                                        desc.position[r]);
+        glm::vec3 row = axes[r] / scale[r];
+        instance.toDecal[r] = glm::vec4(row, -glm::dot(row, desc.position));
+    }
+    int tile = static_cast<int>(desc.type);
+    glm::vec2 tileSize(1.0f / DECAL_ATLAS_COLUMNS, 1.0f / DECAL_ATLAS_ROWS);
+    instance.atlas = glm::vec4((tile % DECAL_ATLAS_COLUMNS) * tileSize.x, (tile / DECAL_ATLAS_COLUMNS) * tileSize.y,
+                               tileSize.x, tileSize.y);
+    instance.params = glm::vec4(desc.opacity, 0.0f, 0.0f, 0.0f);
+    return slot;
+}
+
+void CDecalBuffer::clear() {
+    _next = 0;
+    _live = 0;
+    _dirtyCount = 0;
+}
+
+int CDecalBuffer::getDirtyRanges(DecalRange ranges[2]) const {
+    if (_dirtyCount == 0) return 0;
+    int capacity = getCapacity();
+    int end = _dirtyFirst + _dirtyCount;
+    ranges[0].first = _dirtyFirst;
+    ranges[0].count = std::min(end, capacity) - _dirtyFirst;
+    if (end <= capacity) return 1;
+    ranges[1].first = 0;
+    ranges[1].count = end - capacity;
+    return 2;
+}
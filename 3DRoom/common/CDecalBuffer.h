@@ -0,0 +1,71 @@
+//  CDecalBuffer.h
+//  彈孔等貼花的固定容量環狀緩衝區，滿了之後覆蓋最舊的；CDecalRenderer 只上傳改變的範圍
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define DECAL_DEFAULT_CAPACITY 16384
+#define DECAL_ATLAS_COLUMNS 2          // 貼圖集（CDecalRenderer 產生）為 2 x 2 格，每格一種 DecalType
+#define DECAL_ATLAS_ROWS 2
+
+enum class DecalType : uint8_t {
+    BULLET_HOLE,    // 彈孔：中間的洞與凸起的邊緣
+    CRACK,          // 較大的撞擊：放射狀的裂痕
+    SCORCH,         // 燒焦的痕跡
+    IMPACT          // 撞擊的灰塵
+};
+
+struct DecalDesc {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);   // 表面的法向量（朝外），方塊沿此方向投影
+    float size = 0.15f;        // 表面上的邊長
+    float depth = 0.1f;        // 沿法向量的厚度，表面在方塊中間；太厚會投影到前後的物體上
+    float rotation = 0.0f;     // 繞法向量的旋轉（弧度）
+    float opacity = 1.0f;
+    DecalType type = DecalType::BULLET_HOLE;
+};
+
+// 每個貼花一份，與 decal_vtxshader.glsl 的 instance attribute 相同排列（8 個 vec4）
+// 方塊空間為 [-0.5, 0.5]^3，x、y 為貼圖的 u、v 方向，z 為表面的法向量
+struct DecalInstance {
+    glm::vec4 toWorld[3];      // 方塊空間 → 世界：3 x 4 仿射矩陣的三列
+    glm::vec4 toDecal[3];      // 世界 → 方塊空間
+    glm::vec4 atlas;           // 貼圖集中的範圍 (u, v, 寬, 高)
+    glm::vec4 params;          // x = opacity
+};
+
+struct DecalRange {
+    int first = 0;
+    int count = 0;
+};
+
+class CDecalBuffer {
+public:
+    explicit CDecalBuffer(int capacity = DECAL_DEFAULT_CAPACITY);
+
+    // 回傳使用的格子；緩衝區已滿時覆蓋最舊的貼花
+    int add(const DecalDesc& desc);
+    void clear();
+
+    // 使用中的貼花一定是前 getLiveCount() 個格子（填滿之前依序使用，填滿之後全部使用中）
+    const std::vector<DecalInstance>& getInstances() const { return _instances; }
+    int getLiveCount() const { return _live; }
+    int getCapacity() const { return static_cast<int>(_instances.size()); }
+    long long getAddedCount() const { return _added; }
+    long long getRecycledCount() const { return _added - _live; }
+
+    // 上一次 clearDirty 之後改變的格子，回傳段數（0 ~ 2）
+    int getDirtyRanges(DecalRange ranges[2]) const;
+    void clearDirty() { _dirtyCount = 0; }
+
+private:
+    std::vector<DecalInstance> _instances;
+    int _next = 0;             // 下一個使用的格子（最舊的貼花）
+    int _live = 0;
+    long long _added = 0;
+    int _dirtyFirst = 0;
+    int _dirtyCount = 0;
+};
@@ -0,0 +1,398 @@
+//  CDecalRenderer.cpp
+#include "CDecalRenderer.h"
+#include "CShaderPool.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+float hash2(int x, int y, int seed) {
+    unsigned h = static_cast<unsigned>(x) * 374761393u + static_cast<unsigned>(y) * 668265263u +
+                 static_cast<unsigned>(seed) * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return static_cast<float>((h ^ (h >> 16)) & 0xffffff) / 16777216.0f;
+}
+
+// 0 ~ 1 的平滑雜訊
+float valueNoise(float x, float y, int seed) {
+    int ix = static_cast<int>(std::floor(x)), iy = static_cast<int>(std::floor(y));
+    float fx = x - ix, fy = y - iy;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+    float a = hash2(ix, iy, seed), b = hash2(ix + 1, iy, seed);
+    float c = hash2(ix, iy + 1, seed), d = hash2(ix + 1, iy + 1, seed);
+    return (a + (b - a) * fx) + ((c + (d - c) * fx) - (a + (b - a) * fx)) * fy;
+}
+
+float smooth(float edge0, float edge1, float x) {
+    float t = std::min(std::max((x - edge0) / (edge1 - edge0), 0.0f), 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// 點到中心出發、角度 angle、長度 length 的線段的距離
+float spokeDistance(float x, float y, float angle, float length) {
+    float dx = std::cos(angle), dy = std::sin(angle);
+    float t = std::min(std::max(x * dx + y * dy, 0.0f), length);
+    return std::hypot(x - dx * t, y - dy * t);
+}
+
+// 一格貼花在 (x, y)（-0.5 ~ 0.5，半徑 0.5 之外必須透明）的高度與顏色
+void sampleTile(DecalType type, float x, float y, float& height, glm::vec4& color) {
+    float r = std::hypot(x, y);
+    float noise = valueNoise(x * 24.0f + 7.0f, y * 24.0f + 3.0f, static_cast<int>(type));
+    height = 0.0f;
+    color = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+    switch (type) {
+    case DecalType::BULLET_HOLE: {
+        if (r < 0.08f) {
+            height = -1.0f;
+            color = glm::vec4(0.02f, 0.02f, 0.02f, 1.0f);
+            break;
+        }
+        // 翻起的邊緣與外圍的火藥痕跡
+        height = 0.6f * smooth(0.08f, 0.12f, r) * (1.0f - smooth(0.12f, 0.22f, r)) + 0.05f * noise;
+        float ring = 1.0f - smooth(0.1f, 0.45f, r);
+        color = glm::vec4(glm::vec3(0.2f + 0.15f * noise), std::min(1.0f, ring * ring * (0.8f + 0.4f * noise)));
+        for (int k = 0; k < 5; ++k) {
+            float crack = spokeDistance(x, y, k * 1.2566f + hash2(k, 1, 11) * 0.8f, 0.2f + 0.15f * hash2(k, 2, 11));
+            if (crack < 0.006f + 0.004f * noise) {
+                height = -0.4f;
+                color = glm::vec4(0.08f, 0.08f, 0.08f, 1.0f);
+            }
+        }
+        break;
+    }
+    case DecalType::CRACK: {
+        float wobble = (valueNoise(x * 40.0f, y * 40.0f, 5) - 0.5f) * 0.02f;
+        for (int k = 0; k < 9; ++k) {
+            float angle = k * 0.6981f + hash2(k, 3, 17) * 0.5f;
+            float crack = spokeDistance(x + wobble, y - wobble, angle, 0.25f + 0.22f * hash2(k, 4, 17));
+            float width = 0.012f * (1.0f - r * 1.6f);
+            if (crack < width) {
+                height = -0.7f;
+                color = glm::vec4(0.06f, 0.06f, 0.06f, 1.0f);
+            }
+        }
+        if (r < 0.07f) {
+            height = -0.8f + 0.3f * noise;
+            color = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+        }
+        break;
+    }
+    case DecalType::SCORCH: {
+        float blotch = 1.0f - smooth(0.15f, 0.48f, r + 0.08f * (noise - 0.5f));
+        height = 0.15f * noise * blotch;
+        color = glm::vec4(0.06f, 0.05f, 0.04f, blotch * (0.65f + 0.35f * noise));
+        break;
+    }
+    case DecalType::IMPACT: {
+        float dust = (1.0f - smooth(0.05f, 0.46f, r)) * (0.5f + 0.5f * noise);
+        height = -0.3f * (1.0f - smooth(0.0f, 0.1f, r)) + 0.1f * noise * dust;
+        color = glm::vec4(0.55f, 0.53f, 0.5f, dust * 0.7f);
+        break;
+    }
+    }
+    if (r > 0.5f) color.a = 0.0f;
+}
+
+} // namespace
+
+CDecalRenderer::CDecalRenderer()
+    : _shader(0), _vao(0), _boxVbo(0), _boxEbo(0), _instanceVbo(0), _instanceCapacity(0),
+      _atlasTex(0), _normalTex(0), _fbo(0), _depthTex(0), _width(0), _height(0), _depthSupported(true),
+      _queryIndex(0), _gpuTotal(0.0), _pixelTotal(0.0), _gpuFrames(0) {
+    for (int i = 0; i < 2; i++) {
+        _timeQueries[i] = _sampleQueries[i] = 0;
+        _queryPending[i] = false;
+    }
+}
+
+CDecalRenderer::~CDecalRenderer() {
+    // GL 資源需由 release() 在 context 存在時釋放
+}
+
+void CDecalRenderer::init() {
+    _shader = CShaderPool::getInstance().getShader("decal_vtxshader.glsl", "decal_fragshader.glsl");
+    glUseProgram(_shader);
+    glUniform1i(glGetUniformLocation(_shader, "uDepth"), 0);
+    glUniform1i(glGetUniformLocation(_shader, "uDecalAtlas"), 1);
+    glUniform1i(glGetUniformLocation(_shader, "uDecalNormal"), 2);
+    createBox();
+    createAtlas();
+    glGenFramebuffers(1, &_fbo);
+    glGenQueries(2, _timeQueries);
+    glGenQueries(2, _sampleQueries);
+}
+
+void CDecalRenderer::release() {
+    if (_vao != 0) glDeleteVertexArrays(1, &_vao);
+    GLuint buffers[3] = { _boxVbo, _boxEbo, _instanceVbo };
+    glDeleteBuffers(3, buffers);
+    GLuint textures[3] = { _atlasTex, _normalTex, _depthTex };
+    glDeleteTextures(3, textures);
+    if (_fbo != 0) glDeleteFramebuffers(1, &_fbo);
+    if (_timeQueries[0] != 0) glDeleteQueries(2, _timeQueries);
+    if (_sampleQueries[0] != 0) glDeleteQueries(2, _sampleQueries);
+    _vao = _boxVbo = _boxEbo = _instanceVbo = 0;
+    _atlasTex = _normalTex = _depthTex = _fbo = 0;
+    _timeQueries[0] = _timeQueries[1] = _sampleQueries[0] = _sampleQueries[1] = 0;
+    _instanceCapacity = _width = _height = 0;
+}
+
+// 單位方塊 [-0.5, 0.5]^3，面朝外為逆時針；instance attribute 1 ~ 8 為 DecalInstance
+void CDecalRenderer::createBox() {
+    float vertices[8 * 3];
+    for (int i = 0; i < 8; i++) {
+        vertices[i * 3 + 0] = (i & 1) ? 0.5f : -0.5f;
+        vertices[i * 3 + 1] = (i & 2) ? 0.5f : -0.5f;
+        vertices[i * 3 + 2] = (i & 4) ? 0.5f : -0.5f;
+    }
+    const GLushort faces[6][4] = {
+        { 0, 4, 6, 2 }, { 1, 3, 7, 5 },   // -x, +x
+        { 0, 1, 5, 4 }, { 2, 6, 7, 3 },   // -y, +y
+        { 0, 2, 3, 1 }, { 4, 5, 7, 6 }    // -z, +z
+    };
+    GLushort indices[36];
+    for (int f = 0; f < 6; f++) {
+        const GLushort tri[6] = { faces[f][0], faces[f][1], faces[f][2], faces[f][0], faces[f][2], faces[f][3] };
+        std::copy(tri, tri + 6, indices + f * 6);
+    }
+
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_boxVbo);
+    glGenBuffers(1, &_boxEbo);
+    glGenBuffers(1, &_instanceVbo);
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _boxVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _boxEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // 容量在第一次 render 時依 CDecalBuffer 配置，attribute 指向同一個 buffer 不需要重設
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    for (int i = 0; i < 8; i++) {
+        glEnableVertexAttribArray(1 + i);
+        glVertexAttribPointer(1 + i, 4, GL_FLOAT, GL_FALSE, sizeof(DecalInstance), (void*)(i * sizeof(glm::vec4)));
+        glVertexAttribDivisor(1 + i, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// 每種貼花以高度場產生：顏色取樣自 sampleTile，normal map 為高度的中央差分
+void CDecalRenderer::createAtlas() {
+    const int tile = DECAL_ATLAS_TILE_SIZE;
+    const int width = tile * DECAL_ATLAS_COLUMNS, height = tile * DECAL_ATLAS_ROWS;
+    std::vector<unsigned char> colors(width * height * 4), normals(width * height * 4);
+    std::vector<float> heights(tile * tile);
+    const float bump = 3.0f;   // 高度差轉成法向量的強度
+    for (int t = 0; t < DECAL_ATLAS_COLUMNS * DECAL_ATLAS_ROWS; t++) {
+        int originX = (t % DECAL_ATLAS_COLUMNS) * tile, originY = (t / DECAL_ATLAS_COLUMNS) * tile;
+        for (int y = 0; y < tile; y++) {
+            for (int x = 0; x < tile; x++) {
+                glm::vec4 color;
+                sampleTile(static_cast<DecalType>(t), (x + 0.5f) / tile - 0.5f, (y + 0.5f) / tile - 0.5f,
+                           heights[y * tile + x], color);
+                unsigned char* out = &colors[((originY + y) * width + originX + x) * 4];
+                for (int c = 0; c < 4; c++) out[c] = static_cast<unsigned char>(std::min(color[c], 1.0f) * 255.0f + 0.5f);
+            }
+        }
+        for (int y = 0; y < tile; y++) {
+            for (int x = 0; x < tile; x++) {
+                auto h = [&](int px, int py) {
+                    return heights[std::min(std::max(py, 0), tile - 1) * tile + std::min(std::max(px, 0), tile - 1)];
+                };
+                glm::vec3 n = glm::normalize(glm::vec3(-(h(x + 1, y) - h(x - 1, y)) * bump,
+                                                       -(h(x, y + 1) - h(x, y - 1)) * bump, 1.0f));
+                unsigned char* out = &normals[((originY + y) * width + originX + x) * 4];
+                for (int c = 0; c < 3; c++) out[c] = static_cast<unsigned char>((n[c] * 0.5f + 0.5f) * 255.0f + 0.5f);
+                out[3] = 255;
+            }
+        }
+    }
+
+    GLuint* targets[2] = { &_atlasTex, &_normalTex };
+    const std::vector<unsigned char>* data[2] = { &colors, &normals };
+    for (int i = 0; i < 2; i++) {
+        glGenTextures(1, targets[i]);
+        glBindTexture(GL_TEXTURE_2D, *targets[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data[i]->data());
+        // 遠處的貼花使用 mipmap；每格的邊緣透明，縮小時不會混到相鄰的格子
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// 只上傳改變的格子；容量改變（第一次）時配置並上傳全部
+void CDecalRenderer::upload(CDecalBuffer& decals) {
+    const std::vector<DecalInstance>& instances = decals.getInstances();
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    if (_instanceCapacity != decals.getCapacity()) {
+        _instanceCapacity = decals.getCapacity();
+        glBufferData(GL_ARRAY_BUFFER, _instanceCapacity * sizeof(DecalInstance), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, decals.getLiveCount() * sizeof(DecalInstance), instances.data());
+        _stats.uploadedBytes = decals.getLiveCount() * static_cast<int>(sizeof(DecalInstance));
+    } else {
+        DecalRange ranges[2];
+        int count = decals.getDirtyRanges(ranges);
+        for (int i = 0; i < count; i++) {
+            glBufferSubData(GL_ARRAY_BUFFER, ranges[i].first * sizeof(DecalInstance),
+                            ranges[i].count * sizeof(DecalInstance), &instances[ranges[i].first]);
+            _stats.uploadedBytes += ranges[i].count * static_cast<int>(sizeof(DecalInstance));
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    decals.clearDirty();
+}
+
+bool CDecalRenderer::resizeDepth(int width, int height) {
+    if (width == _width && height == _height && _depthTex != 0) return true;
+    if (_depthTex != 0) glDeleteTextures(1, &_depthTex);
+    // 與 GLFW 預設 framebuffer 相同的格式，才能用 glBlitFramebuffer 複製深度
+    glGenTextures(1, &_depthTex);
+    glBindTexture(GL_TEXTURE_2D, _depthTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, _depthTex, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    bool complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) return false;
+    _width = width;
+    _height = height;
+    return true;
+}
+
+bool CDecalRenderer::copyDepth() {
+    while (glGetError() != GL_NO_ERROR) {}
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fbo);
+    glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void CDecalRenderer::readQueries() {
+    for (int i = 0; i < 2; i++) {
+        if (!_queryPending[i]) continue;
+        GLint timeReady = 0, samplesReady = 0;
+        glGetQueryObjectiv(_timeQueries[i], GL_QUERY_RESULT_AVAILABLE, &timeReady);
+        glGetQueryObjectiv(_sampleQueries[i], GL_QUERY_RESULT_AVAILABLE, &samplesReady);
+        if (!timeReady || !samplesReady) continue;
+        GLuint64 elapsed = 0, samples = 0;
+        glGetQueryObjectui64v(_timeQueries[i], GL_QUERY_RESULT, &elapsed);
+        glGetQueryObjectui64v(_sampleQueries[i], GL_QUERY_RESULT, &samples);
+        _queryPending[i] = false;
+
+        _gpuTotal += elapsed * 1e-6;
+        _pixelTotal += static_cast<double>(samples);
+        if (++_gpuFrames >= DECAL_TIMING_FRAMES) {
+            _stats.gpuMs = _gpuTotal / _gpuFrames;
+            _stats.pixels = _pixelTotal / _gpuFrames;
+            _stats.gpuSamples = _gpuFrames;
+            _gpuTotal = _pixelTotal = 0.0;
+            _gpuFrames = 0;
+        }
+    }
+}
+
+void CDecalRenderer::render(CDecalBuffer& decals, const glm::mat4& view, const glm::mat4& proj,
+                            const glm::vec3& viewPos, const glm::vec3& lightPos) {
+    readQueries();
+    _stats.live = decals.getLiveCount();
+    _stats.recycled = decals.getRecycledCount();
+    _stats.uploadedBytes = 0;
+    if (_shader == 0) return;
+    upload(decals);
+    if (_stats.live == 0 || !_depthSupported) return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (!resizeDepth(viewport[2], viewport[3]) || !copyDepth()) {
+        std::cerr << "Cannot copy depth for decals, decals disabled" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        _depthSupported = false;
+        return;
+    }
+
+    // 上一次使用這組 query 的結果還沒讀到時，這個 frame 不計時
+    int q = _queryIndex;
+    bool timing = (_timeQueries[q] != 0) && !_queryPending[q];
+    if (timing) {
+        glBeginQuery(GL_TIME_ELAPSED, _timeQueries[q]);
+        glBeginQuery(GL_SAMPLES_PASSED, _sampleQueries[q]);
+    }
+
+    glm::mat4 viewProj = proj * view;
+    glUseProgram(_shader);
+    glUniformMatrix4fv(glGetUniformLocation(_shader, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    glm::mat4 invViewProj = glm::inverse(viewProj);
+    glUniformMatrix4fv(glGetUniformLocation(_shader, "uInvViewProj"), 1, GL_FALSE, glm::value_ptr(invViewProj));
+    glUniform4f(glGetUniformLocation(_shader, "uViewport"), (float)viewport[0], (float)viewport[1],
+                (float)viewport[2], (float)viewport[3]);
+    glUniform3fv(glGetUniformLocation(_shader, "uViewPos"), 1, glm::value_ptr(viewPos));
+    glUniform3fv(glGetUniformLocation(_shader, "uLightPos"), 1, glm::value_ptr(lightPos));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _depthTex);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _atlasTex);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, _normalTex);
+
+    // 畫方塊的背面、不做深度測試：攝影機在方塊內或方塊穿過近平面時也能畫出；位置由深度貼圖決定
+    // 混合為 dst * src * 2：src = 0.5 時不改變畫面
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_DST_COLOR, GL_SRC_COLOR);
+    glBindVertexArray(_vao);
+    glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, (void*)0, _stats.live);
+    glBindVertexArray(0);
+    glCullFace(GL_BACK);
+    if (!cullEnabled) glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+    for (int unit = 2; unit >= 0; unit--) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    if (timing) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        glEndQuery(GL_TIME_ELAPSED);
+        _queryPending[q] = true;
+        _queryIndex = 1 - q;
+    }
+}
+
+void CDecalRenderer::printStats() const {
+    std::cout << "Decals: " << _stats.live << " live, " << _stats.recycled << " recycled, "
+              << _stats.uploadedBytes << " bytes uploaded this frame" << std::endl;
+    std::cout << "  decal pass GPU: ";
+    if (_stats.gpuSamples > 0) {
+        std::cout << _stats.gpuMs << " ms, " << static_cast<long long>(_stats.pixels) << " pixels blended (avg of "
+                  << _stats.gpuSamples << " frames)";
+    } else {
+        std::cout << "not measured yet";
+    }
+    std::cout << std::endl;
+}
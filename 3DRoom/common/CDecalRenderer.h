@@ -0,0 +1,68 @@
+//  CDecalRenderer.h
+//  CDecalBuffer 的貼花以一次 instanced draw 投影到畫面上（deferred decal）：
+//  不透明物件畫完後把預設 framebuffer 的深度複製到深度貼圖，每個貼花畫一個方塊（背面，攝影機在方塊內也正確），
+//  fragment shader 由深度還原世界座標，轉到貼花的方塊空間，在方塊內的像素取貼圖集（顏色 + normal map）
+//  以 2 倍乘法混合：保留底下表面原本的光照（牆壁的 normal map、陰影），貼花的 normal map 再依主要光源調整明暗
+//  貼圖集在 init 時以程式產生（2 x 2 格，對應 DecalType），每格的邊緣透明
+//  統計：使用中的貼花、這個 frame 上傳的資料量，以及 GL_TIME_ELAPSED 與 GL_SAMPLES_PASSED（實際寫入的像素）量測的描繪成本
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "CDecalBuffer.h"
+
+#define DECAL_ATLAS_TILE_SIZE 128
+#define DECAL_TIMING_FRAMES 60
+
+// 貼花描繪的統計，GPU 時間與像素數為最近 DECAL_TIMING_FRAMES 個 frame 的平均
+struct DecalStats {
+    int live = 0;                   // 使用中的貼花（這個 frame 描繪的數量）
+    long long recycled = 0;         // 被新的貼花覆蓋的數量
+    int uploadedBytes = 0;          // 這個 frame 上傳的 instance 資料
+    double gpuMs = 0.0;
+    double pixels = 0.0;            // 通過方塊範圍與角度測試、實際混合的像素
+    int gpuSamples = 0;
+};
+
+class CDecalRenderer {
+public:
+    CDecalRenderer();
+    ~CDecalRenderer();
+
+    void init();
+    void release();
+
+    // 在不透明物件之後、透明物件之前呼叫；lightPos 為調整貼花 normal map 明暗的主要光源
+    void render(CDecalBuffer& decals, const glm::mat4& view, const glm::mat4& proj,
+                const glm::vec3& viewPos, const glm::vec3& lightPos);
+
+    const DecalStats& getStats() const { return _stats; }
+    void printStats() const;
+
+private:
+    void createAtlas();
+    void createBox();
+    void upload(CDecalBuffer& decals);
+    bool resizeDepth(int width, int height);
+    bool copyDepth();
+    void readQueries();
+
+    GLuint _shader;
+    GLuint _vao, _boxVbo, _boxEbo, _instanceVbo;
+    int    _instanceCapacity;
+    GLuint _atlasTex, _normalTex;
+    GLuint _fbo, _depthTex;         // 預設 framebuffer 的深度複製到 _depthTex
+    int    _width, _height;
+    bool   _depthSupported;
+
+    // 兩組 query 輪流使用，讀取上一個 frame 的結果以避免等待
+    GLuint _timeQueries[2], _sampleQueries[2];
+    bool   _queryPending[2];
+    int    _queryIndex;
+    double _gpuTotal, _pixelTotal;
+    int    _gpuFrames;
+
+    DecalStats _stats;
+};
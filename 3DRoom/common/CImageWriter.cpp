@@ -0,0 +1,133 @@
+//  CImageWriter.cpp
+#include "CImageWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+static uint32_t crc32Update(uint32_t crc, const unsigned char* data, size_t len) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+    for (size_t i = 0; i < len; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+static void putU32(std::vector<unsigned char>& out, uint32_t v) {
+    out.push_back((v >> 24) & 0xFF);
+    out.push_back((v >> 16) & 0xFF);
+    out.push_back((v >> 8) & 0xFF);
+    out.push_back(v & 0xFF);
+}
+
+static void writeChunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data) {
+    std::vector<unsigned char> chunk;
+    putU32(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    uint32_t crc = crc32Update(0xFFFFFFFFu, chunk.data() + 4, chunk.size() - 4) ^ 0xFFFFFFFFu;
+    putU32(chunk, crc);
+    file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+bool CImageWriter::writePNG(const std::string& path, int width, int height, int channels,
+                            const std::vector<unsigned char>& pixels) {
+    if (channels < 1 || channels > 4 || channels == 2 ||
+        pixels.size() < static_cast<size_t>(width) * height * channels) {
+        std::cerr << "writePNG: invalid image " << path << std::endl;
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "writePNG: cannot open " << path << std::endl;
+        return false;
+    }
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char*>(signature), 8);
+
+    std::vector<unsigned char> ihdr;
+    putU32(ihdr, width);
+    putU32(ihdr, height);
+    ihdr.push_back(8);                                         // bit depth
+    ihdr.push_back(channels == 1 ? 0 : (channels == 3 ? 2 : 6)); // color type
+    ihdr.push_back(0); ihdr.push_back(0); ihdr.push_back(0);
+    writeChunk(file, "IHDR", ihdr);
+
+    // 每列前加上 filter type 0
+    size_t rowBytes = static_cast<size_t>(width) * channels;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + y * rowBytes, pixels.begin() + (y + 1) * rowBytes);
+    }
+
+    // zlib 串流：未壓縮的 deflate 區塊（每塊最多 65535 bytes）+ Adler-32
+    std::vector<unsigned char> idat;
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    size_t pos = 0;
+    do {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        bool last = (pos + len == raw.size());
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(len & 0xFF);
+        idat.push_back((len >> 8) & 0xFF);
+        idat.push_back(~len & 0xFF);
+        idat.push_back((~len >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+    uint32_t a = 1, b = 0;
+    for (unsigned char c : raw) {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    putU32(idat, (b << 16) | a);
+    writeChunk(file, "IDAT", idat);
+    writeChunk(file, "IEND", std::vector<unsigned char>());
+    return static_cast<bool>(file);
+}
+
+bool CImageWriter::writeHDR(const std::string& path, int width, int height, const std::vector<float>& rgb) {
+    if (rgb.size() < static_cast<size_t>(width) * height * 3) {
+        std::cerr << "writeHDR: invalid image " << path << std::endl;
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "writeHDR: cannot open " << path << std::endl;
+        return false;
+    }
+    file << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << height << " +X " << width << "\n";
+
+    std::vector<unsigned char> row(static_cast<size_t>(width) * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const float* p = &rgb[(static_cast<size_t>(y) * width + x) * 3];
+            float m = std::max(p[0], std::max(p[1], p[2]));
+            unsigned char* e = &row[x * 4];
+            if (m < 1e-32f) {
+                e[0] = e[1] = e[2] = e[3] = 0;
+            } else {
+                int exponent;
+                float scale = std::frexp(m, &exponent) * 256.0f / m;
+                e[0] = static_cast<unsigned char>(std::max(0.0f, p[0]) * scale);
+                e[1] = static_cast<unsigned char>(std::max(0.0f, p[1]) * scale);
+                e[2] = static_cast<unsigned char>(std::max(0.0f, p[2]) * scale);
+                e[3] = static_cast<unsigned char>(exponent + 128);
+            }
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,19 @@
+//  CImageWriter.h
+//  工具程式用的影像輸出，不需要額外的函式庫
+//  PNG 使用未壓縮的 deflate 區塊；HDR 為 Radiance RGBE 格式（不做 RLE），stb_image 都能直接讀取
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class CImageWriter {
+public:
+    // pixels 為 width*height*channels 個 byte，第一列為影像最上方（與 stb_image 讀取時相同）
+    static bool writePNG(const std::string& path, int width, int height, int channels,
+                         const std::vector<unsigned char>& pixels);
+
+    // rgb 為 width*height*3 個 float（線性數值）
+    static bool writeHDR(const std::string& path, int width, int height,
+                         const std::vector<float>& rgb);
+};
@@ -0,0 +1,284 @@
+//  CImpostorRenderer.cpp
+#include "CImpostorRenderer.h"
+#include "CShaderPool.h"
+#include "Model.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <iostream>
+
+CImpostorRenderer::CImpostorRenderer()
+    : _shader(0), _bakeShader(0), _vao(0), _instanceVbo(0), _bakeFbo(0), _instanceCapacity(0),
+      _queryIndex(0), _gpuTotal(0.0), _gpuFrames(0) {
+    for (int i = 0; i < 2; i++) {
+        _queries[i] = 0;
+        _queryPending[i] = false;
+    }
+}
+
+CImpostorRenderer::~CImpostorRenderer() {
+    // GL 資源需由 release() 在 context 存在時釋放
+}
+
+void CImpostorRenderer::init() {
+    _shader = CShaderPool::getInstance().getShader("impostor_vtxshader.glsl", "impostor_fragshader.glsl");
+    _bakeShader = CShaderPool::getInstance().getShader("impostor_bake_vtxshader.glsl", "impostor_bake_fragshader.glsl");
+    glUseProgram(_shader);
+    glUniform1i(glGetUniformLocation(_shader, "uAlbedo"), 0);
+    glUniform1i(glGetUniformLocation(_shader, "uNormalDepth"), 1);
+    glUniform1i(glGetUniformLocation(_shader, "uFramesPerSide"), IMPOSTOR_FRAMES_PER_SIDE);
+    glUseProgram(_bakeShader);
+    glUniform1i(glGetUniformLocation(_bakeShader, "uDiffuseTexture"), 0);
+
+    // 四邊形的頂點由 gl_VertexID 產生，buffer 中只有每個實體的模型矩陣（位置 0 ~ 3）
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_instanceVbo);
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    for (int i = 0; i < 4; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glGenFramebuffers(1, &_bakeFbo);
+    glGenQueries(2, _queries);
+}
+
+void CImpostorRenderer::release() {
+    for (Impostor& impostor : _impostors) {
+        if (impostor.albedoTex != 0) glDeleteTextures(1, &impostor.albedoTex);
+        if (impostor.normalDepthTex != 0) glDeleteTextures(1, &impostor.normalDepthTex);
+    }
+    _impostors.clear();
+    if (_vao != 0) glDeleteVertexArrays(1, &_vao);
+    if (_instanceVbo != 0) glDeleteBuffers(1, &_instanceVbo);
+    if (_bakeFbo != 0) glDeleteFramebuffers(1, &_bakeFbo);
+    if (_queries[0] != 0) glDeleteQueries(2, _queries);
+    _vao = _instanceVbo = _bakeFbo = 0;
+    _queries[0] = _queries[1] = 0;
+    _instanceCapacity = 0;
+}
+
+static GLuint createAtlasTexture(int size) {
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, IMPOSTOR_MIP_LEVELS - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+int CImpostorRenderer::bake(Model* model) {
+    if (_bakeShader == 0 || model == nullptr || !model->IsLoaded()) return -1;
+    Impostor impostor;
+    impostor.center = (model->getBoundsMin() + model->getBoundsMax()) * 0.5f;
+    impostor.radius = std::max(glm::length(model->getBoundsMax() - model->getBoundsMin()) * 0.5f, 1e-3f);
+    const int atlasSize = IMPOSTOR_FRAMES_PER_SIDE * IMPOSTOR_FRAME_SIZE;
+    impostor.albedoTex = createAtlasTexture(atlasSize);
+    impostor.normalDepthTex = createAtlasTexture(atlasSize);
+
+    GLint prevFbo = 0, prevProgram = 0, viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    GLboolean blendEnabled = glIsEnabled(GL_BLEND);
+
+    GLuint depthBuffer = 0;
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlasSize, atlasSize);
+    glBindFramebuffer(GL_FRAMEBUFFER, _bakeFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, impostor.albedoTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, impostor.normalDepthTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    if (complete) {
+        // 沒有畫到的像素覆蓋率為 0；法向量朝向視角、深度為最遠
+        const GLfloat clearAlbedo[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        const GLfloat clearNormalDepth[4] = { 0.5f, 0.5f, 1.0f, 1.0f };
+        const GLfloat clearDepth = 1.0f;
+        glClearBufferfv(GL_COLOR, 0, clearAlbedo);
+        glClearBufferfv(GL_COLOR, 1, clearNormalDepth);
+        glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+        glEnable(GL_DEPTH_TEST);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+        glDisable(GL_CULL_FACE);
+        glUseProgram(_bakeShader);
+        glUniformMatrix4fv(glGetUniformLocation(_bakeShader, "mxModel"), 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+        GLint viewProjLoc = glGetUniformLocation(_bakeShader, "mxViewProj");
+
+        // 每個視角以包圍球大小的正交投影，攝影機在球面上往中心看：深度 0 為球的最前端，1 為最後端
+        const float r = impostor.radius;
+        glm::mat4 proj = glm::ortho(-r, r, -r, r, 0.0f, 2.0f * r);
+        for (int y = 0; y < IMPOSTOR_FRAMES_PER_SIDE; ++y) {
+            for (int x = 0; x < IMPOSTOR_FRAMES_PER_SIDE; ++x) {
+                glm::vec3 dir = impostorFrameDirection(x, y, IMPOSTOR_FRAMES_PER_SIDE);
+                glm::vec3 right, up;
+                impostorFrameBasis(dir, right, up);
+                glm::mat4 view = glm::lookAt(impostor.center + dir * r, impostor.center, up);
+                glm::mat4 viewProj = proj * view;
+                glUniformMatrix4fv(viewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
+                glViewport(x * IMPOSTOR_FRAME_SIZE, y * IMPOSTOR_FRAME_SIZE, IMPOSTOR_FRAME_SIZE, IMPOSTOR_FRAME_SIZE);
+                model->RenderProxy(_bakeShader);
+            }
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glUseProgram(prevProgram);
+    if (cullEnabled) glEnable(GL_CULL_FACE);
+    if (blendEnabled) glEnable(GL_BLEND);
+    if (!complete) {
+        std::cerr << "Impostor framebuffer incomplete, impostor not baked" << std::endl;
+        glDeleteTextures(1, &impostor.albedoTex);
+        glDeleteTextures(1, &impostor.normalDepthTex);
+        return -1;
+    }
+    for (GLuint texture : { impostor.albedoTex, impostor.normalDepthTex }) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    _impostors.push_back(impostor);
+    int index = static_cast<int>(_impostors.size()) - 1;
+    std::cout << "Impostor " << index << ": " << IMPOSTOR_FRAMES_PER_SIDE * IMPOSTOR_FRAMES_PER_SIDE << " views of "
+              << IMPOSTOR_FRAME_SIZE << "x" << IMPOSTOR_FRAME_SIZE << ", " << atlasSize << "x" << atlasSize << " atlas, "
+              << getMemoryBytes(index) / 1024 << " KB" << std::endl;
+    return index;
+}
+
+size_t CImpostorRenderer::getMemoryBytes(int impostor) const {
+    (void)impostor;   // 所有 impostor 使用相同的排列與大小
+    return impostorMemoryBytes(IMPOSTOR_FRAMES_PER_SIDE, IMPOSTOR_FRAME_SIZE, IMPOSTOR_MIP_LEVELS);
+}
+
+void CImpostorRenderer::clearInstances() {
+    for (Impostor& impostor : _impostors) impostor.instances.clear();
+}
+
+void CImpostorRenderer::addInstance(int impostor, const glm::mat4& world) {
+    _impostors[impostor].instances.push_back(world);
+}
+
+void CImpostorRenderer::readQueries() {
+    for (int i = 0; i < 2; i++) {
+        if (!_queryPending[i]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(_queries[i], GL_QUERY_RESULT, &elapsed);
+        _queryPending[i] = false;
+
+        _gpuTotal += elapsed * 1e-6;
+        if (++_gpuFrames >= IMPOSTOR_TIMING_FRAMES) {
+            _stats.gpuMs = _gpuTotal / _gpuFrames;
+            _stats.gpuSamples = _gpuFrames;
+            _gpuTotal = 0.0;
+            _gpuFrames = 0;
+        }
+    }
+}
+
+void CImpostorRenderer::render(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& viewPos,
+                               const glm::vec3& lightPos) {
+    readQueries();
+    _stats.instances = 0;
+    _stats.draws = 0;
+    _stats.uploadedBytes = 0;
+    if (_shader == 0) return;
+
+    // 所有實體依 impostor 排在一起，一次上傳
+    _uploadBuffer.clear();
+    for (const Impostor& impostor : _impostors) {
+        _uploadBuffer.insert(_uploadBuffer.end(), impostor.instances.begin(), impostor.instances.end());
+    }
+    int count = static_cast<int>(_uploadBuffer.size());
+    if (count == 0) return;
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    if (count > _instanceCapacity) {
+        _instanceCapacity = std::max(count, _instanceCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, _instanceCapacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), _uploadBuffer.data());
+    _stats.instances = count;
+    _stats.uploadedBytes = count * static_cast<int>(sizeof(glm::mat4));
+
+    int q = _queryIndex;
+    bool timing = (_queries[q] != 0) && !_queryPending[q];
+    if (timing) glBeginQuery(GL_TIME_ELAPSED, _queries[q]);
+
+    glUseProgram(_shader);
+    glm::mat4 viewProj = proj * view;
+    glUniformMatrix4fv(glGetUniformLocation(_shader, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    glUniform3fv(glGetUniformLocation(_shader, "uViewPos"), 1, glm::value_ptr(viewPos));
+    glUniform3f(glGetUniformLocation(_shader, "uCameraRight"), view[0][0], view[1][0], view[2][0]);
+    glUniform3f(glGetUniformLocation(_shader, "uCameraUp"), view[0][1], view[1][1], view[2][1]);
+    glUniform3fv(glGetUniformLocation(_shader, "uLightPos"), 1, glm::value_ptr(lightPos));
+    GLint centerLoc = glGetUniformLocation(_shader, "uCenter");
+    GLint radiusLoc = glGetUniformLocation(_shader, "uRadius");
+
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    glBindVertexArray(_vao);
+    size_t first = 0;
+    for (const Impostor& impostor : _impostors) {
+        if (impostor.instances.empty()) continue;
+        for (int i = 0; i < 4; i++) {
+            glVertexAttribPointer(i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void*)(first * sizeof(glm::mat4) + i * sizeof(glm::vec4)));
+        }
+        glUniform3fv(centerLoc, 1, glm::value_ptr(impostor.center));
+        glUniform1f(radiusLoc, impostor.radius);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, impostor.albedoTex);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, impostor.normalDepthTex);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(impostor.instances.size()));
+        first += impostor.instances.size();
+        _stats.draws++;
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (cullEnabled) glEnable(GL_CULL_FACE);
+
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _queryPending[q] = true;
+        _queryIndex = 1 - q;
+    }
+}
+
+void CImpostorRenderer::printStats() const {
+    size_t memory = 0;
+    for (int i = 0; i < getImpostorCount(); ++i) memory += getMemoryBytes(i);
+    std::cout << "Impostors: " << _stats.instances << " instances in " << _stats.draws << " draws, "
+              << getImpostorCount() << " baked (" << memory / 1024 << " KB, "
+              << (getImpostorCount() > 0 ? getMemoryBytes(0) / 1024 : 0) << " KB each)" << std::endl;
+    std::cout << "  impostor pass GPU: ";
+    if (_stats.gpuSamples > 0) {
+        std::cout << _stats.gpuMs << " ms (avg of " << _stats.gpuSamples << " frames)";
+    } else {
+        std::cout << "not measured yet";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,79 @@
+//  CImpostorRenderer.h
+//  遠處的家具以八面體 impostor 描繪：bake 時從上半球 IMPOSTOR_FRAMES_PER_SIDE² 個方向以正交投影畫出模型的不透明網格
+//  （Model::RenderProxy），每個方向一格寫入兩張貼圖集：顏色 + 覆蓋率、模型空間的法向量 + 深度
+//  描繪時每個實體只有一個面向攝影機的四邊形，vertex shader 依視線方向（模型空間）選出三個相鄰的視角與混合權重，
+//  四邊形上的點投影到各視角的畫面上取樣；fragment shader 以深度還原表面的位置寫入深度緩衝區，與牆壁、門框正確遮擋
+//  每種 impostor 一次 instanced draw；所有實體的模型矩陣每個 frame 上傳一次
+//  OctahedralImpostor.h 為共用的視角排列與記憶體計算
+
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "OctahedralImpostor.h"
+
+class Model;
+
+#define IMPOSTOR_FRAMES_PER_SIDE 8
+#define IMPOSTOR_FRAME_SIZE 64          // 每個視角的像素數（寬、高）
+#define IMPOSTOR_MIP_LEVELS 4           // 最小一層每個視角 8 像素，再小會混到相鄰的視角
+#define IMPOSTOR_TIMING_FRAMES 60
+
+// impostor 描繪的統計，GPU 時間為最近 IMPOSTOR_TIMING_FRAMES 個 frame 的平均
+struct ImpostorStats {
+    int instances = 0;              // 這個 frame 以 impostor 描繪的實體
+    int draws = 0;
+    int uploadedBytes = 0;
+    double gpuMs = 0.0;
+    int gpuSamples = 0;
+};
+
+class CImpostorRenderer {
+public:
+    CImpostorRenderer();
+    ~CImpostorRenderer();
+
+    void init();
+    void release();
+
+    // 烘焙 model 的 impostor（需要 GL context，會暫時改變 framebuffer 與 viewport），回傳編號，失敗時為 -1
+    int bake(Model* model);
+    int getImpostorCount() const { return static_cast<int>(_impostors.size()); }
+    float getRadius(int impostor) const { return _impostors[impostor].radius; }   // 模型空間的包圍球
+    size_t getMemoryBytes(int impostor) const;
+
+    // 每個 frame：clearInstances 後加入要以 impostor 描繪的實體，在不透明物件之間呼叫 render
+    void clearInstances();
+    void addInstance(int impostor, const glm::mat4& world);
+    void render(const glm::mat4& view, const glm::mat4& proj, const glm::vec3& viewPos, const glm::vec3& lightPos);
+
+    const ImpostorStats& getStats() const { return _stats; }
+    void printStats() const;
+
+private:
+    struct Impostor {
+        GLuint albedoTex = 0, normalDepthTex = 0;
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 1.0f;
+        std::vector<glm::mat4> instances;
+    };
+
+    void readQueries();
+
+    GLuint _shader, _bakeShader;
+    GLuint _vao, _instanceVbo, _bakeFbo;
+    int    _instanceCapacity;
+    std::vector<Impostor> _impostors;
+    std::vector<glm::mat4> _uploadBuffer;
+
+    // 兩組 query 輪流使用，讀取上一個 frame 的結果以避免等待
+    GLuint _queries[2];
+    bool   _queryPending[2];
+    int    _queryIndex;
+    double _gpuTotal;
+    int    _gpuFrames;
+
+    ImpostorStats _stats;
+};
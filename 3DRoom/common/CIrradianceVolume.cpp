@@ -0,0 +1,176 @@
+//  CIrradianceVolume.cpp
+#include "CIrradianceVolume.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// IEEE 754 half float 轉換（不處理 NaN，數值範圍遠小於 65504）
+static uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    if (exponent <= 0) {
+        if (exponent < -10) return static_cast<uint16_t>(sign);
+        mantissa = (mantissa | 0x800000u) >> (1 - exponent);
+        return static_cast<uint16_t>(sign | ((mantissa + 0x1000u) >> 13));
+    }
+    if (exponent >= 31) return static_cast<uint16_t>(sign | 0x7BFFu);
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) half++;  // 四捨五入
+    return static_cast<uint16_t>(half);
+}
+
+static float halfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FFu;
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // subnormal
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400u) == 0) { mantissa <<= 1; exponent--; }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, 4);
+    return value;
+}
+
+void CIrradianceVolume::create(const glm::ivec3& dims, const glm::vec3& origin, float spacing) {
+    _dims = dims;
+    _origin = origin;
+    _spacing = spacing;
+    _probes.assign(static_cast<size_t>(dims.x) * dims.y * dims.z, IrradianceProbe());
+    for (auto& p : _probes) {
+        for (int i = 0; i < SH_COEFF_COUNT; i++) p.sh[i] = glm::vec3(0.0f);
+    }
+}
+
+bool CIrradianceVolume::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot write irradiance volume: " << path << std::endl;
+        return false;
+    }
+    uint32_t version = IRRADIANCE_FILE_VERSION;
+    file.write("IRRV", 4);
+    file.write(reinterpret_cast<const char*>(&version), 4);
+    file.write(reinterpret_cast<const char*>(&_dims), sizeof(int32_t) * 3);
+    file.write(reinterpret_cast<const char*>(&_origin), sizeof(float) * 3);
+    file.write(reinterpret_cast<const char*>(&_spacing), sizeof(float));
+    for (const auto& p : _probes) {
+        uint8_t header[2] = { static_cast<uint8_t>(p.valid ? 1 : 0), 0 };
+        uint16_t coeffs[SH_COEFF_COUNT * 3];
+        for (int i = 0; i < SH_COEFF_COUNT; i++) {
+            coeffs[i * 3 + 0] = floatToHalf(p.sh[i].x);
+            coeffs[i * 3 + 1] = floatToHalf(p.sh[i].y);
+            coeffs[i * 3 + 2] = floatToHalf(p.sh[i].z);
+        }
+        file.write(reinterpret_cast<const char*>(header), 2);
+        file.write(reinterpret_cast<const char*>(coeffs), sizeof(coeffs));
+    }
+    return static_cast<bool>(file);
+}
+
+bool CIrradianceVolume::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "Irradiance volume not found: " << path << std::endl;
+        return false;
+    }
+    char magic[4];
+    uint32_t version = 0;
+    glm::ivec3 dims;
+    glm::vec3 origin;
+    float spacing;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&version), 4);
+    file.read(reinterpret_cast<char*>(&dims), sizeof(int32_t) * 3);
+    file.read(reinterpret_cast<char*>(&origin), sizeof(float) * 3);
+    file.read(reinterpret_cast<char*>(&spacing), sizeof(float));
+    if (!file || std::memcmp(magic, "IRRV", 4) != 0 || version != IRRADIANCE_FILE_VERSION ||
+        dims.x <= 0 || dims.y <= 0 || dims.z <= 0 || spacing <= 0.0f) {
+        std::cerr << "Invalid irradiance volume: " << path << std::endl;
+        return false;
+    }
+
+    create(dims, origin, spacing);
+    for (auto& p : _probes) {
+        uint8_t header[2];
+        uint16_t coeffs[SH_COEFF_COUNT * 3];
+        file.read(reinterpret_cast<char*>(header), 2);
+        file.read(reinterpret_cast<char*>(coeffs), sizeof(coeffs));
+        p.valid = (header[0] != 0);
+        for (int i = 0; i < SH_COEFF_COUNT; i++) {
+            p.sh[i] = glm::vec3(halfToFloat(coeffs[i * 3 + 0]), halfToFloat(coeffs[i * 3 + 1]),
+                                halfToFloat(coeffs[i * 3 + 2]));
+        }
+    }
+    if (!file) {
+        std::cerr << "Truncated irradiance volume: " << path << std::endl;
+        _probes.clear();
+        return false;
+    }
+    std::cout << "Loaded irradiance volume: " << path << " (" << dims.x << "x" << dims.y << "x" << dims.z
+              << " probes, spacing " << spacing << ")" << std::endl;
+    return true;
+}
+
+bool CIrradianceVolume::sample(const glm::vec3& pos, glm::vec3 outSH[SH_COEFF_COUNT]) const {
+    if (_probes.empty()) return false;
+
+    glm::vec3 g = (pos - _origin) / _spacing;
+    glm::vec3 maxCell = glm::vec3(_dims - glm::ivec3(1));
+    g = glm::clamp(g, glm::vec3(0.0f), maxCell);
+    glm::ivec3 base = glm::ivec3(glm::floor(g));
+    base = glm::min(base, glm::max(_dims - glm::ivec3(2), glm::ivec3(0)));
+    glm::vec3 f = g - glm::vec3(base);
+
+    for (int i = 0; i < SH_COEFF_COUNT; i++) outSH[i] = glm::vec3(0.0f);
+    float totalWeight = 0.0f;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::ivec3 offset((corner & 1), (corner >> 1) & 1, (corner >> 2) & 1);
+        glm::ivec3 c = glm::min(base + offset, _dims - glm::ivec3(1));
+        const IrradianceProbe& p = _probes[index(c.x, c.y, c.z)];
+        if (!p.valid) continue;
+        float w = (offset.x ? f.x : 1.0f - f.x) * (offset.y ? f.y : 1.0f - f.y) * (offset.z ? f.z : 1.0f - f.z);
+        if (w <= 0.0f) continue;
+        for (int i = 0; i < SH_COEFF_COUNT; i++) outSH[i] += p.sh[i] * w;
+        totalWeight += w;
+    }
+    if (totalWeight <= 1e-5f) return false;
+    // 無效探針的權重分給其他探針
+    for (int i = 0; i < SH_COEFF_COUNT; i++) outSH[i] /= totalWeight;
+    return true;
+}
+
+void CIrradianceVolume::evalBasis(const glm::vec3& d, float out[SH_COEFF_COUNT]) {
+    out[0] = 0.282095f;
+    out[1] = 0.488603f * d.y;
+    out[2] = 0.488603f * d.z;
+    out[3] = 0.488603f * d.x;
+    out[4] = 1.092548f * d.x * d.y;
+    out[5] = 1.092548f * d.y * d.z;
+    out[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+    out[7] = 1.092548f * d.x * d.z;
+    out[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+}
+
+void CIrradianceVolume::convolveCosine(glm::vec3 sh[SH_COEFF_COUNT]) {
+    // Ramamoorthi & Hanrahan：A0 = pi, A1 = 2pi/3, A2 = pi/4
+    const float a0 = 3.141593f, a1 = 2.094395f, a2 = 0.785398f;
+    sh[0] *= a0;
+    for (int i = 1; i < 4; i++) sh[i] *= a1;
+    for (int i = 4; i < 9; i++) sh[i] *= a2;
+}
@@ -0,0 +1,58 @@
+//  CIrradianceVolume.h
+//  Irradiance Volume：覆蓋六個房間的 3D 探針格點，每個探針儲存 L2 球諧函數（9 個 RGB 係數）
+//  係數已經與餘弦核心做過卷積，E(n) = sum(coeff[i] * Y_i(n)) 即為法向量 n 收到的光，
+//  單位與 f_phong 的 diffuse 相同（材質顏色 * E）
+//  由 tools/ProbeBaker 產生，不依賴 OpenGL
+//
+//  .irr 檔案格式（little-endian）：
+//      char[4]  "IRRV"
+//      uint32   版本 (IRRADIANCE_FILE_VERSION)
+//      int32    nx, ny, nz
+//      float    origin[3], spacing
+//      每個探針（x 最快、z 最慢）：uint8 valid, uint8 padding, uint16 half[27]（9 個係數 * RGB）
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define SH_COEFF_COUNT 9
+#define IRRADIANCE_FILE_VERSION 1
+
+struct IrradianceProbe {
+    glm::vec3 sh[SH_COEFF_COUNT];
+    bool valid = true;   // 位於牆壁或物體內部的探針不參與內插
+};
+
+class CIrradianceVolume {
+public:
+    // 建立空的格點（烘焙工具使用）
+    void create(const glm::ivec3& dims, const glm::vec3& origin, float spacing);
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    bool isLoaded() const { return !_probes.empty(); }
+
+    // 以三線性內插取得 pos 位置的球諧係數，周圍沒有有效探針時回傳 false
+    bool sample(const glm::vec3& pos, glm::vec3 outSH[SH_COEFF_COUNT]) const;
+
+    IrradianceProbe& probe(int x, int y, int z) { return _probes[index(x, y, z)]; }
+    glm::vec3 probePosition(int x, int y, int z) const { return _origin + glm::vec3(x, y, z) * _spacing; }
+    const glm::ivec3& getDims() const { return _dims; }
+    int getProbeCount() const { return static_cast<int>(_probes.size()); }
+
+    // 球諧基底（L2，實數）
+    static void evalBasis(const glm::vec3& dir, float out[SH_COEFF_COUNT]);
+    // 把輻射度的投影係數與餘弦核心卷積，轉成 irradiance 係數
+    static void convolveCosine(glm::vec3 sh[SH_COEFF_COUNT]);
+
+private:
+    int index(int x, int y, int z) const { return (z * _dims.y + y) * _dims.x + x; }
+
+    std::vector<IrradianceProbe> _probes;
+    glm::ivec3 _dims = glm::ivec3(0);
+    glm::vec3  _origin = glm::vec3(0.0f);
+    float      _spacing = 1.0f;
+};
@@ -61,6 +61,7 @@ public:
     // yøN light ҫ
     void draw();
     void drawRaw();
+    void setVertexFormat(VertexFormat format) { _lightObj.setVertexFormat(format); } // N light ҫsWǳI
     
     LightType getType() const;
     float getInnerCutOff() const;
@@ -70,6 +71,10 @@ public:
     float getClock() const;
     glm::vec3 getStartPos() const;
 
+    // wMH Light Map TwA Light Map 褣Avp
+    void setBaked(bool baked) { _baked = baked; }
+    bool isBaked() const { return _baked; }
+
 private:
     std::string _lightname;
     GLuint _shaderID;
@@ -97,5 +102,6 @@ private:
     // ʺAܼ
     float _clock;    // ʺA clock
     bool  _motionOn; // ʺA
+    bool  _baked = false;
     
 };
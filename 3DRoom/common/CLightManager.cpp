@@ -89,6 +89,9 @@ void CLightManager::updateAllLightsToShader() {
         loc = glGetUniformLocation(shaderID, (lightName + ".enabled").c_str());
         glUniform1i(loc, light->isLightOn() ? 1 : 0);
         
+        loc = glGetUniformLocation(shaderID, (lightName + ".baked").c_str());
+        glUniform1i(loc, light->isBaked() ? 1 : 0);
+        
         // Spot light specific parameters
         if (light->getType() == CLight::LightType::SPOT) {
             loc = glGetUniformLocation(shaderID, (lightName + ".direction").c_str());
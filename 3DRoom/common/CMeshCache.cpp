@@ -0,0 +1,321 @@
+//  CMeshCache.cpp
+#include "CMeshCache.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// 來源檔案的大小與修改時間，不存在時皆為 -1
+struct SourceStamp {
+    int64_t size = -1;
+    int64_t time = -1;
+};
+
+SourceStamp stampOf(const std::string& path) {
+    SourceStamp stamp;
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) return stamp;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) return stamp;
+    stamp.size = static_cast<int64_t>(size);
+    stamp.time = static_cast<int64_t>(time.time_since_epoch().count());
+    return stamp;
+}
+
+std::string mtlPathOf(const std::string& objPath) {
+    return std::filesystem::path(objPath).replace_extension(".mtl").string();
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeString(std::ofstream& file, const std::string& s) {
+    writeValue(file, static_cast<uint32_t>(s.size()));
+    file.write(s.data(), s.size());
+}
+
+bool readString(std::ifstream& file, std::string& s) {
+    uint32_t length = 0;
+    if (!readValue(file, length) || length > (1u << 16)) return false;
+    s.resize(length);
+    return length == 0 || static_cast<bool>(file.read(&s[0], length));
+}
+
+template <typename T>
+void writeArray(std::ofstream& file, const std::vector<T>& values) {
+    writeValue(file, static_cast<uint32_t>(values.size()));
+    if (!values.empty()) file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readArray(std::ifstream& file, std::vector<T>& values) {
+    uint32_t count = 0;
+    if (!readValue(file, count) || count > (1u << 28)) return false;
+    values.resize(count);
+    return count == 0 || static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), count * sizeof(T)));
+}
+
+// tinyobj 的 real_t 可能是 double，檔案中一律存 float
+void writeReals(std::ofstream& file, const tinyobj::real_t* values, int count) {
+    for (int i = 0; i < count; ++i) writeValue(file, static_cast<float>(values[i]));
+}
+
+bool readReals(std::ifstream& file, tinyobj::real_t* values, int count) {
+    for (int i = 0; i < count; ++i) {
+        float value;
+        if (!readValue(file, value)) return false;
+        values[i] = static_cast<tinyobj::real_t>(value);
+    }
+    return true;
+}
+
+// 檔頭：magic、版本與來源檔案（.obj 與同名 .mtl）的大小、修改時間
+void writeHeader(std::ofstream& file, const char* magic, uint32_t version, const std::string& objPath) {
+    SourceStamp obj = stampOf(objPath), mtl = stampOf(mtlPathOf(objPath));
+    file.write(magic, 4);
+    writeValue(file, version);
+    writeValue(file, obj.size);
+    writeValue(file, obj.time);
+    writeValue(file, mtl.size);
+    writeValue(file, mtl.time);
+}
+
+// 格式或版本不同、來源檔案已修改時輸出原因並回傳 false
+bool readHeader(std::ifstream& file, const char* magic, uint32_t version, const std::string& objPath,
+                const std::string& path) {
+    char fileMagic[4];
+    uint32_t fileVersion = 0;
+    SourceStamp obj, mtl;
+    file.read(fileMagic, 4);
+    readValue(file, fileVersion);
+    readValue(file, obj.size);
+    readValue(file, obj.time);
+    readValue(file, mtl.size);
+    readValue(file, mtl.time);
+    SourceStamp currentObj = stampOf(objPath), currentMtl = stampOf(mtlPathOf(objPath));
+    if (!file || std::memcmp(fileMagic, magic, 4) != 0 || fileVersion != version) {
+        std::cout << "Mesh cache out of date (format): " << path << std::endl;
+        return false;
+    }
+    if (obj.size != currentObj.size || obj.time != currentObj.time ||
+        mtl.size != currentMtl.size || mtl.time != currentMtl.time) {
+        std::cout << "Mesh cache out of date (source changed): " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::string CMeshCache::cachePath(const std::string& objPath) {
+    return std::filesystem::path(objPath).replace_extension(".mcache").string();
+}
+
+bool CMeshCache::load(const std::string& objPath, std::vector<tinyobj::material_t>& materials,
+                      std::vector<Mesh>& meshes, std::vector<CollisionProxy>& proxies) {
+    std::string path = cachePath(objPath);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    if (!readHeader(file, "MCSH", MESH_CACHE_VERSION, objPath, path)) return false;
+
+    uint32_t materialCount = 0;
+    bool ok = readValue(file, materialCount) && materialCount < (1u << 16);
+    materials.assign(ok ? materialCount : 0, tinyobj::material_t());
+    for (auto& m : materials) {
+        ok = ok && readString(file, m.name);
+        ok = ok && readReals(file, m.ambient, 3) && readReals(file, m.diffuse, 3) && readReals(file, m.specular, 3);
+        ok = ok && readReals(file, &m.shininess, 1) && readReals(file, &m.dissolve, 1);
+        ok = ok && readString(file, m.diffuse_texname) && readString(file, m.normal_texname);
+        ok = ok && readString(file, m.specular_texname) && readString(file, m.alpha_texname);
+    }
+
+    uint32_t meshCount = 0;
+    ok = ok && readValue(file, meshCount) && meshCount < (1u << 20);
+    meshes.assign(ok ? meshCount : 0, Mesh());
+    proxies.assign(meshes.size(), CollisionProxy());
+    for (size_t i = 0; ok && i < meshes.size(); ++i) {
+        Mesh& mesh = meshes[i];
+        int32_t materialIndex = -1;
+        ok = readValue(file, materialIndex) && readValue(file, mesh.boundsMin) && readValue(file, mesh.boundsMax);
+        ok = ok && readArray(file, mesh.vertices) && readArray(file, mesh.indices) && readArray(file, mesh.clusters);
+        mesh.materialIndex = materialIndex;
+        CollisionProxy& proxy = proxies[i];
+        ok = ok && readValue(file, proxy.boundsMin) && readValue(file, proxy.boundsMax) && readArray(file, proxy.hull);
+        ok = ok && readValue(file, proxy.box);
+    }
+    if (!ok) {
+        std::cerr << "Truncated mesh cache: " << path << std::endl;
+        materials.clear();
+        meshes.clear();
+        proxies.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CMeshCache::save(const std::string& objPath, const std::vector<tinyobj::material_t>& materials,
+                      const std::vector<Mesh>& meshes, const std::vector<CollisionProxy>& proxies) {
+    std::string path = cachePath(objPath);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot write mesh cache: " << path << std::endl;
+        return false;
+    }
+    writeHeader(file, "MCSH", MESH_CACHE_VERSION, objPath);
+
+    writeValue(file, static_cast<uint32_t>(materials.size()));
+    for (const auto& m : materials) {
+        writeString(file, m.name);
+        writeReals(file, m.ambient, 3);
+        writeReals(file, m.diffuse, 3);
+        writeReals(file, m.specular, 3);
+        writeReals(file, &m.shininess, 1);
+        writeReals(file, &m.dissolve, 1);
+        writeString(file, m.diffuse_texname);
+        writeString(file, m.normal_texname);
+        writeString(file, m.specular_texname);
+        writeString(file, m.alpha_texname);
+    }
+
+    writeValue(file, static_cast<uint32_t>(meshes.size()));
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh& mesh = meshes[i];
+        writeValue(file, static_cast<int32_t>(mesh.materialIndex));
+        writeValue(file, mesh.boundsMin);
+        writeValue(file, mesh.boundsMax);
+        writeArray(file, mesh.vertices);
+        writeArray(file, mesh.indices);
+        writeArray(file, mesh.clusters);
+        const CollisionProxy& proxy = proxies[i];
+        writeValue(file, proxy.boundsMin);
+        writeValue(file, proxy.boundsMax);
+        writeArray(file, proxy.hull);
+        writeValue(file, proxy.box);
+    }
+    return static_cast<bool>(file);
+}
+
+std::string CMeshCache::fracturePath(const std::string& objPath) {
+    return std::filesystem::path(objPath).replace_extension(".fcache").string();
+}
+
+bool CMeshCache::loadFracture(const std::string& objPath, int pieces, unsigned seed, std::vector<FractureChunk>& chunks) {
+    std::string path = fracturePath(objPath);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    if (!readHeader(file, "MCFR", FRACTURE_CACHE_VERSION, objPath, path)) return false;
+
+    int32_t filePieces = 0;
+    uint32_t fileSeed = 0, chunkCount = 0;
+    bool ok = readValue(file, filePieces) && readValue(file, fileSeed);
+    if (ok && (filePieces != pieces || fileSeed != seed)) {
+        std::cout << "Fracture cache out of date (pieces or seed changed): " << path << std::endl;
+        return false;
+    }
+    ok = ok && readValue(file, chunkCount) && chunkCount < (1u << 16);
+    chunks.assign(ok ? chunkCount : 0, FractureChunk());
+    for (size_t i = 0; ok && i < chunks.size(); ++i) {
+        FractureChunk& chunk = chunks[i];
+        ok = readValue(file, chunk.boundsMin) && readValue(file, chunk.boundsMax);
+        ok = ok && readValue(file, chunk.centroid) && readValue(file, chunk.volume);
+        ok = ok && readArray(file, chunk.vertices) && readArray(file, chunk.indices) && readArray(file, chunk.sections);
+    }
+    if (!ok) {
+        std::cerr << "Truncated fracture cache: " << path << std::endl;
+        chunks.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CMeshCache::saveFracture(const std::string& objPath, int pieces, unsigned seed,
+                              const std::vector<FractureChunk>& chunks) {
+    std::string path = fracturePath(objPath);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot write fracture cache: " << path << std::endl;
+        return false;
+    }
+    writeHeader(file, "MCFR", FRACTURE_CACHE_VERSION, objPath);
+    writeValue(file, static_cast<int32_t>(pieces));
+    writeValue(file, static_cast<uint32_t>(seed));
+    writeValue(file, static_cast<uint32_t>(chunks.size()));
+    for (const FractureChunk& chunk : chunks) {
+        writeValue(file, chunk.boundsMin);
+        writeValue(file, chunk.boundsMax);
+        writeValue(file, chunk.centroid);
+        writeValue(file, chunk.volume);
+        writeArray(file, chunk.vertices);
+        writeArray(file, chunk.indices);
+        writeArray(file, chunk.sections);
+    }
+    return static_cast<bool>(file);
+}
+
+std::string CMeshCache::lodPath(const std::string& objPath) {
+    return std::filesystem::path(objPath).replace_extension(".lcache").string();
+}
+
+bool CMeshCache::loadLods(const std::string& objPath, int maxLevels, std::vector<Mesh>& meshes) {
+    std::string path = lodPath(objPath);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    if (!readHeader(file, "MCLD", LOD_CACHE_VERSION, objPath, path)) return false;
+
+    int32_t fileLevels = 0;
+    uint32_t meshCount = 0;
+    bool ok = readValue(file, fileLevels) && readValue(file, meshCount);
+    if (ok && (fileLevels != maxLevels || meshCount != meshes.size())) {
+        std::cout << "LOD cache out of date (levels or meshes changed): " << path << std::endl;
+        return false;
+    }
+    for (size_t i = 0; ok && i < meshes.size(); ++i) {
+        Mesh& mesh = meshes[i];
+        uint32_t indexCount = 0;
+        ok = readValue(file, indexCount) && indexCount == mesh.indices.size();
+        ok = ok && readArray(file, mesh.lods) && readArray(file, mesh.lodIndices);
+        ok = ok && !mesh.lods.empty() && mesh.lods.size() <= static_cast<size_t>(maxLevels);
+        for (const MeshLod& lod : mesh.lods) {
+            ok = ok && static_cast<size_t>(lod.indexStart) + lod.indexCount <= mesh.indices.size() + mesh.lodIndices.size();
+        }
+    }
+    if (!ok) {
+        std::cerr << "Truncated LOD cache: " << path << std::endl;
+        for (Mesh& mesh : meshes) {
+            mesh.lods.clear();
+            mesh.lodIndices.clear();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool CMeshCache::saveLods(const std::string& objPath, int maxLevels, const std::vector<Mesh>& meshes) {
+    std::string path = lodPath(objPath);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot write LOD cache: " << path << std::endl;
+        return false;
+    }
+    writeHeader(file, "MCLD", LOD_CACHE_VERSION, objPath);
+    writeValue(file, static_cast<int32_t>(maxLevels));
+    writeValue(file, static_cast<uint32_t>(meshes.size()));
+    for (const Mesh& mesh : meshes) {
+        writeValue(file, static_cast<uint32_t>(mesh.indices.size()));
+        writeArray(file, mesh.lods);
+        writeArray(file, mesh.lodIndices);
+    }
+    return static_cast<bool>(file);
+}
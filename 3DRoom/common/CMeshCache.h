@@ -0,0 +1,62 @@
+//  CMeshCache.h
+//  OBJ 載入結果的二進位快取（.mcache，與 .obj 同名、放在同一個目錄）
+//  儲存 Model::LoadModel 處理後的網格（頂點、索引、材質索引、包圍盒）、材質參數與碰撞代理形狀，
+//  重新啟動時不需要再解析 OBJ、合併重複頂點與計算碰撞代理。只儲存 CPU 資料，OpenGL 緩衝區與貼圖仍由 Model 建立
+//  .obj 或同名 .mtl 的大小、修改時間改變時快取失效，LoadModel 會重新解析並覆寫
+//
+//  .mcache 檔案格式（little-endian）：
+//      char[4]  "MCSH"
+//      uint32   版本 (MESH_CACHE_VERSION)
+//      int64    obj 大小、obj 修改時間、mtl 大小、mtl 修改時間（沒有 mtl 時為 -1）
+//      uint32   材質數量，每個材質：string name, float ambient[3], diffuse[3], specular[3], shininess, dissolve,
+//               string diffuse / normal / specular / alpha 貼圖名稱（string 為 uint32 長度 + 字元）
+//      uint32   網格數量，每個網格：int32 materialIndex, float boundsMin[3], boundsMax[3],
+//               uint32 頂點數 + Vertex[]（依第一次使用排列）, uint32 索引數 + uint32[]（依叢集排列，CMeshOptimize 最佳化）, uint32 叢集數 + MeshCluster[],
+//               碰撞代理：float boundsMin[3], boundsMax[3], uint32 凸包頂點數 + float[3][],
+//               OBB：float center[3], axes[3][3], halfExtents[3]
+//
+//  預先破碎的碎片（CMeshFracture）另外存在 .fcache，檔頭與 .mcache 相同（magic 為 "MCFR"、版本為 FRACTURE_CACHE_VERSION），
+//  碎片數或種子點不同時也視為失效：
+//      int32    碎片數（要求的數量）、uint32 種子點
+//      uint32   碎片數量，每個碎片：float boundsMin[3], boundsMax[3], centroid[3], volume,
+//               uint32 頂點數 + FractureVertex[], uint32 索引數 + uint32[], uint32 區段數 + FractureSection[]
+//
+//  網格的 LOD（CMeshSimplify）存在 .lcache（magic 為 "MCLD"、版本為 LOD_CACHE_VERSION），層數或網格的索引數不同時失效：
+//      int32    層數上限（MESH_LOD_MAX）
+//      uint32   網格數量，每個網格：uint32 原本的索引數, uint32 層數 + MeshLod[], uint32 LOD 索引數 + uint32[]
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Model.h"
+#include "CollisionProxy.h"
+#include "CMeshFracture.h"
+
+#define MESH_CACHE_VERSION 4
+#define FRACTURE_CACHE_VERSION 1
+#define LOD_CACHE_VERSION 3
+
+class CMeshCache {
+public:
+    // models/sofa.obj -> models/sofa.mcache
+    static std::string cachePath(const std::string& objPath);
+
+    // 快取不存在、版本不同或來源檔案已修改時回傳 false；meshes 不含 OpenGL 緩衝區
+    static bool load(const std::string& objPath, std::vector<tinyobj::material_t>& materials,
+                     std::vector<Mesh>& meshes, std::vector<CollisionProxy>& proxies);
+    static bool save(const std::string& objPath, const std::vector<tinyobj::material_t>& materials,
+                     const std::vector<Mesh>& meshes, const std::vector<CollisionProxy>& proxies);
+
+    // models/sofa.obj -> models/sofa.fcache
+    static std::string fracturePath(const std::string& objPath);
+    static bool loadFracture(const std::string& objPath, int pieces, unsigned seed, std::vector<FractureChunk>& chunks);
+    static bool saveFracture(const std::string& objPath, int pieces, unsigned seed,
+                             const std::vector<FractureChunk>& chunks);
+
+    // models/sofa.obj -> models/sofa.lcache；讀取成功時填入每個網格的 lods 與 lodIndices
+    static std::string lodPath(const std::string& objPath);
+    static bool loadLods(const std::string& objPath, int maxLevels, std::vector<Mesh>& meshes);
+    static bool saveLods(const std::string& objPath, int maxLevels, const std::vector<Mesh>& meshes);
+};
@@ -0,0 +1,187 @@
+//  CMeshCluster.cpp
+#include "CMeshCluster.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+#define CLUSTER_NORMAL_WEIGHT 2.0f   // 候選三角形的分數：距離平方（以預期的叢集半徑正規化）+ 此權重 x (1 - 法向量夾角餘弦)
+
+const unsigned int NONE = ~0u;
+
+// 位置相同的頂點對應到同一個編號（UV 接縫、硬邊兩側的三角形仍視為相鄰）
+std::vector<unsigned int> weldPositions(const float* vertices, size_t vertexCount, size_t stride) {
+    std::vector<unsigned int> order(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) order[i] = static_cast<unsigned int>(i);
+    auto less = [&](unsigned int a, unsigned int b) {
+        const float* pa = vertices + a * stride;
+        const float* pb = vertices + b * stride;
+        if (pa[0] != pb[0]) return pa[0] < pb[0];
+        if (pa[1] != pb[1]) return pa[1] < pb[1];
+        if (pa[2] != pb[2]) return pa[2] < pb[2];
+        return a < b;
+    };
+    std::sort(order.begin(), order.end(), less);
+    std::vector<unsigned int> rep(vertexCount, 0);
+    for (size_t i = 0; i < vertexCount;) {
+        const float* p = vertices + order[i] * stride;
+        size_t j = i + 1;
+        while (j < vertexCount) {
+            const float* q = vertices + order[j] * stride;
+            if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2]) break;
+            ++j;
+        }
+        for (size_t k = i; k < j; ++k) rep[order[k]] = order[i];
+        i = j;
+    }
+    return rep;
+}
+
+glm::vec3 positionOf(const float* vertices, size_t stride, unsigned int v) {
+    const float* p = vertices + v * stride;
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+glm::vec3 normalOf(const float* vertices, size_t stride, unsigned int v) {
+    const float* p = vertices + v * stride;
+    return glm::vec3(p[3], p[4], p[5]);
+}
+
+} // namespace
+
+size_t CMeshCluster::build(const float* vertices, size_t vertexCount, size_t stride, std::vector<unsigned int>& indices,
+                           std::vector<MeshCluster>& clusters, size_t maxTriangles) {
+    clusters.clear();
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return 0;
+    maxTriangles = std::max<size_t>(maxTriangles, 1);
+
+    // 三角形的中心、單位法向量（環繞方向）與是否與頂點法向量同一側
+    std::vector<glm::vec3> centroids(triangleCount), normals(triangleCount);
+    std::vector<char> consistent(triangleCount);
+    double totalArea = 0.0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const unsigned int* tri = &indices[3 * t];
+        glm::vec3 a = positionOf(vertices, stride, tri[0]);
+        glm::vec3 b = positionOf(vertices, stride, tri[1]);
+        glm::vec3 c = positionOf(vertices, stride, tri[2]);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        totalArea += 0.5 * length;
+        centroids[t] = (a + b + c) / 3.0f;
+        normals[t] = length > 0.0f ? n / length : glm::vec3(0.0f);
+        glm::vec3 vertexNormal = normalOf(vertices, stride, tri[0]) + normalOf(vertices, stride, tri[1]) +
+                                 normalOf(vertices, stride, tri[2]);
+        consistent[t] = (length == 0.0f) || glm::dot(n, vertexNormal) > 0.0f;
+    }
+
+    // 以焊接後的頂點建立頂點 -> 三角形的對應（CSR）
+    std::vector<unsigned int> rep = weldPositions(vertices, vertexCount, stride);
+    std::vector<unsigned int> offsets(vertexCount + 1, 0), adjacency(indices.size());
+    for (unsigned int v : indices) offsets[rep[v] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i) adjacency[fill[rep[indices[i]]]++] = static_cast<unsigned int>(i / 3);
+
+    // 叢集的預期半徑：maxTriangles 個平均面積的三角形排成圓盤
+    float expectedRadius2 = static_cast<float>(totalArea / triangleCount * maxTriangles / 3.14159265);
+    float invRadius2 = expectedRadius2 > 0.0f ? 1.0f / expectedRadius2 : 0.0f;
+
+    std::vector<char> assigned(triangleCount, 0);
+    std::vector<unsigned int> order;
+    order.reserve(triangleCount);
+    std::vector<unsigned int> candidates;
+    size_t seedCursor = 0;
+    while (order.size() < triangleCount) {
+        size_t first = order.size();
+        glm::vec3 centroidSum(0.0f), normalSum(0.0f);
+        candidates.clear();
+        unsigned int next = NONE;
+        while (order.size() - first < maxTriangles) {
+            if (next == NONE) {
+                // 沒有相鄰的候選時（新的叢集或不相連的部分）取原本順序中下一個未分配的三角形
+                while (seedCursor < triangleCount && assigned[seedCursor]) ++seedCursor;
+                if (seedCursor >= triangleCount) break;
+                next = static_cast<unsigned int>(seedCursor);
+            }
+            assigned[next] = 1;
+            order.push_back(next);
+            centroidSum += centroids[next];
+            normalSum += normals[next];
+            for (int k = 0; k < 3; ++k) {
+                unsigned int v = rep[indices[3 * next + k]];
+                for (unsigned int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                    if (!assigned[adjacency[i]]) candidates.push_back(adjacency[i]);
+                }
+            }
+
+            // 分數最低的相鄰三角形；已分配的候選順便移除
+            glm::vec3 center = centroidSum / static_cast<float>(order.size() - first);
+            float axisLength = glm::length(normalSum);
+            glm::vec3 axis = axisLength > 0.0f ? normalSum / axisLength : glm::vec3(0.0f);
+            float bestScore = FLT_MAX;
+            next = NONE;
+            for (size_t i = 0; i < candidates.size();) {
+                unsigned int t = candidates[i];
+                if (assigned[t]) {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                glm::vec3 d = centroids[t] - center;
+                float score = glm::dot(d, d) * invRadius2 + CLUSTER_NORMAL_WEIGHT * (1.0f - glm::dot(normals[t], axis));
+                if (score < bestScore) {
+                    bestScore = score;
+                    next = t;
+                }
+                ++i;
+            }
+        }
+        if (order.size() == first) break;
+
+        MeshCluster cluster;
+        cluster.indexStart = static_cast<uint32_t>(3 * first);
+        cluster.indexCount = static_cast<uint32_t>(3 * (order.size() - first));
+        clusters.push_back(cluster);
+    }
+
+    // 依叢集的順序重新排列索引，計算包圍球與法向量錐
+    std::vector<unsigned int> reordered(indices.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (int k = 0; k < 3; ++k) reordered[3 * i + k] = indices[3 * order[i] + k];
+    }
+    for (MeshCluster& cluster : clusters) {
+        glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX), normalSum(0.0f);
+        bool coneValid = true;
+        for (uint32_t i = cluster.indexStart; i < cluster.indexStart + cluster.indexCount; ++i) {
+            glm::vec3 p = positionOf(vertices, stride, reordered[i]);
+            bmin = glm::min(bmin, p);
+            bmax = glm::max(bmax, p);
+        }
+        cluster.center = (bmin + bmax) * 0.5f;
+        float radius2 = 0.0f;
+        for (uint32_t i = cluster.indexStart; i < cluster.indexStart + cluster.indexCount; ++i) {
+            glm::vec3 d = positionOf(vertices, stride, reordered[i]) - cluster.center;
+            radius2 = std::max(radius2, glm::dot(d, d));
+        }
+        cluster.radius = std::sqrt(radius2);
+
+        for (uint32_t t = cluster.indexStart / 3; t < (cluster.indexStart + cluster.indexCount) / 3; ++t) {
+            normalSum += normals[order[t]];
+            if (!consistent[order[t]]) coneValid = false;
+        }
+        float axisLength = glm::length(normalSum);
+        if (!coneValid || axisLength <= 0.0f) continue;
+        cluster.coneAxis = normalSum / axisLength;
+        float minDot = 1.0f;
+        for (uint32_t t = cluster.indexStart / 3; t < (cluster.indexStart + cluster.indexCount) / 3; ++t) {
+            if (normals[order[t]] == glm::vec3(0.0f)) continue;   // 面積為 0 的三角形不會被描繪
+            minDot = std::min(minDot, glm::dot(normals[order[t]], cluster.coneAxis));
+        }
+        // 法向量分散超過半球時從任何方向都看得到某些三角形的正面
+        if (minDot > 0.0f) cluster.coneCutoff = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+    }
+    indices.swap(reordered);
+    return clusters.size();
+}
@@ -0,0 +1,38 @@
+//  CMeshCluster.h
+//  把網格的三角形分成約 MESH_CLUSTER_TRIANGLES 個一組的叢集，記錄包圍球與法向量錐，索引依叢集連續排列
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define MESH_CLUSTER_TRIANGLES 128
+#define MESH_CLUSTER_NO_CONE 2.0f      // coneCutoff 為此值時永遠不會判斷為背面
+
+// 一個叢集：indices 中 [indexStart, indexStart + indexCount) 的三角形
+// 法向量錐：coneCutoff 為 sin(θ)，θ 為三角形的法向量與 coneAxis 的最大夾角
+// 有三角形的環繞方向與頂點法向量相反（雙面或翻轉的面）、或法向量分散超過半球時 coneCutoff 為 MESH_CLUSTER_NO_CONE
+struct MeshCluster {
+    uint32_t indexStart = 0;
+    uint32_t indexCount = 0;
+    glm::vec3 center = glm::vec3(0.0f);    // 模型空間的包圍球
+    float radius = 0.0f;
+    glm::vec3 coneAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+    float coneCutoff = MESH_CLUSTER_NO_CONE;
+};
+
+// 從 eye（與叢集相同的座標空間）看過去叢集中所有三角形都是背面
+inline bool clusterBackfacing(const MeshCluster& cluster, const glm::vec3& eye) {
+    glm::vec3 d = cluster.center - eye;
+    return glm::dot(d, cluster.coneAxis) >= cluster.coneCutoff * glm::length(d) + cluster.radius;
+}
+
+class CMeshCluster {
+public:
+    // vertices 每個頂點 stride 個 float，前六個為位置與法向量；indices 就地重新排列（三角形的集合與環繞方向不變）
+    // 回傳叢集數量
+    static size_t build(const float* vertices, size_t vertexCount, size_t stride, std::vector<unsigned int>& indices,
+                        std::vector<MeshCluster>& clusters, size_t maxTriangles = MESH_CLUSTER_TRIANGLES);
+};
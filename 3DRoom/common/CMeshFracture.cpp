@@ -0,0 +1,476 @@
+//  CMeshFracture.cpp
+#include "CMeshFracture.h"
+#include "CParallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+
+namespace {
+
+struct Triangle {
+    FractureVertex v[3];
+};
+
+// 切面上的一段切口，方向為切面多邊形的邊（由進入的點到離開的點）
+struct Segment {
+    glm::vec3 a, b;
+};
+
+glm::vec3 positionOf(const FractureVertex& v) {
+    return glm::vec3(v.position[0], v.position[1], v.position[2]);
+}
+
+FractureVertex makeVertex(const glm::vec3& p, const glm::vec3& n, const glm::vec2& uv) {
+    FractureVertex v;
+    v.position[0] = p.x; v.position[1] = p.y; v.position[2] = p.z;
+    v.normal[0] = n.x; v.normal[1] = n.y; v.normal[2] = n.z;
+    v.texCoords[0] = uv.x; v.texCoords[1] = uv.y;
+    return v;
+}
+
+bool lessPosition(const FractureVertex& a, const FractureVertex& b) {
+    for (int k = 0; k < 3; ++k) {
+        if (a.position[k] != b.position[k]) return a.position[k] < b.position[k];
+    }
+    return false;
+}
+
+// 邊與平面的交點；端點先依位置排序，共用這條邊的兩個三角形算出的交點位置完全相同，切口才串得起來
+FractureVertex splitEdge(const FractureVertex* a, float da, const FractureVertex* b, float db) {
+    if (lessPosition(*b, *a)) {
+        std::swap(a, b);
+        std::swap(da, db);
+    }
+    float t = da / (da - db);
+    FractureVertex v;
+    for (int k = 0; k < 3; ++k) v.position[k] = a->position[k] + (b->position[k] - a->position[k]) * t;
+    glm::vec3 n(0.0f);
+    for (int k = 0; k < 3; ++k) n[k] = a->normal[k] + (b->normal[k] - a->normal[k]) * t;
+    float length = glm::length(n);
+    if (length > 0.0f) n /= length;
+    for (int k = 0; k < 3; ++k) v.normal[k] = n[k];
+    for (int k = 0; k < 2; ++k) v.texCoords[k] = a->texCoords[k] + (b->texCoords[k] - a->texCoords[k]) * t;
+    return v;
+}
+
+// 以位元比較的位置，用來把切口串成環
+struct PointKey {
+    uint32_t x, y, z;
+    bool operator==(const PointKey& o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+struct PointKeyHash {
+    size_t operator()(const PointKey& k) const {
+        return (static_cast<size_t>(k.x) * 73856093u) ^ (static_cast<size_t>(k.y) * 19349663u) ^
+               (static_cast<size_t>(k.z) * 83492791u);
+    }
+};
+
+PointKey keyOf(const glm::vec3& p) {
+    PointKey key;
+    float x = p.x + 0.0f, y = p.y + 0.0f, z = p.z + 0.0f;   // -0 與 +0 視為相同
+    std::memcpy(&key.x, &x, 4);
+    std::memcpy(&key.y, &y, 4);
+    std::memcpy(&key.z, &z, 4);
+    return key;
+}
+
+// 保留 dot(n, p) <= c 的一側，被切開的三角形以扇形重新三角化
+void clipTriangles(const std::vector<Triangle>& in, const glm::vec3& n, float c, std::vector<Triangle>& out,
+                   std::vector<Segment>& segments) {
+    out.clear();
+    segments.clear();
+    for (const Triangle& tri : in) {
+        float d[3];
+        int inside = 0;
+        for (int k = 0; k < 3; ++k) {
+            d[k] = glm::dot(n, positionOf(tri.v[k])) - c;
+            inside += (d[k] <= 0.0f);
+        }
+        if (inside == 3) { out.push_back(tri); continue; }
+        if (inside == 0) continue;
+
+        FractureVertex poly[4], entry = {}, exit = {};
+        int count = 0;
+        for (int k = 0; k < 3; ++k) {
+            int k1 = (k + 1) % 3;
+            bool inA = d[k] <= 0.0f, inB = d[k1] <= 0.0f;
+            if (inA) poly[count++] = tri.v[k];
+            if (inA == inB) continue;
+            FractureVertex x = splitEdge(&tri.v[k], d[k], &tri.v[k1], d[k1]);
+            poly[count++] = x;
+            if (inA) exit = x;
+            else entry = x;
+        }
+        for (int k = 1; k + 1 < count; ++k) out.push_back({ { poly[0], poly[k], poly[k + 1] } });
+        // 多邊形沿切口由 exit 走到 entry，切面與它共用這條邊，方向相反
+        glm::vec3 a = positionOf(entry), b = positionOf(exit);
+        if (!(keyOf(a) == keyOf(b))) segments.push_back({ a, b });
+    }
+}
+
+// 2D 多邊形（逆時針）的 ear clipping，結果為 points 的索引
+void earClip(const std::vector<glm::vec2>& points, std::vector<int>& triangles) {
+    std::vector<int> ring(points.size());
+    for (size_t i = 0; i < ring.size(); ++i) ring[i] = static_cast<int>(i);
+    auto cross = [&](int a, int b, int c) {
+        glm::vec2 ab = points[b] - points[a], ac = points[c] - points[a];
+        return ab.x * ac.y - ab.y * ac.x;
+    };
+    size_t guard = ring.size() * ring.size() + 16;
+    size_t i = 0;
+    while (ring.size() > 3 && guard-- > 0) {
+        size_t count = ring.size();
+        int prev = ring[(i + count - 1) % count], cur = ring[i % count], next = ring[(i + 1) % count];
+        float area = cross(prev, cur, next);
+        if (area == 0.0f) {
+            // 共線的點仍輸出面積為 0 的三角形，切面的邊才會與側面的邊一一對應（沒有 T 形接點）
+            triangles.push_back(prev);
+            triangles.push_back(cur);
+            triangles.push_back(next);
+            ring.erase(ring.begin() + (i % count));
+            continue;
+        }
+        bool ear = area > 0.0f;
+        for (size_t k = 0; ear && k < count; ++k) {
+            int p = ring[k];
+            if (p == prev || p == cur || p == next) continue;
+            if (points[p] == points[prev] || points[p] == points[cur] || points[p] == points[next]) continue;
+            ear = !(cross(prev, cur, p) >= 0.0f && cross(cur, next, p) >= 0.0f && cross(next, prev, p) >= 0.0f);
+        }
+        if (ear) {
+            triangles.push_back(prev);
+            triangles.push_back(cur);
+            triangles.push_back(next);
+            ring.erase(ring.begin() + (i % count));
+        } else {
+            i = (i + 1) % count;
+        }
+    }
+    // 剩下的點（數值誤差找不到耳朵時）以扇形補上，切面不一定正確但網格仍然封閉
+    for (size_t k = 1; k + 1 < ring.size(); ++k) {
+        triangles.push_back(ring[0]);
+        triangles.push_back(ring[k]);
+        triangles.push_back(ring[k + 1]);
+    }
+}
+
+// 切面上的一個封閉環（3D 位置與投影到切面的 2D 座標），逆時針（面積為正）為外圍、順時針為洞
+struct CapLoop {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> points;
+    float area = 0.0f;
+    float maxX = 0.0f;
+};
+
+bool insideLoop(const CapLoop& loop, const glm::vec2& p) {
+    bool inside = false;
+    for (size_t i = 0, j = loop.points.size() - 1; i < loop.points.size(); j = i++) {
+        const glm::vec2& a = loop.points[i];
+        const glm::vec2& b = loop.points[j];
+        if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) inside = !inside;
+    }
+    return inside;
+}
+
+// 洞最右邊的點向 +x 方向找到外圍上最近的邊，以較右邊的端點當作橋，把洞接進外圍成為一個多邊形
+// （不檢查橋是否被外圍的其他點擋住，最後由 earClip 的扇形補上，網格仍然封閉）
+bool bridgeHole(CapLoop& outer, const CapLoop& hole) {
+    size_t h = 0;
+    for (size_t k = 1; k < hole.points.size(); ++k) {
+        if (hole.points[k].x > hole.points[h].x) h = k;
+    }
+    const glm::vec2& p = hole.points[h];
+    float nearest = FLT_MAX;
+    int bridge = -1;
+    for (size_t i = 0; i < outer.points.size(); ++i) {
+        const glm::vec2& a = outer.points[i];
+        const glm::vec2& b = outer.points[(i + 1) % outer.points.size()];
+        if ((a.y > p.y) == (b.y > p.y)) continue;
+        float x = a.x + (b.x - a.x) * (p.y - a.y) / (b.y - a.y);
+        if (x < p.x || x >= nearest) continue;
+        nearest = x;
+        bridge = static_cast<int>((a.x > b.x) ? i : (i + 1) % outer.points.size());
+    }
+    if (bridge < 0) return false;
+
+    CapLoop merged;
+    size_t count = hole.points.size();
+    for (int i = 0; i <= bridge; ++i) {
+        merged.positions.push_back(outer.positions[i]);
+        merged.points.push_back(outer.points[i]);
+    }
+    for (size_t k = 0; k <= count; ++k) {
+        merged.positions.push_back(hole.positions[(h + k) % count]);
+        merged.points.push_back(hole.points[(h + k) % count]);
+    }
+    for (size_t i = bridge; i < outer.points.size(); ++i) {
+        merged.positions.push_back(outer.positions[i]);
+        merged.points.push_back(outer.points[i]);
+    }
+    merged.area = outer.area + hole.area;
+    merged.maxX = outer.maxX;
+    outer = std::move(merged);
+    return true;
+}
+
+// 切口串成封閉的環，外圍（包含其中的洞）補上一個朝 +n 的切面
+void buildCaps(const std::vector<Segment>& segments, const glm::vec3& n, float uvScale, std::vector<Triangle>& out) {
+    if (segments.size() < 3) return;
+    std::unordered_map<PointKey, int, PointKeyHash> byStart;
+    byStart.reserve(segments.size() * 2);
+    std::vector<int> nextSame(segments.size(), -1);   // 起點相同的下一段（非流形的網格）
+    for (int s = static_cast<int>(segments.size()) - 1; s >= 0; --s) {
+        auto result = byStart.emplace(keyOf(segments[s].a), s);
+        if (!result.second) {
+            nextSame[s] = result.first->second;
+            result.first->second = s;
+        }
+    }
+
+    glm::vec3 u = (std::fabs(n.x) < 0.9f) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    u = glm::normalize(u - n * glm::dot(u, n));
+    glm::vec3 v = glm::cross(n, u);
+    std::vector<char> used(segments.size(), 0);
+    std::vector<CapLoop> outers, holes;
+    for (size_t first = 0; first < segments.size(); ++first) {
+        if (used[first]) continue;
+        used[first] = 1;
+        CapLoop loop;
+        loop.positions.assign(1, segments[first].a);
+        PointKey start = keyOf(segments[first].a);
+        glm::vec3 end = segments[first].b;
+        bool closed = false;
+        while (loop.positions.size() <= segments.size()) {
+            PointKey key = keyOf(end);
+            if (key == start) { closed = true; break; }
+            auto it = byStart.find(key);
+            int s = (it == byStart.end()) ? -1 : it->second;
+            while (s >= 0 && used[s]) s = nextSame[s];
+            if (s < 0) break;
+            used[s] = 1;
+            loop.positions.push_back(segments[s].a);
+            end = segments[s].b;
+        }
+        if (!closed || loop.positions.size() < 3) continue;
+
+        loop.points.resize(loop.positions.size());
+        loop.maxX = -FLT_MAX;
+        for (size_t k = 0; k < loop.positions.size(); ++k) {
+            loop.points[k] = glm::vec2(glm::dot(loop.positions[k], u), glm::dot(loop.positions[k], v));
+            loop.maxX = std::max(loop.maxX, loop.points[k].x);
+        }
+        for (size_t k = 0; k < loop.points.size(); ++k) {
+            const glm::vec2& p = loop.points[k];
+            const glm::vec2& q = loop.points[(k + 1) % loop.points.size()];
+            loop.area += 0.5f * (p.x * q.y - q.x * p.y);
+        }
+        if (loop.area > 0.0f) outers.push_back(std::move(loop));
+        else if (loop.area < 0.0f) holes.push_back(std::move(loop));
+    }
+
+    // 洞由右到左接進包含它的最小外圍；不在任何外圍內的順時針環來自面朝內的殼（例如法向量相反的網格），
+    // 切面也朝 -n，三角形的方向與環相同
+    std::vector<CapLoop> inverted;
+    std::sort(holes.begin(), holes.end(), [](const CapLoop& a, const CapLoop& b) { return a.maxX > b.maxX; });
+    for (CapLoop& hole : holes) {
+        int owner = -1;
+        for (size_t i = 0; i < outers.size(); ++i) {
+            if (outers[i].area + hole.area <= 0.0f || !insideLoop(outers[i], hole.points[0])) continue;
+            if (owner < 0 || outers[i].area < outers[owner].area) owner = static_cast<int>(i);
+        }
+        if (owner >= 0) {
+            bridgeHole(outers[owner], hole);
+        } else {
+            std::reverse(hole.positions.begin(), hole.positions.end());
+            std::reverse(hole.points.begin(), hole.points.end());
+            inverted.push_back(std::move(hole));
+        }
+    }
+
+    std::vector<int> triangles;
+    auto emit = [&](const CapLoop& loop, bool flip) {
+        triangles.clear();
+        earClip(loop.points, triangles);
+        glm::vec3 normal = flip ? -n : n;
+        for (size_t k = 0; k + 2 < triangles.size(); k += 3) {
+            Triangle tri;
+            for (int c = 0; c < 3; ++c) {
+                int index = triangles[k + (flip ? 2 - c : c)];
+                tri.v[c] = makeVertex(loop.positions[index], normal, loop.points[index] * uvScale);
+            }
+            out.push_back(tri);
+        }
+    };
+    for (const CapLoop& loop : outers) emit(loop, false);
+    for (const CapLoop& loop : inverted) emit(loop, true);
+}
+
+void boundsOf(const std::vector<Triangle>& triangles, glm::vec3& bmin, glm::vec3& bmax) {
+    bmin = glm::vec3(FLT_MAX);
+    bmax = glm::vec3(-FLT_MAX);
+    for (const Triangle& tri : triangles) {
+        for (const FractureVertex& v : tri.v) {
+            bmin = glm::min(bmin, positionOf(v));
+            bmax = glm::max(bmax, positionOf(v));
+        }
+    }
+}
+
+// 相同的頂點（位置、法向量、貼圖座標都相同）合併後加入碎片
+struct VertexKey {
+    uint32_t bits[8];
+    bool operator==(const VertexKey& o) const { return std::memcmp(bits, o.bits, sizeof(bits)) == 0; }
+};
+
+struct VertexKeyHash {
+    size_t operator()(const VertexKey& k) const {
+        size_t h = 0;
+        for (uint32_t b : k.bits) h = h * 1000003u ^ b;
+        return h;
+    }
+};
+
+void appendSection(const std::vector<Triangle>& triangles, int mesh, FractureChunk& chunk) {
+    if (triangles.empty()) return;
+    FractureSection section;
+    section.mesh = mesh;
+    section.indexStart = static_cast<uint32_t>(chunk.indices.size());
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> welded;
+    welded.reserve(triangles.size() * 2);
+    for (const Triangle& tri : triangles) {
+        for (const FractureVertex& v : tri.v) {
+            VertexKey key;
+            std::memcpy(key.bits, &v, sizeof(key.bits));
+            auto result = welded.emplace(key, static_cast<unsigned int>(chunk.vertices.size()));
+            if (result.second) chunk.vertices.push_back(v);
+            chunk.indices.push_back(result.first->second);
+        }
+    }
+    section.indexCount = static_cast<uint32_t>(chunk.indices.size()) - section.indexStart;
+    chunk.sections.push_back(section);
+}
+
+// 體積與質心（散度定理，對原點的四面體累加）；不封閉或太薄時以包圍盒代替
+void computeMassProperties(FractureChunk& chunk) {
+    chunk.boundsMin = glm::vec3(FLT_MAX);
+    chunk.boundsMax = glm::vec3(-FLT_MAX);
+    for (const FractureVertex& v : chunk.vertices) {
+        chunk.boundsMin = glm::min(chunk.boundsMin, positionOf(v));
+        chunk.boundsMax = glm::max(chunk.boundsMax, positionOf(v));
+    }
+    double volume = 0.0, moment[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = 0; i + 2 < chunk.indices.size(); i += 3) {
+        const float* a = chunk.vertices[chunk.indices[i]].position;
+        const float* b = chunk.vertices[chunk.indices[i + 1]].position;
+        const float* c = chunk.vertices[chunk.indices[i + 2]].position;
+        double v = (double(a[0]) * (double(b[1]) * c[2] - double(b[2]) * c[1]) +
+                    double(a[1]) * (double(b[2]) * c[0] - double(b[0]) * c[2]) +
+                    double(a[2]) * (double(b[0]) * c[1] - double(b[1]) * c[0])) / 6.0;
+        volume += v;
+        for (int k = 0; k < 3; ++k) moment[k] += (double(a[k]) + b[k] + c[k]) * (v / 4.0);
+    }
+    glm::vec3 size = chunk.boundsMax - chunk.boundsMin;
+    float boxVolume = size.x * size.y * size.z;
+    if (volume > boxVolume * 1e-3) {
+        chunk.volume = static_cast<float>(volume);
+        chunk.centroid = glm::vec3(float(moment[0] / volume), float(moment[1] / volume), float(moment[2] / volume));
+    } else {
+        chunk.volume = boxVolume;
+        chunk.centroid = (chunk.boundsMin + chunk.boundsMax) * 0.5f;
+    }
+}
+
+} // namespace
+
+int CMeshFracture::fracture(const std::vector<FractureInput>& meshes, const FractureOptions& options,
+                            std::vector<FractureChunk>& chunks) {
+    chunks.clear();
+    // 每個網格轉成獨立的三角形，並累計面積供取樣種子點
+    std::vector<std::vector<Triangle>> source(meshes.size());
+    std::vector<double> cumulativeArea;
+    std::vector<std::pair<int, int>> areaTriangle;   // (網格, 三角形)
+    double totalArea = 0.0;
+    glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX);
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        const FractureInput& input = meshes[m];
+        source[m].reserve(input.indexCount / 3);
+        for (size_t i = 0; i + 2 < input.indexCount; i += 3) {
+            Triangle tri;
+            for (int c = 0; c < 3; ++c) {
+                std::memcpy(&tri.v[c], input.vertices + 8 * input.indices[i + c], sizeof(FractureVertex));
+                bmin = glm::min(bmin, positionOf(tri.v[c]));
+                bmax = glm::max(bmax, positionOf(tri.v[c]));
+            }
+            glm::vec3 p0 = positionOf(tri.v[0]);
+            double area = 0.5 * glm::length(glm::cross(positionOf(tri.v[1]) - p0, positionOf(tri.v[2]) - p0));
+            if (area > 0.0) {
+                totalArea += area;
+                cumulativeArea.push_back(totalArea);
+                areaTriangle.push_back({ static_cast<int>(m), static_cast<int>(source[m].size()) });
+            }
+            source[m].push_back(tri);
+        }
+    }
+    if (totalArea <= 0.0 || options.pieces < 1) return 0;
+
+    // 種子點：以面積加權取樣表面上的點，太接近已有的種子點時重新取樣
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    float minDistance = glm::length(bmax - bmin) * 1e-3f;
+    std::vector<glm::vec3> sites;
+    for (int attempt = 0; static_cast<int>(sites.size()) < options.pieces && attempt < options.pieces * 16; ++attempt) {
+        double r = u01(rng) * totalArea;
+        size_t k = std::min(static_cast<size_t>(std::upper_bound(cumulativeArea.begin(), cumulativeArea.end(), r) -
+                                                cumulativeArea.begin()), cumulativeArea.size() - 1);
+        const Triangle& tri = source[areaTriangle[k].first][areaTriangle[k].second];
+        float s = std::sqrt(u01(rng)), t = u01(rng);
+        glm::vec3 p = positionOf(tri.v[0]) * (1.0f - s) + positionOf(tri.v[1]) * (s * (1.0f - t)) +
+                      positionOf(tri.v[2]) * (s * t);
+        bool tooClose = false;
+        for (const glm::vec3& q : sites) tooClose = tooClose || glm::length(p - q) < minDistance;
+        if (!tooClose) sites.push_back(p);
+    }
+
+    int siteCount = static_cast<int>(sites.size());
+    std::vector<FractureChunk> cells(siteCount);
+    parallelFor(0, siteCount, options.threads, 1, [&](int cell) {
+        // 先用較近的種子點切，三角形較早被丟掉
+        std::vector<int> others;
+        for (int j = 0; j < siteCount; ++j) {
+            if (j != cell) others.push_back(j);
+        }
+        std::sort(others.begin(), others.end(), [&](int a, int b) {
+            return glm::length(sites[a] - sites[cell]) < glm::length(sites[b] - sites[cell]);
+        });
+
+        std::vector<Triangle> current, clipped;
+        std::vector<Segment> segments;
+        for (size_t m = 0; m < source.size(); ++m) {
+            current = source[m];
+            for (int j : others) {
+                if (current.empty()) break;
+                glm::vec3 n = glm::normalize(sites[j] - sites[cell]);
+                float c = glm::dot(n, (sites[j] + sites[cell]) * 0.5f);
+                // 包圍盒整個在保留的一側時不需要切
+                glm::vec3 cmin, cmax;
+                boundsOf(current, cmin, cmax);
+                glm::vec3 farthest(n.x > 0.0f ? cmax.x : cmin.x, n.y > 0.0f ? cmax.y : cmin.y, n.z > 0.0f ? cmax.z : cmin.z);
+                if (glm::dot(n, farthest) <= c) continue;
+                clipTriangles(current, n, c, clipped, segments);
+                buildCaps(segments, n, options.capUVScale, clipped);
+                current.swap(clipped);
+            }
+            appendSection(current, static_cast<int>(m), cells[cell]);
+        }
+        computeMassProperties(cells[cell]);
+    });
+
+    for (FractureChunk& chunk : cells) {
+        if (!chunk.indices.empty()) chunks.push_back(std::move(chunk));
+    }
+    return static_cast<int>(chunks.size());
+}
@@ -0,0 +1,53 @@
+//  CMeshFracture.h
+//  把封閉的網格以 Voronoi 預先分割成碎片，切面以 ear clipping 補上（載入時計算，結果存在 CMeshCache）
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// 與 Model 的 Vertex 相同的排列，可以直接複製
+struct FractureVertex {
+    float position[3];
+    float normal[3];
+    float texCoords[2];
+};
+
+// 輸入的網格：vertices 為每個頂點 8 個 float（位置、法向量、貼圖座標），indices 每三個一個三角形
+struct FractureInput {
+    const float* vertices = nullptr;
+    size_t vertexCount = 0;
+    const unsigned int* indices = nullptr;
+    size_t indexCount = 0;
+};
+
+// 碎片中來自同一個輸入網格（同一個材質）的三角形，包含切面
+struct FractureSection {
+    int32_t mesh = 0;             // 輸入網格的索引
+    uint32_t indexStart = 0;      // 碎片 indices 中的位置
+    uint32_t indexCount = 0;
+};
+
+struct FractureChunk {
+    std::vector<FractureVertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<FractureSection> sections;
+    glm::vec3 boundsMin = glm::vec3(0.0f), boundsMax = glm::vec3(0.0f);  // 模型空間
+    glm::vec3 centroid = glm::vec3(0.0f);
+    float volume = 0.0f;          // 網格不封閉時以包圍盒的體積代替
+};
+
+struct FractureOptions {
+    int pieces = 12;
+    unsigned seed = 1;
+    float capUVScale = 1.0f;      // 切面的貼圖座標 = 模型空間的平面座標 * capUVScale
+    int threads = 1;              // 每個胞獨立計算，可以平行
+};
+
+class CMeshFracture {
+public:
+    // 所有輸入網格一起分割（同一組種子點），沒有任何三角形的胞不輸出；回傳碎片數量
+    static int fracture(const std::vector<FractureInput>& meshes, const FractureOptions& options,
+                        std::vector<FractureChunk>& chunks);
+};
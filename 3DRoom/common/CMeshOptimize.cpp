@@ -0,0 +1,243 @@
+//  CMeshOptimize.cpp
+#include "CMeshOptimize.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+
+namespace {
+
+#define FORSYTH_CACHE_DECAY 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_SCALE 2.0f
+#define FORSYTH_VALENCE_POWER 0.5f
+
+const unsigned int NONE = ~0u;
+
+// 頂點的分數：快取中的位置（剛用過的三個頂點固定分數，之後遞減）加上剩下的三角形越少越優先
+float vertexScore(int cachePosition, unsigned int remaining) {
+    if (remaining == 0) return -1.0f;
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        } else {
+            float scaler = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY);
+        }
+    }
+    return score + FORSYTH_VALENCE_SCALE * std::pow(static_cast<float>(remaining), -FORSYTH_VALENCE_POWER);
+}
+
+glm::vec3 positionOf(const unsigned char* vertices, size_t vertexSize, unsigned int v) {
+    float p[3];
+    std::memcpy(p, vertices + v * vertexSize, sizeof(p));
+    return glm::vec3(p[0], p[1], p[2]);
+}
+
+} // namespace
+
+VertexCacheStats CMeshOptimize::analyze(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                        size_t cacheSize) {
+    VertexCacheStats stats;
+    if (indexCount < 3 || vertexCount == 0) return stats;
+    // timestamps[v]：頂點放入快取時的計數，與目前的計數相差不到 cacheSize 時仍在 FIFO 中
+    std::vector<size_t> timestamps(vertexCount, 0);
+    std::vector<char> used(vertexCount, 0);
+    size_t time = cacheSize + 1, misses = 0, usedCount = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        unsigned int v = indices[i];
+        if (!used[v]) {
+            used[v] = 1;
+            usedCount++;
+        }
+        if (time - timestamps[v] > cacheSize) {
+            timestamps[v] = time++;
+            misses++;
+        }
+    }
+    stats.acmr = static_cast<float>(misses) / (indexCount / 3);
+    stats.atvr = usedCount > 0 ? static_cast<float>(misses) / usedCount : 0.0f;
+    return stats;
+}
+
+void CMeshOptimize::optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) return;
+
+    // 頂點 -> 三角形（CSR），remaining 為還沒輸出的三角形數
+    std::vector<unsigned int> offsets(vertexCount + 1, 0), remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        remaining[v] = offsets[v + 1];
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<unsigned int> adjacency(triangleCount * 3), fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount, 0.0f);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScores[v] = vertexScore(-1, remaining[v]);
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScores[t] = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(triangleCount * 3);
+    unsigned int cache[VERTEX_CACHE_SIZE + 3];
+    int cacheCount = 0;
+    size_t scanCursor = 0;
+    unsigned int best = NONE;
+    while (result.size() < triangleCount * 3) {
+        if (best == NONE) {
+            // 快取中的頂點都沒有剩下的三角形時，取原本順序中第一個未輸出的三角形（保持區域性）
+            while (scanCursor < triangleCount && emitted[scanCursor]) ++scanCursor;
+            best = static_cast<unsigned int>(scanCursor);
+        }
+        emitted[best] = 1;
+        unsigned int tri[3] = { indices[3 * best], indices[3 * best + 1], indices[3 * best + 2] };
+        result.insert(result.end(), tri, tri + 3);
+
+        // 三個頂點移到快取的最前面，其餘依序往後，超出的頂點離開快取
+        unsigned int newCache[VERTEX_CACHE_SIZE + 3];
+        int newCount = 0;
+        for (unsigned int v : tri) newCache[newCount++] = v;
+        for (int i = 0; i < cacheCount; ++i) {
+            unsigned int v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) newCache[newCount++] = v;
+        }
+        for (unsigned int v : tri) {
+            // 這個三角形從頂點的清單中移除
+            unsigned int* begin = adjacency.data() + offsets[v];
+            unsigned int* end = begin + remaining[v];
+            unsigned int* it = std::find(begin, end, best);
+            if (it != end) {
+                *it = *(end - 1);
+                remaining[v]--;
+            }
+        }
+        for (int i = 0; i < newCount; ++i) {
+            unsigned int v = newCache[i];
+            cachePosition[v] = (i < VERTEX_CACHE_SIZE) ? i : -1;
+        }
+        cacheCount = std::min(newCount, VERTEX_CACHE_SIZE);
+        for (int i = 0; i < cacheCount; ++i) cache[i] = newCache[i];
+
+        // 只有快取中（與剛離開快取）的頂點分數改變，更新它們的三角形並找出分數最高的
+        best = NONE;
+        float bestScore = -1.0f;
+        for (int i = 0; i < newCount; ++i) {
+            unsigned int v = newCache[i];
+            float score = vertexScore(cachePosition[v], remaining[v]);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            for (unsigned int k = 0; k < remaining[v]; ++k) {
+                unsigned int t = adjacency[offsets[v] + k];
+                triangleScores[t] += delta;
+                if (i < cacheCount && triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+    }
+    std::copy(result.begin(), result.end(), indices);
+}
+
+size_t CMeshOptimize::optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices,
+                                          size_t indexCount) {
+    std::vector<unsigned int> remap(vertexCount, NONE);
+    unsigned int next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        unsigned int& target = remap[indices[i]];
+        if (target == NONE) target = next++;
+        indices[i] = target;
+    }
+    size_t usedCount = next;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] == NONE) remap[v] = next++;
+    }
+    std::vector<unsigned char> copy(static_cast<unsigned char*>(vertices),
+                                    static_cast<unsigned char*>(vertices) + vertexCount * vertexSize);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        std::memcpy(static_cast<unsigned char*>(vertices) + remap[v] * vertexSize, copy.data() + v * vertexSize, vertexSize);
+    }
+    return usedCount;
+}
+
+void CMeshOptimize::optimize(void* vertices, size_t vertexCount, size_t vertexSize, std::vector<unsigned int>& indices,
+                             std::vector<MeshCluster>& clusters) {
+    if (indices.size() < 3 || vertexCount == 0) return;
+    const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+    if (clusters.empty()) {
+        optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+        optimizeVertexFetch(vertices, vertexCount, vertexSize, indices.data(), indices.size());
+        return;
+    }
+
+    // 1. 每個叢集內的頂點快取順序：叢集用到的頂點先轉成 0 起的區域編號
+    std::vector<unsigned int> local(vertexCount, NONE), globalOf, clusterIndices;
+    for (const MeshCluster& cluster : clusters) {
+        globalOf.clear();
+        clusterIndices.assign(indices.begin() + cluster.indexStart, indices.begin() + cluster.indexStart + cluster.indexCount);
+        for (unsigned int& v : clusterIndices) {
+            if (local[v] == NONE) {
+                local[v] = static_cast<unsigned int>(globalOf.size());
+                globalOf.push_back(v);
+            }
+            v = local[v];
+        }
+        optimizeVertexCache(clusterIndices.data(), clusterIndices.size(), globalOf.size());
+        for (size_t i = 0; i < clusterIndices.size(); ++i) indices[cluster.indexStart + i] = globalOf[clusterIndices[i]];
+        for (unsigned int v : globalOf) local[v] = NONE;
+    }
+
+    // 2. overdraw：朝外的叢集先畫
+    glm::vec3 meshCenter(0.0f);
+    float totalArea = 0.0f;
+    std::vector<float> outward(clusters.size(), 0.0f);
+    std::vector<glm::vec3> centroids(clusters.size()), normals(clusters.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (uint32_t i = clusters[c].indexStart; i < clusters[c].indexStart + clusters[c].indexCount; i += 3) {
+            glm::vec3 a = positionOf(bytes, vertexSize, indices[i]);
+            glm::vec3 b = positionOf(bytes, vertexSize, indices[i + 1]);
+            glm::vec3 d = positionOf(bytes, vertexSize, indices[i + 2]);
+            glm::vec3 n = glm::cross(b - a, d - a);
+            float triangleArea = 0.5f * glm::length(n);
+            centroid += (a + b + d) / 3.0f * triangleArea;
+            normal += n;
+            area += triangleArea;
+        }
+        centroids[c] = area > 0.0f ? centroid / area : clusters[c].center;
+        normals[c] = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f);
+        meshCenter += centroids[c] * area;
+        totalArea += area;
+    }
+    if (totalArea > 0.0f) meshCenter /= totalArea;
+    for (size_t c = 0; c < clusters.size(); ++c) outward[c] = glm::dot(centroids[c] - meshCenter, normals[c]);
+    std::vector<size_t> order(clusters.size());
+    for (size_t c = 0; c < order.size(); ++c) order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return outward[a] > outward[b]; });
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(indices.size());
+    std::vector<MeshCluster> sorted;
+    sorted.reserve(clusters.size());
+    for (size_t c : order) {
+        MeshCluster cluster = clusters[c];
+        reordered.insert(reordered.end(), indices.begin() + cluster.indexStart,
+                         indices.begin() + cluster.indexStart + cluster.indexCount);
+        cluster.indexStart = static_cast<uint32_t>(reordered.size() - cluster.indexCount);
+        sorted.push_back(cluster);
+    }
+    indices.swap(reordered);
+    clusters.swap(sorted);
+
+    // 3. 頂點讀取的順序
+    optimizeVertexFetch(vertices, vertexCount, vertexSize, indices.data(), indices.size());
+}
@@ -0,0 +1,36 @@
+//  CMeshOptimize.h
+//  匯入網格時依頂點快取（Forsyth）、overdraw 與頂點讀取順序重新排列索引與頂點
+//  analyze 以 FIFO 快取模擬計算 ACMR 與 ATVR
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "CMeshCluster.h"
+
+#define VERTEX_CACHE_SIZE 32            // Forsyth 計分用的 LRU 快取大小
+#define VERTEX_CACHE_ANALYZE_SIZE 16    // ACMR / ATVR 模擬的 FIFO 快取大小
+
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+class CMeshOptimize {
+public:
+    static VertexCacheStats analyze(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                    size_t cacheSize = VERTEX_CACHE_ANALYZE_SIZE);
+
+    // indices 中的三角形以 Forsyth 的演算法重新排列（vertexCount 為索引的上限）
+    static void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount);
+
+    // vertices 每個頂點 vertexSize 個 byte，前三個 float 為位置；clusters 為 CMeshCluster::build 的結果
+    // 依序做三個步驟，vertices、indices 與 clusters 都就地更新
+    static void optimize(void* vertices, size_t vertexCount, size_t vertexSize, std::vector<unsigned int>& indices,
+                         std::vector<MeshCluster>& clusters);
+
+    // 頂點依在 indices 中第一次出現的順序重新編號（沒有用到的頂點移到最後），回傳用到的頂點數
+    static size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices,
+                                      size_t indexCount);
+};
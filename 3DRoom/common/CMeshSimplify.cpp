@@ -0,0 +1,362 @@
+//  CMeshSimplify.cpp
+#include "CMeshSimplify.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "CTriangleBVH.h"
+
+namespace {
+
+#define SIMPLIFY_BORDER_WEIGHT 10.0   // 開放的邊（接縫）的平面相對於三角形平面的權重
+#define SIMPLIFY_FLIP_LIMIT 0.2f      // 合併後三角形法向量與原本的夾角餘弦低於此值時不合併
+
+const unsigned int NONE = ~0u;
+
+// Q(p) = pᵀAp + 2b·p + c，weight 為累計的面積（邊為長度平方），Q(p) / weight 為平均的距離平方
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0, c = 0, weight = 0;
+
+    void addPlane(const glm::vec3& n, float d, double w) {
+        a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+        a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+        b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+        c += w * d * d;
+        weight += w;
+    }
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c; weight += q.weight;
+    }
+};
+
+double evaluate(const Quadric& q0, const Quadric& q1, const glm::vec3& p) {
+    double x = p.x, y = p.y, z = p.z;
+    double a00 = q0.a00 + q1.a00, a01 = q0.a01 + q1.a01, a02 = q0.a02 + q1.a02;
+    double a11 = q0.a11 + q1.a11, a12 = q0.a12 + q1.a12, a22 = q0.a22 + q1.a22;
+    double e = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z);
+    e += 2.0 * ((q0.b0 + q1.b0) * x + (q0.b1 + q1.b1) * y + (q0.b2 + q1.b2) * z) + q0.c + q1.c;
+    double w = q0.weight + q1.weight;
+    return w > 0.0 ? std::max(e, 0.0) / w : 0.0;
+}
+
+enum VertexKind : uint8_t { KIND_UNUSED, KIND_MANIFOLD, KIND_SEAM, KIND_LOCKED };
+
+struct Collapse {
+    unsigned int from, to;
+    float error;   // 距離平方
+};
+
+inline uint64_t edgeKey(unsigned int a, unsigned int b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+// 位置相同的頂點：rep 為代表的頂點（誤差與合併都以位置為單位），wedge 把同一個位置的頂點串成環
+void buildPositionGroups(const float* vertices, size_t vertexCount, size_t stride,
+                         std::vector<unsigned int>& rep, std::vector<unsigned int>& wedge) {
+    std::vector<unsigned int> order(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) order[i] = static_cast<unsigned int>(i);
+    auto less = [&](unsigned int a, unsigned int b) {
+        const float* pa = vertices + a * stride;
+        const float* pb = vertices + b * stride;
+        if (pa[0] != pb[0]) return pa[0] < pb[0];
+        if (pa[1] != pb[1]) return pa[1] < pb[1];
+        if (pa[2] != pb[2]) return pa[2] < pb[2];
+        return a < b;
+    };
+    std::sort(order.begin(), order.end(), less);
+    rep.assign(vertexCount, 0);
+    wedge.assign(vertexCount, 0);
+    for (size_t i = 0; i < vertexCount;) {
+        const float* p = vertices + order[i] * stride;
+        size_t j = i + 1;
+        while (j < vertexCount) {
+            const float* q = vertices + order[j] * stride;
+            if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2]) break;
+            ++j;
+        }
+        for (size_t k = i; k < j; ++k) {
+            rep[order[k]] = order[i];
+            wedge[order[k]] = order[k + 1 < j ? k + 1 : i];
+        }
+        i = j;
+    }
+}
+
+// 原本的索引用到的頂點到簡化後表面的最大距離（簡化後的頂點都是原本的頂點，只需要量測這一側）
+float measureDeviation(const float* vertices, size_t vertexCount, size_t stride, const unsigned int* indices,
+                       size_t indexCount, const std::vector<unsigned int>& simplified) {
+    CTriangleBVH bvh;
+    bvh.build(vertices, stride, simplified.data(), simplified.size());
+    std::vector<uint8_t> used(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; ++i) used[indices[i]] = 1;
+    float worst = 0.0f;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (!used[v]) continue;
+        const float* p = vertices + v * stride;
+        BVHSphereHit hit;
+        if (bvh.closestPoint(glm::vec3(p[0], p[1], p[2]), FLT_MAX, hit)) worst = std::max(worst, hit.distance);
+    }
+    return worst;
+}
+
+} // namespace
+
+float CMeshSimplify::simplify(const float* vertices, size_t vertexCount, size_t stride,
+                              const unsigned int* indices, size_t indexCount,
+                              const SimplifyOptions& options, std::vector<unsigned int>& result) {
+    result.assign(indices, indices + indexCount - indexCount % 3);
+    if (vertexCount == 0 || result.size() <= options.targetIndexCount) return 0.0f;
+    auto position = [&](unsigned int v) { return glm::vec3(vertices[v * stride], vertices[v * stride + 1], vertices[v * stride + 2]); };
+
+    std::vector<unsigned int> rep, wedge;
+    buildPositionGroups(vertices, vertexCount, stride, rep, wedge);
+
+    // 三角形平面以面積加權；只在一側有三角形的邊另外加上垂直於三角形、通過這條邊的平面，接縫不會被拉離原本的位置
+    std::vector<Quadric> quadrics(vertexCount);
+    std::unordered_map<uint64_t, int> indexEdges;
+    indexEdges.reserve(result.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) indexEdges[edgeKey(result[i + e], result[i + (e + 1) % 3])]++;
+    }
+    for (size_t i = 0; i < result.size(); i += 3) {
+        glm::vec3 p[3] = { position(result[i]), position(result[i + 1]), position(result[i + 2]) };
+        glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+        float length = glm::length(normal);
+        if (length <= 0.0f) continue;
+        normal /= length;
+        for (int k = 0; k < 3; ++k) quadrics[rep[result[i + k]]].addPlane(normal, -glm::dot(normal, p[0]), length * 0.5);
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = result[i + e], b = result[i + (e + 1) % 3];
+            if (indexEdges.count(edgeKey(b, a))) continue;
+            glm::vec3 edge = p[(e + 1) % 3] - p[e];
+            glm::vec3 edgeNormal = glm::cross(edge, normal);
+            float edgeLength = glm::length(edgeNormal);
+            if (edgeLength <= 0.0f) continue;
+            edgeNormal /= edgeLength;
+            double w = glm::dot(edge, edge) * SIMPLIFY_BORDER_WEIGHT;
+            quadrics[rep[a]].addPlane(edgeNormal, -glm::dot(edgeNormal, p[e]), w);
+            quadrics[rep[b]].addPlane(edgeNormal, -glm::dot(edgeNormal, p[e]), w);
+        }
+    }
+
+    const double maxErrorSq = (options.maxError < FLT_MAX) ? double(options.maxError) * options.maxError : DBL_MAX;
+    const size_t targetTriangles = options.targetIndexCount / 3;
+    float resultError = 0.0f;
+
+    std::vector<uint8_t> kind(vertexCount), touched(vertexCount);
+    std::vector<unsigned int> openOut(vertexCount), openIn(vertexCount), remap(vertexCount);
+    std::vector<unsigned int> adjacencyStart(vertexCount + 1), adjacency;
+    std::unordered_map<uint64_t, int> positionEdges;
+    std::vector<Collapse> collapses;
+
+    while (result.size() / 3 > targetTriangles) {
+        size_t triangleCount = result.size() / 3;
+
+        // 有向邊在索引與位置上各出現幾次
+        indexEdges.clear();
+        positionEdges.clear();
+        positionEdges.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = result[i + e], b = result[i + (e + 1) % 3];
+                indexEdges[edgeKey(a, b)]++;
+                positionEdges[edgeKey(rep[a], rep[b])]++;
+            }
+        }
+
+        // 頂點分類：反方向的邊只在另一個同位置的頂點上時為接縫；沒有反方向的邊（邊界）或不是流形時固定
+        std::fill(kind.begin(), kind.end(), KIND_UNUSED);
+        std::fill(openOut.begin(), openOut.end(), NONE);
+        std::fill(openIn.begin(), openIn.end(), NONE);
+        for (unsigned int v : result) kind[v] = KIND_MANIFOLD;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = result[i + e], b = result[i + (e + 1) % 3];
+                if (indexEdges[edgeKey(a, b)] > 1 || positionEdges[edgeKey(rep[a], rep[b])] > 1) {
+                    kind[a] = kind[b] = KIND_LOCKED;
+                    continue;
+                }
+                if (indexEdges.count(edgeKey(b, a))) continue;
+                if (!positionEdges.count(edgeKey(rep[b], rep[a]))) {
+                    kind[a] = kind[b] = KIND_LOCKED;
+                    continue;
+                }
+                if (openOut[a] != NONE) kind[a] = KIND_LOCKED;
+                if (openIn[b] != NONE) kind[b] = KIND_LOCKED;
+                openOut[a] = b;
+                openIn[b] = a;
+            }
+        }
+        for (unsigned int v = 0; v < vertexCount; ++v) {
+            if (kind[v] != KIND_MANIFOLD) continue;
+            unsigned int other = NONE;
+            int used = 0;
+            for (unsigned int w = v;;) {
+                if (kind[w] != KIND_UNUSED) {
+                    used++;
+                    if (w != v) other = w;
+                }
+                w = wedge[w];
+                if (w == v) break;
+            }
+            if (used == 1) {
+                if (openOut[v] != NONE || openIn[v] != NONE) kind[v] = KIND_LOCKED;
+                continue;
+            }
+            // 接縫：兩個頂點各有一條進入與離開的開放邊，兩側的邊首尾相接，而且往兩個不同的位置延伸
+            bool seam = (used == 2) &&
+                        openOut[v] != NONE && openIn[v] != NONE && openOut[other] != NONE && openIn[other] != NONE &&
+                        rep[openOut[v]] == rep[openIn[other]] && rep[openIn[v]] == rep[openOut[other]] &&
+                        rep[openOut[v]] != rep[openIn[v]];
+            kind[v] = seam ? KIND_SEAM : KIND_LOCKED;
+        }
+        // 接縫兩側一起移動，另一側固定時這一側也固定
+        for (unsigned int v = 0; v < vertexCount; ++v) {
+            if (kind[v] != KIND_SEAM) continue;
+            for (unsigned int w = wedge[v]; w != v; w = wedge[w]) {
+                if (kind[w] == KIND_LOCKED) kind[v] = KIND_LOCKED;
+            }
+        }
+
+        // 頂點 -> 三角形
+        std::fill(adjacencyStart.begin(), adjacencyStart.end(), 0);
+        for (unsigned int v : result) adjacencyStart[v + 1]++;
+        for (size_t v = 0; v < vertexCount; ++v) adjacencyStart[v + 1] += adjacencyStart[v];
+        adjacency.resize(result.size());
+        std::vector<unsigned int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i) adjacency[fill[result[i]]++] = static_cast<unsigned int>(i / 3);
+
+        // 候選的合併：流形頂點可以移到任何相鄰的頂點，接縫頂點只能沿著接縫移動
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = result[i + e], b = result[i + (e + 1) % 3];
+                for (int dir = 0; dir < 2; ++dir) {
+                    unsigned int from = dir ? b : a, to = dir ? a : b;
+                    if (rep[from] == rep[to]) continue;
+                    bool allowed = kind[from] == KIND_MANIFOLD ||
+                                   (kind[from] == KIND_SEAM && (openOut[from] == to || openIn[from] == to));
+                    if (!allowed) continue;
+                    float error = static_cast<float>(evaluate(quadrics[rep[from]], quadrics[rep[to]], position(to)));
+                    collapses.push_back({ from, to, error });
+                }
+            }
+        }
+        if (collapses.empty()) break;
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        // 依誤差由小到大套用；合併過或相鄰的頂點這一輪不再移動，翻轉檢查才會以正確的位置計算
+        std::fill(touched.begin(), touched.end(), 0);
+        for (unsigned int v = 0; v < vertexCount; ++v) remap[v] = v;
+        size_t removed = 0;
+        int applied = 0;
+        for (const Collapse& c : collapses) {
+            if (triangleCount - removed <= targetTriangles) break;
+            if (c.error > maxErrorSq) break;
+            unsigned int rf = rep[c.from], rt = rep[c.to];
+            if (touched[rf] || touched[rt]) continue;
+
+            // 接縫另一側的頂點移到目標位置上、與它以開放邊相連的頂點
+            unsigned int twin = NONE, twinTarget = NONE;
+            if (kind[c.from] == KIND_SEAM) {
+                for (unsigned int w = wedge[c.from]; w != c.from; w = wedge[w]) {
+                    if (kind[w] != KIND_UNUSED) twin = w;
+                }
+                if (twin == NONE) continue;
+                if (openOut[twin] != NONE && rep[openOut[twin]] == rt) twinTarget = openOut[twin];
+                else if (openIn[twin] != NONE && rep[openIn[twin]] == rt) twinTarget = openIn[twin];
+                if (twinTarget == NONE) continue;
+            }
+
+            // 不會被移除的三角形在合併後不可以翻面或變得太歪
+            glm::vec3 target = position(c.to);
+            bool flipped = false;
+            size_t collapsing = 0;
+            for (unsigned int v : { c.from, twin }) {
+                if (v == NONE) continue;
+                for (unsigned int k = adjacencyStart[v]; k < adjacencyStart[v + 1] && !flipped; ++k) {
+                    const unsigned int* t = &result[adjacency[k] * 3];
+                    if (rep[t[0]] == rt || rep[t[1]] == rt || rep[t[2]] == rt) {
+                        collapsing++;
+                        continue;
+                    }
+                    glm::vec3 p[3] = { position(t[0]), position(t[1]), position(t[2]) };
+                    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for (int j = 0; j < 3; ++j) {
+                        if (t[j] == v) p[j] = target;
+                    }
+                    glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    float limit = SIMPLIFY_FLIP_LIMIT * glm::length(before) * glm::length(after);
+                    if (glm::dot(before, after) <= limit) flipped = true;
+                }
+            }
+            if (flipped) continue;
+
+            remap[c.from] = c.to;
+            if (twin != NONE) remap[twin] = twinTarget;
+            quadrics[rt].add(quadrics[rf]);
+            resultError = std::max(resultError, c.error);
+            removed += collapsing;
+            applied++;
+            touched[rf] = touched[rt] = 1;
+            for (unsigned int v : { c.from, twin }) {
+                if (v == NONE) continue;
+                for (unsigned int k = adjacencyStart[v]; k < adjacencyStart[v + 1]; ++k) {
+                    const unsigned int* t = &result[adjacency[k] * 3];
+                    touched[rep[t[0]]] = touched[rep[t[1]]] = touched[rep[t[2]]] = 1;
+                }
+            }
+        }
+        if (applied == 0) break;
+
+        // 重寫索引，移除兩個頂點重合的三角形
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            unsigned int a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (rep[a] == rep[b] || rep[b] == rep[c] || rep[a] == rep[c]) continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+    return std::sqrt(resultError);
+}
+
+int CMeshSimplify::buildLods(const float* vertices, size_t vertexCount, size_t stride,
+                             const unsigned int* indices, size_t indexCount, int maxLevels,
+                             std::vector<unsigned int>& lodIndices, std::vector<MeshLod>& lods) {
+    lodIndices.clear();
+    lods.clear();
+    MeshLod base;
+    base.indexCount = static_cast<uint32_t>(indexCount);
+    lods.push_back(base);
+    if (indexCount / 3 < MESH_LOD_MIN_TRIANGLES) return 1;
+
+    // 每一層都從原本的網格簡化，誤差是相對於原本的形狀，而不是上一層；
+    // QEM 的誤差是平均的距離平方，少數幾次合併就可能遠大於實際的偏移，所以每一層另外量測
+    std::vector<unsigned int> simplified;
+    float target = static_cast<float>(indexCount);
+    for (int level = 1; level < maxLevels; ++level) {
+        target *= MESH_LOD_RATIO;
+        SimplifyOptions options;
+        options.targetIndexCount = static_cast<size_t>(target) / 3 * 3;
+        simplify(vertices, vertexCount, stride, indices, indexCount, options, simplified);
+        if (simplified.empty() || simplified.size() > lods.back().indexCount * MESH_LOD_MIN_REDUCTION) break;
+        float error = measureDeviation(vertices, vertexCount, stride, indices, indexCount, simplified);
+        if (lods.size() > 1 && error <= lods.back().error) {
+            lodIndices.resize(lods.back().indexStart - indexCount);
+            lods.pop_back();
+        }
+        MeshLod lod;
+        lod.indexStart = static_cast<uint32_t>(indexCount + lodIndices.size());
+        lod.indexCount = static_cast<uint32_t>(simplified.size());
+        lod.error = error;
+        lods.push_back(lod);
+        lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+    }
+    return static_cast<int>(lods.size());
+}
@@ -0,0 +1,42 @@
+//  CMeshSimplify.h
+//  以 QEM 合併邊簡化網格，產生共用原本頂點緩衝區的 LOD 索引；接縫與開放的邊不會裂開
+
+#pragma once
+
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define MESH_LOD_MAX 4                 // 包含原本的網格（LOD 0）
+#define MESH_LOD_RATIO 0.5f            // 每一層的目標三角形數量為上一層的比例
+#define MESH_LOD_MIN_TRIANGLES 256     // 三角形比這少的網格不產生 LOD
+#define MESH_LOD_MIN_REDUCTION 0.85f   // 簡化後仍超過上一層的此比例時（大多是固定的邊界太多）不再產生下一層
+
+// 一層 LOD 的索引範圍；error 為模型空間的距離（原本的頂點到這一層表面的最大距離，建立時實際量測）
+struct MeshLod {
+    uint32_t indexStart = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;
+};
+
+struct SimplifyOptions {
+    size_t targetIndexCount = 0;
+    float maxError = FLT_MAX;          // 模型空間的距離，合併的誤差超過時停止
+};
+
+class CMeshSimplify {
+public:
+    // vertices 每個頂點 stride 個 float，前三個為位置；indices 每三個一個三角形
+    // 結果寫入 result（面積為 0 的三角形已移除），回傳誤差（模型空間的距離）
+    static float simplify(const float* vertices, size_t vertexCount, size_t stride,
+                          const unsigned int* indices, size_t indexCount,
+                          const SimplifyOptions& options, std::vector<unsigned int>& result);
+
+    // LOD 0 為原本的 indices；第 1 層以後的索引依序寫入 lodIndices，
+    // lods[k].indexStart 是在「原本的 indices 之後接著 lodIndices」的索引緩衝區中的位置；回傳層數
+    // 每一層的 error 都比上一層大：誤差沒有增加的一層取代上一層（上一層不會被選到）
+    static int buildLods(const float* vertices, size_t vertexCount, size_t stride,
+                         const unsigned int* indices, size_t indexCount, int maxLevels,
+                         std::vector<unsigned int>& lodIndices, std::vector<MeshLod>& lods);
+};
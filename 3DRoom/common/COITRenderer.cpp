@@ -0,0 +1,266 @@
+//  COITRenderer.cpp
+#include "COITRenderer.h"
+#include "CShaderPool.h"
+#include "Model.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+COITRenderer::COITRenderer()
+    : _compositeShader(0), _emptyVao(0), _fbo(0), _accumTex(0), _weightTex(0), _depthBuffer(0),
+      _width(0), _height(0), _queryIndex(0),
+      _mode(TransparencyMode::WEIGHTED_OIT), _oitSupported(true) {
+    for (int i = 0; i < 2; i++) {
+        _queries[i] = 0;
+        _queryPending[i] = false;
+        _queryMode[i] = 0;
+        _gpuTotal[i] = 0.0;
+        _gpuFrames[i] = 0;
+    }
+}
+
+COITRenderer::~COITRenderer() {
+    // GL 資源需由 release() 在 context 存在時釋放
+}
+
+void COITRenderer::init() {
+    _compositeShader = CShaderPool::getInstance().getShader("oit_vtxshader.glsl", "oit_fragshader.glsl");
+    glUseProgram(_compositeShader);
+    glUniform1i(glGetUniformLocation(_compositeShader, "uAccum"), 0);
+    glUniform1i(glGetUniformLocation(_compositeShader, "uWeight"), 1);
+    glGenVertexArrays(1, &_emptyVao);
+    glGenFramebuffers(1, &_fbo);
+    glGenQueries(2, _queries);
+}
+
+void COITRenderer::release() {
+    deleteTargets();
+    if (_fbo != 0) glDeleteFramebuffers(1, &_fbo);
+    if (_emptyVao != 0) glDeleteVertexArrays(1, &_emptyVao);
+    if (_queries[0] != 0) glDeleteQueries(2, _queries);
+    _fbo = _emptyVao = 0;
+    _queries[0] = _queries[1] = 0;
+}
+
+void COITRenderer::toggleMode() {
+    _mode = (_mode == TransparencyMode::WEIGHTED_OIT) ? TransparencyMode::SORTED_BLEND
+                                                      : TransparencyMode::WEIGHTED_OIT;
+    if (_mode == TransparencyMode::WEIGHTED_OIT && !_oitSupported) {
+        std::cout << "Weighted blended OIT unavailable, using sorted blending" << std::endl;
+        _mode = TransparencyMode::SORTED_BLEND;
+        return;
+    }
+    std::cout << "Transparency: "
+              << (_mode == TransparencyMode::WEIGHTED_OIT ? "weighted blended OIT" : "sorted alpha blending")
+              << std::endl;
+}
+
+void COITRenderer::deleteTargets() {
+    if (_accumTex != 0) glDeleteTextures(1, &_accumTex);
+    if (_weightTex != 0) glDeleteTextures(1, &_weightTex);
+    if (_depthBuffer != 0) glDeleteRenderbuffers(1, &_depthBuffer);
+    _accumTex = _weightTex = _depthBuffer = 0;
+    _width = _height = 0;
+}
+
+bool COITRenderer::resizeTargets(int width, int height) {
+    if (width == _width && height == _height && _accumTex != 0) return true;
+    deleteTargets();
+
+    glGenTextures(1, &_accumTex);
+    glBindTexture(GL_TEXTURE_2D, _accumTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &_weightTex);
+    glBindTexture(GL_TEXTURE_2D, _weightTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, width, height, 0, GL_RED, GL_HALF_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // 與 GLFW 預設 framebuffer 相同的格式，才能用 glBlitFramebuffer 複製深度
+    glGenRenderbuffers(1, &_depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _accumTex, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _weightTex, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthBuffer);
+    GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    bool complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "OIT framebuffer incomplete" << std::endl;
+        deleteTargets();
+        return false;
+    }
+    _width = width;
+    _height = height;
+    return true;
+}
+
+bool COITRenderer::copyDepth() {
+    while (glGetError() != GL_NO_ERROR) {}
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fbo);
+    glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void COITRenderer::collectDraws(const std::vector<SceneObject>& objects, const glm::vec3& eyePos) {
+    _draws.clear();
+    for (const SceneObject& obj : objects) {
+        for (size_t m = 0; m < obj.model->GetMeshCount(); m++) {
+            if (!obj.model->IsMeshTransparent(m)) continue;
+            // 距離只有 SORTED_BLEND（以及 OIT 無法使用時的退回）才會用來排序
+            glm::vec3 center = glm::vec3(obj.world * glm::vec4(obj.model->GetMeshCenter(m), 1.0f));
+            glm::vec3 d = center - eyePos;
+            _draws.push_back({ &obj, m, glm::dot(d, d) });
+        }
+    }
+}
+
+void COITRenderer::readTimers() {
+    for (int i = 0; i < 2; i++) {
+        if (!_queryPending[i]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(_queries[i], GL_QUERY_RESULT, &elapsed);
+        _queryPending[i] = false;
+
+        int mode = _queryMode[i];
+        _gpuTotal[mode] += elapsed * 1e-6;
+        if (++_gpuFrames[mode] >= OIT_TIMING_FRAMES) {
+            _stats.gpuMs[mode] = _gpuTotal[mode] / _gpuFrames[mode];
+            _stats.gpuSamples[mode] = _gpuFrames[mode];
+            _gpuTotal[mode] = 0.0;
+            _gpuFrames[mode] = 0;
+        }
+    }
+}
+
+void COITRenderer::render(const std::vector<SceneObject>& objects, GLuint shaderProg, const glm::vec3& eyePos,
+                          const std::function<void(const SceneObject&)>& setupObject) {
+    readTimers();
+    collectDraws(objects, eyePos);
+    _stats.draws = static_cast<int>(_draws.size());
+    if (_draws.empty()) return;
+
+    // 上一次使用這個 query 的結果還沒讀到時，這個 frame 不計時
+    int q = _queryIndex;
+    bool timing = (_queries[q] != 0) && !_queryPending[q];
+    if (timing) glBeginQuery(GL_TIME_ELAPSED, _queries[q]);
+
+    if (_mode == TransparencyMode::WEIGHTED_OIT) {
+        renderWeighted(shaderProg, setupObject);
+    } else {
+        renderSorted(shaderProg, setupObject);
+    }
+
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _queryPending[q] = true;
+        _queryMode[q] = static_cast<int>(_mode);
+        _queryIndex = 1 - q;
+    }
+}
+
+void COITRenderer::renderSorted(GLuint shaderProg, const std::function<void(const SceneObject&)>& setupObject) {
+    auto start = std::chrono::steady_clock::now();
+    std::sort(_draws.begin(), _draws.end(), [](const TransparentDraw& a, const TransparentDraw& b) {
+        return a.distance2 > b.distance2;  // 由遠到近
+    });
+    _stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    glUseProgram(shaderProg);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    for (const TransparentDraw& draw : _draws) {
+        setupObject(*draw.object);
+        draw.object->model->RenderMesh(draw.mesh, shaderProg);
+    }
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+void COITRenderer::renderWeighted(GLuint shaderProg, const std::function<void(const SceneObject&)>& setupObject) {
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (!resizeTargets(viewport[2], viewport[3]) || !copyDepth()) {
+        std::cerr << "Cannot share depth with OIT targets, falling back to sorted blending" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        _oitSupported = false;
+        _mode = TransparencyMode::SORTED_BLEND;
+        renderSorted(shaderProg, setupObject);
+        return;
+    }
+
+    // 累積：accum 清為 (0,0,0,1)（alpha 為 revealage），weight 清為 0
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+    glViewport(0, 0, _width, _height);
+    const GLfloat clearAccum[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    const GLfloat clearWeight[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, clearAccum);
+    glClearBufferfv(GL_COLOR, 1, clearWeight);
+
+    // OpenGL 3.3 沒有 glBlendFunci，兩個輸出共用同一組混合：
+    // rgb 相加（顏色與權重總和），alpha 乘上 (1 - a)（revealage）
+    glUseProgram(shaderProg);
+    glUniform1i(glGetUniformLocation(shaderProg, "uOITPass"), 1);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    for (const TransparentDraw& draw : _draws) {
+        setupObject(*draw.object);
+        draw.object->model->RenderMesh(draw.mesh, shaderProg);
+    }
+    glUniform1i(glGetUniformLocation(shaderProg, "uOITPass"), 0);
+
+    // 合成到預設 framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glUseProgram(_compositeShader);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _accumTex);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _weightTex);
+    glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(_emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glUseProgram(shaderProg);
+}
+
+void COITRenderer::printStats() const {
+    std::cout << "Transparency: "
+              << (_mode == TransparencyMode::WEIGHTED_OIT ? "weighted blended OIT" : "sorted alpha blending")
+              << ", " << _stats.draws << " transparent meshes" << std::endl;
+    const char* names[2] = { "weighted OIT", "sorted blend" };
+    for (int m = 0; m < 2; m++) {
+        std::cout << "  " << names[m] << " GPU: ";
+        if (_stats.gpuSamples[m] > 0) {
+            std::cout << _stats.gpuMs[m] << " ms (avg of " << _stats.gpuSamples[m] << " frames)";
+        } else {
+            std::cout << "not measured yet";
+        }
+        if (m == 1) std::cout << ", CPU sort " << _stats.sortMs << " ms";
+        std::cout << std::endl;
+    }
+}
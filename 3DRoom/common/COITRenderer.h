@@ -0,0 +1,86 @@
+//  COITRenderer.h
+//  透明網格的描繪：所有模型的透明網格集中在一起，在不透明物件之後描繪
+//  WEIGHTED_OIT：Weighted Blended OIT（McGuire & Bavoil 2013），以任意順序累積到兩張浮點貼圖，
+//                最後用一個全畫面三角形合成，不需要每個 frame 排序
+//  SORTED_BLEND：依網格中心到攝影機的距離由遠到近排序後以 alpha blending 描繪（比較用）
+//  兩種模式都以 GL_TIME_ELAPSED 量測 GPU 時間，'t' 鍵切換，'i' 鍵輸出比較
+
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "SceneObject.h"
+
+enum class TransparencyMode {
+    WEIGHTED_OIT,
+    SORTED_BLEND
+};
+
+// 透明描繪的統計，GPU 時間為最近 OIT_TIMING_FRAMES 個 frame 的平均
+struct TransparencyStats {
+    int    draws = 0;              // 這個 frame 描繪的透明網格數
+    double sortMs = 0.0;           // SORTED_BLEND 的 CPU 排序時間
+    double gpuMs[2] = { 0.0, 0.0 };  // 依 TransparencyMode 索引
+    int    gpuSamples[2] = { 0, 0 };
+};
+
+#define OIT_TIMING_FRAMES 60
+
+class COITRenderer {
+public:
+    COITRenderer();
+    ~COITRenderer();
+
+    void init();
+    void release();
+
+    void setMode(TransparencyMode mode) { _mode = mode; }
+    TransparencyMode getMode() const { return _mode; }
+    void toggleMode();
+
+    // 在所有不透明物件之後呼叫；setupObject 負責設定每個物件的 mxModel 等 uniform
+    void render(const std::vector<SceneObject>& objects, GLuint shaderProg, const glm::vec3& eyePos,
+                const std::function<void(const SceneObject&)>& setupObject);
+
+    const TransparencyStats& getStats() const { return _stats; }
+    void printStats() const;
+
+private:
+    struct TransparentDraw {
+        const SceneObject* object;
+        size_t mesh;
+        float  distance2;
+    };
+
+    void collectDraws(const std::vector<SceneObject>& objects, const glm::vec3& eyePos);
+    bool resizeTargets(int width, int height);
+    void deleteTargets();
+    bool copyDepth();
+    void renderWeighted(GLuint shaderProg, const std::function<void(const SceneObject&)>& setupObject);
+    void renderSorted(GLuint shaderProg, const std::function<void(const SceneObject&)>& setupObject);
+    void readTimers();
+
+    GLuint _compositeShader;
+    GLuint _emptyVao;              // core profile 描繪時必須綁定 VAO
+    GLuint _fbo;
+    GLuint _accumTex;              // RGBA16F
+    GLuint _weightTex;             // R16F
+    GLuint _depthBuffer;           // 不透明物件的深度由預設 framebuffer 複製過來
+    int    _width, _height;
+
+    // GPU 計時，兩組 query 輪流使用，讀取上一個 frame 的結果以避免等待
+    GLuint _queries[2];
+    bool   _queryPending[2];
+    int    _queryMode[2];
+    int    _queryIndex;
+    double _gpuTotal[2];
+    int    _gpuFrames[2];
+
+    TransparencyMode _mode;
+    bool _oitSupported;            // 深度無法複製時退回 SORTED_BLEND
+    std::vector<TransparentDraw> _draws;
+    TransparencyStats _stats;
+};
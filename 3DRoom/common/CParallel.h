@@ -0,0 +1,40 @@
+//  CParallel.h
+//  簡單的 parallelFor：把 [begin, end) 切成 grain 大小的區塊，由多個執行緒動態領取
+//  執行緒數 <= 1 時直接在呼叫端執行，方便比較單執行緒與多執行緒的結果
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+
+#include "CThreadPool.h"
+
+// 硬體可用的執行緒數（取不到時回傳 1）
+inline int hardwareThreadCount()
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n);
+}
+
+// func(int index) 會對 [begin, end) 中每個 index 各呼叫一次，不保證順序
+// 每次呼叫都會建立與結束執行緒，只用在離線的工具與載入；每個 frame 執行的工作使用 CThreadPool
+template <typename Func>
+void parallelFor(int begin, int end, int numThreads, int grain, Func&& func)
+{
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    int chunks = (end - begin + grain - 1) / grain;
+    CThreadPool pool(std::max(1, std::min(numThreads, chunks)));
+    pool.parallelFor(begin, end, numThreads, grain, func);
+}
+
+// 以 pool 的執行緒處理，pool 為 nullptr 時在呼叫端依序執行
+template <typename Func>
+void parallelFor(CThreadPool* pool, int begin, int end, int numThreads, int grain, Func&& func)
+{
+    if (pool != nullptr) {
+        pool->parallelFor(begin, end, numThreads, grain, func);
+        return;
+    }
+    for (int i = begin; i < end; i++) func(i);
+}
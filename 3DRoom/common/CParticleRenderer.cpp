@@ -0,0 +1,137 @@
+//  CParticleRenderer.cpp
+#include "CParticleRenderer.h"
+#include "CShaderPool.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <string>
+
+CParticleRenderer::CParticleRenderer()
+    : _shader(0), _vao(0), _vbo(0), _capacity(0), _queryIndex(0), _gpuTotal(0.0), _gpuFrames(0) {
+    for (int i = 0; i < 2; i++) {
+        _queries[i] = 0;
+        _queryPending[i] = false;
+    }
+}
+
+CParticleRenderer::~CParticleRenderer() {
+    // GL 資源需由 release() 在 context 存在時釋放
+}
+
+void CParticleRenderer::init() {
+    _shader = CShaderPool::getInstance().getShader("particle_vtxshader.glsl", "particle_fragshader.glsl");
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_vbo);
+    glGenQueries(2, _queries);
+}
+
+void CParticleRenderer::release() {
+    if (_vao != 0) glDeleteVertexArrays(1, &_vao);
+    if (_vbo != 0) glDeleteBuffers(1, &_vbo);
+    if (_queries[0] != 0) glDeleteQueries(2, _queries);
+    _vao = _vbo = 0;
+    _queries[0] = _queries[1] = 0;
+    _capacity = 0;
+}
+
+// buffer 中依序為 x、y、z、年齡各 capacity 個 float，最後為 capacity 個 style；容量改變時重新配置並設定 attribute
+void CParticleRenderer::upload(const CParticleSystem& particles) {
+    const int count = particles.getCount();
+    const size_t floatArray = static_cast<size_t>(particles.getCapacity()) * sizeof(float);
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    if (_capacity != particles.getCapacity()) {
+        _capacity = particles.getCapacity();
+        glBufferData(GL_ARRAY_BUFFER, floatArray * 4 + _capacity, nullptr, GL_STREAM_DRAW);
+        for (int i = 0; i < 4; i++) {
+            glEnableVertexAttribArray(i);
+            glVertexAttribPointer(i, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(floatArray * i));
+            glVertexAttribDivisor(i, 1);
+        }
+        glEnableVertexAttribArray(4);
+        glVertexAttribIPointer(4, 1, GL_UNSIGNED_BYTE, 1, (void*)(floatArray * 4));
+        glVertexAttribDivisor(4, 1);
+    }
+    const float* arrays[4] = { particles.getPositionX(), particles.getPositionY(), particles.getPositionZ(),
+                               particles.getAge() };
+    for (int i = 0; i < 4; i++) {
+        glBufferSubData(GL_ARRAY_BUFFER, floatArray * i, count * sizeof(float), arrays[i]);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, floatArray * 4, count, particles.getStyleIndices());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    _stats.uploadedBytes = count * static_cast<int>(sizeof(float) * 4 + 1);
+}
+
+void CParticleRenderer::readQueries() {
+    for (int i = 0; i < 2; i++) {
+        if (!_queryPending[i]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(_queries[i], GL_QUERY_RESULT, &elapsed);
+        _queryPending[i] = false;
+
+        _gpuTotal += elapsed * 1e-6;
+        if (++_gpuFrames >= PARTICLE_TIMING_FRAMES) {
+            _stats.gpuMs = _gpuTotal / _gpuFrames;
+            _stats.gpuSamples = _gpuFrames;
+            _gpuTotal = 0.0;
+            _gpuFrames = 0;
+        }
+    }
+}
+
+void CParticleRenderer::render(const CParticleSystem& particles, const glm::mat4& viewProj, const glm::vec3& viewPos) {
+    readQueries();
+    _stats.particles = particles.getCount();
+    _stats.uploadedBytes = 0;
+    if (_shader == 0 || _stats.particles == 0) return;
+    upload(particles);
+
+    int q = _queryIndex;
+    bool timing = (_queries[q] != 0) && !_queryPending[q];
+    if (timing) glBeginQuery(GL_TIME_ELAPSED, _queries[q]);
+
+    glUseProgram(_shader);
+    glUniformMatrix4fv(glGetUniformLocation(_shader, "uViewProj"), 1, GL_FALSE, glm::value_ptr(viewProj));
+    glUniform3fv(glGetUniformLocation(_shader, "uViewPos"), 1, glm::value_ptr(viewPos));
+    const std::vector<ParticleStyle>& styles = particles.getStyles();
+    for (size_t s = 0; s < styles.size(); s++) {
+        std::string index = "[" + std::to_string(s) + "]";
+        glUniform4fv(glGetUniformLocation(_shader, ("uColorStart" + index).c_str()), 1, glm::value_ptr(styles[s].colorStart));
+        glUniform4fv(glGetUniformLocation(_shader, ("uColorEnd" + index).c_str()), 1, glm::value_ptr(styles[s].colorEnd));
+        glUniform2f(glGetUniformLocation(_shader, ("uSize" + index).c_str()), styles[s].sizeStart, styles[s].sizeEnd);
+        glUniform1f(glGetUniformLocation(_shader, ("uAdditive" + index).c_str()), styles[s].additive ? 1.0f : 0.0f);
+    }
+
+    GLboolean cullEnabled = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    glBindVertexArray(_vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _stats.particles);
+    glBindVertexArray(0);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    if (cullEnabled) glEnable(GL_CULL_FACE);
+
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _queryPending[q] = true;
+        _queryIndex = 1 - q;
+    }
+}
+
+void CParticleRenderer::printStats() const {
+    std::cout << "Particles: " << _stats.particles << " drawn, " << _stats.uploadedBytes << " bytes uploaded this frame"
+              << std::endl;
+    std::cout << "  particle pass GPU: ";
+    if (_stats.gpuSamples > 0) {
+        std::cout << _stats.gpuMs << " ms (avg of " << _stats.gpuSamples << " frames)";
+    } else {
+        std::cout << "not measured yet";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,56 @@
+//  CParticleRenderer.h
+//  CParticleSystem 的所有粒子以一次 instanced draw 畫成面向攝影機的四邊形
+//  instance 資料直接使用 CParticleSystem 的 SoA 陣列：一個 buffer 依序放 x、y、z、年齡（float）與 style（byte），
+//  每個陣列一次 glBufferSubData，不需要在 CPU 上轉成每個粒子一個結構
+//  四邊形的頂點由 gl_VertexID 產生，billboard 的方向（Model::calculateSphericalBillboard 的算法）在 vertex shader 計算，
+//  顏色與大小依 style 的 uniform 陣列與年齡內插
+//  以 premultiplied alpha 混合（GL_ONE, GL_ONE_MINUS_SRC_ALPHA）：additive 的 style 輸出 alpha 0 即為相加混合，
+//  兩種粒子可以在同一次 draw 中不排序地描繪；做深度測試但不寫入深度
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "CParticleSystem.h"
+
+#define PARTICLE_TIMING_FRAMES 60
+
+// 粒子描繪的統計，GPU 時間為最近 PARTICLE_TIMING_FRAMES 個 frame 的平均
+struct ParticleStats {
+    int particles = 0;            // 這個 frame 描繪的粒子數
+    int uploadedBytes = 0;
+    double gpuMs = 0.0;
+    int gpuSamples = 0;
+};
+
+class CParticleRenderer {
+public:
+    CParticleRenderer();
+    ~CParticleRenderer();
+
+    void init();
+    void release();
+
+    // 在透明網格之後呼叫
+    void render(const CParticleSystem& particles, const glm::mat4& viewProj, const glm::vec3& viewPos);
+
+    const ParticleStats& getStats() const { return _stats; }
+    void printStats() const;
+
+private:
+    void upload(const CParticleSystem& particles);
+    void readQueries();
+
+    GLuint _shader;
+    GLuint _vao, _vbo;
+    int    _capacity;               // _vbo 中每個陣列的長度
+
+    GLuint _queries[2];
+    bool   _queryPending[2];
+    int    _queryIndex;
+    double _gpuTotal;
+    int    _gpuFrames;
+
+    ParticleStats _stats;
+};
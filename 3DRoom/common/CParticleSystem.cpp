@@ -0,0 +1,191 @@
+//  CParticleSystem.cpp
+#include "CParticleSystem.h"
+#include "CParallel.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+
+CParticleSystem::CParticleSystem(int capacity) : _threads(hardwareThreadCount()) {
+    // 陣列長度為 4 的倍數，SIMD 更新最後一組時不會超出範圍
+    _capacity = std::max(4, (capacity + 3) & ~3);
+    size_t n = static_cast<size_t>(_capacity);
+    for (std::vector<float>* v : { &_posX, &_posY, &_posZ, &_velX, &_velY, &_velZ, &_life, &_invLifetime, &_age,
+                                   &_gravityScale, &_damping }) {
+        v->assign(n, 0.0f);
+    }
+    _style.assign(n, 0);
+    _deadBits.assign(n / 4, 0);
+    _deadList.resize(n);
+    _styles.reserve(PARTICLE_MAX_STYLES);
+}
+
+int CParticleSystem::addStyle(const ParticleStyle& style) {
+    if (static_cast<int>(_styles.size()) >= PARTICLE_MAX_STYLES) return static_cast<int>(_styles.size()) - 1;
+    _styles.push_back(style);
+    return static_cast<int>(_styles.size()) - 1;
+}
+
+int CParticleSystem::addEmitter(const ParticleEmitterDesc& desc) {
+    Emitter emitter;
+    emitter.desc = desc;
+    _emitters.push_back(emitter);
+    return static_cast<int>(_emitters.size()) - 1;
+}
+
+// xorshift32，0 ~ 1
+float CParticleSystem::random01() {
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return static_cast<float>(_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+void CParticleSystem::spawn(const ParticleEmitterDesc& desc) {
+    if (_count == _capacity) {
+        _dropped++;
+        return;
+    }
+    int i = _count++;
+    glm::vec3 jitter(random01() * 2.0f - 1.0f, random01() * 2.0f - 1.0f, random01() * 2.0f - 1.0f);
+    glm::vec3 position = desc.position + jitter * desc.positionJitter;
+    glm::vec3 offset(random01() * 2.0f - 1.0f, random01() * 2.0f - 1.0f, random01() * 2.0f - 1.0f);
+    glm::vec3 direction = desc.direction + offset * desc.spread;
+    float length = glm::length(direction);
+    direction = (length > 1e-6f) ? direction / length : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 velocity = direction * (desc.speedMin + (desc.speedMax - desc.speedMin) * random01());
+    float lifetime = std::max(1e-3f, desc.lifetimeMin + (desc.lifetimeMax - desc.lifetimeMin) * random01());
+
+    _posX[i] = position.x; _posY[i] = position.y; _posZ[i] = position.z;
+    _velX[i] = velocity.x; _velY[i] = velocity.y; _velZ[i] = velocity.z;
+    _life[i] = lifetime;
+    _invLifetime[i] = 1.0f / lifetime;
+    _age[i] = 0.0f;
+    _gravityScale[i] = desc.gravityScale;
+    _damping[i] = desc.damping;
+    _style[i] = static_cast<uint8_t>(desc.style);
+    _spawned++;
+}
+
+int CParticleSystem::emitBurst(const ParticleEmitterDesc& desc, int count) {
+    int before = _count;
+    for (int k = 0; k < count; ++k) spawn(desc);
+    return _count - before;
+}
+
+void CParticleSystem::update(float dt) {
+    if (dt <= 0.0f) return;
+    for (Emitter& emitter : _emitters) {
+        if (!emitter.enabled || emitter.desc.rate <= 0.0f) continue;
+        emitter.accumulator += emitter.desc.rate * dt;
+        int n = static_cast<int>(emitter.accumulator);
+        emitter.accumulator -= static_cast<float>(n);
+        for (int k = 0; k < n; ++k) spawn(emitter.desc);
+    }
+    if (_count == 0) return;
+
+    int blocks = (_count + PARTICLE_BLOCK_SIZE - 1) / PARTICLE_BLOCK_SIZE;
+    parallelFor(_pool, 0, blocks, _threads, 1, [&](int block) {
+        int begin = block * PARTICLE_BLOCK_SIZE;
+        int end = std::min(begin + PARTICLE_BLOCK_SIZE, _count);
+        if (_simd) updateRange(begin, end, dt);
+        else updateRangeScalar(begin, end, dt);
+    });
+    removeDead();
+}
+
+// begin 為 4 的倍數；最後一組超過 end 的 lane 也會計算（陣列長度足夠），但不會標記為死亡
+void CParticleSystem::updateRange(int begin, int end, float dt) {
+    const Float4 vdt = Float4::set1(dt);
+    const Float4 one = Float4::set1(1.0f), zero = Float4::set1(0.0f);
+    const Float4 gx = Float4::set1(_gravity.x * dt), gy = Float4::set1(_gravity.y * dt), gz = Float4::set1(_gravity.z * dt);
+    const Float4 floorY = Float4::set1(_floorY), bounce = Float4::set1(-_bounce), friction = Float4::set1(_friction);
+    for (int i = begin; i < end; i += 4) {
+        // 先積分速度，再以新的速度移動（semi-implicit Euler）
+        Float4 keep = max4(one - Float4::load(&_damping[i]) * vdt, zero);
+        Float4 g = Float4::load(&_gravityScale[i]);
+        Float4 vx = Float4::load(&_velX[i]) * keep + gx * g;
+        Float4 vy = Float4::load(&_velY[i]) * keep + gy * g;
+        Float4 vz = Float4::load(&_velZ[i]) * keep + gz * g;
+        Float4 px = Float4::load(&_posX[i]) + vx * vdt;
+        Float4 py = Float4::load(&_posY[i]) + vy * vdt;
+        Float4 pz = Float4::load(&_posZ[i]) + vz * vdt;
+
+        // 低於地面的粒子移到地面上，往下的反彈
+        Mask4 below = py < floorY;
+        Mask4 falling = below & (vy < zero);
+        py = select4(below, floorY, py);
+        vy = select4(falling, vy * bounce, vy);
+        vx = select4(falling, vx * friction, vx);
+        vz = select4(falling, vz * friction, vz);
+
+        Float4 life = Float4::load(&_life[i]) - vdt;
+        Float4 age = min4(one - life * Float4::load(&_invLifetime[i]), one);
+
+        vx.store(&_velX[i]); vy.store(&_velY[i]); vz.store(&_velZ[i]);
+        px.store(&_posX[i]); py.store(&_posY[i]); pz.store(&_posZ[i]);
+        life.store(&_life[i]);
+        age.store(&_age[i]);
+
+        int dead = (life <= zero).bits();
+        if (end - i < 4) dead &= (1 << (end - i)) - 1;
+        _deadBits[i >> 2] = static_cast<uint8_t>(dead);
+    }
+}
+
+// 與 updateRange 相同的運算，一次一個粒子
+void CParticleSystem::updateRangeScalar(int begin, int end, float dt) {
+    const float gx = _gravity.x * dt, gy = _gravity.y * dt, gz = _gravity.z * dt;
+    for (int g = begin >> 2; g < (end + 3) >> 2; ++g) _deadBits[g] = 0;
+    for (int i = begin; i < end; ++i) {
+        float keep = std::max(1.0f - _damping[i] * dt, 0.0f);
+        float g = _gravityScale[i];
+        float vx = _velX[i] * keep + gx * g;
+        float vy = _velY[i] * keep + gy * g;
+        float vz = _velZ[i] * keep + gz * g;
+        float px = _posX[i] + vx * dt;
+        float py = _posY[i] + vy * dt;
+        float pz = _posZ[i] + vz * dt;
+        if (py < _floorY) {
+            py = _floorY;
+            if (vy < 0.0f) {
+                vy = vy * -_bounce;
+                vx = vx * _friction;
+                vz = vz * _friction;
+            }
+        }
+        float life = _life[i] - dt;
+        _velX[i] = vx; _velY[i] = vy; _velZ[i] = vz;
+        _posX[i] = px; _posY[i] = py; _posZ[i] = pz;
+        _life[i] = life;
+        _age[i] = std::min(1.0f - life * _invLifetime[i], 1.0f);
+        if (life <= 0.0f) _deadBits[i >> 2] |= static_cast<uint8_t>(1 << (i & 3));
+    }
+}
+
+// 由後往前以最後一個粒子填補死亡的位置：較後面的死亡粒子已經先移除，補進來的一定還活著
+void CParticleSystem::removeDead() {
+    int deadCount = 0;
+    int groups = (_count + 3) >> 2;
+    for (int g = 0; g < groups; ++g) {
+        int bits = _deadBits[g];
+        while (bits != 0) {
+            int lane = 0;
+            while (!(bits & (1 << lane))) ++lane;
+            bits &= ~(1 << lane);
+            _deadList[deadCount++] = g * 4 + lane;
+        }
+    }
+    for (int k = deadCount - 1; k >= 0; --k) {
+        int i = _deadList[k];
+        int last = --_count;
+        if (i == last) continue;
+        _posX[i] = _posX[last]; _posY[i] = _posY[last]; _posZ[i] = _posZ[last];
+        _velX[i] = _velX[last]; _velY[i] = _velY[last]; _velZ[i] = _velZ[last];
+        _life[i] = _life[last];
+        _invLifetime[i] = _invLifetime[last];
+        _age[i] = _age[last];
+        _gravityScale[i] = _gravityScale[last];
+        _damping[i] = _damping[last];
+        _style[i] = _style[last];
+    }
+}
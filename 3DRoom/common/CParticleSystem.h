@@ -0,0 +1,113 @@
+//  CParticleSystem.h
+//  火花、灰塵等粒子：固定容量的 SoA，以 SimdMath 的 Float4 一次更新 4 個粒子
+//  顏色與大小依 style 與年齡在 shader 中計算，CParticleRenderer 以一次 instanced draw 描繪
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class CThreadPool;
+
+#define PARTICLE_DEFAULT_CAPACITY 65536
+#define PARTICLE_MAX_STYLES 8
+#define PARTICLE_BLOCK_SIZE 16384      // 多執行緒更新時每個工作的粒子數（4 的倍數）
+
+// 顏色與大小從出生到死亡線性變化；additive 為 true 時以相加混合（發光的火花），否則為一般的 alpha 混合
+struct ParticleStyle {
+    glm::vec4 colorStart = glm::vec4(1.0f);
+    glm::vec4 colorEnd = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+    float sizeStart = 0.05f;
+    float sizeEnd = 0.05f;
+    bool additive = false;
+};
+
+struct ParticleEmitterDesc {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 1.0f, 0.0f);
+    float spread = 0.3f;            // 隨機方向的比例：0 完全沿 direction，1 約為半球
+    float positionJitter = 0.0f;    // 出生位置在此半徑的立方體內隨機
+    float speedMin = 1.0f, speedMax = 2.0f;
+    float lifetimeMin = 1.0f, lifetimeMax = 2.0f;
+    float gravityScale = 1.0f;
+    float damping = 0.0f;           // 每秒速度減少的比例
+    float rate = 0.0f;              // 發射器每秒產生的粒子數（emitBurst 不使用）
+    int style = 0;
+};
+
+class CParticleSystem {
+public:
+    explicit CParticleSystem(int capacity = PARTICLE_DEFAULT_CAPACITY);
+
+    // 回傳 style 編號，最多 PARTICLE_MAX_STYLES 種
+    int addStyle(const ParticleStyle& style);
+    const std::vector<ParticleStyle>& getStyles() const { return _styles; }
+
+    int addEmitter(const ParticleEmitterDesc& desc);
+    void setEmitterPosition(int emitter, const glm::vec3& position) { _emitters[emitter].desc.position = position; }
+    void setEmitterDirection(int emitter, const glm::vec3& direction) { _emitters[emitter].desc.direction = direction; }
+    void setEmitterEnabled(int emitter, bool enabled) { _emitters[emitter].enabled = enabled; }
+
+    // 立即產生 count 個粒子，回傳實際產生的數量（容量不足時較少）
+    int emitBurst(const ParticleEmitterDesc& desc, int count);
+    void clear() { _count = 0; }
+
+    // 發射器產生粒子後更新所有粒子，移除壽命結束的粒子
+    void update(float dt);
+
+    void setGravity(const glm::vec3& gravity) { _gravity = gravity; }
+    // 低於 height 的粒子反彈，垂直速度乘上 bounce，水平速度乘上 friction
+    void setFloor(float height, float bounce, float friction) { _floorY = height; _bounce = bounce; _friction = friction; }
+    // 區塊由 pool 的執行緒處理（最多 setThreadCount 個，預設為硬體的執行緒數），沒有設定 pool 時在呼叫端依序更新
+    void setThreadPool(CThreadPool* pool) { _pool = pool; }
+    void setThreadCount(int threads) { _threads = threads < 1 ? 1 : threads; }
+    // false 時以一次一個粒子的一般程式碼更新（與 SIMD 的結果比較用）
+    void setSimdEnabled(bool enabled) { _simd = enabled; }
+
+    // 前 getCount() 個為使用中的粒子；陣列長度為容量（4 的倍數）
+    int getCount() const { return _count; }
+    int getCapacity() const { return _capacity; }
+    const float* getPositionX() const { return _posX.data(); }
+    const float* getPositionY() const { return _posY.data(); }
+    const float* getPositionZ() const { return _posZ.data(); }
+    const float* getAge() const { return _age.data(); }        // 0 為剛出生，1 為死亡
+    const uint8_t* getStyleIndices() const { return _style.data(); }
+    glm::vec3 getPosition(int i) const { return glm::vec3(_posX[i], _posY[i], _posZ[i]); }
+    glm::vec3 getVelocity(int i) const { return glm::vec3(_velX[i], _velY[i], _velZ[i]); }
+    long long getSpawnedCount() const { return _spawned; }
+    long long getDroppedCount() const { return _dropped; }    // 容量已滿而沒有產生的粒子
+
+private:
+    struct Emitter {
+        ParticleEmitterDesc desc;
+        float accumulator = 0.0f;
+        bool enabled = true;
+    };
+
+    void spawn(const ParticleEmitterDesc& desc);
+    float random01();
+    void updateRange(int begin, int end, float dt);
+    void updateRangeScalar(int begin, int end, float dt);
+    void removeDead();
+
+    int _capacity;
+    int _count = 0;
+    std::vector<float> _posX, _posY, _posZ;
+    std::vector<float> _velX, _velY, _velZ;
+    std::vector<float> _life, _invLifetime, _age;
+    std::vector<float> _gravityScale, _damping;
+    std::vector<uint8_t> _style;
+    std::vector<uint8_t> _deadBits;      // 每 4 個粒子一個位元組，第 i 個位元為 1 表示死亡
+    std::vector<int> _deadList;
+
+    std::vector<ParticleStyle> _styles;
+    std::vector<Emitter> _emitters;
+    glm::vec3 _gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+    float _floorY = -1e30f, _bounce = 0.3f, _friction = 0.7f;
+    CThreadPool* _pool = nullptr;
+    int _threads;
+    bool _simd = true;
+    uint32_t _rng = 0x9e3779b9u;
+    long long _spawned = 0, _dropped = 0;
+};
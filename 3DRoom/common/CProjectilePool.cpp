@@ -0,0 +1,195 @@
+//  CProjectilePool.cpp
+#include "CProjectilePool.h"
+#include "CollisionManager.h"
+#include "CParallel.h"
+#include <algorithm>
+#include <cmath>
+
+// 5 位元的整數，每個位元之間插入兩個 0（Morton code 的一個軸）
+static inline uint32_t spreadBits5(uint32_t v) {
+    v &= 0x1f;
+    v = (v | (v << 8)) & 0x100f;
+    v = (v | (v << 4)) & 0x10c3;
+    v = (v | (v << 2)) & 0x1249;
+    return v;
+}
+
+CProjectilePool::CProjectilePool(int capacity)
+    : _capacity(std::max(1, capacity)), _rayHits(new RayBatchHits()), _hits(PROJECTILE_HIT_QUEUE_SIZE),
+      _droppedHits(0), _threads(hardwareThreadCount()) {
+    size_t n = static_cast<size_t>(_capacity);
+    for (std::vector<float>* v : { &_posX, &_posY, &_posZ, &_velX, &_velY, &_velZ, &_life, &_gravityScale, &_clearance }) {
+        v->resize(n);
+    }
+    _tag.resize(n);
+    _dead.resize(n);
+    _sortKey.resize(n);
+    _sortOrder.resize(n);
+    _sortCount.resize((1 << 15) + 1);
+    _sortFloat.resize(n);
+    _sortTag.resize(n);
+    for (std::vector<float>* v : { &_rays.ox, &_rays.oy, &_rays.oz, &_rays.dx, &_rays.dy, &_rays.dz, &_rays.maxT }) {
+        v->assign(n, 0.0f);
+    }
+    _testIndex.resize(n);
+    _rayHits->resize(n);
+    _candidates.resize((_capacity + PROJECTILE_BLOCK_SIZE - 1) / PROJECTILE_BLOCK_SIZE);
+    for (std::vector<int>& candidates : _candidates) candidates.reserve(64);
+}
+
+CProjectilePool::~CProjectilePool() = default;
+
+bool CProjectilePool::spawn(const ProjectileDesc& desc) {
+    if (_count == _capacity) return false;
+    int i = _count++;
+    _posX[i] = desc.position.x; _posY[i] = desc.position.y; _posZ[i] = desc.position.z;
+    _velX[i] = desc.velocity.x; _velY[i] = desc.velocity.y; _velZ[i] = desc.velocity.z;
+    _life[i] = desc.lifetime;
+    _gravityScale[i] = desc.gravityScale;
+    _tag[i] = desc.tag;
+    _dead[i] = 0;
+    _clearance[i] = 0.0f;
+    return true;
+}
+
+void CProjectilePool::clear() {
+    _count = 0;
+    ProjectileHit hit;
+    while (_hits.pop(hit)) {}
+}
+
+void CProjectilePool::update(float dt, CollisionManager& world) {
+    if (_count == 0 || dt <= 0.0f) return;
+    dt = std::min(dt, PROJECTILE_MAX_TIME_STEP);
+    // 障礙物的 BVH 與距離格點在主執行緒先建立，之後各區塊只讀取 world
+    world.prepareClearance();
+    // 牆壁或障礙物改變後，之前查詢的距離不再可靠
+    if (world.getColliderVersion() != _colliderVersion) {
+        std::fill(_clearance.begin(), _clearance.begin() + _count, 0.0f);
+        _colliderVersion = world.getColliderVersion();
+    }
+    int slice = (_count + PROJECTILE_SORT_INTERVAL - 1) / PROJECTILE_SORT_INTERVAL;
+    int sortBegin = std::min(_sortSlice * slice, _count);
+    sortByCell(sortBegin, std::min(sortBegin + slice, _count));
+    _sortSlice = (_sortSlice + 1) % PROJECTILE_SORT_INTERVAL;
+    int blocks = (_count + PROJECTILE_BLOCK_SIZE - 1) / PROJECTILE_BLOCK_SIZE;
+    const CollisionManager& queries = world;
+    parallelFor(_pool, 0, blocks, _threads, 1, [&](int block) { updateBlock(block, dt, queries); });
+    removeDead();
+}
+
+void CProjectilePool::updateBlock(int block, float dt, const CollisionManager& world) {
+    int begin = block * PROJECTILE_BLOCK_SIZE;
+    int end = std::min(begin + PROJECTILE_BLOCK_SIZE, _count);
+
+    // 打中的條件是線段進入擴張過的碰撞體：牆壁與障礙物擴張 radius，OBB 擴張 radius 後仍在世界座標 AABB 的
+    // radius * √3 之內，所以到最近碰撞體的距離大於這一步的長度 + radius * √3 時不可能打中
+    const float reach = _radius * 1.7320508f + PROJECTILE_CLEARANCE_MARGIN;
+    int tested = begin;
+
+    // 先積分速度，這一步的位移 = 新的速度 * dt（semi-implicit Euler），線段從目前的位置開始
+    for (int i = begin; i < end; ++i) {
+        float g = _gravityScale[i] * dt;
+        _velX[i] += _gravity.x * g;
+        _velY[i] += _gravity.y * g;
+        _velZ[i] += _gravity.z * g;
+        float dx = _velX[i] * dt, dy = _velY[i] * dt, dz = _velZ[i] * dt;
+        float step = std::sqrt(dx * dx + dy * dy + dz * dz);
+        // 距離下限不夠（新產生的投射物為 0）時先在目前的位置重新查詢，仍不夠才做碰撞偵測
+        if (_clearance[i] <= step + reach) {
+            _clearance[i] = world.clearance(glm::vec3(_posX[i], _posY[i], _posZ[i]), PROJECTILE_MAX_CLEARANCE);
+        }
+        if (_clearance[i] > step + reach) {
+            _posX[i] += dx;
+            _posY[i] += dy;
+            _posZ[i] += dz;
+            _clearance[i] -= step;
+            _life[i] -= dt;
+            _dead[i] = (_life[i] <= 0.0f) ? 1 : 0;
+            continue;
+        }
+        // tested <= i，寫入不會蓋掉還沒處理的投射物
+        _rays.ox[tested] = _posX[i];
+        _rays.oy[tested] = _posY[i];
+        _rays.oz[tested] = _posZ[i];
+        _rays.dx[tested] = dx;
+        _rays.dy[tested] = dy;
+        _rays.dz[tested] = dz;
+        _rays.maxT[tested] = 1.0f;
+        _testIndex[tested] = i;
+        tested++;
+    }
+
+    RayBatchHits& hits = *_rayHits;
+    world.raycastBatch(_rays, begin, tested - begin, _radius, hits, _candidates[block]);
+
+    for (int k = begin; k < tested; ++k) {
+        int i = _testIndex[k];
+        if (hits.type[k] == ColliderType::NONE) {
+            _posX[i] += _rays.dx[k];
+            _posY[i] += _rays.dy[k];
+            _posZ[i] += _rays.dz[k];
+            _life[i] -= dt;
+            _dead[i] = (_life[i] <= 0.0f) ? 1 : 0;
+            // 距離下限是這一步開始時查詢的，減去移動的距離後仍然成立
+            float step = std::sqrt(_rays.dx[k] * _rays.dx[k] + _rays.dy[k] * _rays.dy[k] + _rays.dz[k] * _rays.dz[k]);
+            _clearance[i] = _dead[i] ? 0.0f : std::max(_clearance[i] - step, 0.0f);
+            continue;
+        }
+        float t = hits.distance[k];
+        ProjectileHit hit;
+        hit.position = glm::vec3(_posX[i] + _rays.dx[k] * t, _posY[i] + _rays.dy[k] * t, _posZ[i] + _rays.dz[k] * t);
+        hit.normal = glm::vec3(hits.nx[k], hits.ny[k], hits.nz[k]);
+        hit.velocity = glm::vec3(_velX[i], _velY[i], _velZ[i]);
+        hit.type = hits.type[k];
+        hit.colliderId = hits.colliderId[k];
+        hit.tag = _tag[i];
+        if (!_hits.push(hit)) _droppedHits.fetch_add(1, std::memory_order_relaxed);
+        _dead[i] = 1;
+    }
+}
+
+// 以最後一個使用中的投射物填補移除的位置（順序不重要）
+void CProjectilePool::removeDead() {
+    int i = 0;
+    while (i < _count) {
+        if (!_dead[i]) {
+            ++i;
+            continue;
+        }
+        int last = --_count;
+        _posX[i] = _posX[last]; _posY[i] = _posY[last]; _posZ[i] = _posZ[last];
+        _velX[i] = _velX[last]; _velY[i] = _velY[last]; _velZ[i] = _velZ[last];
+        _life[i] = _life[last];
+        _gravityScale[i] = _gravityScale[last];
+        _clearance[i] = _clearance[last];
+        _tag[i] = _tag[last];
+        _dead[i] = _dead[last];
+    }
+}
+
+// [begin, end) 的投射物依格子的 Morton code（每個軸 5 位元，共 15 位元）以 counting sort 重新排列
+void CProjectilePool::sortByCell(int begin, int end) {
+    if (end - begin < 2) return;
+    std::fill(_sortCount.begin(), _sortCount.end(), 0);
+    const float inv = 1.0f / PROJECTILE_SORT_CELL;
+    for (int i = begin; i < end; ++i) {
+        uint32_t x = static_cast<uint32_t>(static_cast<int>(std::floor(_posX[i] * inv)));
+        uint32_t y = static_cast<uint32_t>(static_cast<int>(std::floor(_posY[i] * inv)));
+        uint32_t z = static_cast<uint32_t>(static_cast<int>(std::floor(_posZ[i] * inv)));
+        uint16_t key = static_cast<uint16_t>(spreadBits5(x) | (spreadBits5(y) << 1) | (spreadBits5(z) << 2));
+        _sortKey[i] = key;
+        _sortCount[key + 1]++;
+    }
+    for (size_t k = 1; k < _sortCount.size(); ++k) _sortCount[k] += _sortCount[k - 1];
+    // _sortOrder[k] 為排序後第 begin + k 個位置的投射物
+    for (int i = begin; i < end; ++i) _sortOrder[_sortCount[_sortKey[i]]++] = i;
+
+    int n = end - begin;
+    for (std::vector<float>* v : { &_posX, &_posY, &_posZ, &_velX, &_velY, &_velZ, &_life, &_gravityScale, &_clearance }) {
+        for (int k = 0; k < n; ++k) _sortFloat[k] = (*v)[_sortOrder[k]];
+        std::copy(_sortFloat.begin(), _sortFloat.begin() + n, v->begin() + begin);
+    }
+    for (int k = 0; k < n; ++k) _sortTag[k] = _tag[_sortOrder[k]];
+    std::copy(_sortTag.begin(), _sortTag.begin() + n, _tag.begin() + begin);
+}
@@ -0,0 +1,114 @@
+//  CProjectilePool.h
+//  子彈等投射物：固定容量的 SoA，每次 update 以 CollisionManager::raycastBatch 做連續碰撞偵測
+//  離碰撞體還很遠、這一步不可能打中的投射物直接前進，只有其餘的投射物做碰撞偵測
+//  打中的投射物以 ProjectileHit 事件放進無鎖佇列，由主執行緒以 popHit 取出
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CollisionBVH.h"
+#include "CLockFreeQueue.h"
+
+class CollisionManager;
+class CThreadPool;
+struct RayBatchHits;
+enum class ColliderType;    // 定義在 CollisionManager.h
+
+#define PROJECTILE_DEFAULT_CAPACITY 131072
+#define PROJECTILE_BLOCK_SIZE 1024        // 一個執行緒一次處理的投射物數量
+#define PROJECTILE_HIT_QUEUE_SIZE 65536   // 佇列滿了之後的事件丟棄（getDroppedHits）
+#define PROJECTILE_MAX_TIME_STEP 0.1f     // 畫面卡住時一次 update 最多前進的時間
+#define PROJECTILE_SORT_CELL 4.0f         // 排序用的格子大小；每個軸 5 位元，128 m 之外的格子會重疊（只影響效能）
+#define PROJECTILE_SORT_INTERVAL 4        // 每次 update 排序其中一段，每個投射物每幾次 update 排序一次（幾個 frame 內移動的距離不到一個格子）
+#define PROJECTILE_MAX_CLEARANCE 8.0f     // 查詢到碰撞體的距離時的上限（m）
+#define PROJECTILE_CLEARANCE_MARGIN 0.01f // 判斷這一步不可能打中時保留的誤差（m）
+
+struct ProjectileDesc {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 velocity = glm::vec3(0.0f);
+    float lifetime = 3.0f;       // 秒，時間到還沒打中任何東西就移除
+    float gravityScale = 0.0f;   // 0：直線飛行（子彈）；1：受完整的重力
+    uint32_t tag = 0;            // 呼叫端自訂（例如發射者、武器），原樣放進 ProjectileHit
+};
+
+// 打中牆壁或障礙物的事件
+struct ProjectileHit {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 velocity;          // 打中時的速度
+    ColliderType type;
+    int colliderId;              // 與 RaycastHit 相同：getWalls()、getObstacles() 或 getOrientedObstacles() 的索引
+    uint32_t tag;
+};
+
+class CProjectilePool {
+public:
+    explicit CProjectilePool(int capacity = PROJECTILE_DEFAULT_CAPACITY);
+    ~CProjectilePool();
+
+    // 容量已滿時回傳 false
+    bool spawn(const ProjectileDesc& desc);
+    void clear();
+
+    // 前進 dt 秒並處理碰撞：呼叫期間 world 的障礙物不可改變（打中的事件在 update 之後再處理）
+    void update(float dt, CollisionManager& world);
+
+    // 取出一個打中的事件，沒有事件時回傳 false；事件的 colliderId 在 world 的障礙物改變後失效，應在下一次改變前取出
+    bool popHit(ProjectileHit& hit) { return _hits.pop(hit); }
+    int getDroppedHits() const { return _droppedHits.load(std::memory_order_relaxed); }
+
+    int getCount() const { return _count; }
+    int getCapacity() const { return _capacity; }
+    glm::vec3 getPosition(int i) const { return glm::vec3(_posX[i], _posY[i], _posZ[i]); }
+    glm::vec3 getVelocity(int i) const { return glm::vec3(_velX[i], _velY[i], _velZ[i]); }
+
+    void setGravity(const glm::vec3& gravity) { _gravity = gravity; }
+    void setRadius(float radius) { _radius = radius; }   // > 0 時以球體掃過（AABB 擴張 radius）
+    // 區塊由 pool 的執行緒處理（最多 setThreadCount 個），沒有設定 pool 時在呼叫端依序處理
+    void setThreadPool(CThreadPool* pool) { _pool = pool; }
+    void setThreadCount(int threads) { _threads = threads; }
+    int getThreadCount() const { return _threads; }
+
+private:
+    void updateBlock(int block, float dt, const CollisionManager& world);
+    void removeDead();
+    void sortByCell(int begin, int end);
+
+    int _capacity;
+    int _count = 0;
+    // SoA：每個陣列的第 i 個元素屬於投射物 i
+    std::vector<float> _posX, _posY, _posZ;
+    std::vector<float> _velX, _velY, _velZ;
+    std::vector<float> _life, _gravityScale;
+    std::vector<float> _clearance;   // 到最近碰撞體的距離下限，每一步減去移動的距離，0 表示需要做碰撞偵測
+    std::vector<uint32_t> _tag;
+    std::vector<uint8_t> _dead;
+    uint32_t _colliderVersion = 0;   // _clearance 對應的 CollisionManager::getColliderVersion()
+
+    // sortByCell 的暫存，以容量預先配置
+    std::vector<uint16_t> _sortKey;
+    std::vector<int> _sortOrder, _sortCount;
+    std::vector<float> _sortFloat;
+    std::vector<uint32_t> _sortTag;
+    int _sortSlice = 0;   // 下一次 update 排序的區段（_count 分成 PROJECTILE_SORT_INTERVAL 段），分散排序的時間
+
+    // 這一步需要做碰撞偵測的線段：方向為這一步的位移、maxT = 1，以容量預先配置，
+    // 每個區塊從自己的起點連續寫入，_testIndex 為對應的投射物
+    RayBatch _rays;
+    std::vector<int> _testIndex;
+    std::unique_ptr<RayBatchHits> _rayHits;
+    std::vector<std::vector<int>> _candidates;   // 每個區塊一個 raycastBatch 的暫存
+
+    CLockFreeQueue<ProjectileHit> _hits;
+    std::atomic<int> _droppedHits;
+
+    glm::vec3 _gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+    float _radius = 0.0f;
+    CThreadPool* _pool = nullptr;
+    int _threads;
+};
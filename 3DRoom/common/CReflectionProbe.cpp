@@ -0,0 +1,204 @@
+//  CReflectionProbe.cpp
+#include "CReflectionProbe.h"
+#include "CShaderPool.h"
+#include "CLight.h"
+#include "Model.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <iostream>
+
+CReflectionProbeManager::CReflectionProbeManager()
+    : _shader(0), _fbo(0), _modelLoc(-1), _viewProjLoc(-1),
+      _facesPerFrame(1), _minProjectedSize(0.02f), _nextProbe(0), _nextFace(0),
+      _initialized(false) {
+}
+
+CReflectionProbeManager::~CReflectionProbeManager() {
+    // GL 資源需由 release() 在 context 存在時釋放
+}
+
+void CReflectionProbeManager::init() {
+    _shader = CShaderPool::getInstance().getShader("probe_vtxshader.glsl", "probe_fragshader.glsl");
+    _modelLoc = glGetUniformLocation(_shader, "mxModel");
+    _viewProjLoc = glGetUniformLocation(_shader, "mxViewProj");
+    glUseProgram(_shader);
+    glUniform1i(glGetUniformLocation(_shader, "uDiffuseTexture"), 0);
+    glGenFramebuffers(1, &_fbo);
+    _initialized = true;
+}
+
+void CReflectionProbeManager::release() {
+    for (auto& probe : _probes) {
+        if (probe.cubeMap != 0) glDeleteTextures(1, &probe.cubeMap);
+        if (probe.depthBuffer != 0) glDeleteRenderbuffers(1, &probe.depthBuffer);
+        probe.cubeMap = probe.depthBuffer = 0;
+    }
+    if (_fbo != 0) glDeleteFramebuffers(1, &_fbo);
+    _fbo = 0;
+    _initialized = false;
+}
+
+int CReflectionProbeManager::addProbe(int ownerId, int resolution, float farPlane) {
+    if (!_initialized) return -1;
+
+    Probe probe;
+    probe.ownerId = ownerId;
+    probe.resolution = resolution;
+    probe.farPlane = farPlane;
+
+    glGenTextures(1, &probe.cubeMap);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, probe.cubeMap);
+    for (int f = 0; f < 6; f++) {
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, GL_RGB8, resolution, resolution, 0,
+                     GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    glGenRenderbuffers(1, &probe.depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, probe.depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, resolution, resolution);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    // 先清成黑色，f_phong 會忽略接近黑色的環境顏色，還沒輪到的面不會造成錯誤反射
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+    for (int f = 0; f < 6; f++) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, probe.cubeMap, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    _probes.push_back(probe);
+    return static_cast<int>(_probes.size()) - 1;
+}
+
+GLuint CReflectionProbeManager::getCubeMap(int probe) const {
+    if (probe < 0 || probe >= static_cast<int>(_probes.size())) return 0;
+    return _probes[probe].cubeMap;
+}
+
+void CReflectionProbeManager::setFacesPerFrame(int faces) {
+    _facesPerFrame = std::max(0, faces);
+}
+
+void CReflectionProbeManager::uploadLights(CLightManager& lightManager) {
+    int count = std::min(lightManager.getLightCount(), MAX_PROBE_LIGHTS);
+    glUniform1i(glGetUniformLocation(_shader, "uNumLights"), count);
+    for (int i = 0; i < count; i++) {
+        CLight* light = lightManager.getLight(i);
+        std::string idx = "[" + std::to_string(i) + "]";
+        glm::vec3 pos = light->getPos();
+        glm::vec4 diff = light->isLightOn() ? light->getDiffuse() : glm::vec4(0.0f);
+        glm::vec4 amb = light->isLightOn() ? light->getAmbient() : glm::vec4(0.0f);
+        float c, l, q;
+        light->getAttenuation(c, l, q);
+        glUniform3fv(glGetUniformLocation(_shader, ("uLightPos" + idx).c_str()), 1, glm::value_ptr(pos));
+        glUniform3fv(glGetUniformLocation(_shader, ("uLightDiffuse" + idx).c_str()), 1, glm::value_ptr(glm::vec3(diff)));
+        glUniform3fv(glGetUniformLocation(_shader, ("uLightAmbient" + idx).c_str()), 1, glm::value_ptr(glm::vec3(amb)));
+        glUniform3f(glGetUniformLocation(_shader, ("uLightAtten" + idx).c_str()), c, l, q);
+    }
+}
+
+void CReflectionProbeManager::renderFace(Probe& probe, int face, const std::vector<SceneObject>& objects) {
+    // 與 CShadowManager 相同的 cube map 面方向
+    static const glm::vec3 dirs[6] = {
+        glm::vec3( 1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3( 0.0f, 1.0f, 0.0f), glm::vec3( 0.0f,-1.0f, 0.0f),
+        glm::vec3( 0.0f, 0.0f, 1.0f), glm::vec3( 0.0f, 0.0f,-1.0f)
+    };
+    static const glm::vec3 ups[6] = {
+        glm::vec3(0.0f,-1.0f, 0.0f), glm::vec3(0.0f,-1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f,-1.0f),
+        glm::vec3(0.0f,-1.0f, 0.0f), glm::vec3(0.0f,-1.0f, 0.0f)
+    };
+    glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.05f, probe.farPlane);
+    glm::mat4 viewProj = proj * glm::lookAt(probe.position, probe.position + dirs[face], ups[face]);
+
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, probe.cubeMap, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, probe.depthBuffer);
+    glViewport(0, 0, probe.resolution, probe.resolution);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glUniformMatrix4fv(_viewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
+
+    for (const auto& obj : objects) {
+        if (obj.model == nullptr || obj.id == probe.ownerId) continue;
+        // 太小或不在這一面視錐內的物件略過
+        glm::vec3 center = (obj.worldMin + obj.worldMax) * 0.5f;
+        float radius = glm::length(obj.worldMax - obj.worldMin) * 0.5f;
+        float dist = glm::length(center - probe.position);
+        if ((dist > radius && radius / dist < _minProjectedSize) ||
+            !aabbInFrustum(viewProj, obj.worldMin, obj.worldMax)) {
+            _stats.objectsCulled++;
+            continue;
+        }
+        glUniformMatrix4fv(_modelLoc, 1, GL_FALSE, glm::value_ptr(obj.world));
+        obj.model->RenderProxy(_shader);
+        _stats.objectsDrawn++;
+    }
+}
+
+void CReflectionProbeManager::render(const std::vector<SceneObject>& objects, CLightManager& lightManager) {
+    _stats = ProbeStats();
+    if (!_initialized || _probes.empty()) return;
+
+    // 探針位置跟著所屬物件（世界 AABB 的中心）
+    for (auto& probe : _probes) {
+        for (const auto& obj : objects) {
+            if (obj.id == probe.ownerId) {
+                probe.position = (obj.worldMin + obj.worldMax) * 0.5f;
+                break;
+            }
+        }
+    }
+    if (_facesPerFrame == 0) return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint prevProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+    glUseProgram(_shader);
+    uploadLights(lightManager);
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+
+    // 所有探針共用預算，依序輪流，每個面更新的間隔為 (探針數 * 6 / 預算) 個 frame
+    int total = static_cast<int>(_probes.size()) * 6;
+    int faces = std::min(_facesPerFrame, total);
+    for (int n = 0; n < faces; n++) {
+        if (_nextProbe >= static_cast<int>(_probes.size())) _nextProbe = 0;
+        renderFace(_probes[_nextProbe], _nextFace, objects);
+        _stats.facesRendered++;
+        if (++_nextFace >= 6) {
+            _nextFace = 0;
+            _nextProbe++;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glUseProgram(prevProgram);
+}
+
+void CReflectionProbeManager::printStats() const {
+    std::cout << "Reflection probes: " << _probes.size() << " probes, budget "
+              << _facesPerFrame << " faces/frame" << std::endl;
+    std::cout << "  faces rendered: " << _stats.facesRendered
+              << ", objects drawn: " << _stats.objectsDrawn
+              << ", culled: " << _stats.objectsCulled << std::endl;
+}
@@ -0,0 +1,71 @@
+//  CReflectionProbe.h
+//  動態反射探針：從物件位置把場景描繪到 cube map，取代固定的環境貼圖
+//  所有探針共用「每個 frame 最多更新幾個面」的預算，依序輪流更新，
+//  因此不論探針數量多少，每個 frame 的描繪成本都是固定的
+
+#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "CLightManager.h"
+#include "SceneObject.h"
+
+#define MAX_PROBE_LIGHTS 8   // 需與 probe_fragshader.glsl 相同
+
+// 每個 frame 的探針統計
+struct ProbeStats {
+    int facesRendered = 0;   // 這個 frame 更新的面數
+    int objectsDrawn = 0;    // 描繪的物件數
+    int objectsCulled = 0;   // 被視錐或最小尺寸剔除的物件數
+};
+
+class CReflectionProbeManager {
+public:
+    CReflectionProbeManager();
+    ~CReflectionProbeManager();
+
+    void init();
+    void release();
+
+    // 新增探針，ownerId 為所屬物件在 SceneObject 中的 id（描繪時會略過自己）
+    // 回傳探針索引，失敗回傳 -1
+    int addProbe(int ownerId, int resolution = 128, float farPlane = 60.0f);
+    GLuint getCubeMap(int probe) const;
+
+    // 每個 frame 所有探針合計最多更新的面數（預設 1）
+    void setFacesPerFrame(int faces);
+    int  getFacesPerFrame() const { return _facesPerFrame; }
+    // 投影後半徑小於此比例（相對距離）的物件不描繪，以降低成本
+    void setMinProjectedSize(float size) { _minProjectedSize = size; }
+
+    // 探針跟著所屬物件移動，並依預算更新 cube map 的面
+    void render(const std::vector<SceneObject>& objects, CLightManager& lightManager);
+
+    const ProbeStats& getStats() const { return _stats; }
+    void printStats() const;
+
+private:
+    struct Probe {
+        int       ownerId = -1;
+        int       resolution = 128;
+        float     farPlane = 60.0f;
+        glm::vec3 position = glm::vec3(0.0f);
+        GLuint    cubeMap = 0;
+        GLuint    depthBuffer = 0;
+    };
+
+    void renderFace(Probe& probe, int face, const std::vector<SceneObject>& objects);
+    void uploadLights(CLightManager& lightManager);
+
+    std::vector<Probe> _probes;
+    GLuint _shader;
+    GLuint _fbo;
+    GLint  _modelLoc, _viewProjLoc;
+    int    _facesPerFrame;
+    float  _minProjectedSize;
+    int    _nextProbe, _nextFace;   // 下一個要更新的面
+    bool   _initialized;
+    ProbeStats _stats;
+};
@@ -0,0 +1,452 @@
+//  CRigidBodyPool.cpp
+#include "CRigidBodyPool.h"
+#include "CollisionManager.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#define RIGID_BODY_WORLD_MARGIN 0.05f      // 查詢牆壁時包圍盒向外擴張的距離，讓求解迭代中移動的物體也能找到接觸
+#define RIGID_BODY_PENETRATION_SLOP 0.005f // 允許的穿透深度，避免靜止接觸來回抖動
+#define RIGID_BODY_CORRECTION 0.8f         // 每次迭代修正的穿透比例
+#define RIGID_BODY_BOUNCE_SPEED 1.0f       // 接觸速度低於此值時不反彈，讓物體能靜止下來
+#define RIGID_BODY_RESERVED_CONTACTS 4     // 每個物體預先配置的配對與牆壁接觸數量，堆疊的碎片在步驟中不需要配置
+#define RIGID_BODY_RESERVED_QUERY 64       // 查詢牆壁與障礙物的暫存預先配置的數量
+
+// 球心 c、半徑 r 與方塊 [bmin, bmax] 的接觸，n 由球指向方塊
+static bool sphereBoxContact(const glm::vec3& c, float r, const glm::vec3& bmin, const glm::vec3& bmax,
+                             glm::vec3& n, float& depth) {
+    glm::vec3 d = glm::clamp(c, bmin, bmax) - c;
+    float dist2 = glm::dot(d, d);
+    if (dist2 > 1e-12f) {
+        if (dist2 >= r * r) return false;
+        float dist = std::sqrt(dist2);
+        n = d / dist;
+        depth = r - dist;
+        return true;
+    }
+    // 球心在方塊內：從最近的面推出去
+    glm::vec3 toMin = c - bmin, toMax = bmax - c;
+    int axis = 0;
+    float best = FLT_MAX, sign = 1.0f;
+    for (int k = 0; k < 3; ++k) {
+        if (toMin[k] < best) { best = toMin[k]; axis = k; sign = 1.0f; }
+        if (toMax[k] < best) { best = toMax[k]; axis = k; sign = -1.0f; }
+    }
+    n = glm::vec3(0.0f);
+    n[axis] = sign;
+    depth = best + r;
+    return true;
+}
+
+// 兩個方塊的接觸：取重疊最少的軸，n 由 a 指向 b
+static bool boxBoxContact(const glm::vec3& amin, const glm::vec3& amax, const glm::vec3& bmin, const glm::vec3& bmax,
+                          glm::vec3& n, float& depth) {
+    glm::vec3 overlap = glm::min(amax, bmax) - glm::max(amin, bmin);
+    if (overlap.x <= 0.0f || overlap.y <= 0.0f || overlap.z <= 0.0f) return false;
+    int axis = (overlap.x < overlap.y) ? ((overlap.x < overlap.z) ? 0 : 2) : ((overlap.y < overlap.z) ? 1 : 2);
+    n = glm::vec3(0.0f);
+    n[axis] = (bmin[axis] + bmax[axis] > amin[axis] + amax[axis]) ? 1.0f : -1.0f;
+    depth = overlap[axis];
+    return true;
+}
+
+CRigidBodyPool::CRigidBodyPool(int capacity) : _capacity(std::max(capacity, 1)) {
+    for (std::vector<float>* array : { &_posX, &_posY, &_posZ, &_velX, &_velY, &_velZ, &_prevX, &_prevY, &_prevZ,
+                                       &_halfX, &_halfY, &_halfZ,
+                                       &_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ,
+                                       &_invMass, &_restitution, &_friction, &_sleepTimer }) {
+        array->assign(_capacity, 0.0f);
+    }
+    _shape.assign(_capacity, 0);
+    _state.assign(_capacity, STATE_FREE);
+    _activeSlot.assign(_capacity, -1);
+    _sapRank.assign(_capacity, -1);
+    _active.reserve(_capacity);
+    _sap.reserve(_capacity);
+    _awake.reserve(_capacity);
+    _pairs.reserve(static_cast<size_t>(_capacity) * RIGID_BODY_RESERVED_CONTACTS);
+    _worldContacts.reserve(static_cast<size_t>(_capacity) * RIGID_BODY_RESERVED_CONTACTS);
+    _boxScratch.reserve(RIGID_BODY_RESERVED_QUERY);
+    _obbScratch.reserve(RIGID_BODY_RESERVED_QUERY);
+    clear();
+}
+
+void CRigidBodyPool::clear() {
+    std::fill(_state.begin(), _state.end(), STATE_FREE);
+    _freeList.resize(_capacity);
+    for (int i = 0; i < _capacity; ++i) _freeList[i] = _capacity - 1 - i;   // spawn 由編號 0 開始
+    _active.clear();
+    _sap.clear();
+    _sapDirty = false;
+    _maxWidthX = 0.0f;
+    _accumulator = 0.0f;
+    _stats = RigidBodyStats();
+}
+
+int CRigidBodyPool::spawn(const RigidBodyDesc& desc) {
+    if (_freeList.empty()) return -1;
+    int id = _freeList.back();
+    _freeList.pop_back();
+
+    glm::vec3 half = (desc.shape == RigidBodyShape::SPHERE) ? glm::vec3(desc.halfExtents.x) : desc.halfExtents;
+    _shape[id] = static_cast<uint8_t>(desc.shape);
+    _posX[id] = desc.position.x; _posY[id] = desc.position.y; _posZ[id] = desc.position.z;
+    _velX[id] = desc.velocity.x; _velY[id] = desc.velocity.y; _velZ[id] = desc.velocity.z;
+    _halfX[id] = half.x; _halfY[id] = half.y; _halfZ[id] = half.z;
+    _invMass[id] = (desc.mass > 0.0f) ? 1.0f / desc.mass : 0.0f;
+    _restitution[id] = desc.restitution;
+    _friction[id] = desc.friction;
+    _sleepTimer[id] = 0.0f;
+    _state[id] = STATE_AWAKE;
+    updateBounds(id);
+
+    _activeSlot[id] = static_cast<int>(_active.size());
+    _active.push_back(id);
+    _sapRank[id] = static_cast<int>(_sap.size());
+    _sap.push_back(SapEntry());   // 下一次 sortAxis 時填入包圍盒並插入到正確的位置
+    _sap.back().body = id;
+    _maxWidthX = std::max(_maxWidthX, 2.0f * half.x);
+    return id;
+}
+
+int CRigidBodyPool::spawnChunks(const glm::vec3& bmin, const glm::vec3& bmax, const glm::ivec3& divisions,
+                                const glm::vec3& origin, float speed, float density) {
+    glm::ivec3 count = glm::max(divisions, glm::ivec3(1));
+    glm::vec3 cell = (bmax - bmin) / glm::vec3(count);
+    RigidBodyDesc desc;
+    desc.shape = RigidBodyShape::BOX;
+    desc.halfExtents = cell * 0.45f;   // 碎片之間留一點空隙，一開始不互相重疊
+    desc.mass = std::max(density * cell.x * cell.y * cell.z, 1e-4f);
+    int spawned = 0;
+    for (int z = 0; z < count.z; ++z) {
+        for (int y = 0; y < count.y; ++y) {
+            for (int x = 0; x < count.x; ++x) {
+                desc.position = bmin + cell * (glm::vec3(x, y, z) + 0.5f);
+                glm::vec3 away = desc.position - origin;
+                float len = glm::length(away);
+                desc.velocity = (len > 1e-6f) ? away * (speed / len) : glm::vec3(0.0f, speed, 0.0f);
+                if (spawn(desc) < 0) return spawned;
+                spawned++;
+            }
+        }
+    }
+    return spawned;
+}
+
+void CRigidBodyPool::release(int body) {
+    if (body < 0 || body >= _capacity || _state[body] == STATE_FREE) return;
+    _state[body] = STATE_FREE;
+    int slot = _activeSlot[body];
+    int last = _active.back();
+    _active[slot] = last;
+    _activeSlot[last] = slot;
+    _active.pop_back();
+    _activeSlot[body] = -1;
+    _freeList.push_back(body);
+    _sapDirty = true;
+}
+
+void CRigidBodyPool::getBounds(int body, glm::vec3& bmin, glm::vec3& bmax) const {
+    bmin = glm::vec3(_minX[body], _minY[body], _minZ[body]);
+    bmax = glm::vec3(_maxX[body], _maxY[body], _maxZ[body]);
+}
+
+void CRigidBodyPool::updateBounds(int body) {
+    _minX[body] = _posX[body] - _halfX[body]; _maxX[body] = _posX[body] + _halfX[body];
+    _minY[body] = _posY[body] - _halfY[body]; _maxY[body] = _posY[body] + _halfY[body];
+    _minZ[body] = _posZ[body] - _halfZ[body]; _maxZ[body] = _posZ[body] + _halfZ[body];
+}
+
+void CRigidBodyPool::applyImpulse(int body, const glm::vec3& impulse) {
+    if (_state[body] == STATE_FREE) return;
+    wake(body);
+    _velX[body] += impulse.x * _invMass[body];
+    _velY[body] += impulse.y * _invMass[body];
+    _velZ[body] += impulse.z * _invMass[body];
+}
+
+void CRigidBodyPool::wake(int body) {
+    if (_state[body] != STATE_SLEEPING) return;
+    _state[body] = STATE_AWAKE;
+    _sleepTimer[body] = 0.0f;
+}
+
+int CRigidBodyPool::wakeInRadius(const glm::vec3& center, float radius) {
+    int woken = 0;
+    for (int body : _active) {
+        if (_state[body] != STATE_SLEEPING) continue;
+        glm::vec3 bmin, bmax;
+        getBounds(body, bmin, bmax);
+        glm::vec3 d = glm::clamp(center, bmin, bmax) - center;
+        if (glm::dot(d, d) <= radius * radius) {
+            wake(body);
+            woken++;
+        }
+    }
+    return woken;
+}
+
+void CRigidBodyPool::update(float dt, CollisionManager& world) {
+    _accumulator += std::min(dt, RIGID_BODY_TIME_STEP * RIGID_BODY_MAX_SUBSTEPS);
+    for (int steps = 0; _accumulator >= RIGID_BODY_TIME_STEP && steps < RIGID_BODY_MAX_SUBSTEPS; ++steps) {
+        step(RIGID_BODY_TIME_STEP, world);
+        _accumulator -= RIGID_BODY_TIME_STEP;
+    }
+}
+
+void CRigidBodyPool::step(float dt, CollisionManager& world) {
+    _awake.clear();
+    for (int body : _active) {
+        if (_state[body] == STATE_AWAKE) _awake.push_back(body);
+    }
+    _stats = RigidBodyStats();
+    _stats.active = static_cast<int>(_active.size());
+    if (_awake.empty()) return;   // 全部睡眠：不需要任何計算
+
+    // 半隱式 Euler：先更新速度再以新的速度移動
+    const float maxSpeed2 = RIGID_BODY_MAX_SPEED * RIGID_BODY_MAX_SPEED;
+    for (int body : _awake) {
+        glm::vec3 v = getVelocity(body) + _gravity * dt;
+        float speed2 = glm::dot(v, v);
+        if (speed2 > maxSpeed2) v *= RIGID_BODY_MAX_SPEED / std::sqrt(speed2);
+        _velX[body] = v.x; _velY[body] = v.y; _velZ[body] = v.z;
+        _prevX[body] = _posX[body]; _prevY[body] = _posY[body]; _prevZ[body] = _posZ[body];
+        _posX[body] += v.x * dt; _posY[body] += v.y * dt; _posZ[body] += v.z * dt;
+        updateBounds(body);
+    }
+
+    sortAxis();
+    collectPairs();
+    collectWorldContacts(world);
+    _stats.pairs = static_cast<int>(_pairs.size());
+
+    // 每次迭代以目前的位置重新計算接觸，牆壁的候選只在步驟開始時查詢一次
+    for (int iteration = 0; iteration < RIGID_BODY_SOLVER_ITERATIONS; ++iteration) {
+        glm::vec3 n;
+        float depth;
+        for (const auto& pair : _pairs) {
+            if (!pairContact(pair.first, pair.second, n, depth)) continue;
+            if (iteration == 0) _stats.contacts++;
+            resolve(pair.first, pair.second, n, depth);
+        }
+        for (const WorldContact& contact : _worldContacts) {
+            if (!worldContact(contact.body, contact.box, contact.obb, n, depth)) continue;
+            if (iteration == 0) _stats.worldContacts++;
+            resolve(contact.body, -1, n, depth);
+        }
+    }
+
+    // 被夾住的物體速度無法收斂，位置卻被修正回來：每個軸的速度不超過實際的位移，避免累積的假速度喚醒周圍的物體
+    for (int body : _awake) {
+        updateBounds(body);
+        glm::vec3 v = getVelocity(body);
+        glm::vec3 moved = (getPosition(body) - glm::vec3(_prevX[body], _prevY[body], _prevZ[body])) / dt;
+        for (int k = 0; k < 3; ++k) {
+            if (v[k] * moved[k] <= 0.0f) v[k] = 0.0f;
+            else if (std::fabs(moved[k]) < std::fabs(v[k])) v[k] = moved[k];
+        }
+        _velX[body] = v.x; _velY[body] = v.y; _velZ[body] = v.z;
+    }
+    updateSleep(dt);
+    _stats.awake = static_cast<int>(_awake.size());
+}
+
+void CRigidBodyPool::refreshSapEntry(int body) {
+    SapEntry& entry = _sap[_sapRank[body]];
+    entry.minX = _minX[body]; entry.maxX = _maxX[body];
+    entry.minY = _minY[body]; entry.maxY = _maxY[body];
+    entry.minZ = _minZ[body]; entry.maxZ = _maxZ[body];
+}
+
+void CRigidBodyPool::sortAxis() {
+    if (_sapDirty) {
+        _sap.erase(std::remove_if(_sap.begin(), _sap.end(),
+                                  [&](const SapEntry& entry) { return _state[entry.body] == STATE_FREE; }),
+                   _sap.end());
+        for (size_t i = 0; i < _sap.size(); ++i) _sapRank[_sap[i].body] = static_cast<int>(i);
+        _sapDirty = false;
+    }
+    // 睡眠中的物體不動，只需要更新未睡眠的物體，再以插入排序移到新的位置
+    for (int body : _awake) refreshSapEntry(body);
+    for (size_t i = 1; i < _sap.size(); ++i) {
+        if (_sap[i - 1].minX <= _sap[i].minX) continue;
+        SapEntry entry = _sap[i];
+        size_t j = i;
+        while (j > 0 && _sap[j - 1].minX > entry.minX) {
+            _sap[j] = _sap[j - 1];
+            _sapRank[_sap[j].body] = static_cast<int>(j);
+            j--;
+        }
+        _sap[j] = entry;
+        _sapRank[entry.body] = static_cast<int>(j);
+    }
+}
+
+// 只從未睡眠的物體出發掃描：往 minX 較大的方向找所有範圍重疊的物體，往較小的方向只找睡眠中的物體
+// （兩個都未睡眠的配對由 minX 較小的一方找到），花費與未睡眠的物體數成正比
+void CRigidBodyPool::collectPairs() {
+    _pairs.clear();
+    const int count = static_cast<int>(_sap.size());
+    const bool anySleeping = _awake.size() < _active.size();
+    for (int a : _awake) {
+        int rank = _sapRank[a];
+        const SapEntry& ea = _sap[rank];
+        // 以 & 而不是 && 組合比較，x 軸重疊的候選很多時避免分支預測失敗
+        auto overlapsYZ = [&](const SapEntry& eb) {
+            return (ea.minY <= eb.maxY) & (ea.maxY >= eb.minY) & (ea.minZ <= eb.maxZ) & (ea.maxZ >= eb.minZ);
+        };
+        for (int k = rank + 1; k < count && _sap[k].minX <= ea.maxX; ++k) {
+            if (overlapsYZ(_sap[k])) _pairs.push_back({ a, _sap[k].body });
+        }
+        if (!anySleeping) continue;
+        float reach = ea.minX - _maxWidthX;
+        for (int k = rank - 1; k >= 0 && _sap[k].minX >= reach; --k) {
+            const SapEntry& eb = _sap[k];
+            if ((eb.maxX >= ea.minX) & overlapsYZ(eb) && _state[eb.body] == STATE_SLEEPING) _pairs.push_back({ eb.body, a });
+        }
+    }
+}
+
+void CRigidBodyPool::findPairs(std::vector<std::pair<int, int>>& pairs) {
+    _awake.clear();
+    for (int body : _active) {
+        if (_state[body] == STATE_AWAKE) _awake.push_back(body);
+    }
+    sortAxis();
+    collectPairs();
+    pairs.clear();
+    for (const auto& pair : _pairs) pairs.push_back({ std::min(pair.first, pair.second), std::max(pair.first, pair.second) });
+    std::sort(pairs.begin(), pairs.end());
+}
+
+void CRigidBodyPool::collectWorldContacts(CollisionManager& world) {
+    _worldContacts.clear();
+    bool hasOriented = world.getOrientedObstacleCount() > 0;
+    AABB query;
+    for (int body : _awake) {
+        query.min = glm::vec3(_minX[body], _minY[body], _minZ[body]) - glm::vec3(RIGID_BODY_WORLD_MARGIN);
+        query.max = glm::vec3(_maxX[body], _maxY[body], _maxZ[body]) + glm::vec3(RIGID_BODY_WORLD_MARGIN);
+        _boxScratch.clear();
+        world.overlapAABB(query, _boxScratch);
+        for (const AABB* box : _boxScratch) _worldContacts.push_back({ body, box, nullptr });
+        if (!hasOriented) continue;
+        _obbScratch.clear();
+        float radius = glm::length(getHalfExtents(body)) + RIGID_BODY_WORLD_MARGIN;
+        world.overlapSphere(getPosition(body), radius, _obbScratch);
+        for (const OBB* obb : _obbScratch) _worldContacts.push_back({ body, nullptr, obb });
+    }
+}
+
+bool CRigidBodyPool::pairContact(int a, int b, glm::vec3& n, float& depth) const {
+    glm::vec3 pa = getPosition(a), pb = getPosition(b);
+    bool sphereA = _shape[a] == static_cast<uint8_t>(RigidBodyShape::SPHERE);
+    bool sphereB = _shape[b] == static_cast<uint8_t>(RigidBodyShape::SPHERE);
+    if (sphereA && sphereB) {
+        glm::vec3 d = pb - pa;
+        float dist2 = glm::dot(d, d), r = _halfX[a] + _halfX[b];
+        if (dist2 >= r * r) return false;
+        float dist = std::sqrt(dist2);
+        n = (dist > 1e-6f) ? d / dist : glm::vec3(0.0f, 1.0f, 0.0f);
+        depth = r - dist;
+        return true;
+    }
+    glm::vec3 ha = getHalfExtents(a), hb = getHalfExtents(b);
+    if (sphereA) return sphereBoxContact(pa, _halfX[a], pb - hb, pb + hb, n, depth);
+    if (sphereB) {
+        if (!sphereBoxContact(pb, _halfX[b], pa - ha, pa + ha, n, depth)) return false;
+        n = -n;
+        return true;
+    }
+    return boxBoxContact(pa - ha, pa + ha, pb - hb, pb + hb, n, depth);
+}
+
+bool CRigidBodyPool::worldContact(int body, const AABB* box, const OBB* obb, glm::vec3& n, float& depth) const {
+    glm::vec3 p = getPosition(body), h = getHalfExtents(body);
+    bool sphere = _shape[body] == static_cast<uint8_t>(RigidBodyShape::SPHERE);
+    if (box) {
+        if (sphere) return sphereBoxContact(p, _halfX[body], box->min, box->max, n, depth);
+        return boxBoxContact(p - h, p + h, box->min, box->max, n, depth);
+    }
+    // OBB：轉到 OBB 的區域座標，方塊物體以包住它的區域 AABB 近似
+    glm::vec3 local = obb->toLocal(p), localN;
+    bool hit;
+    if (sphere) {
+        hit = sphereBoxContact(local, _halfX[body], -obb->halfExtents, obb->halfExtents, localN, depth);
+    } else {
+        glm::vec3 localHalf;
+        for (int k = 0; k < 3; ++k) localHalf[k] = glm::dot(glm::abs(obb->axes[k]), h);
+        hit = boxBoxContact(local - localHalf, local + localHalf, -obb->halfExtents, obb->halfExtents, localN, depth);
+    }
+    if (hit) n = obb->toWorldDirection(localN);
+    return hit;
+}
+
+// 位置修正加上法向衝量（含反彈）與庫侖摩擦；睡眠中的物體視為靜止，被用力撞到時才喚醒
+void CRigidBodyPool::resolve(int a, int b, const glm::vec3& n, float depth) {
+    glm::vec3 va = getVelocity(a);
+    glm::vec3 vb = (b >= 0) ? getVelocity(b) : glm::vec3(0.0f);
+    float vn = glm::dot(vb - va, n);
+    if (b >= 0 && -vn > RIGID_BODY_WAKE_SPEED) {
+        for (int body : { a, b }) {
+            if (_state[body] != STATE_SLEEPING) continue;
+            wake(body);
+            _prevX[body] = _posX[body]; _prevY[body] = _posY[body]; _prevZ[body] = _posZ[body];
+            _awake.push_back(body);
+        }
+    }
+    float invA = (_state[a] == STATE_AWAKE) ? _invMass[a] : 0.0f;
+    float invB = (b >= 0 && _state[b] == STATE_AWAKE) ? _invMass[b] : 0.0f;
+    float invSum = invA + invB;
+    if (invSum <= 0.0f) return;
+
+    float correction = std::max(depth - RIGID_BODY_PENETRATION_SLOP, 0.0f) * RIGID_BODY_CORRECTION / invSum;
+    glm::vec3 pa = getPosition(a) - n * (correction * invA);
+    _posX[a] = pa.x; _posY[a] = pa.y; _posZ[a] = pa.z;
+    if (b >= 0) {
+        glm::vec3 pb = getPosition(b) + n * (correction * invB);
+        _posX[b] = pb.x; _posY[b] = pb.y; _posZ[b] = pb.z;
+    }
+
+    if (vn < 0.0f) {
+        float restitution = (b >= 0) ? std::max(_restitution[a], _restitution[b]) : _restitution[a];
+        float friction = (b >= 0) ? std::sqrt(_friction[a] * _friction[b]) : _friction[a];
+        float e = (-vn > RIGID_BODY_BOUNCE_SPEED) ? restitution : 0.0f;
+        float j = -(1.0f + e) * vn / invSum;
+        va -= n * (j * invA);
+        vb += n * (j * invB);
+
+        glm::vec3 vr = vb - va;
+        glm::vec3 vt = vr - n * glm::dot(vr, n);
+        float vtLength = glm::length(vt);
+        if (vtLength > 1e-6f) {
+            float jt = std::min(vtLength / invSum, friction * j);
+            glm::vec3 t = vt / vtLength;
+            va += t * (jt * invA);
+            vb -= t * (jt * invB);
+        }
+        _velX[a] = va.x; _velY[a] = va.y; _velZ[a] = va.z;
+        if (b >= 0) { _velX[b] = vb.x; _velY[b] = vb.y; _velZ[b] = vb.z; }
+    }
+}
+
+// 疊在一起的物體在有限的迭代次數內速度無法完全收斂，但位置修正讓它們實際上不動，所以以這一步的位移判斷
+void CRigidBodyPool::updateSleep(float dt) {
+    const float sleepDistance2 = RIGID_BODY_SLEEP_SPEED * RIGID_BODY_SLEEP_SPEED * dt * dt;
+    size_t kept = 0;
+    for (int body : _awake) {
+        glm::vec3 moved = getPosition(body) - glm::vec3(_prevX[body], _prevY[body], _prevZ[body]);
+        if (glm::dot(moved, moved) < sleepDistance2) {
+            _sleepTimer[body] += dt;
+            if (_sleepTimer[body] >= RIGID_BODY_SLEEP_TIME) {
+                _state[body] = STATE_SLEEPING;
+                _velX[body] = _velY[body] = _velZ[body] = 0.0f;
+                refreshSapEntry(body);
+                continue;
+            }
+        } else {
+            _sleepTimer[body] = 0.0f;
+        }
+        _awake[kept++] = body;
+    }
+    _awake.resize(kept);
+}
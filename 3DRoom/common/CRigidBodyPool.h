@@ -0,0 +1,139 @@
+//  CRigidBodyPool.h
+//  碎片等簡單剛體：固定容量的 SoA，sweep-and-prune 配對，只處理球與不旋轉的方塊，靜止後進入睡眠
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+class CollisionManager;
+struct AABB;
+struct OBB;
+
+#define RIGID_BODY_DEFAULT_CAPACITY 16384
+#define RIGID_BODY_TIME_STEP (1.0f / 60.0f)   // update 以固定的時間步長前進
+#define RIGID_BODY_MAX_SUBSTEPS 4             // 一次 update 最多的步數，畫面卡住時丟掉多出來的時間
+#define RIGID_BODY_SOLVER_ITERATIONS 4
+#define RIGID_BODY_SLEEP_SPEED 0.08f          // 一步的位移換算的速度低於此值持續 RIGID_BODY_SLEEP_TIME 秒就進入睡眠
+#define RIGID_BODY_SLEEP_TIME 0.5f
+#define RIGID_BODY_WAKE_SPEED 0.5f            // 以高於此值的相對速度撞上睡眠中的物體時喚醒它
+#define RIGID_BODY_MAX_SPEED 40.0f            // 限制速度，避免一步穿過牆壁
+
+enum class RigidBodyShape : uint8_t {
+    SPHERE,   // halfExtents.x 為半徑
+    BOX       // 軸對齊的方塊
+};
+
+struct RigidBodyDesc {
+    RigidBodyShape shape = RigidBodyShape::BOX;
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 velocity = glm::vec3(0.0f);
+    glm::vec3 halfExtents = glm::vec3(0.1f);
+    float mass = 1.0f;
+    float restitution = 0.2f;
+    float friction = 0.5f;
+};
+
+struct RigidBodyStats {
+    int active = 0;          // 使用中的物體
+    int awake = 0;           // 未睡眠的物體
+    int pairs = 0;           // broadphase 找到的配對
+    int contacts = 0;        // narrowphase 確認有接觸的配對
+    int worldContacts = 0;   // 與牆壁、障礙物的接觸
+};
+
+class CRigidBodyPool {
+public:
+    explicit CRigidBodyPool(int capacity = RIGID_BODY_DEFAULT_CAPACITY);
+
+    // 回傳物體編號，容量已滿時回傳 -1
+    int spawn(const RigidBodyDesc& desc);
+    // 把 [bmin, bmax] 切成 divisions 個方塊碎片，從 origin 向外以 speed 飛散，回傳實際產生的數量
+    int spawnChunks(const glm::vec3& bmin, const glm::vec3& bmax, const glm::ivec3& divisions,
+                    const glm::vec3& origin, float speed, float density = 1.0f);
+    void release(int body);
+    void clear();
+
+    // 累積 dt，以 RIGID_BODY_TIME_STEP 為單位呼叫 step
+    void update(float dt, CollisionManager& world);
+    void step(float dt, CollisionManager& world);
+
+    void applyImpulse(int body, const glm::vec3& impulse);
+    void wake(int body);
+    // 喚醒包圍盒與球體重疊的物體（例如支撐它們的家具被打壞時），回傳喚醒的數量
+    int wakeInRadius(const glm::vec3& center, float radius);
+
+    // 包圍盒重疊、至少一個未睡眠的配對（a < b），以目前的位置計算
+    void findPairs(std::vector<std::pair<int, int>>& pairs);
+
+    bool isActive(int body) const { return _state[body] != STATE_FREE; }
+    bool isSleeping(int body) const { return _state[body] == STATE_SLEEPING; }
+    RigidBodyShape getShape(int body) const { return static_cast<RigidBodyShape>(_shape[body]); }
+    glm::vec3 getPosition(int body) const { return glm::vec3(_posX[body], _posY[body], _posZ[body]); }
+    glm::vec3 getVelocity(int body) const { return glm::vec3(_velX[body], _velY[body], _velZ[body]); }
+    glm::vec3 getHalfExtents(int body) const { return glm::vec3(_halfX[body], _halfY[body], _halfZ[body]); }
+    void getBounds(int body, glm::vec3& bmin, glm::vec3& bmax) const;
+
+    int getCapacity() const { return _capacity; }
+    int getActiveCount() const { return static_cast<int>(_active.size()); }
+    const std::vector<int>& getActiveBodies() const { return _active; }
+    const RigidBodyStats& getStats() const { return _stats; }
+
+    void setGravity(const glm::vec3& gravity) { _gravity = gravity; }
+    const glm::vec3& getGravity() const { return _gravity; }
+
+private:
+    enum : uint8_t { STATE_FREE, STATE_AWAKE, STATE_SLEEPING };
+
+    void updateBounds(int body);
+    void refreshSapEntry(int body);
+    void sortAxis();
+    void collectPairs();
+    void collectWorldContacts(CollisionManager& world);
+    // 接觸法向量 n 由 a 指向 b，depth 為穿透深度；b < 0 表示靜止的牆壁
+    bool pairContact(int a, int b, glm::vec3& n, float& depth) const;
+    bool worldContact(int body, const AABB* box, const OBB* obb, glm::vec3& n, float& depth) const;
+    void resolve(int a, int b, const glm::vec3& n, float depth);
+    void updateSleep(float dt);
+
+    int _capacity;
+    // SoA：每個陣列的第 i 個元素屬於物體 i
+    std::vector<float> _posX, _posY, _posZ;
+    std::vector<float> _velX, _velY, _velZ;
+    std::vector<float> _prevX, _prevY, _prevZ;   // 步驟開始時的位置，以實際位移判斷是否靜止
+    std::vector<float> _halfX, _halfY, _halfZ;
+    std::vector<float> _minX, _minY, _minZ, _maxX, _maxY, _maxZ;
+    std::vector<float> _invMass, _restitution, _friction, _sleepTimer;
+    std::vector<uint8_t> _shape, _state;
+
+    std::vector<int> _freeList;
+    std::vector<int> _active;       // 使用中的物體
+    std::vector<int> _activeSlot;   // 物體在 _active 中的位置
+    // sweep-and-prune 的資料連續存放，掃描時不需要經由物體編號到各個陣列讀取
+    struct SapEntry {
+        float minX, maxX, minY, maxY, minZ, maxZ;
+        int body;
+        int padding;
+    };
+    std::vector<SapEntry> _sap;     // 依 minX 排序的使用中物體（每一步以插入排序維持，物體幾乎不動時接近線性）
+    std::vector<int> _sapRank;      // 物體在 _sap 中的位置
+    bool _sapDirty = false;         // release 後 _sap 有已釋放的物體
+    float _maxWidthX = 0.0f;        // 最寬的物體在 x 軸的寬度，決定向前掃描的範圍
+
+    struct WorldContact {
+        int body;
+        const AABB* box;
+        const OBB* obb;
+    };
+    std::vector<int> _awake;
+    std::vector<std::pair<int, int>> _pairs;
+    std::vector<WorldContact> _worldContacts;
+    std::vector<const AABB*> _boxScratch;
+    std::vector<const OBB*> _obbScratch;
+
+    glm::vec3 _gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+    float _accumulator = 0.0f;
+    RigidBodyStats _stats;
+};
@@ -0,0 +1,347 @@
+//  CShadowManager.cpp
+#include "CShadowManager.h"
+#include "CShaderPool.h"
+#include "Model.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+
+CShadowManager::CShadowManager()
+    : _depthShader(0), _fbo(0), _copyFbo(0),
+      _lightSpaceLoc(-1), _lightPosLoc(-1), _farPlaneLoc(-1), _modelLoc(-1),
+      _resolution(1024), _faceBudget(0), _nextLight(0), _numCubes(0), _numSpots(0),
+      _enabled(true), _initialized(false) {
+}
+
+CShadowManager::~CShadowManager() {
+    // 與 CLightManager 相同，GL 資源需由 release() 在 context 存在時釋放
+}
+
+void CShadowManager::init(int resolution) {
+    _resolution = resolution;
+    _depthShader = CShaderPool::getInstance().getShader("shadow_vtxshader.glsl", "shadow_fragshader.glsl");
+    _lightSpaceLoc = glGetUniformLocation(_depthShader, "uLightSpace");
+    _lightPosLoc = glGetUniformLocation(_depthShader, "uLightPos");
+    _farPlaneLoc = glGetUniformLocation(_depthShader, "uFarPlane");
+    _modelLoc = glGetUniformLocation(_depthShader, "mxModel");
+
+    glGenFramebuffers(1, &_fbo);
+    glGenFramebuffers(1, &_copyFbo);
+    _initialized = true;
+
+    for (auto& sl : _lights) createTextures(sl);
+}
+
+void CShadowManager::release() {
+    for (auto& sl : _lights) deleteTextures(sl);
+    if (_fbo != 0) glDeleteFramebuffers(1, &_fbo);
+    if (_copyFbo != 0) glDeleteFramebuffers(1, &_copyFbo);
+    _fbo = _copyFbo = 0;
+    _initialized = false;
+}
+
+bool CShadowManager::addLight(CLight* light) {
+    if (light == nullptr) return false;
+
+    ShadowLight sl;
+    sl.light = light;
+    sl.isPoint = (light->getType() == CLight::LightType::POINT);
+    if (sl.isPoint) {
+        if (_numCubes >= MAX_SHADOW_CUBES) return false;
+        sl.slot = _numCubes++;
+        sl.numFaces = 6;
+    } else {
+        if (_numSpots >= MAX_SHADOW_SPOTS) return false;
+        sl.slot = _numSpots++;
+        sl.numFaces = 1;
+    }
+    for (int f = 0; f < 6; f++) {
+        sl.staticDirty[f] = true;
+        sl.dynamicLastFrame[f] = false;
+    }
+    sl.range = computeLightRange(light);
+    updateLightMatrices(sl);
+    if (_initialized) createTextures(sl);
+    _lights.push_back(sl);
+    return true;
+}
+
+void CShadowManager::setResolution(int resolution) {
+    if (resolution == _resolution) return;
+    _resolution = resolution;
+    if (!_initialized) return;
+    // 重新配置所有貼圖，快取全部失效
+    for (auto& sl : _lights) {
+        deleteTextures(sl);
+        createTextures(sl);
+    }
+    invalidateAll();
+}
+
+void CShadowManager::setFaceBudget(int facesPerFrame) {
+    _faceBudget = std::max(0, facesPerFrame);
+}
+
+void CShadowManager::invalidateAll() {
+    for (auto& sl : _lights) {
+        for (int f = 0; f < 6; f++) sl.staticDirty[f] = true;
+    }
+}
+
+void CShadowManager::createTextures(ShadowLight& sl) {
+    GLuint tex[2];
+    glGenTextures(2, tex);
+    GLenum target = sl.isPoint ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    for (int t = 0; t < 2; t++) {
+        glBindTexture(target, tex[t]);
+        if (sl.isPoint) {
+            for (int f = 0; f < 6; f++) {
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, GL_DEPTH_COMPONENT24,
+                             _resolution, _resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+            }
+            glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24,
+                         _resolution, _resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        }
+        // 在 shader 中自行比較距離，所以使用 NEAREST 並關閉 compare mode
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+    }
+    glBindTexture(target, 0);
+    sl.staticTex = tex[0];
+    sl.liveTex = tex[1];
+    for (int f = 0; f < 6; f++) sl.staticDirty[f] = true;
+}
+
+void CShadowManager::deleteTextures(ShadowLight& sl) {
+    if (sl.staticTex != 0) glDeleteTextures(1, &sl.staticTex);
+    if (sl.liveTex != 0) glDeleteTextures(1, &sl.liveTex);
+    sl.staticTex = sl.liveTex = 0;
+}
+
+float CShadowManager::computeLightRange(CLight* light) const {
+    // 找出衰減後亮度小於 2% 的距離： c + l*d + q*d^2 = maxDiffuse / 0.02
+    float c, l, q;
+    light->getAttenuation(c, l, q);
+    glm::vec4 diff = light->getDiffuse();
+    float brightness = std::max(diff.r, std::max(diff.g, diff.b));
+    float target = brightness / 0.02f;
+    float range = 100.0f;
+    if (q > 0.0f) {
+        float disc = l * l - 4.0f * q * (c - target);
+        if (disc > 0.0f) range = (-l + std::sqrt(disc)) / (2.0f * q);
+    } else if (l > 0.0f) {
+        range = (target - c) / l;
+    }
+    return glm::clamp(range, 1.0f, 100.0f);
+}
+
+void CShadowManager::updateLightMatrices(ShadowLight& sl) {
+    glm::vec3 pos = sl.light->getPos();
+    if (sl.isPoint) {
+        // 標準 cube map 六個面的觀察方向與 up 向量
+        static const glm::vec3 dirs[6] = {
+            glm::vec3( 1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+            glm::vec3( 0.0f, 1.0f, 0.0f), glm::vec3( 0.0f,-1.0f, 0.0f),
+            glm::vec3( 0.0f, 0.0f, 1.0f), glm::vec3( 0.0f, 0.0f,-1.0f)
+        };
+        static const glm::vec3 ups[6] = {
+            glm::vec3(0.0f,-1.0f, 0.0f), glm::vec3(0.0f,-1.0f, 0.0f),
+            glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f,-1.0f),
+            glm::vec3(0.0f,-1.0f, 0.0f), glm::vec3(0.0f,-1.0f, 0.0f)
+        };
+        glm::mat4 proj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, sl.range);
+        for (int f = 0; f < 6; f++) {
+            sl.faceMatrix[f] = proj * glm::lookAt(pos, pos + dirs[f], ups[f]);
+        }
+    } else {
+        glm::vec3 dir = sl.light->getDirection();
+        glm::vec3 up = (std::fabs(dir.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        // 視角取外圈角度的兩倍再加一點邊界
+        float halfAngle = std::acos(glm::clamp(sl.light->getOuterCutOff(), -1.0f, 1.0f));
+        float fov = glm::clamp(2.0f * halfAngle + glm::radians(5.0f), glm::radians(10.0f), glm::radians(170.0f));
+        glm::mat4 proj = glm::perspective(fov, 1.0f, 0.1f, sl.range);
+        sl.faceMatrix[0] = proj * glm::lookAt(pos, pos + dir, up);
+        sl.lastDir = dir;
+    }
+    sl.lastPos = pos;
+}
+
+void CShadowManager::attachFace(GLuint fbo, const ShadowLight& sl, GLuint tex, int face) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    GLenum target = sl.isPoint ? (GLenum)(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face) : GL_TEXTURE_2D;
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target, tex, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+}
+
+void CShadowManager::renderFace(ShadowLight& sl, GLuint tex, int face,
+                                const std::vector<SceneObject>& objects, bool staticPass) {
+    attachFace(_fbo, sl, tex, face);
+    if (staticPass) glClear(GL_DEPTH_BUFFER_BIT);
+
+    glm::vec3 lightPos = sl.light->getPos();
+    glUniformMatrix4fv(_lightSpaceLoc, 1, GL_FALSE, glm::value_ptr(sl.faceMatrix[face]));
+    glUniform3fv(_lightPosLoc, 1, glm::value_ptr(lightPos));
+    glUniform1f(_farPlaneLoc, sl.range);
+
+    for (const auto& obj : objects) {
+        if (obj.model == nullptr || obj.isStatic != staticPass) continue;
+        if (!sphereOverlapsAABB(lightPos, sl.range, obj.worldMin, obj.worldMax)) continue;
+        if (!aabbInFrustum(sl.faceMatrix[face], obj.worldMin, obj.worldMax)) continue;
+        glUniformMatrix4fv(_modelLoc, 1, GL_FALSE, glm::value_ptr(obj.world));
+        obj.model->RenderDepth();
+    }
+}
+
+void CShadowManager::copyFace(ShadowLight& sl, int face) {
+    // 靜態快取 -> 實際取樣的貼圖（GL 3.3 沒有 glCopyImageSubData，改用 depth blit）
+    attachFace(_copyFbo, sl, sl.staticTex, face);
+    attachFace(_fbo, sl, sl.liveTex, face);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _copyFbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fbo);
+    glBlitFramebuffer(0, 0, _resolution, _resolution, 0, 0, _resolution, _resolution,
+                      GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+}
+
+void CShadowManager::render(const std::vector<SceneObject>& objects) {
+    _stats = ShadowStats();
+    if (!_initialized || !_enabled || _lights.empty()) return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint prevProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+
+    glUseProgram(_depthShader);
+    glViewport(0, 0, _resolution, _resolution);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+
+    int budget = (_faceBudget > 0) ? _faceBudget : INT_MAX;
+    int count = static_cast<int>(_lights.size());
+
+    for (int n = 0; n < count; n++) {
+        ShadowLight& sl = _lights[(_nextLight + n) % count];
+
+        // 光源移動（CLight::updateMotion）或聚光燈轉向時，整個靜態快取失效
+        glm::vec3 pos = sl.light->getPos();
+        bool moved = glm::length(pos - sl.lastPos) > 1e-4f;
+        if (!sl.isPoint) moved = moved || glm::length(sl.light->getDirection() - sl.lastDir) > 1e-4f;
+        if (moved) {
+            updateLightMatrices(sl);
+            for (int f = 0; f < 6; f++) sl.staticDirty[f] = true;
+        }
+
+        if (!sl.light->isLightOn()) {
+            _stats.facesReused += sl.numFaces;
+            continue;
+        }
+
+        for (int f = 0; f < sl.numFaces; f++) {
+            // 這一面是否有動態物件
+            bool dynamicNow = false;
+            for (const auto& obj : objects) {
+                if (obj.isStatic || obj.model == nullptr) continue;
+                if (sphereOverlapsAABB(pos, sl.range, obj.worldMin, obj.worldMax) &&
+                    aabbInFrustum(sl.faceMatrix[f], obj.worldMin, obj.worldMax)) {
+                    dynamicNow = true;
+                    break;
+                }
+            }
+
+            // 上一個 frame 有動態物件時也要更新，才能清掉舊的影子
+            bool needLive = sl.staticDirty[f] || dynamicNow || sl.dynamicLastFrame[f];
+            if (!needLive) {
+                _stats.facesReused++;
+                continue;
+            }
+            if (budget <= 0) {
+                // 預算用完，保留舊內容，狀態不變讓下一個 frame 繼續處理
+                _stats.facesDeferred++;
+                continue;
+            }
+            budget--;
+
+            if (sl.staticDirty[f]) {
+                renderFace(sl, sl.staticTex, f, objects, true);
+                sl.staticDirty[f] = false;
+                _stats.staticFacesRebuilt++;
+            }
+            copyFace(sl, f);
+            if (dynamicNow) renderFace(sl, sl.liveTex, f, objects, false);
+            sl.dynamicLastFrame[f] = dynamicNow;
+            _stats.facesRendered++;
+        }
+    }
+    // 下一個 frame 從下一個光源開始，預算不足時每個光源都能輪到
+    _nextLight = (_nextLight + 1) % count;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glUseProgram(prevProgram);
+}
+
+void CShadowManager::bindToShader(GLuint shaderProg, CLightManager& lightManager) {
+    glUseProgram(shaderProg);
+
+    for (int i = 0; i < MAX_SHADOW_CUBES; i++) {
+        std::string name = "uShadowCube[" + std::to_string(i) + "]";
+        glUniform1i(glGetUniformLocation(shaderProg, name.c_str()), SHADOW_TEXTURE_UNIT + i);
+    }
+    for (int i = 0; i < MAX_SHADOW_SPOTS; i++) {
+        std::string name = "uSpotShadowMap[" + std::to_string(i) + "]";
+        glUniform1i(glGetUniformLocation(shaderProg, name.c_str()), SHADOW_TEXTURE_UNIT + MAX_SHADOW_CUBES + i);
+    }
+
+    for (const auto& sl : _lights) {
+        if (sl.isPoint) {
+            glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT + sl.slot);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, sl.liveTex);
+        } else {
+            glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_UNIT + MAX_SHADOW_CUBES + sl.slot);
+            glBindTexture(GL_TEXTURE_2D, sl.liveTex);
+            std::string name = "uSpotShadowMatrix[" + std::to_string(sl.slot) + "]";
+            glUniformMatrix4fv(glGetUniformLocation(shaderProg, name.c_str()), 1, GL_FALSE,
+                               glm::value_ptr(sl.faceMatrix[0]));
+        }
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    // 每個 uLights[i] 對應到哪一張陰影貼圖
+    for (int i = 0; i < lightManager.getLightCount() && i < MAX_LIGHTS; i++) {
+        CLight* light = lightManager.getLight(i);
+        int shadowIndex = -1;
+        float farPlane = 1.0f;
+        for (const auto& sl : _lights) {
+            if (sl.light == light && sl.liveTex != 0) {
+                shadowIndex = sl.slot;
+                farPlane = sl.range;
+                break;
+            }
+        }
+        std::string lightName = "uLights[" + std::to_string(i) + "]";
+        glUniform1i(glGetUniformLocation(shaderProg, (lightName + ".shadowIndex").c_str()), shadowIndex);
+        glUniform1f(glGetUniformLocation(shaderProg, (lightName + ".shadowFar").c_str()), farPlane);
+    }
+    glUniform1i(glGetUniformLocation(shaderProg, "uShadowsEnabled"), (_enabled && _initialized) ? 1 : 0);
+}
+
+void CShadowManager::printStats() const {
+    std::cout << "Shadow maps: " << _lights.size() << " lights, " << _resolution << "x" << _resolution
+              << ", budget " << (_faceBudget > 0 ? std::to_string(_faceBudget) : std::string("unlimited"))
+              << " faces/frame" << std::endl;
+    std::cout << "  faces rendered: " << _stats.facesRendered
+              << " (static rebuilt: " << _stats.staticFacesRebuilt << ")"
+              << ", reused: " << _stats.facesReused
+              << ", deferred: " << _stats.facesDeferred << std::endl;
+}
@@ -0,0 +1,96 @@
+//  CShadowManager.h
+//  點光源使用 cube shadow map，聚光燈使用 2D shadow map
+//  靜態物件（房間、家具）描繪到快取的深度貼圖中，只有在光源移動時才重建；
+//  動態物件（跟著鏡頭的機器人、電風扇）進入某一面的範圍時，
+//  才把靜態快取複製到實際取樣的貼圖，再疊上動態物件
+
+#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "CLight.h"
+#include "CLightManager.h"
+#include "SceneObject.h"
+
+#define MAX_SHADOW_CUBES 6      // 需與 f_phong.glsl 相同
+#define MAX_SHADOW_SPOTS 2      // 需與 f_phong.glsl 相同
+#define SHADOW_TEXTURE_UNIT 6   // 0~5 由 Model::RenderMesh 使用
+
+// 每個 frame 的陰影統計
+struct ShadowStats {
+    int facesRendered = 0;      // 這個 frame 重新描繪的面數
+    int facesReused = 0;        // 內容不需要更新、直接沿用的面數（不含 facesDeferred）
+    int staticFacesRebuilt = 0; // 其中重建靜態快取的面數
+    int facesDeferred = 0;      // 需要更新但超出預算、暫時保留舊內容的面數
+};
+
+class CShadowManager {
+public:
+    CShadowManager();
+    ~CShadowManager();
+
+    // 建立 depth shader 與 FBO，resolution 為每一面的解析度
+    void init(int resolution = 1024);
+    void release();
+
+    // 加入投射陰影的光源（點光源最多 MAX_SHADOW_CUBES 個，聚光燈最多 MAX_SHADOW_SPOTS 個）
+    bool addLight(CLight* light);
+
+    // 解析度與每個 frame 的描繪預算
+    void setResolution(int resolution);
+    int  getResolution() const { return _resolution; }
+    void setFaceBudget(int facesPerFrame); // 0 = 不限制
+    int  getFaceBudget() const { return _faceBudget; }
+    void setEnabled(bool enable) { _enabled = enable; }
+    bool isEnabled() const { return _enabled; }
+
+    // 強制所有靜態快取重建（例如場景中的靜態物件被移動）
+    void invalidateAll();
+
+    // 更新陰影貼圖，需在主要描繪之前呼叫
+    void render(const std::vector<SceneObject>& objects);
+
+    // 綁定陰影貼圖並上傳 uniform 到主要 shader
+    void bindToShader(GLuint shaderProg, CLightManager& lightManager);
+
+    const ShadowStats& getStats() const { return _stats; }
+    void printStats() const;
+
+private:
+    struct ShadowLight {
+        CLight*   light = nullptr;
+        bool      isPoint = true;
+        int       slot = 0;            // cube slot 或 spot slot
+        int       numFaces = 6;        // 點光源 6 面，聚光燈 1 面
+        GLuint    staticTex = 0;       // 只含靜態物件的快取
+        GLuint    liveTex = 0;         // shader 實際取樣的貼圖
+        glm::vec3 lastPos = glm::vec3(0.0f);
+        glm::vec3 lastDir = glm::vec3(0.0f);
+        float     range = 50.0f;       // 光源影響範圍，也是 shadow 的 far plane
+        bool      staticDirty[6];
+        bool      dynamicLastFrame[6];
+        glm::mat4 faceMatrix[6];       // proj * view
+    };
+
+    void createTextures(ShadowLight& sl);
+    void deleteTextures(ShadowLight& sl);
+    void updateLightMatrices(ShadowLight& sl);
+    float computeLightRange(CLight* light) const;
+    void renderFace(ShadowLight& sl, GLuint tex, int face, const std::vector<SceneObject>& objects, bool staticPass);
+    void copyFace(ShadowLight& sl, int face);
+    void attachFace(GLuint fbo, const ShadowLight& sl, GLuint tex, int face);
+
+    std::vector<ShadowLight> _lights;
+    GLuint _depthShader;
+    GLuint _fbo, _copyFbo;
+    GLint  _lightSpaceLoc, _lightPosLoc, _farPlaneLoc, _modelLoc;
+    int    _resolution;
+    int    _faceBudget;
+    int    _nextLight;   // 預算不足時輪流處理的起點
+    int    _numCubes, _numSpots;
+    bool   _enabled;
+    bool   _initialized;
+    ShadowStats _stats;
+};
@@ -0,0 +1,68 @@
+//  CThreadPool.cpp
+#include "CThreadPool.h"
+
+CThreadPool::CThreadPool(int numThreads) : _next(0)
+{
+    int workers = std::max(1, numThreads) - 1;
+    _workers.reserve(workers);
+    for (int w = 0; w < workers; w++) _workers.emplace_back(&CThreadPool::workerLoop, this, w);
+}
+
+CThreadPool::~CThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& th : _workers) th.join();
+}
+
+void CThreadPool::run(int begin, int end, int grain, int helpers, Task task, void* context)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = task;
+        _context = context;
+        _end = end;
+        _grain = grain;
+        _next.store(begin);
+        _helpers = helpers;
+        _pending = helpers;
+        _generation++;
+    }
+    _wake.notify_all();
+    workChunks(); // 呼叫端的執行緒也一起工作
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this]() { return _pending == 0; });
+}
+
+void CThreadPool::workChunks()
+{
+    for (;;) {
+        int start = _next.fetch_add(_grain);
+        if (start >= _end) break;
+        int stop = std::min(start + _grain, _end);
+        for (int i = start; i < stop; i++) _task(_context, i);
+    }
+}
+
+void CThreadPool::workerLoop(int worker)
+{
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+            if (_stop) return;
+            seen = _generation;
+            if (worker >= _helpers) continue;
+        }
+        workChunks();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_pending == 0) _done.notify_one();
+        }
+    }
+}
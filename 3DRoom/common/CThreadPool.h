@@ -0,0 +1,63 @@
+//  CThreadPool.h
+//  建立一次、重複使用的工作執行緒，每個 frame 的 parallelFor 不建立執行緒也不配置記憶體
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class CThreadPool {
+public:
+    // numThreads 包含呼叫 parallelFor 的執行緒，另外建立 numThreads - 1 個工作執行緒
+    explicit CThreadPool(int numThreads);
+    ~CThreadPool();
+    CThreadPool(const CThreadPool&) = delete;
+    CThreadPool& operator=(const CThreadPool&) = delete;
+
+    int getThreadCount() const { return static_cast<int>(_workers.size()) + 1; }
+
+    // 與 CParallel.h 的 parallelFor 相同，numThreads 以 getThreadCount() 為上限
+    // 同一時間只能由一個執行緒呼叫，func 中不可再呼叫 parallelFor
+    template <typename Func>
+    void parallelFor(int begin, int end, int numThreads, int grain, Func&& func)
+    {
+        if (end <= begin) return;
+        grain = std::max(1, grain);
+        int chunks = (end - begin + grain - 1) / grain;
+        numThreads = std::max(1, std::min(std::min(numThreads, chunks), getThreadCount()));
+
+        if (numThreads == 1) {
+            for (int i = begin; i < end; i++) func(i);
+            return;
+        }
+        typedef typename std::remove_reference<Func>::type F;
+        run(begin, end, grain, numThreads - 1, [](void* context, int index) { (*static_cast<F*>(context))(index); },
+            const_cast<void*>(static_cast<const void*>(&func)));
+    }
+
+private:
+    typedef void (*Task)(void* context, int index);
+
+    void run(int begin, int end, int grain, int helpers, Task task, void* context);
+    void workChunks();
+    void workerLoop(int worker);
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake, _done;
+    uint64_t _generation = 0;
+    int _helpers = 0;          // 這一次參與的工作執行緒（編號小於 _helpers 的）
+    int _pending = 0;          // 還沒做完的工作執行緒
+    bool _stop = false;
+
+    Task _task = nullptr;
+    void* _context = nullptr;
+    int _end = 0, _grain = 1;
+    std::atomic<int> _next;
+};
@@ -0,0 +1,468 @@
+//  CTriangleBVH.cpp
+#include "CTriangleBVH.h"
+#include "CParallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#define BVH_LEAF_SIZE 4              // 三角形數不超過此值時一定是葉節點
+#define BVH_MAX_LEAF_SIZE 16         // SAH 認為不值得再切時，葉節點最多的三角形數
+#define BVH_SAH_BINS 16
+#define BVH_MAX_SAH_DEPTH 32         // 超過此深度改用中位數切開，限制樹的深度（走訪的 stack 大小）
+#define BVH_PARALLEL_MIN_TRIANGLES 4096  // 三角形數少於此值的子樹不再分給其他執行緒
+#define BVH_STACK_SIZE 64
+
+void CTriangleBVH::clear() {
+    _nodes.clear();
+    _triIndices.clear();
+    _v0.clear(); _e1.clear(); _e2.clear();
+}
+
+void CTriangleBVH::build(const std::vector<glm::vec3>& positions, const BVHBuildOptions& options) {
+    clear();
+    int triCount = static_cast<int>(positions.size() / 3);
+    if (triCount == 0) return;
+
+    BuildData data;
+    data.method = options.method;
+    data.centroids.resize(triCount);
+    data.triMin.resize(triCount);
+    data.triMax.resize(triCount);
+    _v0.resize(triCount); _e1.resize(triCount); _e2.resize(triCount);
+    for (int i = 0; i < triCount; i++) {
+        const glm::vec3& a = positions[3 * i + 0];
+        const glm::vec3& b = positions[3 * i + 1];
+        const glm::vec3& c = positions[3 * i + 2];
+        _v0[i] = a;
+        _e1[i] = b - a;
+        _e2[i] = c - a;
+        data.centroids[i] = (a + b + c) * (1.0f / 3.0f);
+        data.triMin[i] = glm::min(a, glm::min(b, c));
+        data.triMax[i] = glm::max(a, glm::max(b, c));
+    }
+    buildTree(data, options.threads > 0 ? options.threads : hardwareThreadCount());
+}
+
+void CTriangleBVH::build(const float* positions, size_t stride, const unsigned int* indices, size_t indexCount,
+                         const BVHBuildOptions& options) {
+    std::vector<glm::vec3> triangles(indexCount - indexCount % 3);
+    for (size_t i = 0; i < triangles.size(); i++) {
+        const float* p = positions + static_cast<size_t>(indices[i]) * stride;
+        triangles[i] = glm::vec3(p[0], p[1], p[2]);
+    }
+    build(triangles, options);
+}
+
+void CTriangleBVH::buildTree(BuildData& data, int threads) {
+    int triCount = static_cast<int>(_v0.size());
+    _triIndices.resize(triCount);
+    for (int i = 0; i < triCount; i++) _triIndices[i] = i;
+
+    _nodes.reserve(2 * triCount / BVH_LEAF_SIZE + 1);
+    Node root;
+    root.first = 0;
+    root.count = triCount;
+    _nodes.push_back(root);
+
+    // 上層在呼叫端切開，直到子樹數量足夠分給各個執行緒（每次切開最大的子樹）
+    struct Task { int node; int depth; };
+    std::vector<Task> tasks = { { 0, 0 } };
+    if (threads > 1) {
+        const size_t targetTasks = static_cast<size_t>(threads) * 4;
+        while (tasks.size() < targetTasks) {
+            size_t largest = 0;
+            for (size_t i = 1; i < tasks.size(); i++) {
+                if (_nodes[tasks[i].node].count > _nodes[tasks[largest].node].count) largest = i;
+            }
+            Task task = tasks[largest];
+            if (_nodes[task.node].count < BVH_PARALLEL_MIN_TRIANGLES) break;
+            if (!splitNode(_nodes, task.node, task.depth, data)) {
+                tasks.erase(tasks.begin() + largest);   // 成為葉節點
+                if (tasks.empty()) return;
+                continue;
+            }
+            int left = _nodes[task.node].first;
+            tasks[largest] = { left, task.depth + 1 };
+            tasks.push_back({ left + 1, task.depth + 1 });
+        }
+    }
+
+    // 每個子樹建立在自己的節點陣列中（三角形索引的範圍互不重疊），完成後再接到 _nodes 後面
+    std::vector<std::vector<Node>> subtrees(tasks.size());
+    parallelFor(0, static_cast<int>(tasks.size()), threads, 1, [&](int i) {
+        subtrees[i].push_back(_nodes[tasks[i].node]);
+        buildSubtree(subtrees[i], 0, tasks[i].depth, data);
+    });
+    for (size_t i = 0; i < tasks.size(); i++) {
+        // 子樹的節點 j（j >= 1）搬到 base + j - 1
+        int base = static_cast<int>(_nodes.size());
+        auto relocate = [base](Node node) {
+            if (node.count == 0) node.first = base + node.first - 1;
+            return node;
+        };
+        _nodes[tasks[i].node] = relocate(subtrees[i][0]);
+        for (size_t j = 1; j < subtrees[i].size(); j++) _nodes.push_back(relocate(subtrees[i][j]));
+    }
+}
+
+void CTriangleBVH::buildSubtree(std::vector<Node>& nodes, int nodeIndex, int depth, const BuildData& data) {
+    if (!splitNode(nodes, nodeIndex, depth, data)) return;
+    int left = nodes[nodeIndex].first;
+    buildSubtree(nodes, left, depth + 1, data);
+    buildSubtree(nodes, left + 1, depth + 1, data);
+}
+
+// 包圍盒表面積的一半（SAH 只需要比例）
+static inline float halfArea(const glm::vec3& bmin, const glm::vec3& bmax) {
+    glm::vec3 d = glm::max(bmax - bmin, glm::vec3(0.0f));
+    return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+bool CTriangleBVH::splitNode(std::vector<Node>& nodes, int nodeIndex, int depth, const BuildData& data) {
+    int first = nodes[nodeIndex].first;
+    int count = nodes[nodeIndex].count;
+
+    // 計算節點的包圍盒與中心點的範圍
+    glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX), cmin(FLT_MAX), cmax(-FLT_MAX);
+    for (int i = first; i < first + count; i++) {
+        int tri = _triIndices[i];
+        bmin = glm::min(bmin, data.triMin[tri]);
+        bmax = glm::max(bmax, data.triMax[tri]);
+        cmin = glm::min(cmin, data.centroids[tri]);
+        cmax = glm::max(cmax, data.centroids[tri]);
+    }
+    nodes[nodeIndex].bmin = bmin;
+    nodes[nodeIndex].bmax = bmax;
+    if (count <= BVH_LEAF_SIZE) return false;
+
+    glm::vec3 extent = cmax - cmin;
+    int mid = -1;
+    if (data.method == BVHSplitMethod::SAH && depth < BVH_MAX_SAH_DEPTH) {
+        // 三個軸各分成 BVH_SAH_BINS 個區間，找 Al * Nl + Ar * Nr 最小的切面
+        float bestCost = FLT_MAX;
+        int bestAxis = -1, bestBin = -1;
+        for (int axis = 0; axis < 3; axis++) {
+            if (extent[axis] <= 0.0f) continue;
+            float scale = BVH_SAH_BINS / extent[axis];
+            int binCount[BVH_SAH_BINS] = {};
+            glm::vec3 binMin[BVH_SAH_BINS], binMax[BVH_SAH_BINS];
+            for (int b = 0; b < BVH_SAH_BINS; b++) { binMin[b] = glm::vec3(FLT_MAX); binMax[b] = glm::vec3(-FLT_MAX); }
+            for (int i = first; i < first + count; i++) {
+                int tri = _triIndices[i];
+                int b = std::min(BVH_SAH_BINS - 1, static_cast<int>((data.centroids[tri][axis] - cmin[axis]) * scale));
+                binCount[b]++;
+                binMin[b] = glm::min(binMin[b], data.triMin[tri]);
+                binMax[b] = glm::max(binMax[b], data.triMax[tri]);
+            }
+            // 由右往左累計，再由左往右計算每個切面的成本
+            float rightArea[BVH_SAH_BINS];
+            int rightCount[BVH_SAH_BINS];
+            glm::vec3 rmin(FLT_MAX), rmax(-FLT_MAX);
+            int rc = 0;
+            for (int b = BVH_SAH_BINS - 1; b > 0; b--) {
+                rc += binCount[b];
+                if (binCount[b] > 0) { rmin = glm::min(rmin, binMin[b]); rmax = glm::max(rmax, binMax[b]); }
+                rightArea[b] = halfArea(rmin, rmax);
+                rightCount[b] = rc;
+            }
+            glm::vec3 lmin(FLT_MAX), lmax(-FLT_MAX);
+            int lc = 0;
+            for (int b = 0; b < BVH_SAH_BINS - 1; b++) {
+                lc += binCount[b];
+                if (binCount[b] > 0) { lmin = glm::min(lmin, binMin[b]); lmax = glm::max(lmax, binMax[b]); }
+                if (lc == 0 || rightCount[b + 1] == 0) continue;
+                float cost = halfArea(lmin, lmax) * lc + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+        // 切開的成本（走訪一個節點約等於測試一個三角形）不低於直接測試所有三角形時做成葉節點
+        float leafCost = halfArea(bmin, bmax) * count;
+        if (bestAxis >= 0 && bestCost + halfArea(bmin, bmax) >= leafCost && count <= BVH_MAX_LEAF_SIZE) return false;
+        if (bestAxis >= 0) {
+            float scale = BVH_SAH_BINS / extent[bestAxis];
+            float axisMin = cmin[bestAxis];
+            auto midIt = std::partition(_triIndices.begin() + first, _triIndices.begin() + first + count, [&](int tri) {
+                int b = std::min(BVH_SAH_BINS - 1, static_cast<int>((data.centroids[tri][bestAxis] - axisMin) * scale));
+                return b <= bestBin;
+            });
+            mid = static_cast<int>(midIt - _triIndices.begin());
+            if (mid == first || mid == first + count) mid = -1;
+        }
+    }
+    if (mid < 0) {
+        // 依中心點分佈最廣的軸，以中位數切成兩半
+        int axis = 0;
+        if (extent.y > extent.x) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+        if (extent[axis] <= 0.0f) return false;  // 所有中心點重疊，無法再切
+        mid = first + count / 2;
+        std::nth_element(_triIndices.begin() + first, _triIndices.begin() + mid, _triIndices.begin() + first + count,
+                         [&](int a, int b) { return data.centroids[a][axis] < data.centroids[b][axis]; });
+    }
+
+    Node left, right;
+    left.first = first;
+    left.count = mid - first;
+    right.first = mid;
+    right.count = first + count - mid;
+
+    int leftIndex = static_cast<int>(nodes.size());
+    nodes.push_back(left);
+    nodes.push_back(right);
+    nodes[nodeIndex].first = leftIndex;
+    nodes[nodeIndex].count = 0;
+    return true;
+}
+
+int CTriangleBVH::getDepth() const {
+    if (_nodes.empty()) return 0;
+    int depth = 0;
+    std::vector<std::pair<int, int>> stack = { { 0, 1 } };
+    while (!stack.empty()) {
+        auto [index, d] = stack.back();
+        stack.pop_back();
+        depth = std::max(depth, d);
+        if (_nodes[index].count == 0) {
+            stack.push_back({ _nodes[index].first, d + 1 });
+            stack.push_back({ _nodes[index].first + 1, d + 1 });
+        }
+    }
+    return depth;
+}
+
+bool CTriangleBVH::rayAABB(const glm::vec3& origin, const glm::vec3& invDir, float tMax,
+                           const glm::vec3& bmin, const glm::vec3& bmax, float& tNear) {
+    glm::vec3 t0 = (bmin - origin) * invDir;
+    glm::vec3 t1 = (bmax - origin) * invDir;
+    glm::vec3 tsmall = glm::min(t0, t1);
+    glm::vec3 tbig = glm::max(t0, t1);
+    float tmin = std::max(std::max(tsmall.x, tsmall.y), std::max(tsmall.z, 0.0f));
+    float tmax = std::min(std::min(tbig.x, tbig.y), std::min(tbig.z, tMax));
+    tNear = tmin;
+    return tmin <= tmax;
+}
+
+bool CTriangleBVH::rayTriangle(int tri, const glm::vec3& origin, const glm::vec3& dir, float tMax, BVHHit& hit) const {
+    // Möller-Trumbore，雙面
+    const glm::vec3& e1 = _e1[tri];
+    const glm::vec3& e2 = _e2[tri];
+    glm::vec3 p = glm::cross(dir, e2);
+    float det = glm::dot(e1, p);
+    if (std::fabs(det) < 1e-10f) return false;
+    float invDet = 1.0f / det;
+    glm::vec3 s = origin - _v0[tri];
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+    float t = glm::dot(e2, q) * invDet;
+    if (t <= 0.0f || t >= tMax) return false;
+    hit.t = t;
+    hit.u = u;
+    hit.v = v;
+    hit.triangle = tri;
+    return true;
+}
+
+static inline glm::vec3 safeInverse(const glm::vec3& d) {
+    return glm::vec3(d.x != 0.0f ? 1.0f / d.x : FLT_MAX,
+                     d.y != 0.0f ? 1.0f / d.y : FLT_MAX,
+                     d.z != 0.0f ? 1.0f / d.z : FLT_MAX);
+}
+
+bool CTriangleBVH::intersect(const glm::vec3& origin, const glm::vec3& dir, float tMax, BVHHit& hit) const {
+    if (_nodes.empty()) return false;
+    glm::vec3 invDir = safeInverse(dir);
+    bool found = false;
+    float closest = tMax;
+
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        const Node& node = _nodes[stack[--sp]];
+        float tNear;
+        if (!rayAABB(origin, invDir, closest, node.bmin, node.bmax, tNear)) continue;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                BVHHit h;
+                if (rayTriangle(_triIndices[i], origin, dir, closest, h)) {
+                    hit = h;
+                    closest = h.t;
+                    found = true;
+                }
+            }
+        } else if (sp + 2 <= BVH_STACK_SIZE) {
+            // 先走較近的子節點
+            float tl, tr;
+            bool hl = rayAABB(origin, invDir, closest, _nodes[node.first].bmin, _nodes[node.first].bmax, tl);
+            bool hr = rayAABB(origin, invDir, closest, _nodes[node.first + 1].bmin, _nodes[node.first + 1].bmax, tr);
+            if (hl && hr) {
+                if (tl < tr) { stack[sp++] = node.first + 1; stack[sp++] = node.first; }
+                else         { stack[sp++] = node.first;     stack[sp++] = node.first + 1; }
+            } else if (hl) {
+                stack[sp++] = node.first;
+            } else if (hr) {
+                stack[sp++] = node.first + 1;
+            }
+        }
+    }
+    return found;
+}
+
+bool CTriangleBVH::occluded(const glm::vec3& origin, const glm::vec3& dir, float tMax) const {
+    if (_nodes.empty()) return false;
+    glm::vec3 invDir = safeInverse(dir);
+
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        const Node& node = _nodes[stack[--sp]];
+        float tNear;
+        if (!rayAABB(origin, invDir, tMax, node.bmin, node.bmax, tNear)) continue;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                BVHHit h;
+                if (rayTriangle(_triIndices[i], origin, dir, tMax, h)) return true;
+            }
+        } else if (sp + 2 <= BVH_STACK_SIZE) {
+            stack[sp++] = node.first;
+            stack[sp++] = node.first + 1;
+        }
+    }
+    return false;
+}
+
+static inline float distance2ToAABB(const glm::vec3& p, const glm::vec3& bmin, const glm::vec3& bmax) {
+    glm::vec3 d = p - glm::clamp(p, bmin, bmax);
+    return glm::dot(d, d);
+}
+
+glm::vec3 CTriangleBVH::closestOnTriangle(int tri, const glm::vec3& p) const {
+    // Ericson, Real-Time Collision Detection 5.1.5：依 p 落在哪個 Voronoi 區域（頂點、邊、面）決定最近點
+    const glm::vec3& a = _v0[tri];
+    const glm::vec3& ab = _e1[tri];
+    const glm::vec3& ac = _e2[tri];
+    glm::vec3 ap = p - a;
+    float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+    glm::vec3 bp = ap - ab;
+    float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return a + ab;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+    glm::vec3 cp = ap - ac;
+    float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return a + ac;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return a + ab + (ac - ab) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+bool CTriangleBVH::closestPoint(const glm::vec3& center, float radius, BVHSphereHit& hit) const {
+    if (_nodes.empty()) return false;
+    float best2 = radius * radius;
+    bool found = false;
+
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        const Node& node = _nodes[stack[--sp]];
+        if (distance2ToAABB(center, node.bmin, node.bmax) >= best2) continue;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                int tri = _triIndices[i];
+                glm::vec3 q = closestOnTriangle(tri, center);
+                float d2 = glm::dot(q - center, q - center);
+                if (d2 < best2) {
+                    best2 = d2;
+                    hit.triangle = tri;
+                    hit.point = q;
+                    found = true;
+                }
+            }
+        } else if (sp + 2 <= BVH_STACK_SIZE) {
+            // 較近的子節點後放入，先走訪
+            float dl = distance2ToAABB(center, _nodes[node.first].bmin, _nodes[node.first].bmax);
+            float dr = distance2ToAABB(center, _nodes[node.first + 1].bmin, _nodes[node.first + 1].bmax);
+            if (dl < dr) { stack[sp++] = node.first + 1; stack[sp++] = node.first; }
+            else         { stack[sp++] = node.first;     stack[sp++] = node.first + 1; }
+        }
+    }
+    if (found) hit.distance = std::sqrt(best2);
+    return found;
+}
+
+void CTriangleBVH::querySphere(const glm::vec3& center, float radius, std::vector<int>& triangles) const {
+    if (_nodes.empty()) return;
+    float r2 = radius * radius;
+
+    int stack[BVH_STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        const Node& node = _nodes[stack[--sp]];
+        if (distance2ToAABB(center, node.bmin, node.bmax) >= r2) continue;
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++) {
+                int tri = _triIndices[i];
+                glm::vec3 q = closestOnTriangle(tri, center);
+                if (glm::dot(q - center, q - center) < r2) triangles.push_back(tri);
+            }
+        } else if (sp + 2 <= BVH_STACK_SIZE) {
+            stack[sp++] = node.first;
+            stack[sp++] = node.first + 1;
+        }
+    }
+}
+
+bool CTriangleBVH::intersectInstance(const glm::mat4& invWorld, const glm::vec3& origin, const glm::vec3& dir,
+                                     float tMax, BVHHit& hit) const {
+    // dir 不正規化：模型空間的 o + t * d 對應世界座標的 origin + t * dir
+    glm::vec3 o = glm::vec3(invWorld * glm::vec4(origin, 1.0f));
+    glm::vec3 d = glm::vec3(invWorld * glm::vec4(dir, 0.0f));
+    return intersect(o, d, tMax, hit);
+}
+
+bool CTriangleBVH::closestPointInstance(const glm::mat4& world, const glm::mat4& invWorld, const glm::vec3& center,
+                                        float radius, BVHSphereHit& hit) const {
+    // 世界座標半徑 radius 的球在模型空間最多延伸 radius / 最小縮放
+    float minScale = std::min(glm::length(glm::vec3(world[0])),
+                              std::min(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+    if (minScale <= 0.0f) return false;
+    glm::vec3 localCenter = glm::vec3(invWorld * glm::vec4(center, 1.0f));
+    BVHSphereHit local;
+    if (!closestPoint(localCenter, radius / minScale, local)) return false;
+
+    glm::vec3 point = glm::vec3(world * glm::vec4(local.point, 1.0f));
+    float distance = glm::length(point - center);
+    if (distance >= radius) return false;
+    hit.triangle = local.triangle;
+    hit.point = point;
+    hit.distance = distance;
+    return true;
+}
+
+glm::vec3 CTriangleBVH::getTriangleNormal(int triangle) const {
+    glm::vec3 n = glm::cross(_e1[triangle], _e2[triangle]);
+    float len = glm::length(n);
+    return len > 0.0f ? n / len : glm::vec3(0.0f, 1.0f, 0.0f);
+}
@@ -0,0 +1,97 @@
+//  CTriangleBVH.h
+//  三角形的 BVH（分箱 SAH），供 CPU 端的光線追蹤（Light Map 烘焙）與家具網格的精確查詢使用
+
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// 光線與三角形的交點
+struct BVHHit {
+    float t = 0.0f;         // 沿著光線的距離
+    int   triangle = -1;    // 三角形索引（build 時的順序）
+    float u = 0.0f, v = 0.0f; // 重心座標：p = (1-u-v)*v0 + u*v1 + v*v2
+};
+
+// 球體查詢的結果：離球心最近的三角形上的點
+struct BVHSphereHit {
+    float distance = 0.0f;  // 球心到 point 的距離
+    int   triangle = -1;
+    glm::vec3 point = glm::vec3(0.0f);
+};
+
+enum class BVHSplitMethod {
+    SAH,     // 分箱 SAH，查詢較快
+    MEDIAN   // 中心點範圍最大的軸取中位數（比較用）
+};
+
+struct BVHBuildOptions {
+    BVHSplitMethod method = BVHSplitMethod::SAH;
+    int threads = 0;        // 0：使用硬體執行緒數
+};
+
+class CTriangleBVH {
+public:
+    CTriangleBVH() = default;
+
+    // positions 每三個頂點為一個三角形
+    void build(const std::vector<glm::vec3>& positions, const BVHBuildOptions& options = BVHBuildOptions());
+    // 索引的網格（例如 Mesh::vertices / indices），相鄰兩個頂點的位置相差 stride 個 float
+    // 三角形索引為 indices 中的第幾個三角形
+    void build(const float* positions, size_t stride, const unsigned int* indices, size_t indexCount,
+               const BVHBuildOptions& options = BVHBuildOptions());
+    void clear();
+
+    // 最近的交點，找不到回傳 false
+    bool intersect(const glm::vec3& origin, const glm::vec3& dir, float tMax, BVHHit& hit) const;
+    // 只判斷 (0, tMax) 之間是否被遮擋（陰影光線），找到任何交點就提早結束
+    bool occluded(const glm::vec3& origin, const glm::vec3& dir, float tMax) const;
+
+    // 距離球心 radius 以內最近的三角形上的點，找不到回傳 false
+    bool closestPoint(const glm::vec3& center, float radius, BVHSphereHit& hit) const;
+    // 所有與球體重疊的三角形
+    void querySphere(const glm::vec3& center, float radius, std::vector<int>& triangles) const;
+
+    // 以 world 矩陣放置的實體：查詢時把射線或球體轉到模型空間，BVH 不需要重建
+    // 射線的 t 與 tMax 仍以世界座標的 dir 為單位；球體的半徑以 world 最小的縮放換算（等比例縮放時為精確值）
+    bool intersectInstance(const glm::mat4& invWorld, const glm::vec3& origin, const glm::vec3& dir, float tMax,
+                           BVHHit& hit) const;
+    bool closestPointInstance(const glm::mat4& world, const glm::mat4& invWorld, const glm::vec3& center,
+                              float radius, BVHSphereHit& hit) const;
+
+    // 模型空間的三角形法向量（v0 -> v1 -> v2 逆時針為正面）
+    glm::vec3 getTriangleNormal(int triangle) const;
+
+    int getTriangleCount() const { return static_cast<int>(_v0.size()); }
+    int getNodeCount() const { return static_cast<int>(_nodes.size()); }
+    int getDepth() const;
+
+private:
+    // 32 bytes：葉節點 count > 0，first 為 _triIndices 的起點；內部節點 count == 0，first 為左子節點
+    struct Node {
+        glm::vec3 bmin;
+        int       first;
+        glm::vec3 bmax;
+        int       count;
+    };
+    static_assert(sizeof(Node) == 32, "CTriangleBVH::Node must stay 32 bytes");
+
+    // 建立時使用的暫存資料
+    struct BuildData {
+        std::vector<glm::vec3> centroids;
+        std::vector<glm::vec3> triMin, triMax;
+        BVHSplitMethod method;
+    };
+
+    void buildTree(BuildData& data, int threads);
+    bool splitNode(std::vector<Node>& nodes, int nodeIndex, int depth, const BuildData& data);
+    void buildSubtree(std::vector<Node>& nodes, int nodeIndex, int depth, const BuildData& data);
+    bool rayTriangle(int tri, const glm::vec3& origin, const glm::vec3& dir, float tMax, BVHHit& hit) const;
+    glm::vec3 closestOnTriangle(int tri, const glm::vec3& p) const;
+    static bool rayAABB(const glm::vec3& origin, const glm::vec3& invDir, float tMax,
+                        const glm::vec3& bmin, const glm::vec3& bmax, float& tNear);
+
+    std::vector<Node> _nodes;
+    std::vector<int>  _triIndices;
+    std::vector<glm::vec3> _v0, _e1, _e2;   // 預先計算 Möller-Trumbore 需要的邊
+};
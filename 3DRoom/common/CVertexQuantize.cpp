@@ -0,0 +1,98 @@
+//  CVertexQuantize.cpp
+#include "CVertexQuantize.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+#define UNORM16_MAX 65535.0f
+#define SNORM10_MAX 511.0f
+
+uint16_t quantizeUnorm16(float value, float offset, float scale) {
+    if (scale <= 0.0f) return 0;
+    float q = std::round((value - offset) / scale * UNORM16_MAX);
+    return static_cast<uint16_t>(std::min(std::max(q, 0.0f), UNORM16_MAX));
+}
+
+} // namespace
+
+uint32_t CVertexQuantize::packNormal(const float normal[3]) {
+    uint32_t packed = 0;
+    for (int k = 0; k < 3; ++k) {
+        float q = std::round(std::min(std::max(normal[k], -1.0f), 1.0f) * SNORM10_MAX);
+        packed |= (static_cast<uint32_t>(static_cast<int32_t>(q)) & 0x3FFu) << (10 * k);
+    }
+    return packed;
+}
+
+void CVertexQuantize::unpackNormal(uint32_t packed, float normal[3]) {
+    for (int k = 0; k < 3; ++k) {
+        int32_t value = static_cast<int32_t>((packed >> (10 * k)) & 0x3FFu);
+        if (value & 0x200) value -= 0x400;   // 符號延伸
+        normal[k] = std::max(static_cast<float>(value) / SNORM10_MAX, -1.0f);
+    }
+}
+
+void CVertexQuantize::unpack(const PackedVertex& vertex, const VertexDecode& decode, float position[3], float normal[3],
+                             float texCoords[2]) {
+    for (int k = 0; k < 3; ++k) {
+        position[k] = vertex.position[k] / UNORM16_MAX * decode.positionScale[k] + decode.positionOffset[k];
+    }
+    unpackNormal(vertex.normal, normal);
+    for (int k = 0; k < 2; ++k) {
+        texCoords[k] = vertex.texCoords[k] / UNORM16_MAX * decode.texCoordScaleOffset[k] + decode.texCoordScaleOffset[2 + k];
+    }
+}
+
+QuantizeError CVertexQuantize::pack(const float* vertices, size_t vertexCount, size_t stride, size_t normalOffset,
+                                    size_t texCoordOffset, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                                    std::vector<PackedVertex>& packed, VertexDecode& decode) {
+    decode = VertexDecode();
+    decode.positionScale[3] = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        decode.positionScale[k] = std::max(boundsMax[k] - boundsMin[k], 0.0f);
+        decode.positionOffset[k] = boundsMin[k];
+    }
+    float uvMin[2] = { FLT_MAX, FLT_MAX }, uvMax[2] = { -FLT_MAX, -FLT_MAX };
+    for (size_t v = 0; v < vertexCount; ++v) {
+        for (int k = 0; k < 2; ++k) {
+            uvMin[k] = std::min(uvMin[k], vertices[v * stride + texCoordOffset + k]);
+            uvMax[k] = std::max(uvMax[k], vertices[v * stride + texCoordOffset + k]);
+        }
+    }
+    for (int k = 0; k < 2; ++k) {
+        decode.texCoordScaleOffset[k] = vertexCount > 0 ? uvMax[k] - uvMin[k] : 0.0f;
+        decode.texCoordScaleOffset[2 + k] = vertexCount > 0 ? uvMin[k] : 0.0f;
+    }
+
+    QuantizeError error;
+    packed.resize(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* source = vertices + v * stride;
+        PackedVertex& out = packed[v];
+        for (int k = 0; k < 3; ++k) {
+            out.position[k] = quantizeUnorm16(source[k], decode.positionOffset[k], decode.positionScale[k]);
+        }
+        out.position[3] = 0;
+        out.normal = packNormal(source + normalOffset);
+        for (int k = 0; k < 2; ++k) {
+            out.texCoords[k] = quantizeUnorm16(source[texCoordOffset + k], decode.texCoordScaleOffset[2 + k],
+                                               decode.texCoordScaleOffset[k]);
+        }
+
+        float position[3], normal[3], texCoords[2];
+        unpack(out, decode, position, normal, texCoords);
+        for (int k = 0; k < 3; ++k) error.position = std::max(error.position, std::fabs(position[k] - source[k]));
+        for (int k = 0; k < 2; ++k) {
+            error.texCoord = std::max(error.texCoord, std::fabs(texCoords[k] - source[texCoordOffset + k]));
+        }
+        glm::vec3 n(source[normalOffset], source[normalOffset + 1], source[normalOffset + 2]);
+        glm::vec3 decoded(normal[0], normal[1], normal[2]);
+        if (glm::length(n) > 0.0f && glm::length(decoded) > 0.0f) {
+            float c = glm::dot(glm::normalize(n), glm::normalize(decoded));
+            error.normalDegrees = std::max(error.normalDegrees, glm::degrees(std::acos(std::min(c, 1.0f))));
+        }
+    }
+    return error;
+}
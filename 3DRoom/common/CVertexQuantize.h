@@ -0,0 +1,58 @@
+//  CVertexQuantize.h
+//  16 bytes 的壓縮頂點格式：位置與貼圖座標為 unorm16，法向量為 10:10:10:2
+//  shader 以 VERTEX_DECODE_LOCATION 的屬性還原，float 頂點的 VAO 讀到預設值 (0,0,0,1)，維持原本的值
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#define VERTEX_DECODE_LOCATION 8        // 8：vec4 位置的 scale（w 為 0），9：vec3 位置的 offset，10：vec4 UV 的 scale / offset
+#define VERTEX_QUANTIZE_MAX_POSITION_ERROR 0.001f        // 超過時改用 float 頂點（模型空間的單位）
+#define VERTEX_QUANTIZE_MAX_TEXCOORD_ERROR (1.0f / 8192.0f)
+
+enum class VertexFormat {
+    FLOAT,        // Vertex（32 bytes）
+    QUANTIZED     // PackedVertex（16 bytes）
+};
+
+struct PackedVertex {
+    uint16_t position[4];     // unorm16，w 不使用
+    uint32_t normal;          // snorm 10:10:10，最高的 2 bits 不使用
+    uint16_t texCoords[2];    // unorm16
+};
+
+// 一個網格的還原參數，依序對應 VERTEX_DECODE_LOCATION 開始的三個屬性
+struct VertexDecode {
+    float positionScale[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float positionOffset[3] = { 0.0f, 0.0f, 0.0f };
+    float texCoordScaleOffset[4] = { 1.0f, 1.0f, 0.0f, 0.0f };
+};
+
+// 量化前後的最大差異
+struct QuantizeError {
+    float position = 0.0f;
+    float normalDegrees = 0.0f;
+    float texCoord = 0.0f;
+};
+
+class CVertexQuantize {
+public:
+    // vertices 每個頂點 stride 個 float，位置在最前面，法向量與貼圖座標在 normalOffset、texCoordOffset
+    // 位置以 [boundsMin, boundsMax] 量化（同一個模型的網格使用模型的包圍盒，共用的頂點還原後仍然相同，不會出現裂縫）
+    static QuantizeError pack(const float* vertices, size_t vertexCount, size_t stride, size_t normalOffset,
+                              size_t texCoordOffset, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+                              std::vector<PackedVertex>& packed, VertexDecode& decode);
+    static bool acceptable(const QuantizeError& error) {
+        return error.position <= VERTEX_QUANTIZE_MAX_POSITION_ERROR && error.texCoord <= VERTEX_QUANTIZE_MAX_TEXCOORD_ERROR;
+    }
+
+    // 與 shader 相同的還原（法向量不正規化）
+    static void unpack(const PackedVertex& vertex, const VertexDecode& decode, float position[3], float normal[3],
+                       float texCoords[2]);
+
+    static uint32_t packNormal(const float normal[3]);
+    static void unpackNormal(uint32_t packed, float normal[3]);
+};
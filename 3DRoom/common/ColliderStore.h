@@ -0,0 +1,125 @@
+#ifndef COLLIDER_STORE_H
+#define COLLIDER_STORE_H
+
+// AABB 的 SoA 儲存：min / max 的每個分量各一個陣列，長度補齊為 4 的倍數，
+// 一次以 SIMD 測試一個球體或 AABB 與 4 個 AABB，結果為每 4 個一組的命中位元（bit i 對應第 i 個）
+// 只儲存範圍，牆壁名稱等資料仍由 CollisionManager 的 AABB 保存，以索引對應
+// 補齊用的空盒子 min = FLT_MAX、max = -FLT_MAX，不會與任何東西重疊
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "SimdMath.h"
+
+class ColliderStore {
+public:
+    void clear() {
+        minX.clear(); minY.clear(); minZ.clear();
+        maxX.clear(); maxY.clear(); maxZ.clear();
+        _count = 0;
+    }
+
+    void reserve(size_t count) {
+        size_t padded = (count + 3) & ~size_t(3);
+        minX.reserve(padded); minY.reserve(padded); minZ.reserve(padded);
+        maxX.reserve(padded); maxY.reserve(padded); maxZ.reserve(padded);
+    }
+
+    // 加入一個 AABB，回傳它的索引
+    size_t add(const glm::vec3& bmin, const glm::vec3& bmax) {
+        if (_count == minX.size()) pushBlock();
+        minX[_count] = bmin.x; minY[_count] = bmin.y; minZ[_count] = bmin.z;
+        maxX[_count] = bmax.x; maxY[_count] = bmax.y; maxZ[_count] = bmax.z;
+        return _count++;
+    }
+
+    // 加入一個空位（不會命中），用來讓下一個 AABB 從新的一組開始
+    void addEmpty() {
+        if (_count == minX.size()) pushBlock();
+        _count++;
+    }
+
+    size_t size() const { return _count; }
+    size_t blockCount() const { return minX.size() / 4; }
+    glm::vec3 getMin(size_t i) const { return glm::vec3(minX[i], minY[i], minZ[i]); }
+    glm::vec3 getMax(size_t i) const { return glm::vec3(maxX[i], maxY[i], maxZ[i]); }
+
+    // 第 block 組的 4 個 AABB 與球體（與 Sphere::intersects 相同：距離 < 半徑）
+    // 球心與半徑平方先以 Float4::set1 展開，查詢多組時不必重複
+    int sphereMask(size_t block, Float4 cx, Float4 cy, Float4 cz, Float4 r2) const {
+        size_t i = block * 4;
+        Float4 dx = cx - min4(max4(cx, Float4::load(&minX[i])), Float4::load(&maxX[i]));
+        Float4 dy = cy - min4(max4(cy, Float4::load(&minY[i])), Float4::load(&maxY[i]));
+        Float4 dz = cz - min4(max4(cz, Float4::load(&minZ[i])), Float4::load(&maxZ[i]));
+        return ((dx * dx + dy * dy + dz * dz) < r2).bits();
+    }
+
+    // 第 block 組的 4 個 AABB 到點的距離平方（在盒內為 0，補齊的空盒子為無限大）
+    Float4 distance2(size_t block, Float4 px, Float4 py, Float4 pz) const {
+        size_t i = block * 4;
+        Float4 zero = Float4::set1(0.0f);
+        Float4 dx = max4(max4(Float4::load(&minX[i]) - px, px - Float4::load(&maxX[i])), zero);
+        Float4 dy = max4(max4(Float4::load(&minY[i]) - py, py - Float4::load(&maxY[i])), zero);
+        Float4 dz = max4(max4(Float4::load(&minZ[i]) - pz, pz - Float4::load(&maxZ[i])), zero);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // 第 block 組的 4 個 AABB 與 [qmin, qmax]（與 AABB::intersects 相同，邊界相接也算）
+    int aabbMask(size_t block, Float4 qminX, Float4 qminY, Float4 qminZ,
+                 Float4 qmaxX, Float4 qmaxY, Float4 qmaxZ) const {
+        size_t i = block * 4;
+        Mask4 x = (Float4::load(&minX[i]) <= qmaxX) & (qminX <= Float4::load(&maxX[i]));
+        Mask4 y = (Float4::load(&minY[i]) <= qmaxY) & (qminY <= Float4::load(&maxY[i]));
+        Mask4 z = (Float4::load(&minZ[i]) <= qmaxZ) & (qminZ <= Float4::load(&maxZ[i]));
+        return (x & y & z).bits();
+    }
+
+    // 一個球體與所有 AABB，masks[block] 為每組的命中位元，回傳命中總數
+    int overlapSphere(const glm::vec3& center, float radius, std::vector<uint8_t>& masks) const {
+        Float4 cx = Float4::set1(center.x), cy = Float4::set1(center.y), cz = Float4::set1(center.z);
+        Float4 r2 = Float4::set1(radius * radius);
+        masks.resize(blockCount());
+        int hits = 0;
+        for (size_t block = 0; block < masks.size(); ++block) {
+            int mask = sphereMask(block, cx, cy, cz, r2);
+            masks[block] = static_cast<uint8_t>(mask);
+            hits += popcount4(mask);
+        }
+        return hits;
+    }
+
+    // 一個 AABB 與所有 AABB，masks 同上
+    int overlapAABB(const glm::vec3& qmin, const glm::vec3& qmax, std::vector<uint8_t>& masks) const {
+        Float4 qminX = Float4::set1(qmin.x), qminY = Float4::set1(qmin.y), qminZ = Float4::set1(qmin.z);
+        Float4 qmaxX = Float4::set1(qmax.x), qmaxY = Float4::set1(qmax.y), qmaxZ = Float4::set1(qmax.z);
+        masks.resize(blockCount());
+        int hits = 0;
+        for (size_t block = 0; block < masks.size(); ++block) {
+            int mask = aabbMask(block, qminX, qminY, qminZ, qmaxX, qmaxY, qmaxZ);
+            masks[block] = static_cast<uint8_t>(mask);
+            hits += popcount4(mask);
+        }
+        return hits;
+    }
+
+    static int popcount4(int mask) {
+        return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+    }
+
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+private:
+    void pushBlock() {
+        for (int i = 0; i < 4; ++i) {
+            minX.push_back(FLT_MAX); minY.push_back(FLT_MAX); minZ.push_back(FLT_MAX);
+            maxX.push_back(-FLT_MAX); maxY.push_back(-FLT_MAX); maxZ.push_back(-FLT_MAX);
+        }
+    }
+
+    size_t _count = 0;
+};
+
+#endif // COLLIDER_STORE_H
@@ -0,0 +1,410 @@
+#ifndef COLLISION_BVH_H
+#define COLLISION_BVH_H
+
+// 碰撞用的 AABB 層次包圍盒（BVH）
+// CollisionManager 的牆壁與障礙物各建一棵，查詢時只需檢查與查詢範圍重疊的節點，
+// 取代逐一掃描所有 AABB。只儲存索引，AABB 本身仍由 CollisionManager 保存
+// 葉節點最多 4 個 AABB，建立後依葉節點的順序複製到 ColliderStore（SoA），每個葉節點剛好是一組，
+// 球體與 AABB 查詢在葉節點只需一次 SIMD 測試
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ColliderStore.h"
+#include "SimdMath.h"
+
+#define COLLISION_BVH_LEAF_SIZE 4   // 必須是 4：每個葉節點對應 ColliderStore 的一組
+
+// 批次射線（SoA：每個分量一個陣列，每次以 SIMD 處理 4 條）
+struct RayBatch {
+    std::vector<float> ox, oy, oz;
+    std::vector<float> dx, dy, dz;
+    std::vector<float> maxT;
+
+    void add(const glm::vec3& origin, const glm::vec3& dir, float maxDistance) {
+        ox.push_back(origin.x); oy.push_back(origin.y); oz.push_back(origin.z);
+        dx.push_back(dir.x); dy.push_back(dir.y); dz.push_back(dir.z);
+        maxT.push_back(maxDistance);
+    }
+    void clear() {
+        ox.clear(); oy.clear(); oz.clear();
+        dx.clear(); dy.clear(); dz.clear();
+        maxT.clear();
+    }
+    size_t size() const { return ox.size(); }
+    glm::vec3 origin(size_t i) const { return glm::vec3(ox[i], oy[i], oz[i]); }
+    glm::vec3 direction(size_t i) const { return glm::vec3(dx[i], dy[i], dz[i]); }
+};
+
+class CollisionBVH {
+public:
+    struct Node {
+        glm::vec3 bmin, bmax;
+        int first;   // 葉節點：_indices 中的起點（4 的倍數）；內部節點：左子節點（右子節點為 first + 1）
+        int count;   // 葉節點的 AABB 數量，0 表示內部節點
+    };
+
+    // boxMin / boxMax 為每個 AABB 的範圍，需要有相同長度
+    void build(const std::vector<glm::vec3>& boxMin, const std::vector<glm::vec3>& boxMax) {
+        _boxMin = boxMin;
+        _boxMax = boxMax;
+        _nodes.clear();
+        _indices.resize(boxMin.size());
+        for (size_t i = 0; i < _indices.size(); ++i) _indices[i] = static_cast<int>(i);
+        if (_indices.empty()) return;
+
+        _nodes.reserve(_indices.size() * 2);
+        _nodes.push_back(Node());
+        buildNode(0, 0, static_cast<int>(_indices.size()));
+        layoutLeaves();
+    }
+
+    void clear() {
+        _nodes.clear();
+        _indices.clear();
+        _boxMin.clear();
+        _boxMax.clear();
+        _leafBoxes.clear();
+    }
+
+    bool empty() const { return _nodes.empty(); }
+    size_t getNodeCount() const { return _nodes.size(); }
+
+    // 回傳第一個與球體重疊的 AABB 索引，沒有則回傳 -1
+    int firstSphereOverlap(const glm::vec3& center, float radius) const {
+        int found = -1;
+        visitSphere(center, radius, [&](int index) { found = index; return false; });
+        return found;
+    }
+
+    // 所有與球體重疊的 AABB 索引
+    void querySphere(const glm::vec3& center, float radius, std::vector<int>& out) const {
+        visitSphere(center, radius, [&](int index) { out.push_back(index); return true; });
+    }
+
+    // 所有與 AABB 重疊的 AABB 索引
+    void queryAABB(const glm::vec3& qmin, const glm::vec3& qmax, std::vector<int>& out) const {
+        if (_nodes.empty()) return;
+        Float4 qminX = Float4::set1(qmin.x), qminY = Float4::set1(qmin.y), qminZ = Float4::set1(qmin.z);
+        Float4 qmaxX = Float4::set1(qmax.x), qmaxY = Float4::set1(qmax.y), qmaxZ = Float4::set1(qmax.z);
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = _nodes[stack[--top]];
+            if (!boxOverlap(node.bmin, node.bmax, qmin, qmax)) continue;
+            if (node.count > 0) {
+                int mask = _leafBoxes.aabbMask(node.first / 4, qminX, qminY, qminZ, qmaxX, qmaxY, qmaxZ);
+                for (int lane = 0; lane < node.count; ++lane) {
+                    if (mask & (1 << lane)) out.push_back(_indices[node.first + lane]);
+                }
+            } else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+    }
+
+    // 點到最近的 AABB 的距離（在盒內為 0），超過 maxDistance 時回傳 maxDistance
+    float nearestDistance(const glm::vec3& p, float maxDistance) const {
+        if (_nodes.empty()) return maxDistance;
+        float best2 = maxDistance * maxDistance;
+        Float4 px = Float4::set1(p.x), py = Float4::set1(p.y), pz = Float4::set1(p.z);
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = _nodes[stack[--top]];
+            if (distance2(p, node.bmin, node.bmax) >= best2) continue;
+            if (node.count > 0) {
+                float d2[4];
+                _leafBoxes.distance2(node.first / 4, px, py, pz).store(d2);
+                best2 = std::min(best2, std::min(std::min(d2[0], d2[1]), std::min(d2[2], d2[3])));
+            } else {
+                // 較近的子節點後放入，先走訪
+                float dLeft = distance2(p, _nodes[node.first].bmin, _nodes[node.first].bmax);
+                float dRight = distance2(p, _nodes[node.first + 1].bmin, _nodes[node.first + 1].bmax);
+                int nearChild = (dLeft <= dRight) ? node.first : node.first + 1;
+                int farChild = (dLeft <= dRight) ? node.first + 1 : node.first;
+                if (std::max(dLeft, dRight) < best2) stack[top++] = farChild;
+                if (std::min(dLeft, dRight) < best2) stack[top++] = nearChild;
+            }
+        }
+        return std::sqrt(best2);
+    }
+
+    // 最近的交點：每個 AABB 先向外擴張 inflate（球體掃過時的近似），
+    // t 以 dir 的長度為單位，回傳 AABB 索引，沒有交點回傳 -1
+    // normal 不為 nullptr 時輸出射線進入的那一面的法向量
+    int raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, float inflate, float& tHit,
+                glm::vec3* normal = nullptr) const {
+        if (_nodes.empty()) return -1;
+        glm::vec3 invDir(safeInverse(dir.x), safeInverse(dir.y), safeInverse(dir.z));
+        glm::vec3 pad(inflate);
+        int hit = -1;
+        tHit = maxT;
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = _nodes[stack[--top]];
+            float tNode;
+            if (!slab(origin, invDir, node.bmin - pad, node.bmax + pad, tHit, tNode)) continue;
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    int index = _indices[i];
+                    float t;
+                    if (slab(origin, invDir, _boxMin[index] - pad, _boxMax[index] + pad, tHit, t)) {
+                        tHit = t;
+                        hit = index;
+                    }
+                }
+            } else {
+                // 先走較近的子節點，較早縮短 tHit
+                const Node& left = _nodes[node.first];
+                const Node& right = _nodes[node.first + 1];
+                float tLeft, tRight;
+                bool hitLeft = slab(origin, invDir, left.bmin - pad, left.bmax + pad, tHit, tLeft);
+                bool hitRight = slab(origin, invDir, right.bmin - pad, right.bmax + pad, tHit, tRight);
+                if (hitLeft && hitRight) {
+                    if (tLeft < tRight) {
+                        stack[top++] = node.first + 1;
+                        stack[top++] = node.first;
+                    } else {
+                        stack[top++] = node.first;
+                        stack[top++] = node.first + 1;
+                    }
+                } else if (hitLeft) {
+                    stack[top++] = node.first;
+                } else if (hitRight) {
+                    stack[top++] = node.first + 1;
+                }
+            }
+        }
+        if (hit >= 0 && normal != nullptr) {
+            *normal = hitNormal(origin, dir, _boxMin[hit] - pad, _boxMax[hit] + pad, tHit);
+        }
+        return hit;
+    }
+
+    // 批次最近交點，4 條射線一組一起走訪 BVH
+    // tHit 為輸入/輸出：呼叫前填入上限（例如 rays.maxT 或另一棵樹的結果），只有更近的交點會覆寫
+    // hitIndex 只在找到更近的交點時寫入
+    void raycastBatch(const RayBatch& rays, float inflate, float* tHit, int* hitIndex) const {
+        raycastBatch(rays, 0, rays.size(), inflate, tHit, hitIndex);
+    }
+    // 只處理 [first, first + count) 的射線，tHit、hitIndex 從第 first 條射線開始
+    // 不修改樹，多個執行緒可以同時處理不重疊的範圍
+    void raycastBatch(const RayBatch& rays, size_t first, size_t count, float inflate, float* tHit, int* hitIndex) const {
+        if (_nodes.empty()) return;
+        for (size_t offset = 0; offset < count; offset += 4) {
+            int lanes = static_cast<int>(std::min<size_t>(4, count - offset));
+            raycastPacket(rays, first + offset, lanes, inflate, tHit + offset, hitIndex + offset);
+        }
+    }
+
+    // 射線在 t 時進入 [bmin, bmax] 的那一面的法向量，起點在盒內時回傳 -dir
+    static glm::vec3 hitNormal(const glm::vec3& origin, const glm::vec3& dir,
+                               const glm::vec3& bmin, const glm::vec3& bmax, float t) {
+        glm::vec3 back = -dir / std::max(glm::length(dir), 1e-12f);
+        if (t <= 0.0f) return back;
+        int axis = -1;
+        float best = -FLT_MAX;
+        for (int a = 0; a < 3; ++a) {
+            if (std::fabs(dir[a]) < 1e-12f) continue;
+            float tNear = ((dir[a] > 0.0f ? bmin[a] : bmax[a]) - origin[a]) / dir[a];
+            if (tNear > best) {
+                best = tNear;
+                axis = a;
+            }
+        }
+        if (axis < 0) return back;
+        glm::vec3 n(0.0f);
+        n[axis] = (dir[axis] > 0.0f) ? -1.0f : 1.0f;
+        return n;
+    }
+
+private:
+    void raycastPacket(const RayBatch& rays, size_t first, int count, float inflate, float* tHit, int* hitIndex) const {
+        // 不足 4 條時以最後一條補齊，並以 active 遮罩排除
+        float lane[6][4], bestT[4];
+        for (int i = 0; i < 4; ++i) {
+            size_t r = first + std::min(i, count - 1);
+            lane[0][i] = rays.ox[r]; lane[1][i] = rays.oy[r]; lane[2][i] = rays.oz[r];
+            lane[3][i] = safeInverse(rays.dx[r]);
+            lane[4][i] = safeInverse(rays.dy[r]);
+            lane[5][i] = safeInverse(rays.dz[r]);
+            bestT[i] = tHit[std::min(i, count - 1)];
+        }
+        const int active = (1 << count) - 1;
+        Float4 ox = Float4::load(lane[0]), oy = Float4::load(lane[1]), oz = Float4::load(lane[2]);
+        Float4 ix = Float4::load(lane[3]), iy = Float4::load(lane[4]), iz = Float4::load(lane[5]);
+        Float4 tBest = Float4::load(bestT);
+        Float4 zero = Float4::set1(0.0f);
+
+        // 4 條射線與一個 AABB 的 slab 測試，回傳命中的 lane 位元與進入的 t
+        auto slab4 = [&](const glm::vec3& bmin, const glm::vec3& bmax, Float4& enter) {
+            Float4 t0x = (Float4::set1(bmin.x - inflate) - ox) * ix, t1x = (Float4::set1(bmax.x + inflate) - ox) * ix;
+            Float4 t0y = (Float4::set1(bmin.y - inflate) - oy) * iy, t1y = (Float4::set1(bmax.y + inflate) - oy) * iy;
+            Float4 t0z = (Float4::set1(bmin.z - inflate) - oz) * iz, t1z = (Float4::set1(bmax.z + inflate) - oz) * iz;
+            enter = max4(max4(min4(t0x, t1x), min4(t0y, t1y)), max4(min4(t0z, t1z), zero));
+            Float4 exit = min4(min4(max4(t0x, t1x), max4(t0y, t1y)), min4(max4(t0z, t1z), tBest));
+            return (enter <= exit).bits() & active;
+        };
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = _nodes[stack[--top]];
+            Float4 enter;
+            if (slab4(node.bmin, node.bmax, enter) == 0) continue;
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    int index = _indices[i];
+                    int hits = slab4(_boxMin[index], _boxMax[index], enter);
+                    if (hits == 0) continue;
+                    tBest = select4(laneMask(hits), enter, tBest);
+                    for (int l = 0; l < count; ++l) {
+                        if (hits & (1 << l)) hitIndex[l] = index;
+                    }
+                }
+            } else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+        tBest.store(bestT);
+        for (int l = 0; l < count; ++l) tHit[l] = bestT[l];
+    }
+
+    void buildNode(int nodeIndex, int begin, int end) {
+        glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX), cmin(FLT_MAX), cmax(-FLT_MAX);
+        for (int i = begin; i < end; ++i) {
+            int index = _indices[i];
+            bmin = glm::min(bmin, _boxMin[index]);
+            bmax = glm::max(bmax, _boxMax[index]);
+            glm::vec3 c = (_boxMin[index] + _boxMax[index]) * 0.5f;
+            cmin = glm::min(cmin, c);
+            cmax = glm::max(cmax, c);
+        }
+        _nodes[nodeIndex].bmin = bmin;
+        _nodes[nodeIndex].bmax = bmax;
+
+        int count = end - begin;
+        if (count <= COLLISION_BVH_LEAF_SIZE) {
+            _nodes[nodeIndex].first = begin;
+            _nodes[nodeIndex].count = count;
+            return;
+        }
+
+        // 以中心點範圍最大的軸，在中位數切開
+        glm::vec3 extent = cmax - cmin;
+        int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+        int mid = (begin + end) / 2;
+        std::nth_element(_indices.begin() + begin, _indices.begin() + mid, _indices.begin() + end,
+                         [&](int a, int b) {
+                             return (_boxMin[a][axis] + _boxMax[a][axis]) < (_boxMin[b][axis] + _boxMax[b][axis]);
+                         });
+
+        int left = static_cast<int>(_nodes.size());
+        _nodes.push_back(Node());
+        _nodes.push_back(Node());
+        _nodes[nodeIndex].first = left;
+        _nodes[nodeIndex].count = 0;
+        buildNode(left, begin, mid);
+        buildNode(left + 1, mid, end);
+    }
+
+    // 依走訪順序重新排列葉節點，每個葉節點從 4 的倍數開始，不足 4 個的位置補 -1（空盒子）
+    void layoutLeaves() {
+        std::vector<int> slots;
+        slots.reserve(_indices.size() * 2);
+        _leafBoxes.clear();
+        _leafBoxes.reserve(_indices.size() * 2);
+        for (Node& node : _nodes) {
+            if (node.count == 0) continue;
+            int first = static_cast<int>(slots.size());
+            for (int lane = 0; lane < 4; ++lane) {
+                if (lane < node.count) {
+                    int index = _indices[node.first + lane];
+                    slots.push_back(index);
+                    _leafBoxes.add(_boxMin[index], _boxMax[index]);
+                } else {
+                    slots.push_back(-1);
+                    _leafBoxes.addEmpty();
+                }
+            }
+            node.first = first;
+        }
+        _indices.swap(slots);
+    }
+
+    // visit 回傳 false 時停止
+    template <typename Visitor>
+    void visitSphere(const glm::vec3& center, float radius, Visitor visit) const {
+        if (_nodes.empty()) return;
+        float r2 = radius * radius;
+        Float4 cx = Float4::set1(center.x), cy = Float4::set1(center.y), cz = Float4::set1(center.z);
+        Float4 r2x4 = Float4::set1(r2);
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = _nodes[stack[--top]];
+            if (distance2(center, node.bmin, node.bmax) >= r2) continue;
+            if (node.count > 0) {
+                // 與 Sphere::intersects(const AABB&) 相同：距離 < 半徑
+                int mask = _leafBoxes.sphereMask(node.first / 4, cx, cy, cz, r2x4);
+                for (int lane = 0; lane < node.count; ++lane) {
+                    if ((mask & (1 << lane)) && !visit(_indices[node.first + lane])) return;
+                }
+            } else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+    }
+
+    // 點到 AABB 的距離平方（在盒內為 0）
+    static float distance2(const glm::vec3& p, const glm::vec3& bmin, const glm::vec3& bmax) {
+        float dx = std::max(std::max(bmin.x - p.x, p.x - bmax.x), 0.0f);
+        float dy = std::max(std::max(bmin.y - p.y, p.y - bmax.y), 0.0f);
+        float dz = std::max(std::max(bmin.z - p.z, p.z - bmax.z), 0.0f);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    static bool boxOverlap(const glm::vec3& amin, const glm::vec3& amax, const glm::vec3& bmin, const glm::vec3& bmax) {
+        return (amin.x <= bmax.x && amax.x >= bmin.x) &&
+               (amin.y <= bmax.y && amax.y >= bmin.y) &&
+               (amin.z <= bmax.z && amax.z >= bmin.z);
+    }
+
+    static float safeInverse(float v) {
+        return (std::fabs(v) > 1e-12f) ? 1.0f / v : (v < 0.0f ? -FLT_MAX : FLT_MAX);
+    }
+
+    // 射線與 AABB 的 slab 測試，起點在盒內時 tEntry = 0
+    static bool slab(const glm::vec3& origin, const glm::vec3& invDir, const glm::vec3& bmin, const glm::vec3& bmax,
+                     float maxT, float& tEntry) {
+        glm::vec3 t0 = (bmin - origin) * invDir;
+        glm::vec3 t1 = (bmax - origin) * invDir;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+        tEntry = enter;
+        return enter <= exit;
+    }
+
+    std::vector<Node> _nodes;
+    std::vector<int> _indices;
+    std::vector<glm::vec3> _boxMin, _boxMax;
+    ColliderStore _leafBoxes;          // 依葉節點順序排列的 SoA 副本
+};
+
+#endif // COLLISION_BVH_H
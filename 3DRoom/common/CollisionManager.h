@@ -1,11 +1,21 @@
 #ifndef COLLISION_SYSTEM_H
 #define COLLISION_SYSTEM_H
 
+#include <algorithm>
+#include <iostream>
+#include <string>
 #include <vector>
 #include <glm/glm.hpp>
 #include "../models/CCube.h"
+#include "CollisionBVH.h"
+#include "CollisionProxy.h"
+#include "CollisionOBB.h"
 #include <memory>
 
+#define COLLISION_MAX_SLIDES 4   // moveAndSlide 每次最多處理的碰撞次數
+#define COLLISION_OBB_MAX_FILL 0.9f  // OBB 體積小於世界座標 AABB 的這個比例時，addModelProxies 改用 OBB
+#define COLLISION_QUERY_RESERVE 256  // overlapSphere / overlapAABB 暫存預先配置的數量
+
 // AABB 包圍盒結構
 // AABB 包圍盒結構
 struct AABB {
@@ -63,6 +73,32 @@ struct Sphere {
     
 };
 
+// 射線檢測的結果
+enum class ColliderType { NONE, WALL, OBSTACLE, ORIENTED_OBSTACLE };
+
+struct RaycastHit {
+    float distance = 0.0f;       // 以 direction 的長度為單位（direction 為單位向量時即為距離）
+    glm::vec3 point = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+    ColliderType type = ColliderType::NONE;
+    int colliderId = -1;         // getWalls()、getObstacles() 或 getOrientedObstacles() 中的索引
+};
+
+// 批次射線檢測的結果（SoA，與 RayBatch 的順序相同）
+struct RayBatchHits {
+    std::vector<float> distance;
+    std::vector<float> nx, ny, nz;
+    std::vector<int> colliderId;
+    std::vector<ColliderType> type;  // NONE 表示沒有交點
+
+    void resize(size_t count) {
+        distance.resize(count);
+        nx.resize(count); ny.resize(count); nz.resize(count);
+        colliderId.resize(count);
+        type.resize(count);
+    }
+};
+
 // Structure to define door parameters for an arched doorway
 struct DoorwayConfig {
     bool hasDoor = false;
@@ -73,6 +109,10 @@ struct DoorwayConfig {
     float lintelHeight = 0.0f; // Height of the top lintel
 };
 
+#define DISTANCE_GRID_CELL 1.0f            // 距離格點的間距（m）
+#define DISTANCE_GRID_MAX 8.0f             // 格點記錄的最大距離（m）
+#define DISTANCE_GRID_MAX_POINTS 4194304   // 格點超過這個數量時只以 BVH 查詢
+
 // 碰撞檢測管理器
 class CollisionManager {
 private:
@@ -82,10 +122,256 @@ private:
     std::vector<Sphere> sphereObstacles; // 球體障礙物
     float m_cameraRadius = 0.3f;
     
+    CollisionBVH wallTree;             // 牆壁只在 initializeWalls / setWalls 時建立
+    CollisionBVH obstacleTree;         // 障礙物改變後，在下一次查詢時重建
+    bool obstacleTreeDirty = true;
+    uint32_t colliderVersion = 0;      // 牆壁或障礙物改變時加 1
+    
+    // 距離格點：涵蓋所有牆壁的範圍，每 DISTANCE_GRID_CELL 一個點，記錄到最近的牆壁與障礙物（OBB 以世界座標 AABB）
+    // 的距離（最多 DISTANCE_GRID_MAX）。只有投射物使用，由 prepareClearance 建立，沒有投射物時不建立：
+    // 牆壁改變後重建，新增的障礙物併入附近的格點，移除的障礙物不扣除（距離仍是下限，只是比較保守）
+    std::vector<float> distanceGrid;
+    glm::vec3 distanceGridOrigin = glm::vec3(0.0f);
+    int distanceGridSize[3] = { 0, 0, 0 };
+    bool distanceGridDirty = true;
+    size_t distanceGridObstacles = 0;   // 已併入格點的 obstacles 與 orientedObstacles 數量
+    size_t distanceGridOriented = 0;
+    bool logCollisions = true;         // 每次碰撞輸出牆壁資訊（效能測試時關閉）
+    
+    static void buildTree(CollisionBVH& tree, const std::vector<AABB>& boxes) {
+        std::vector<glm::vec3> boxMin(boxes.size()), boxMax(boxes.size());
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            boxMin[i] = boxes[i].min;
+            boxMax[i] = boxes[i].max;
+        }
+        tree.build(boxMin, boxMax);
+    }
+    
+    // 格點清空後 clearance 改以 BVH 查詢
+    void clearDistanceGrid() {
+        distanceGrid.clear();
+        distanceGridSize[0] = distanceGridSize[1] = distanceGridSize[2] = 0;
+        distanceGridDirty = true;
+    }
+    
+    void buildDistanceGrid() {
+        clearDistanceGrid();
+        distanceGridDirty = false;
+        distanceGridObstacles = distanceGridOriented = 0;
+        if (walls.empty()) return;
+        glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX);
+        for (const AABB& wall : walls) {
+            bmin = glm::min(bmin, wall.min);
+            bmax = glm::max(bmax, wall.max);
+        }
+        int size[3];
+        size_t points = 1;
+        for (int a = 0; a < 3; ++a) {
+            size[a] = static_cast<int>(std::ceil((bmax[a] - bmin[a]) / DISTANCE_GRID_CELL)) + 1;
+            points *= static_cast<size_t>(size[a]);
+        }
+        if (points > DISTANCE_GRID_MAX_POINTS) return;
+        distanceGridOrigin = bmin;
+        std::copy(size, size + 3, distanceGridSize);
+        distanceGrid.resize(points);
+        size_t n = 0;
+        for (int z = 0; z < size[2]; ++z) {
+            for (int y = 0; y < size[1]; ++y) {
+                for (int x = 0; x < size[0]; ++x) {
+                    glm::vec3 point = bmin + glm::vec3(float(x), float(y), float(z)) * DISTANCE_GRID_CELL;
+                    distanceGrid[n++] = wallTree.nearestDistance(point, DISTANCE_GRID_MAX);
+                }
+            }
+        }
+    }
+    
+    // 距離 DISTANCE_GRID_MAX 以內的格點改為與 [bmin, bmax] 的距離中較小的一個
+    void mergeDistanceGrid(const glm::vec3& bmin, const glm::vec3& bmax) {
+        int lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            float first = (bmin[a] - DISTANCE_GRID_MAX - distanceGridOrigin[a]) / DISTANCE_GRID_CELL;
+            float last = (bmax[a] + DISTANCE_GRID_MAX - distanceGridOrigin[a]) / DISTANCE_GRID_CELL;
+            lo[a] = std::max(0, static_cast<int>(std::ceil(first)));
+            hi[a] = std::min(distanceGridSize[a] - 1, static_cast<int>(std::floor(last)));
+            if (lo[a] > hi[a]) return;
+        }
+        for (int z = lo[2]; z <= hi[2]; ++z) {
+            for (int y = lo[1]; y <= hi[1]; ++y) {
+                size_t row = (static_cast<size_t>(z) * distanceGridSize[1] + y) * distanceGridSize[0];
+                for (int x = lo[0]; x <= hi[0]; ++x) {
+                    glm::vec3 point = distanceGridOrigin + glm::vec3(float(x), float(y), float(z)) * DISTANCE_GRID_CELL;
+                    float dx = std::max(std::max(bmin.x - point.x, point.x - bmax.x), 0.0f);
+                    float dy = std::max(std::max(bmin.y - point.y, point.y - bmax.y), 0.0f);
+                    float dz = std::max(std::max(bmin.z - point.z, point.z - bmax.z), 0.0f);
+                    distanceGrid[row + x] = std::min(distanceGrid[row + x], std::sqrt(dx * dx + dy * dy + dz * dz));
+                }
+            }
+        }
+    }
+    
+    // 還沒併入格點的障礙物併入格點（沒有格點時只更新數量）
+    void mergePendingObstacles() {
+        if (!distanceGrid.empty()) {
+            for (size_t i = distanceGridObstacles; i < obstacles.size(); ++i) {
+                mergeDistanceGrid(obstacles[i].min, obstacles[i].max);
+            }
+            for (size_t i = distanceGridOriented; i < orientedObstacles.size(); ++i) {
+                glm::vec3 bmin, bmax;
+                orientedObstacles[i].bounds(bmin, bmax);
+                mergeDistanceGrid(bmin, bmax);
+            }
+        }
+        distanceGridObstacles = obstacles.size();
+        distanceGridOriented = orientedObstacles.size();
+    }
+    
+    void updateObstacleTree() {
+        if (!obstacleTreeDirty) return;
+        buildTree(obstacleTree, obstacles);
+        obstacleTreeDirty = false;
+    }
+    
+    std::vector<int> sweepCandidates;  // sweepSphere 的暫存，避免每次配置
+    std::vector<int> overlapCandidates; // overlapSphere / overlapAABB 的暫存（剛體每個步驟都會查詢）
+    
+    // 旋轉的障礙物（OBB），以各自的世界座標 AABB 建立 BVH 作為粗略篩選，再以 OBB 精確測試
+    std::vector<OBB> orientedObstacles;
+    std::vector<std::string> orientedNames;
+    CollisionBVH orientedTree;
+    bool orientedTreeDirty = true;
+    std::vector<int> orientedCandidates;
+    
+    void updateOrientedTree() {
+        if (!orientedTreeDirty) return;
+        std::vector<glm::vec3> boxMin(orientedObstacles.size()), boxMax(orientedObstacles.size());
+        for (size_t i = 0; i < orientedObstacles.size(); ++i) orientedObstacles[i].bounds(boxMin[i], boxMax[i]);
+        orientedTree.build(boxMin, boxMax);
+        orientedTreeDirty = false;
+    }
+    
+    // 最近的 OBB 交點（OBB 擴張 radius），找不到回傳 -1
+    int raycastOriented(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float radius,
+                        float& tHit, glm::vec3& normal) {
+        updateOrientedTree();
+        return raycastOriented(origin, direction, maxDistance, radius, tHit, normal, orientedCandidates);
+    }
+    // 不重建 BVH 的版本（呼叫前 BVH 需要是最新的），candidates 為呼叫端的暫存，可以在多個執行緒同時呼叫
+    int raycastOriented(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float radius,
+                        float& tHit, glm::vec3& normal, std::vector<int>& candidates) const {
+        if (orientedObstacles.empty()) return -1;
+        glm::vec3 end = origin + direction * maxDistance;
+        candidates.clear();
+        orientedTree.queryAABB(glm::min(origin, end) - glm::vec3(radius), glm::max(origin, end) + glm::vec3(radius),
+                               candidates);
+        int best = -1;
+        tHit = maxDistance;
+        for (int index : candidates) {
+            float t;
+            glm::vec3 n;
+            if (orientedObstacles[index].raycast(origin, direction, tHit, radius, t, n) && (best < 0 || t < tHit)) {
+                tHit = t;
+                normal = n;
+                best = index;
+            }
+        }
+        return best;
+    }
+    
+    // 球心從 center 沿 move 移動時碰到 [bmin, bmax] 的時間 t（0~1），即射線與圓角盒（AABB 擴張 radius）的交點：
+    // 三個只沿單軸擴張的盒子（面）、12 條邊的圓柱、8 個角的球，取最早的交點
+    static bool sweepSphereAABB(const glm::vec3& center, const glm::vec3& move, float radius,
+                                const glm::vec3& bmin, const glm::vec3& bmax, float& tHit, glm::vec3& normal) {
+        // 起點已經重疊：只在往盒子內部移動時視為 t = 0 的碰撞，允許離開
+        glm::vec3 closest = glm::clamp(center, bmin, bmax);
+        glm::vec3 d = center - closest;
+        float dist2 = glm::dot(d, d);
+        if (dist2 < radius * radius) {
+            if (dist2 > 1e-12f) {
+                normal = d / std::sqrt(dist2);
+            } else {
+                // 球心在盒內：取穿透最淺的面
+                glm::vec3 toMin = center - bmin, toMax = bmax - center;
+                float best = FLT_MAX;
+                for (int a = 0; a < 3; ++a) {
+                    if (toMin[a] < best) { best = toMin[a]; normal = glm::vec3(0.0f); normal[a] = -1.0f; }
+                    if (toMax[a] < best) { best = toMax[a]; normal = glm::vec3(0.0f); normal[a] = 1.0f; }
+                }
+            }
+            if (glm::dot(move, normal) >= 0.0f) return false;
+            tHit = 0.0f;
+            return true;
+        }
+        
+        float best = FLT_MAX;
+        // 面：只在 a 軸擴張 radius 的盒子
+        for (int a = 0; a < 3; ++a) {
+            glm::vec3 fmin = bmin, fmax = bmax;
+            fmin[a] -= radius;
+            fmax[a] += radius;
+            float enter = 0.0f, exit = 1.0f;
+            bool hit = true;
+            for (int k = 0; k < 3 && hit; ++k) {
+                if (std::fabs(move[k]) < 1e-12f) {
+                    hit = (center[k] >= fmin[k] && center[k] <= fmax[k]);
+                    continue;
+                }
+                float t0 = (fmin[k] - center[k]) / move[k];
+                float t1 = (fmax[k] - center[k]) / move[k];
+                if (t0 > t1) std::swap(t0, t1);
+                enter = std::max(enter, t0);
+                exit = std::min(exit, t1);
+                hit = (enter <= exit);
+            }
+            if (hit && enter < best) best = enter;
+        }
+        // 邊：沿 a 軸的圓柱，位於另外兩軸的 min/max
+        for (int a = 0; a < 3; ++a) {
+            int b = (a + 1) % 3, c = (a + 2) % 3;
+            float A = move[b] * move[b] + move[c] * move[c];
+            if (A < 1e-12f) continue;
+            for (int corner = 0; corner < 4; ++corner) {
+                float eb = (corner & 1) ? bmax[b] : bmin[b];
+                float ec = (corner & 2) ? bmax[c] : bmin[c];
+                float ob = center[b] - eb, oc = center[c] - ec;
+                float B = 2.0f * (ob * move[b] + oc * move[c]);
+                float C = ob * ob + oc * oc - radius * radius;
+                float disc = B * B - 4.0f * A * C;
+                if (disc < 0.0f) continue;
+                float t = (-B - std::sqrt(disc)) / (2.0f * A);
+                if (t < 0.0f || t > 1.0f || t >= best) continue;
+                float pa = center[a] + move[a] * t;
+                if (pa >= bmin[a] && pa <= bmax[a]) best = t;
+            }
+        }
+        // 角：球
+        float A = glm::dot(move, move);
+        if (A > 1e-12f) {
+            for (int corner = 0; corner < 8; ++corner) {
+                glm::vec3 k((corner & 1) ? bmax.x : bmin.x, (corner & 2) ? bmax.y : bmin.y, (corner & 4) ? bmax.z : bmin.z);
+                glm::vec3 o = center - k;
+                float B = 2.0f * glm::dot(o, move);
+                float C = glm::dot(o, o) - radius * radius;
+                float disc = B * B - 4.0f * A * C;
+                if (disc < 0.0f) continue;
+                float t = (-B - std::sqrt(disc)) / (2.0f * A);
+                if (t >= 0.0f && t <= 1.0f && t < best) best = t;
+            }
+        }
+        if (best > 1.0f) return false;
+        
+        tHit = best;
+        glm::vec3 contact = center + move * best;
+        glm::vec3 n = contact - glm::clamp(contact, bmin, bmax);
+        float len = glm::length(n);
+        normal = (len > 1e-6f) ? n / len : -move / std::sqrt(A);
+        return true;
+    }
+    
 public:
     CollisionManager() {
         // 設置攝影機碰撞器（半徑0.3f）
         cameraCollider.radius = 0.3f;
+        overlapCandidates.reserve(COLLISION_QUERY_RESERVE);
         initializeWalls();
     }
     
@@ -167,101 +453,373 @@ public:
         addRoomWalls(this->walls, 6, room6Center, roomX, roomY, roomZ, wallThickness,
                      doorConfig_R6_F, {}, doorConfig_R6_L, {}
                      );
+        buildTree(wallTree, walls);
+        clearDistanceGrid();
+        colliderVersion++;
     }
+    
+    // 以其他牆壁配置取代（例如程序產生的房間）
+    void setWalls(const std::vector<AABB>& newWalls) {
+        walls = newWalls;
+        buildTree(wallTree, walls);
+        clearDistanceGrid();
+        colliderVersion++;
+    }
+    
     // 添加障礙物
     void addObstacle(const AABB& obstacle) {
         obstacles.push_back(obstacle);
+        obstacleTreeDirty = true;
+        colliderVersion++;
+    }
+    
+    // 添加旋轉的障礙物
+    void addObstacle(const OBB& obstacle, const std::string& name = "Oriented Obstacle") {
+        orientedObstacles.push_back(obstacle);
+        orientedNames.push_back(name);
+        orientedTreeDirty = true;
+        colliderVersion++;
     }
     
+    void setCollisionLogging(bool enable) { logCollisions = enable; }
+    
     // 檢查攝影機位置是否會發生碰撞
     bool checkCameraCollision(const glm::vec3& newPosition) {
         cameraCollider.center = newPosition;
         
-        for (size_t i = 0; i < walls.size(); ++i) {
-            const auto& wall = walls[i];
-
-            if (cameraCollider.intersects(wall)) {
+        int wallIndex = wallTree.firstSphereOverlap(newPosition, cameraCollider.radius);
+        if (wallIndex >= 0) {
+            const auto& wall = walls[wallIndex];
+            if (logCollisions) {
                 std::cout << "Collision Detected!" << std::endl;
                 std::cout << "  Camera Attempted Position: (" << newPosition.x << ", " << newPosition.y << ", " << newPosition.z << ")" << std::endl;
                 std::cout << "  Collided with Wall Segment: " << wall.type << std::endl; // Use the stored type
                 std::cout << "  Wall Min: (" << wall.min.x << ", " << wall.min.y << ", " << wall.min.z << ")" << std::endl; //
                 std::cout << "  Wall Max: (" << wall.max.x << ", " << wall.max.y << ", " << wall.max.z << ")" << std::endl; //
-                return true;
             }
+            return true;
         }
 
 
         // 檢查與障礙物的碰撞
-        for (const auto& obstacle : obstacles) {
-            if (cameraCollider.intersects(obstacle)) {
+        updateObstacleTree();
+        if (obstacleTree.firstSphereOverlap(newPosition, cameraCollider.radius) >= 0) {
+            if (logCollisions) {
                 std::cout << "checkCameraCollision = true (Obstacle)" << std::endl;
                 std::cout << "Collision Pos (Camera attempt): (" << newPosition.x << "," << newPosition.y << "," << newPosition.z << ")" << std::endl;
-                // You might want to print obstacle details here too
-                return true;
             }
+            return true;
+        }
+
+        // 旋轉的障礙物：先以 AABB 篩選，再測試 OBB
+        updateOrientedTree();
+        orientedCandidates.clear();
+        orientedTree.querySphere(newPosition, cameraCollider.radius, orientedCandidates);
+        for (int index : orientedCandidates) {
+            if (!orientedObstacles[index].intersectsSphere(newPosition, cameraCollider.radius)) continue;
+            if (logCollisions) {
+                std::cout << "checkCameraCollision = true (" << orientedNames[index] << ")" << std::endl;
+            }
+            return true;
         }
 
         return false;
     }
     
-    // 計算滑動向量（沿著牆面滑動）
-    glm::vec3 calculateSliding(const glm::vec3& originalMovement,
-                              const glm::vec3& currentPos) {
-        glm::vec3 newPos = currentPos + originalMovement;
-        
-        if (!checkCameraCollision(newPos)) {
-            return originalMovement;
+    // 與球體重疊的所有牆壁與障礙物
+    void overlapSphere(const glm::vec3& center, float radius, std::vector<const AABB*>& result) {
+        std::vector<int>& indices = overlapCandidates;
+        indices.clear();
+        wallTree.querySphere(center, radius, indices);
+        for (int i : indices) result.push_back(&walls[i]);
+        indices.clear();
+        updateObstacleTree();
+        obstacleTree.querySphere(center, radius, indices);
+        for (int i : indices) result.push_back(&obstacles[i]);
+    }
+    
+    // 與球體重疊的旋轉障礙物
+    void overlapSphere(const glm::vec3& center, float radius, std::vector<const OBB*>& result) {
+        updateOrientedTree();
+        orientedCandidates.clear();
+        orientedTree.querySphere(center, radius, orientedCandidates);
+        for (int i : orientedCandidates) {
+            if (orientedObstacles[i].intersectsSphere(center, radius)) result.push_back(&orientedObstacles[i]);
         }
-        
-        // 嘗試分別在X、Y、Z軸上移動
-        glm::vec3 xOnly(originalMovement.x, 0.0f, 0.0f);
-        glm::vec3 yOnly(0.0f, originalMovement.y, 0.0f);
-        glm::vec3 zOnly(0.0f, 0.0f, originalMovement.z);
-        
-        glm::vec3 result(0.0f);
-        
-        if (!checkCameraCollision(currentPos + xOnly)) {
-            result += xOnly;
+    }
+    
+    // 與 OBB 重疊（分離軸定理）的牆壁、障礙物與旋轉障礙物
+    void overlapOBB(const OBB& box, std::vector<const AABB*>& result, std::vector<const OBB*>& orientedResult) {
+        glm::vec3 qmin, qmax;
+        box.bounds(qmin, qmax);
+        std::vector<int> indices;
+        wallTree.queryAABB(qmin, qmax, indices);
+        for (int i : indices) {
+            if (box.intersectsAABB(walls[i].min, walls[i].max)) result.push_back(&walls[i]);
         }
-        if (!checkCameraCollision(currentPos + yOnly)) {
-            result += yOnly;
+        indices.clear();
+        updateObstacleTree();
+        obstacleTree.queryAABB(qmin, qmax, indices);
+        for (int i : indices) {
+            if (box.intersectsAABB(obstacles[i].min, obstacles[i].max)) result.push_back(&obstacles[i]);
         }
-        if (!checkCameraCollision(currentPos + zOnly)) {
-            result += zOnly;
+        indices.clear();
+        updateOrientedTree();
+        orientedTree.queryAABB(qmin, qmax, indices);
+        for (int i : indices) {
+            if (box.intersects(orientedObstacles[i])) orientedResult.push_back(&orientedObstacles[i]);
         }
-        
-        return result;
     }
     
-    // 安全移動攝影機
-    glm::vec3 getSafeMovement(const glm::vec3& movement,
-                             const glm::vec3& currentPos) {
-        glm::vec3 targetPos = currentPos + movement;
+    // 與 AABB 重疊的所有牆壁與障礙物
+    void overlapAABB(const AABB& box, std::vector<const AABB*>& result) {
+        std::vector<int>& indices = overlapCandidates;
+        indices.clear();
+        wallTree.queryAABB(box.min, box.max, indices);
+        for (int i : indices) result.push_back(&walls[i]);
+        indices.clear();
+        updateObstacleTree();
+        obstacleTree.queryAABB(box.min, box.max, indices);
+        for (int i : indices) result.push_back(&obstacles[i]);
+    }
+    
+    // 最近的交點：radius > 0 時把 AABB 擴張 radius（球體沿射線掃過的保守近似）
+    bool raycastHit(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float radius,
+                    RaycastHit& hit) {
+        float tWall, tObstacle;
+        glm::vec3 wallNormal, obstacleNormal;
+        int wallIndex = wallTree.raycast(origin, direction, maxDistance, radius, tWall, &wallNormal);
+        updateObstacleTree();
+        float obstacleMax = (wallIndex >= 0) ? tWall : maxDistance;
+        int obstacleIndex = obstacleTree.raycast(origin, direction, obstacleMax, radius, tObstacle, &obstacleNormal);
+        float orientedMax = (obstacleIndex >= 0) ? tObstacle : obstacleMax;
+        float tOriented;
+        glm::vec3 orientedNormal;
+        int orientedIndex = raycastOriented(origin, direction, orientedMax, radius, tOriented, orientedNormal);
+        if (wallIndex < 0 && obstacleIndex < 0 && orientedIndex < 0) return false;
         
-        // 如果目標位置沒有碰撞，直接返回原始移動
-        if (!checkCameraCollision(targetPos)) {
-            return movement;
+        if (orientedIndex >= 0) {
+            hit.distance = tOriented;
+            hit.normal = orientedNormal;
+            hit.type = ColliderType::ORIENTED_OBSTACLE;
+            hit.colliderId = orientedIndex;
+        } else {
+            bool useWall = (obstacleIndex < 0);
+            hit.distance = useWall ? tWall : tObstacle;
+            hit.normal = useWall ? wallNormal : obstacleNormal;
+            hit.type = useWall ? ColliderType::WALL : ColliderType::OBSTACLE;
+            hit.colliderId = useWall ? wallIndex : obstacleIndex;
+        }
+        hit.point = origin + direction * hit.distance;
+        return true;
+    }
+    
+    // 一次檢測大量射線（投射物、點選、可見度），以 SIMD 每 4 條一組走訪 BVH
+    void raycastBatch(const RayBatch& rays, float radius, RayBatchHits& hits) {
+        hits.resize(rays.size());
+        prepareQueries();
+        raycastBatch(rays, 0, rays.size(), radius, hits, orientedCandidates);
+    }
+    
+    // 在多個執行緒查詢前由主執行緒呼叫：重建改變過的障礙物 BVH，之後範圍版本的 raycastBatch 只讀取資料
+    void prepareQueries() {
+        updateObstacleTree();
+        updateOrientedTree();
+    }
+    
+    // 只處理 [first, first + count) 的射線，結果寫在 hits 的相同位置（hits 需要已有 rays.size() 的長度）
+    // 不修改 CollisionManager：呼叫前先 prepareQueries()，查詢期間不可增減障礙物；
+    // candidates 為呼叫端的暫存，多個執行緒各用一個即可同時處理不重疊的範圍
+    void raycastBatch(const RayBatch& rays, size_t first, size_t count, float radius, RayBatchHits& hits,
+                      std::vector<int>& candidates) const {
+        const size_t packet = 64;   // 每次走訪 BVH 的射線數量，索引放在堆疊上
+        int wallIndex[packet], obstacleIndex[packet], orientedBoundsIndex[packet];
+        float orientedBoundsT[packet];
+        glm::vec3 pad(radius);
+        for (size_t begin = first; begin < first + count; begin += packet) {
+            size_t n = std::min(packet, first + count - begin);
+            std::copy(rays.maxT.begin() + begin, rays.maxT.begin() + begin + n, hits.distance.begin() + begin);
+            std::fill(wallIndex, wallIndex + n, -1);
+            std::fill(obstacleIndex, obstacleIndex + n, -1);
+            wallTree.raycastBatch(rays, begin, n, radius, &hits.distance[begin], wallIndex);
+            obstacleTree.raycastBatch(rays, begin, n, radius, &hits.distance[begin], obstacleIndex);
+            // OBB 的世界座標 AABB 也以 SIMD 先篩選：沒有碰到任何一個的射線不需要逐條測試
+            // （擴張 radius * √3，包含旋轉後擴張 radius 的 OBB）
+            if (!orientedObstacles.empty()) {
+                std::copy(hits.distance.begin() + begin, hits.distance.begin() + begin + n, orientedBoundsT);
+                std::fill(orientedBoundsIndex, orientedBoundsIndex + n, -1);
+                orientedTree.raycastBatch(rays, begin, n, radius * 1.7320508f, orientedBoundsT, orientedBoundsIndex);
+            }
+            
+            for (size_t k = 0; k < n; ++k) {
+                size_t i = begin + k;
+                hits.nx[i] = hits.ny[i] = hits.nz[i] = 0.0f;
+                hits.colliderId[i] = -1;
+                hits.type[i] = ColliderType::NONE;
+                // 障礙物的結果一定比牆壁近（以牆壁的距離為上限）
+                const AABB* box = nullptr;
+                if (obstacleIndex[k] >= 0) {
+                    box = &obstacles[obstacleIndex[k]];
+                    hits.type[i] = ColliderType::OBSTACLE;
+                    hits.colliderId[i] = obstacleIndex[k];
+                } else if (wallIndex[k] >= 0) {
+                    box = &walls[wallIndex[k]];
+                    hits.type[i] = ColliderType::WALL;
+                    hits.colliderId[i] = wallIndex[k];
+                }
+                // 旋轉的障礙物數量少，逐條射線以純量測試，上限為目前最近的交點
+                float tOriented;
+                glm::vec3 normal;
+                int orientedIndex = (orientedObstacles.empty() || orientedBoundsIndex[k] < 0) ? -1 :
+                    raycastOriented(rays.origin(i), rays.direction(i), hits.distance[i], radius, tOriented, normal,
+                                    candidates);
+                if (orientedIndex >= 0) {
+                    hits.distance[i] = tOriented;
+                    hits.type[i] = ColliderType::ORIENTED_OBSTACLE;
+                    hits.colliderId[i] = orientedIndex;
+                } else if (box == nullptr) {
+                    continue;
+                } else {
+                    normal = CollisionBVH::hitNormal(rays.origin(i), rays.direction(i), box->min - pad, box->max + pad,
+                                                     hits.distance[i]);
+                }
+                hits.nx[i] = normal.x;
+                hits.ny[i] = normal.y;
+                hits.nz[i] = normal.z;
+            }
+        }
+    }
+    
+    // prepareQueries 之外，建立距離格點（牆壁改變後第一次呼叫時）並併入新增的障礙物（CProjectilePool::update 呼叫）
+    void prepareClearance() {
+        prepareQueries();
+        if (distanceGridDirty) buildDistanceGrid();
+        mergePendingObstacles();
+    }
+    
+    // 點到最近的牆壁、障礙物的距離下限（OBB 以世界座標 AABB 計算），最多 maxDistance
+    // 格點內為最近格點的距離減去到格點的距離（距離每移動 1 m 最多減少 1 m），格點外或格點不是最新時以 BVH 查詢
+    // 呼叫前先 prepareClearance()，之後可以在多個執行緒同時呼叫
+    float clearance(const glm::vec3& p, float maxDistance) const {
+        // 每個投射物每一步可能查詢一次，以 float 計算
+        const float inv = 1.0f / DISTANCE_GRID_CELL;
+        float gx = (p.x - distanceGridOrigin.x) * inv + 0.5f;
+        float gy = (p.y - distanceGridOrigin.y) * inv + 0.5f;
+        float gz = (p.z - distanceGridOrigin.z) * inv + 0.5f;
+        bool inside = !distanceGridDirty && distanceGridObstacles == obstacles.size() &&
+                      distanceGridOriented == orientedObstacles.size() &&
+                      gx >= 0.0f && gx < float(distanceGridSize[0]) && gy >= 0.0f && gy < float(distanceGridSize[1]) &&
+                      gz >= 0.0f && gz < float(distanceGridSize[2]);
+        if (inside) {
+            int x = static_cast<int>(gx), y = static_cast<int>(gy), z = static_cast<int>(gz);
+            float dx = p.x - (distanceGridOrigin.x + float(x) * DISTANCE_GRID_CELL);
+            float dy = p.y - (distanceGridOrigin.y + float(y) * DISTANCE_GRID_CELL);
+            float dz = p.z - (distanceGridOrigin.z + float(z) * DISTANCE_GRID_CELL);
+            size_t index = (static_cast<size_t>(z) * distanceGridSize[1] + y) * distanceGridSize[0] + x;
+            float distance = distanceGrid[index] - std::sqrt(dx * dx + dy * dy + dz * dz);
+            return std::min(std::max(distance, 0.0f), maxDistance);
         }
+        float distance = wallTree.nearestDistance(p, maxDistance);
+        distance = obstacleTree.nearestDistance(p, distance);
+        return orientedTree.nearestDistance(p, distance);
+    }
+    
+    // 牆壁或障礙物改變過後會不同，快取查詢結果的呼叫端以此判斷是否失效
+    uint32_t getColliderVersion() const { return colliderVersion; }
+    
+    // 球體沿 move 移動時最早碰到的牆壁或障礙物，t 為 0~1 的比例
+    bool sweepSphere(const glm::vec3& start, const glm::vec3& move, float radius, float& tHit, glm::vec3& normal) {
+        glm::vec3 end = start + move;
+        glm::vec3 qmin = glm::min(start, end) - glm::vec3(radius);
+        glm::vec3 qmax = glm::max(start, end) + glm::vec3(radius);
+        bool hit = false;
+        tHit = FLT_MAX;
+        
+        auto testBoxes = [&](const CollisionBVH& tree, const std::vector<AABB>& boxes) {
+            sweepCandidates.clear();
+            tree.queryAABB(qmin, qmax, sweepCandidates);
+            for (int index : sweepCandidates) {
+                float t;
+                glm::vec3 n;
+                if (sweepSphereAABB(start, move, radius, boxes[index].min, boxes[index].max, t, n) && t < tHit) {
+                    tHit = t;
+                    normal = n;
+                    hit = true;
+                }
+            }
+        };
+        testBoxes(wallTree, walls);
+        updateObstacleTree();
+        testBoxes(obstacleTree, obstacles);
         
-        // 使用滑動碰撞
-        return calculateSliding(movement, currentPos);
+        // OBB：轉到區域座標後就是以原點為中心的 AABB
+        updateOrientedTree();
+        sweepCandidates.clear();
+        orientedTree.queryAABB(qmin, qmax, sweepCandidates);
+        for (int index : sweepCandidates) {
+            const OBB& box = orientedObstacles[index];
+            glm::vec3 localMove(glm::dot(move, box.axes[0]), glm::dot(move, box.axes[1]), glm::dot(move, box.axes[2]));
+            float t;
+            glm::vec3 n;
+            if (sweepSphereAABB(box.toLocal(start), localMove, radius, -box.halfExtents, box.halfExtents, t, n) &&
+                t < tHit) {
+                tHit = t;
+                normal = box.toWorldDirection(n);
+                hit = true;
+            }
+        }
+        return hit;
     }
     
-    // 射線檢測（用於預測碰撞）
-    bool raycast(const glm::vec3& origin, const glm::vec3& direction,
-                float maxDistance, glm::vec3& hitPoint) {
-        // 簡化的射線檢測實現
-        const int steps = 20;
-        float stepSize = maxDistance / steps;
+    // 連續碰撞的移動：計算碰撞時間，停在接觸點前，剩下的移動量投影到接觸平面上繼續，
+    // 最多 COLLISION_MAX_SLIDES 次。回傳實際的移動量
+    glm::vec3 moveAndSlide(const glm::vec3& start, const glm::vec3& movement, float radius) {
+        const float skin = 1e-3f;  // 與牆面保持的距離，避免下一次從重疊開始
+        glm::vec3 pos = start;
+        glm::vec3 remaining = movement;
+        glm::vec3 firstNormal(0.0f);
         
-        for (int i = 1; i <= steps; ++i) {
-            glm::vec3 testPos = origin + direction * (stepSize * i);
-            if (checkCameraCollision(testPos)) {
-                hitPoint = testPos;
-                return true;
+        for (int iteration = 0; iteration < COLLISION_MAX_SLIDES; ++iteration) {
+            float length = glm::length(remaining);
+            if (length < 1e-6f) break;
+            
+            float t;
+            glm::vec3 normal;
+            if (!sweepSphere(pos, remaining, radius, t, normal)) {
+                pos += remaining;
+                break;
+            }
+            float tSafe = std::max(0.0f, t - skin / length);
+            pos += remaining * tSafe;
+            remaining *= (1.0f - tSafe);
+            
+            // 沿接觸平面滑動；第二次碰撞時若又推回第一個平面，改沿兩個平面的交線移動
+            remaining -= normal * glm::dot(remaining, normal);
+            if (iteration == 0) {
+                firstNormal = normal;
+            } else if (glm::dot(remaining, firstNormal) < 0.0f) {
+                glm::vec3 crease = glm::cross(firstNormal, normal);
+                float creaseLength = glm::length(crease);
+                remaining = (creaseLength > 1e-6f) ? crease * (glm::dot(remaining, crease) / (creaseLength * creaseLength))
+                                                   : glm::vec3(0.0f);
             }
         }
-        return false;
+        return pos - start;
+    }
+    
+    // 安全移動攝影機（連續碰撞，大的 frame 位移也不會穿牆）
+    glm::vec3 getSafeMovement(const glm::vec3& movement,
+                             const glm::vec3& currentPos) {
+        return moveAndSlide(currentPos, movement, cameraCollider.radius);
+    }
+    
+    // 射線檢測（用於預測碰撞）：攝影機球體沿射線移動時最先碰到的位置
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction,
+                float maxDistance, glm::vec3& hitPoint) {
+        RaycastHit hit;
+        if (!raycastHit(origin, direction, maxDistance, cameraCollider.radius, hit)) return false;
+        hitPoint = hit.point;
+        return true;
     }
     
     // 獲取攝影機碰撞器半徑
@@ -270,8 +828,63 @@ public:
     // 設置攝影機碰撞器半徑
     void setCameraRadius(float radius) { cameraCollider.radius = radius; }
     
+    // 將模型網格的碰撞代理（Model::GetCollisionProxies）經 world 矩陣轉成障礙物，回傳加入的數量
+    // 旋轉的網格 OBB 明顯比世界座標 AABB 小時加入 OBB，否則加入 AABB
+    int addModelProxies(const std::vector<CollisionProxy>& proxies, const glm::mat4& world, const std::string& name) {
+        int added = 0;
+        for (size_t i = 0; i < proxies.size(); ++i) {
+            if (proxies[i].empty()) continue;
+            glm::vec3 bmin, bmax;
+            proxies[i].worldBounds(world, bmin, bmax);
+            std::string meshName = name + " (Mesh " + std::to_string(i) + ")";
+            OBB box = proxies[i].box.transformed(world);
+            glm::vec3 size = bmax - bmin;
+            if (box.volume() < COLLISION_OBB_MAX_FILL * size.x * size.y * size.z) {
+                addObstacle(box, meshName);
+            } else {
+                addObstacle(AABB(bmin, bmax, meshName));
+            }
+            added++;
+        }
+        return added;
+    }
+    
+    // 移除名稱以 prefix 開頭的障礙物（例如被破壞的家具的所有網格），回傳移除的數量
+    int removeObstacles(const std::string& prefix) {
+        mergePendingObstacles();   // 距離格點保留被移除的障礙物，之後新增的障礙物由這裡的數量開始併入
+        auto matches = [&](const std::string& name) { return name.compare(0, prefix.size(), prefix) == 0; };
+        size_t before = obstacles.size() + orientedObstacles.size();
+        obstacles.erase(std::remove_if(obstacles.begin(), obstacles.end(),
+                                       [&](const AABB& box) { return matches(box.type); }),
+                        obstacles.end());
+        size_t kept = 0;
+        for (size_t i = 0; i < orientedObstacles.size(); ++i) {
+            if (matches(orientedNames[i])) continue;
+            orientedObstacles[kept] = orientedObstacles[i];
+            orientedNames[kept] = orientedNames[i];
+            kept++;
+        }
+        orientedObstacles.resize(kept);
+        orientedNames.resize(kept);
+        distanceGridObstacles = obstacles.size();
+        distanceGridOriented = orientedObstacles.size();
+        obstacleTreeDirty = true;
+        orientedTreeDirty = true;
+        colliderVersion++;
+        return static_cast<int>(before - obstacles.size() - orientedObstacles.size());
+    }
+    
     // 清除所有障礙物
-    void clearObstacles() { obstacles.clear(); }
+    void clearObstacles() {
+        mergePendingObstacles();
+        obstacles.clear();
+        obstacleTreeDirty = true;
+        orientedObstacles.clear();
+        orientedNames.clear();
+        orientedTreeDirty = true;
+        distanceGridObstacles = distanceGridOriented = 0;
+        colliderVersion++;
+    }
     
     // 獲取牆壁數量
     size_t getWallCount() const { return walls.size(); }
@@ -282,6 +895,21 @@ public:
     const std::vector<AABB>& getObstacles() const {
             return obstacles;
         }
+    
+    size_t getOrientedObstacleCount() const { return orientedObstacles.size(); }
+    const std::vector<OBB>& getOrientedObstacles() const { return orientedObstacles; }
+    
+    // RaycastHit 等查詢結果的碰撞體名稱（牆壁的種類、障礙物的名稱）；索引在障礙物增減後失效，需要在當下取得
+    const std::string& getColliderName(ColliderType type, int colliderId) const {
+        static const std::string none;
+        if (colliderId < 0) return none;
+        switch (type) {
+        case ColliderType::WALL: return walls[colliderId].type;
+        case ColliderType::OBSTACLE: return obstacles[colliderId].type;
+        case ColliderType::ORIENTED_OBSTACLE: return orientedNames[colliderId];
+        default: return none;
+        }
+    }
     // 獲取所有球體障礙物
     const std::vector<Sphere>& getSphereObstacles() const {
         return sphereObstacles;
@@ -321,76 +949,19 @@ public:
         }
     }
     
-    // 相機碰撞處理
+    // 相機碰撞處理：從 currentCamPos 移動到 nextCamPos，回傳碰撞後的位置
     glm::vec3 handleCameraCollision(const glm::vec3& currentCamPos, const glm::vec3& nextCamPos, float cameraRadius) {
-        Sphere cameraSphere(nextCamPos, cameraRadius);
-        glm::vec3 newPosition = nextCamPos;
-
-        for (const auto& wall : getWalls()) {
-            if (cameraSphere.intersects(wall)) {
-                // 如果發生碰撞，將相機位置限制在牆壁之外
-                // 這是一個簡化的碰撞響應，可能需要更複雜的投影或推開算法
-                // 目前的實現只是阻止相機進入牆壁
-                // 這裡的邏輯可以根據您的需求進行調整
-
-                // 為了避免穿牆，我們可以將相機位置回退到碰撞前的位置，或者推開
-                // 這裡我們嘗試推開，但需要更精確的向量運算
-                // 對於簡單的AABB，我們可以判斷是在哪個軸上發生碰撞，然後調整該軸的位置
-
-                // 獲取相機移動方向
-                glm::vec3 moveDir = glm::normalize(nextCamPos - currentCamPos);
-
-                // 嘗試沿每個軸推開
-                // x 軸
-                if (nextCamPos.x + cameraRadius > wall.min.x && nextCamPos.x - cameraRadius < wall.max.x &&
-                    nextCamPos.y + cameraRadius > wall.min.y && nextCamPos.y - cameraRadius < wall.max.y &&
-                    nextCamPos.z + cameraRadius > wall.min.x && nextCamPos.z - cameraRadius < wall.max.z) { // 這行有問題
-                     // 正確判斷 z 軸的碰撞
-                     if (nextCamPos.z + cameraRadius > wall.min.z && nextCamPos.z - cameraRadius < wall.max.z) {
-                        // 在 x 軸上發生碰撞
-                        if (moveDir.x > 0) { // 從左邊進入
-                            newPosition.x = wall.min.x - cameraRadius;
-                        } else if (moveDir.x < 0) { // 從右邊進入
-                            newPosition.x = wall.max.x + cameraRadius;
-                        }
-                    }
-                }
-
-                // y 軸
-                if (nextCamPos.y + cameraRadius > wall.min.y && nextCamPos.y - cameraRadius < wall.max.y &&
-                    nextCamPos.x + cameraRadius > wall.min.x && nextCamPos.x - cameraRadius < wall.max.x &&
-                    nextCamPos.z + cameraRadius > wall.min.z && nextCamPos.z - cameraRadius < wall.max.z) {
-                    // 在 y 軸上發生碰撞
-                    if (moveDir.y > 0) { // 從下進入
-                        newPosition.y = wall.min.y - cameraRadius;
-                    } else if (moveDir.y < 0) { // 從上進入
-                        newPosition.y = wall.max.y + cameraRadius;
-                    }
-                }
-
-                // z 軸
-                if (nextCamPos.z + cameraRadius > wall.min.z && nextCamPos.z - cameraRadius < wall.max.z &&
-                    nextCamPos.x + cameraRadius > wall.min.x && nextCamPos.x - cameraRadius < wall.max.x &&
-                    nextCamPos.y + cameraRadius > wall.min.y && nextCamPos.y - cameraRadius < wall.max.y) {
-                    // 在 z 軸上發生碰撞
-                    if (moveDir.z > 0) { // 從前進入
-                        newPosition.z = wall.min.z - cameraRadius;
-                    } else if (moveDir.z < 0) { // 從後進入
-                        newPosition.z = wall.max.z + cameraRadius;
-                    }
-                }
-            }
-        }
-        return newPosition;
+        return currentCamPos + moveAndSlide(currentCamPos, nextCamPos - currentCamPos, cameraRadius);
     }
     
     // Helper function to create a wall segment
-    void createWallSegment(std::vector<AABB>& wallsVec, const glm::vec3& minPoint, const glm::vec3& maxPoint, const std::string& type_desc) {
+    static void createWallSegment(std::vector<AABB>& wallsVec, const glm::vec3& minPoint, const glm::vec3& maxPoint, const std::string& type_desc) {
         wallsVec.push_back(AABB(minPoint, maxPoint, type_desc));
     }
 
     // Function to add a room's walls - MODIFIED FOR ARCHED DOORS
-    void addRoomWalls(std::vector<AABB>& wallsVec, int roomIndex, const glm::vec3& roomCenter, float roomXSize, float roomYSize, float roomZSize, float wallThickness,
+    // static：不使用管理器的狀態，RoomGrid.h 的產生器也以這個函式建立每個房間的牆
+    static void addRoomWalls(std::vector<AABB>& wallsVec, int roomIndex, const glm::vec3& roomCenter, float roomXSize, float roomYSize, float roomZSize, float wallThickness,
                       DoorwayConfig doorFrontConfig = {}, DoorwayConfig doorBackConfig = {},
                       DoorwayConfig doorLeftConfig = {}, DoorwayConfig doorRightConfig = {}) {
 
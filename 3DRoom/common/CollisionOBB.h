@@ -0,0 +1,220 @@
+#ifndef COLLISION_OBB_H
+#define COLLISION_OBB_H
+
+// 有方向的包圍盒（OBB）：旋轉的物件（例如轉了 30 度的木頭方塊）不需要用放大的 AABB 代替
+// 與球體、AABB、其他 OBB 的測試都以分離軸定理（SAT）或轉到 OBB 的區域座標計算
+// fitPoints 以主成分分析（PCA）從網格頂點求出方向，再與軸對齊的盒子比較，取體積較小的一個
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct OBB {
+    glm::vec3 center = glm::vec3(0.0f);
+    glm::vec3 axes[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+    glm::vec3 halfExtents = glm::vec3(0.0f);
+
+    OBB() = default;
+    OBB(const glm::vec3& c, const glm::mat3& rotation, const glm::vec3& half) : center(c), halfExtents(half) {
+        for (int i = 0; i < 3; ++i) axes[i] = rotation[i];
+    }
+
+    static OBB fromAABB(const glm::vec3& bmin, const glm::vec3& bmax) {
+        OBB box;
+        box.center = (bmin + bmax) * 0.5f;
+        box.halfExtents = (bmax - bmin) * 0.5f;
+        return box;
+    }
+
+    float volume() const { return 8.0f * halfExtents.x * halfExtents.y * halfExtents.z; }
+
+    // 世界座標轉到 OBB 的區域座標（原點在 center，三個軸為 axes）
+    glm::vec3 toLocal(const glm::vec3& p) const {
+        glm::vec3 d = p - center;
+        return glm::vec3(glm::dot(d, axes[0]), glm::dot(d, axes[1]), glm::dot(d, axes[2]));
+    }
+    glm::vec3 toWorld(const glm::vec3& local) const {
+        return center + axes[0] * local.x + axes[1] * local.y + axes[2] * local.z;
+    }
+    glm::vec3 toWorldDirection(const glm::vec3& local) const {
+        return axes[0] * local.x + axes[1] * local.y + axes[2] * local.z;
+    }
+
+    // 經過 world 矩陣（旋轉、平移、縮放，不含切變）後的 OBB
+    OBB transformed(const glm::mat4& world) const {
+        OBB box;
+        box.center = glm::vec3(world * glm::vec4(center, 1.0f));
+        glm::mat3 m(world);
+        for (int i = 0; i < 3; ++i) {
+            glm::vec3 v = m * axes[i];
+            float len = glm::length(v);
+            box.axes[i] = (len > 1e-12f) ? v / len : axes[i];
+            box.halfExtents[i] = halfExtents[i] * len;
+        }
+        return box;
+    }
+
+    // 包住 OBB 的 AABB
+    void bounds(glm::vec3& bmin, glm::vec3& bmax) const {
+        glm::vec3 extent(0.0f);
+        for (int i = 0; i < 3; ++i) extent += glm::abs(axes[i]) * halfExtents[i];
+        bmin = center - extent;
+        bmax = center + extent;
+    }
+
+    glm::vec3 closestPoint(const glm::vec3& p) const {
+        return toWorld(glm::clamp(toLocal(p), -halfExtents, halfExtents));
+    }
+
+    // 與 Sphere::intersects(const AABB&) 相同：距離 < 半徑
+    bool intersectsSphere(const glm::vec3& c, float radius) const {
+        glm::vec3 local = toLocal(c);
+        glm::vec3 d = local - glm::clamp(local, -halfExtents, halfExtents);
+        return glm::dot(d, d) < radius * radius;
+    }
+
+    // 分離軸定理：兩個 OBB 各 3 個面法向量，加上兩兩邊方向的外積共 15 個軸
+    // （Ericson, Real-Time Collision Detection 4.4.1），接觸也算相交
+    bool intersects(const OBB& other) const {
+        const float epsilon = 1e-6f;   // 邊平行時外積接近 0，避免誤判為分離
+        float R[3][3], absR[3][3];
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                R[i][j] = glm::dot(axes[i], other.axes[j]);
+                absR[i][j] = std::fabs(R[i][j]) + epsilon;
+            }
+        }
+        glm::vec3 d = other.center - center;
+        float t[3] = { glm::dot(d, axes[0]), glm::dot(d, axes[1]), glm::dot(d, axes[2]) };
+        const glm::vec3& a = halfExtents;
+        const glm::vec3& b = other.halfExtents;
+
+        for (int i = 0; i < 3; ++i) {
+            float rb = b[0] * absR[i][0] + b[1] * absR[i][1] + b[2] * absR[i][2];
+            if (std::fabs(t[i]) > a[i] + rb) return false;
+        }
+        for (int j = 0; j < 3; ++j) {
+            float ra = a[0] * absR[0][j] + a[1] * absR[1][j] + a[2] * absR[2][j];
+            if (std::fabs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ra + b[j]) return false;
+        }
+        for (int i = 0; i < 3; ++i) {
+            int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            for (int j = 0; j < 3; ++j) {
+                int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                float ra = a[i1] * absR[i2][j] + a[i2] * absR[i1][j];
+                float rb = b[j1] * absR[i][j2] + b[j2] * absR[i][j1];
+                if (std::fabs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb) return false;
+            }
+        }
+        return true;
+    }
+
+    bool intersectsAABB(const glm::vec3& bmin, const glm::vec3& bmax) const {
+        return intersects(fromAABB(bmin, bmax));
+    }
+
+    // 射線與 OBB（各面向外擴張 inflate）的最近交點，t 以 dir 的長度為單位，起點在盒內時 t = 0
+    bool raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, float inflate, float& tHit,
+                 glm::vec3& normal) const {
+        glm::vec3 o = toLocal(origin);
+        glm::vec3 d(glm::dot(dir, axes[0]), glm::dot(dir, axes[1]), glm::dot(dir, axes[2]));
+        glm::vec3 h = halfExtents + glm::vec3(inflate);
+        float enter = 0.0f, exit = maxT;
+        int enterAxis = -1;
+        for (int k = 0; k < 3; ++k) {
+            if (std::fabs(d[k]) < 1e-12f) {
+                if (o[k] < -h[k] || o[k] > h[k]) return false;
+                continue;
+            }
+            float t0 = (-h[k] - o[k]) / d[k];
+            float t1 = (h[k] - o[k]) / d[k];
+            if (t0 > t1) std::swap(t0, t1);
+            if (t0 > enter) { enter = t0; enterAxis = k; }
+            exit = std::min(exit, t1);
+            if (enter > exit) return false;
+        }
+        tHit = enter;
+        glm::vec3 localNormal(0.0f);
+        if (enterAxis >= 0) {
+            localNormal[enterAxis] = (d[enterAxis] > 0.0f) ? -1.0f : 1.0f;
+            normal = toWorldDirection(localNormal);
+        } else {
+            normal = -dir / std::max(glm::length(dir), 1e-12f);
+        }
+        return true;
+    }
+
+    // positions 為 count 個頂點，相鄰兩個頂點相差 stride 個 float
+    // PCA：頂點共變異數矩陣的特徵向量作為三個軸；旋轉後反而變大時（例如本來就是軸對齊的方塊）改用 AABB
+    static OBB fitPoints(const float* positions, size_t count, size_t stride) {
+        if (count == 0) return OBB();
+        auto point = [&](size_t i) { return glm::vec3(positions[i * stride], positions[i * stride + 1], positions[i * stride + 2]); };
+
+        glm::vec3 mean(0.0f), bmin(FLT_MAX), bmax(-FLT_MAX);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 p = point(i);
+            mean += p;
+            bmin = glm::min(bmin, p);
+            bmax = glm::max(bmax, p);
+        }
+        mean /= static_cast<float>(count);
+        glm::mat3 cov(0.0f);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 d = point(i) - mean;
+            for (int c = 0; c < 3; ++c)
+                for (int r = 0; r < 3; ++r) cov[c][r] += d[c] * d[r];
+        }
+        cov /= static_cast<float>(count);
+
+        glm::mat3 eigenvectors = jacobiEigenvectors(cov);
+        glm::vec3 axis0 = glm::normalize(eigenvectors[0]);
+        glm::vec3 axis1 = glm::normalize(eigenvectors[1] - axis0 * glm::dot(eigenvectors[1], axis0));
+        glm::vec3 axis2 = glm::cross(axis0, axis1);
+
+        OBB box;
+        box.axes[0] = axis0; box.axes[1] = axis1; box.axes[2] = axis2;
+        glm::vec3 lmin(FLT_MAX), lmax(-FLT_MAX);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 p = point(i);
+            glm::vec3 l(glm::dot(p, axis0), glm::dot(p, axis1), glm::dot(p, axis2));
+            lmin = glm::min(lmin, l);
+            lmax = glm::max(lmax, l);
+        }
+        glm::vec3 mid = (lmin + lmax) * 0.5f;
+        box.center = axis0 * mid.x + axis1 * mid.y + axis2 * mid.z;
+        box.halfExtents = (lmax - lmin) * 0.5f;
+
+        OBB aligned = fromAABB(bmin, bmax);
+        return (box.volume() < aligned.volume()) ? box : aligned;
+    }
+
+private:
+    // 對稱 3x3 矩陣的特徵向量（Jacobi 旋轉），回傳的矩陣每一行（column）為一個特徵向量
+    static glm::mat3 jacobiEigenvectors(glm::mat3 a) {
+        glm::mat3 v(1.0f);
+        for (int sweep = 0; sweep < 16; ++sweep) {
+            float off = a[1][0] * a[1][0] + a[2][0] * a[2][0] + a[2][1] * a[2][1];
+            float diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+            if (off <= 1e-12f * diag) break;
+            for (int p = 0; p < 2; ++p) {
+                for (int q = p + 1; q < 3; ++q) {
+                    float apq = a[q][p];
+                    if (apq == 0.0f) continue;
+                    float theta = (a[q][q] - a[p][p]) / (2.0f * apq);
+                    float t = ((theta >= 0.0f) ? 1.0f : -1.0f) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0f));
+                    float c = 1.0f / std::sqrt(t * t + 1.0f), s = t * c;
+                    glm::mat3 j(1.0f);
+                    j[p][p] = c; j[q][q] = c;
+                    j[q][p] = s; j[p][q] = -s;
+                    a = glm::transpose(j) * a * j;
+                    v = v * j;
+                }
+            }
+        }
+        return v;
+    }
+};
+
+#endif // COLLISION_OBB_H
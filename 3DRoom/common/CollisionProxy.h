@@ -0,0 +1,93 @@
+#ifndef COLLISION_PROXY_H
+#define COLLISION_PROXY_H
+
+// 由模型網格產生的碰撞代理形狀（模型空間）
+// 每個網格一個：AABB 以及簡化的凸包（在固定的 26 個方向上最遠的頂點，最多 COLLISION_PROXY_HULL_BUDGET 個）
+// 凸包的頂點都是網格上的點，經過 world 矩陣轉換後取範圍，旋轉的物件也能得到貼近的世界座標 AABB
+// box 為以全部頂點擬合的 OBB，物件旋轉後比世界座標 AABB 更貼近時由 CollisionManager 使用
+// Model::LoadModel 建立後與網格資料一起存在 .mcache，重新啟動時不需要再計算
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+#include <vector>
+#include <glm/glm.hpp>
+#include "CollisionOBB.h"
+
+#define COLLISION_PROXY_HULL_BUDGET 26
+
+struct CollisionProxy {
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    std::vector<glm::vec3> hull;
+    OBB box;
+
+    bool empty() const { return hull.empty(); }
+
+    // positions 為 count 個頂點，相鄰兩個頂點的位置相差 stride 個 float（例如 Vertex 為 8）
+    void build(const float* positions, size_t count, size_t stride, int hullBudget = COLLISION_PROXY_HULL_BUDGET) {
+        hull.clear();
+        box = OBB();
+        if (count == 0) return;
+        box = OBB::fitPoints(positions, count, stride);
+
+        // 26 個方向：6 個軸、12 個邊、8 個角，依序取用直到用完頂點預算
+        std::vector<glm::vec3> directions;
+        for (int pass = 1; pass <= 3; ++pass) {
+            for (int x = -1; x <= 1; ++x)
+                for (int y = -1; y <= 1; ++y)
+                    for (int z = -1; z <= 1; ++z) {
+                        if (std::abs(x) + std::abs(y) + std::abs(z) == pass) {
+                            directions.push_back(glm::vec3(x, y, z));
+                        }
+                    }
+        }
+        if (hullBudget < static_cast<int>(directions.size())) directions.resize(std::max(hullBudget, 0));
+
+        std::vector<size_t> best(directions.size(), 0);
+        std::vector<float> bestDot(directions.size(), -FLT_MAX);
+        boundsMin = glm::vec3(FLT_MAX);
+        boundsMax = glm::vec3(-FLT_MAX);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 p(positions[i * stride], positions[i * stride + 1], positions[i * stride + 2]);
+            boundsMin = glm::min(boundsMin, p);
+            boundsMax = glm::max(boundsMax, p);
+            for (size_t d = 0; d < directions.size(); ++d) {
+                float dot = glm::dot(p, directions[d]);
+                if (dot > bestDot[d]) {
+                    bestDot[d] = dot;
+                    best[d] = i;
+                }
+            }
+        }
+        // 同一個頂點可能是多個方向的最遠點
+        std::sort(best.begin(), best.end());
+        best.erase(std::unique(best.begin(), best.end()), best.end());
+        for (size_t i : best) {
+            hull.push_back(glm::vec3(positions[i * stride], positions[i * stride + 1], positions[i * stride + 2]));
+        }
+    }
+
+    // 世界座標的 AABB：轉換凸包頂點後取範圍，沒有凸包時轉換 AABB 的八個角
+    void worldBounds(const glm::mat4& world, glm::vec3& outMin, glm::vec3& outMax) const {
+        outMin = glm::vec3(FLT_MAX);
+        outMax = glm::vec3(-FLT_MAX);
+        if (!hull.empty()) {
+            for (const glm::vec3& p : hull) {
+                glm::vec3 w = glm::vec3(world * glm::vec4(p, 1.0f));
+                outMin = glm::min(outMin, w);
+                outMax = glm::max(outMax, w);
+            }
+            return;
+        }
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 p((corner & 1) ? boundsMax.x : boundsMin.x, (corner & 2) ? boundsMax.y : boundsMin.y,
+                        (corner & 4) ? boundsMax.z : boundsMin.z);
+            glm::vec3 w = glm::vec3(world * glm::vec4(p, 1.0f));
+            outMin = glm::min(outMin, w);
+            outMax = glm::max(outMax, w);
+        }
+    }
+};
+
+#endif // COLLISION_PROXY_H
@@ -0,0 +1,23 @@
+//  IndexWidth.h
+//  上傳索引緩衝區時，頂點不超過 65536 個的網格改用 16-bit 索引（Model 與 CShape 共用）
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define INDEX16_LIMIT 65536u
+
+inline bool fitsIndex16(const unsigned int* indices, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= INDEX16_LIMIT) return false;
+    }
+    return true;
+}
+
+// 呼叫前以 fitsIndex16 確認
+inline void narrowIndices(const unsigned int* indices, size_t count, std::vector<uint16_t>& narrow) {
+    narrow.resize(count);
+    for (size_t i = 0; i < count; ++i) narrow[i] = static_cast<uint16_t>(indices[i]);
+}
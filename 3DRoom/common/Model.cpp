@@ -1,4 +1,8 @@
 #include "Model.h"
+#include "CMeshCache.h"
+#include "CMeshOptimize.h"
+#include "CParallel.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -8,6 +12,8 @@
 //#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+VertexFormat Model::s_defaultVertexFormat = VertexFormat::QUANTIZED;
+
 Model::~Model() {
     Cleanup();
 }
@@ -18,11 +24,34 @@ bool Model::LoadModel(const std::string& filepath) {
     
     // 取得檔案目錄
     directory = GetDirectory(filepath);
+    sourcePath = filepath;
+    
+    // 有最新的 .mcache 時直接使用處理好的網格與碰撞代理，不需要解析 OBJ
+    std::vector<tinyobj::material_t> objMaterials;
+    std::vector<Mesh> cachedMeshes;
+    if (CMeshCache::load(filepath, objMaterials, cachedMeshes, collisionProxies)) {
+        ProcessMaterials(objMaterials);
+        for (Mesh& mesh : cachedMeshes) {
+            _boundsMin = glm::min(_boundsMin, mesh.boundsMin);
+            _boundsMax = glm::max(_boundsMax, mesh.boundsMax);
+            SetupMesh(mesh);
+            meshes.push_back(std::move(mesh));
+        }
+        SetVertexFormat(s_defaultVertexFormat);
+        BuildMeshBVHs();
+        BuildLods();
+        std::cout << "Successfully loaded model from cache: " << CMeshCache::cachePath(filepath) << std::endl;
+        std::cout << "Meshes: " << meshes.size() << ", Materials: " << materials.size() << std::endl;
+        std::cout << "Vertex buffers: " << GetVertexBufferBytes() / 1024 << " KB (float vertices "
+                  << GetFloatVertexBufferBytes() / 1024 << " KB)" << std::endl;
+        std::cout << "Index buffers: " << GetIndexBufferBytes() / 1024 << " KB (32-bit indices "
+                  << GetUint32IndexBufferBytes() / 1024 << " KB)" << std::endl;
+        return true;
+    }
     
     // TinyObjLoader 變數
     tinyobj::attrib_t attrib;
     std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> objMaterials;
     std::string warn, err;
     
     // 載入 OBJ 檔案
@@ -56,9 +85,26 @@ bool Model::LoadModel(const std::string& filepath) {
     for (const auto& shape : shapes) {
         ProcessMesh(attrib, shape, objMaterials);
     }
+    // 位置以整個模型的包圍盒量化，所有網格處理完才上傳頂點
+    SetVertexFormat(s_defaultVertexFormat);
+    
+    // 每個網格的碰撞代理，與網格資料一起寫入快取
+    collisionProxies.assign(meshes.size(), CollisionProxy());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const std::vector<Vertex>& vertices = meshes[i].vertices;
+        if (vertices.empty()) continue;
+        collisionProxies[i].build(vertices[0].position, vertices.size(), sizeof(Vertex) / sizeof(float));
+    }
+    CMeshCache::save(filepath, objMaterials, meshes, collisionProxies);
+    BuildMeshBVHs();
+    BuildLods();
     
     std::cout << "Successfully loaded model: " << filepath << std::endl;
     std::cout << "Meshes: " << meshes.size() << ", Materials: " << materials.size() << std::endl;
+    std::cout << "Vertex buffers: " << GetVertexBufferBytes() / 1024 << " KB (float vertices "
+              << GetFloatVertexBufferBytes() / 1024 << " KB)" << std::endl;
+    std::cout << "Index buffers: " << GetIndexBufferBytes() / 1024 << " KB (32-bit indices "
+              << GetUint32IndexBufferBytes() / 1024 << " KB)" << std::endl;
     
     return true;
 }
@@ -265,6 +311,15 @@ void Model::ProcessMesh(const tinyobj::attrib_t& attrib,
         }
     }
 
+    // 累計模型的包圍盒
+    for (const Vertex& v : mesh.vertices) {
+        glm::vec3 p(v.position[0], v.position[1], v.position[2]);
+        mesh.boundsMin = glm::min(mesh.boundsMin, p);
+        mesh.boundsMax = glm::max(mesh.boundsMax, p);
+    }
+    _boundsMin = glm::min(_boundsMin, mesh.boundsMin);
+    _boundsMax = glm::max(_boundsMax, mesh.boundsMax);
+
     // 設定材質索引
     if (!shape.mesh.material_ids.empty() && shape.mesh.material_ids[0] >= 0) {
         mesh.materialIndex = shape.mesh.material_ids[0];
@@ -274,47 +329,358 @@ void Model::ProcessMesh(const tinyobj::attrib_t& attrib,
         std::cout << "  Mesh has no material index" << std::endl;
     }
 
+    // 依叢集重新排列索引與頂點（之後的 BVH、LOD 與快取都使用排列後的順序）
+    if (!mesh.vertices.empty()) {
+        CMeshCluster::build(mesh.vertices[0].position, mesh.vertices.size(), sizeof(Vertex) / sizeof(float),
+                            mesh.indices, mesh.clusters);
+        std::cout << "  Mesh clusters: " << mesh.clusters.size() << std::endl;
+
+        // 叢集內的頂點快取順序、叢集的 overdraw 順序與頂點讀取順序（ACMR / ATVR 與 OBJ 原本的順序比較）
+        VertexCacheStats before = CMeshOptimize::analyze(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+        CMeshOptimize::optimize(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), mesh.indices, mesh.clusters);
+        VertexCacheStats after = CMeshOptimize::analyze(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+        std::cout << "  Vertex cache ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr
+                  << " -> " << after.atvr << std::endl;
+    }
+
     // 設置 OpenGL 緩衝區
     SetupMesh(mesh);
 
     meshes.push_back(mesh);
 }
 
+void Model::BuildMeshBVHs() {
+    meshBVHs.assign(meshes.size(), CTriangleBVH());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh& mesh = meshes[i];
+        if (mesh.vertices.empty() || mesh.indices.empty()) continue;
+        meshBVHs[i].build(mesh.vertices[0].position, sizeof(Vertex) / sizeof(float),
+                          mesh.indices.data(), mesh.indices.size());
+    }
+}
+
+bool Model::Raycast(const glm::mat4& world, const glm::vec3& origin, const glm::vec3& dir, float maxT,
+                    ModelRayHit& hit) const {
+    glm::mat4 invWorld = glm::inverse(world);
+    bool found = false;
+    float closest = maxT;
+    for (size_t i = 0; i < meshBVHs.size(); ++i) {
+        BVHHit h;
+        if (!meshBVHs[i].intersectInstance(invWorld, origin, dir, closest, h)) continue;
+        closest = h.t;
+        hit.t = h.t;
+        hit.mesh = static_cast<int>(i);
+        hit.triangle = h.triangle;
+        found = true;
+    }
+    if (!found) return false;
+
+    hit.point = origin + dir * hit.t;
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+    glm::vec3 n = glm::normalize(normalMatrix * meshBVHs[hit.mesh].getTriangleNormal(hit.triangle));
+    hit.normal = (glm::dot(n, dir) > 0.0f) ? -n : n;
+    return true;
+}
+
+bool Model::ClosestPoint(const glm::mat4& world, const glm::vec3& center, float radius, ModelSphereHit& hit) const {
+    glm::mat4 invWorld = glm::inverse(world);
+    bool found = false;
+    float closest = radius;
+    for (size_t i = 0; i < meshBVHs.size(); ++i) {
+        BVHSphereHit h;
+        if (!meshBVHs[i].closestPointInstance(world, invWorld, center, closest, h)) continue;
+        closest = h.distance;
+        hit.distance = h.distance;
+        hit.mesh = static_cast<int>(i);
+        hit.triangle = h.triangle;
+        hit.point = h.point;
+        found = true;
+    }
+    return found;
+}
+
+void Model::BuildLods() {
+    if (!CMeshCache::loadLods(sourcePath, MESH_LOD_MAX, meshes)) {
+        // 每個網格獨立簡化（不同材質的網格之間的邊界固定不動）
+        parallelFor(0, static_cast<int>(meshes.size()), hardwareThreadCount(), 1, [&](int i) {
+            Mesh& mesh = meshes[i];
+            if (mesh.vertices.empty()) {
+                mesh.lods.assign(1, MeshLod());
+                return;
+            }
+            CMeshSimplify::buildLods(mesh.vertices[0].position, mesh.vertices.size(), sizeof(Vertex) / sizeof(float),
+                                     mesh.indices.data(), mesh.indices.size(), MESH_LOD_MAX, mesh.lodIndices, mesh.lods);
+        });
+        CMeshCache::saveLods(sourcePath, MESH_LOD_MAX, meshes);
+    }
+    
+    // 原本的索引之後接著 LOD 的索引，所有 LOD 共用同一個 VAO
+    std::vector<size_t> triangles(MESH_LOD_MAX, 0);
+    float error[MESH_LOD_MAX] = {};
+    for (Mesh& mesh : meshes) {
+        for (int k = 0; k < MESH_LOD_MAX; ++k) {
+            const MeshLod& lod = mesh.lods[std::min(k, static_cast<int>(mesh.lods.size()) - 1)];
+            triangles[k] += lod.indexCount / 3;
+            error[k] = std::max(error[k], lod.error);
+        }
+        if (mesh.lods.size() < 2 || mesh.EBO == 0) continue;
+        UploadIndices(mesh);
+    }
+    std::cout << "LOD triangles:";
+    for (int k = 0; k < MESH_LOD_MAX; ++k) {
+        std::cout << (k ? " / " : " ") << triangles[k];
+        if (k > 0) std::cout << " (error " << error[k] << ")";
+    }
+    std::cout << std::endl;
+}
+
 void Model::SetupMesh(Mesh& mesh) {
     glGenVertexArrays(1, &mesh.VAO);
     glGenBuffers(1, &mesh.VBO);
     glGenBuffers(1, &mesh.EBO);
     
-    glBindVertexArray(mesh.VAO);
-    
-    // 頂點緩衝區
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Vertex),
-                 mesh.vertices.data(), GL_STATIC_DRAW);
+    UploadIndices(mesh);
+}
+
+void Model::UploadIndices(Mesh& mesh) {
+    // 原本的索引之後接著 LOD 的索引（BuildLods 之前 lodIndices 為空）
+    std::vector<unsigned int> combined;
+    const std::vector<unsigned int>* source = &mesh.indices;
+    if (!mesh.lodIndices.empty()) {
+        combined.reserve(mesh.indices.size() + mesh.lodIndices.size());
+        combined.insert(combined.end(), mesh.indices.begin(), mesh.indices.end());
+        combined.insert(combined.end(), mesh.lodIndices.begin(), mesh.lodIndices.end());
+        source = &combined;
+    }
     
-    // 索引緩衝區
+    glBindVertexArray(mesh.VAO);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int),
-                 mesh.indices.data(), GL_STATIC_DRAW);
+    if (fitsIndex16(source->data(), source->size())) {
+        std::vector<uint16_t> narrow;
+        narrowIndices(source->data(), source->size(), narrow);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrow.size() * sizeof(uint16_t), narrow.data(), GL_STATIC_DRAW);
+        mesh.indexType = GL_UNSIGNED_SHORT;
+    } else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, source->size() * sizeof(unsigned int), source->data(), GL_STATIC_DRAW);
+        mesh.indexType = GL_UNSIGNED_INT;
+    }
+    glBindVertexArray(0);
+}
+
+void Model::UploadVertices(size_t meshIndex, VertexFormat format) {
+    Mesh& mesh = meshes[meshIndex];
+    if (mesh.VAO == 0 || mesh.vertices.empty()) return;
+    
+    std::vector<PackedVertex> packed;
+    if (format == VertexFormat::QUANTIZED) {
+        QuantizeError error = CVertexQuantize::pack(mesh.vertices[0].position, mesh.vertices.size(),
+                                                    sizeof(Vertex) / sizeof(float), offsetof(Vertex, normal) / sizeof(float),
+                                                    offsetof(Vertex, texCoords) / sizeof(float), _boundsMin, _boundsMax,
+                                                    packed, _vertexDecodes[meshIndex]);
+        if (!CVertexQuantize::acceptable(error)) {
+            std::cout << "  Mesh " << meshIndex << " keeps float vertices (position error " << error.position
+                      << ", uv error " << error.texCoord << ")" << std::endl;
+            format = VertexFormat::FLOAT;
+        }
+    }
+    mesh.vertexFormat = format;
     
-    // 頂點屬性
-    // 位置
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glBindVertexArray(mesh.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    if (format == VertexFormat::QUANTIZED) {
+        glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+        // 位置與紋理坐標為 unorm16（0 ~ 1，shader 以還原參數轉回），法向量為 snorm 10:10:10
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                              (void*)offsetof(PackedVertex, position));
+        glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex),
+                              (void*)offsetof(PackedVertex, normal));
+        glVertexAttribPointer(3, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                              (void*)offsetof(PackedVertex, texCoords));
+        
+        // 還原參數：divisor 為 1，非 instanced 的描繪讀取第 0 個（這個網格的那一筆）
+        size_t base = meshIndex * sizeof(VertexDecode);
+        glBindBuffer(GL_ARRAY_BUFFER, _decodeVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, base, sizeof(VertexDecode), &_vertexDecodes[meshIndex]);
+        glVertexAttribPointer(VERTEX_DECODE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(VertexDecode),
+                              (void*)(base + offsetof(VertexDecode, positionScale)));
+        glVertexAttribPointer(VERTEX_DECODE_LOCATION + 1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexDecode),
+                              (void*)(base + offsetof(VertexDecode, positionOffset)));
+        glVertexAttribPointer(VERTEX_DECODE_LOCATION + 2, 4, GL_FLOAT, GL_FALSE, sizeof(VertexDecode),
+                              (void*)(base + offsetof(VertexDecode, texCoordScaleOffset)));
+        for (int k = 0; k < 3; ++k) {
+            glVertexAttribDivisor(VERTEX_DECODE_LOCATION + k, 1);
+            glEnableVertexAttribArray(VERTEX_DECODE_LOCATION + k);
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Vertex), mesh.vertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+        // 沒有啟用還原參數時讀到 (0,0,0,1)，shader 直接使用 float 的值
+        for (int k = 0; k < 3; ++k) glDisableVertexAttribArray(VERTEX_DECODE_LOCATION + k);
+    }
     glEnableVertexAttribArray(0);
-    
-    // 法向量
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                         (void*)offsetof(Vertex, normal));
     glEnableVertexAttribArray(2);
-    
-    // 紋理坐標
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                         (void*)offsetof(Vertex, texCoords));
     glEnableVertexAttribArray(3);
-    
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Model::SetVertexFormat(VertexFormat format) {
+    for (size_t i = 0; i < meshes.size(); ++i) SetMeshVertexFormat(i, format);
+}
+
+void Model::SetMeshVertexFormat(size_t meshIndex, VertexFormat format) {
+    if (_decodeVBO == 0 && !meshes.empty()) {
+        _vertexDecodes.assign(meshes.size(), VertexDecode());
+        glGenBuffers(1, &_decodeVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, _decodeVBO);
+        glBufferData(GL_ARRAY_BUFFER, _vertexDecodes.size() * sizeof(VertexDecode), _vertexDecodes.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    UploadVertices(meshIndex, format);
+}
+
+size_t Model::GetVertexBufferBytes() const {
+    size_t bytes = 0;
+    for (const Mesh& mesh : meshes) {
+        bytes += mesh.vertices.size() * (mesh.vertexFormat == VertexFormat::QUANTIZED ? sizeof(PackedVertex) : sizeof(Vertex));
+    }
+    return bytes;
+}
+
+size_t Model::GetFloatVertexBufferBytes() const {
+    size_t bytes = 0;
+    for (const Mesh& mesh : meshes) bytes += mesh.vertices.size() * sizeof(Vertex);
+    return bytes;
+}
+
+size_t Model::GetIndexBufferBytes() const {
+    size_t bytes = 0;
+    for (const Mesh& mesh : meshes) bytes += (mesh.indices.size() + mesh.lodIndices.size()) * mesh.indexSize();
+    return bytes;
+}
+
+size_t Model::GetUint32IndexBufferBytes() const {
+    size_t bytes = 0;
+    for (const Mesh& mesh : meshes) bytes += (mesh.indices.size() + mesh.lodIndices.size()) * sizeof(unsigned int);
+    return bytes;
+}
+
+bool Model::LoadFracture(int pieces, unsigned seed) {
+    if (meshes.empty()) return false;
+    fractureChunks.clear();
+    if (CMeshCache::loadFracture(sourcePath, pieces, seed, fractureChunks)) {
+        std::cout << "Loaded fracture from cache: " << CMeshCache::fracturePath(sourcePath) << std::endl;
+    } else {
+        static_assert(sizeof(FractureVertex) == sizeof(Vertex), "FractureVertex must match Vertex");
+        std::vector<FractureInput> inputs(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            if (meshes[i].vertices.empty()) continue;
+            inputs[i].vertices = meshes[i].vertices[0].position;
+            inputs[i].vertexCount = meshes[i].vertices.size();
+            inputs[i].indices = meshes[i].indices.data();
+            inputs[i].indexCount = meshes[i].indices.size();
+        }
+        FractureOptions options;
+        options.pieces = pieces;
+        options.seed = seed;
+        options.threads = hardwareThreadCount();
+        CMeshFracture::fracture(inputs, options, fractureChunks);
+        CMeshCache::saveFracture(sourcePath, pieces, seed, fractureChunks);
+    }
+    SetupFracture();
+    std::cout << "Fracture: " << sourcePath << " -> " << fractureChunks.size() << " chunks" << std::endl;
+    return !fractureChunks.empty();
+}
+
+void Model::SetupFracture() {
+    if (fractureVAO != 0) glDeleteVertexArrays(1, &fractureVAO);
+    if (fractureVBO != 0) glDeleteBuffers(1, &fractureVBO);
+    if (fractureEBO != 0) glDeleteBuffers(1, &fractureEBO);
+    fractureVAO = fractureVBO = fractureEBO = 0;
+    fractureIndexOffsets.clear();
+    if (fractureChunks.empty()) return;
+
+    std::vector<FractureVertex> vertices;
+    std::vector<unsigned int> indices;
+    for (const FractureChunk& chunk : fractureChunks) {
+        unsigned int base = static_cast<unsigned int>(vertices.size());
+        fractureIndexOffsets.push_back(static_cast<unsigned int>(indices.size()));
+        vertices.insert(vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+        for (unsigned int index : chunk.indices) indices.push_back(base + index);
+    }
+
+    glGenVertexArrays(1, &fractureVAO);
+    glGenBuffers(1, &fractureVBO);
+    glGenBuffers(1, &fractureEBO);
+    glBindVertexArray(fractureVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, fractureVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(FractureVertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, fractureEBO);
+    // 所有碎片共用一個緩衝區，以全部碎片的頂點數決定索引寬度
+    if (fitsIndex16(indices.data(), indices.size())) {
+        std::vector<uint16_t> narrow;
+        narrowIndices(indices.data(), indices.size(), narrow);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrow.size() * sizeof(uint16_t), narrow.data(), GL_STATIC_DRAW);
+        fractureIndexType = GL_UNSIGNED_SHORT;
+    } else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        fractureIndexType = GL_UNSIGNED_INT;
+    }
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(FractureVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(FractureVertex), (void*)offsetof(FractureVertex, normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(FractureVertex), (void*)offsetof(FractureVertex, texCoords));
+    glEnableVertexAttribArray(3);
+    // 實體的模型矩陣每個實體前進一次，指向的緩衝區與位置在描繪時設定
+    for (int column = 0; column < 4; ++column) {
+        glEnableVertexAttribArray(INSTANCE_MATRIX_LOCATION + column);
+        glVertexAttribDivisor(INSTANCE_MATRIX_LOCATION + column, 1);
+    }
     glBindVertexArray(0);
 }
 
+void Model::RenderFractureInstanced(GLuint shaderProgram, GLuint instanceBuffer, const DebrisInstanceRange* ranges) {
+    if (fractureVAO == 0) return;
+    bool any = false;
+    for (size_t c = 0; c < fractureChunks.size(); ++c) any = any || ranges[c].count > 0;
+    if (!any) return;
+
+    glUseProgram(shaderProgram);
+    GLint instancedLoc = glGetUniformLocation(shaderProgram, "uInstanced");
+    glUniform1i(instancedLoc, 1);
+    glBindVertexArray(fractureVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (size_t m = 0; m < meshes.size(); ++m) {
+        bool bound = false;
+        for (size_t c = 0; c < fractureChunks.size(); ++c) {
+            if (ranges[c].count == 0) continue;
+            for (const FractureSection& section : fractureChunks[c].sections) {
+                if (section.mesh != static_cast<int>(m)) continue;
+                if (!bound) {
+                    BindMaterial(meshes[m].materialIndex, shaderProgram);
+                    bound = true;
+                }
+                // OpenGL 3.3 沒有 base instance，改變實體屬性的起點指向這個碎片的實體
+                size_t offset = static_cast<size_t>(ranges[c].first) * sizeof(glm::mat4);
+                for (int column = 0; column < 4; ++column) {
+                    glVertexAttribPointer(INSTANCE_MATRIX_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                          (void*)(offset + column * sizeof(glm::vec4)));
+                }
+                size_t first = fractureIndexOffsets[c] + section.indexStart;
+                size_t indexSize = fractureIndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+                glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(section.indexCount), fractureIndexType,
+                                        (void*)(first * indexSize), ranges[c].count);
+            }
+        }
+        if (bound) UnbindTextures();
+    }
+    glBindVertexArray(0);
+    glUniform1i(instancedLoc, 0);
+}
+
 GLuint Model::LoadTexture(const std::string& path) {
     // 檢查檔案是否存在
     std::ifstream file(path);
@@ -433,50 +799,159 @@ GLuint Model::LoadTexture(const std::string& path) {
 }
 
 void Model::Render(GLuint shaderProgram) {
+    RenderOpaque(shaderProgram);
+    
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);  // 禁止寫入深度緩衝區，但仍進行深度測試
+    
+    for (size_t i = 0; i < meshes.size(); i++) {
+        if (IsTransparent(meshes[i])) RenderMesh(i, shaderProgram);
+    }
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+size_t Model::RenderOpaque(GLuint shaderProgram, float pixelsPerUnit, float pixelError,
+                           const CClusterCuller* culler, int firstItem) {
     // 確保 shader 程式是當前使用的
     glUseProgram(shaderProgram);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
     
-    std::vector<size_t> opaqueMeshes;
-    std::vector<size_t> transparentMeshes;
-    
+    size_t triangles = 0;
     for (size_t i = 0; i < meshes.size(); i++) {
-        const Mesh& mesh = meshes[i];
-        bool isTransparent = false;
-        
+        if (IsTransparent(meshes[i])) continue;
+        int item = (culler != nullptr && firstItem >= 0) ? firstItem + static_cast<int>(i) : -1;
+        if (item >= 0 && culler->isClustered(item)) {
+            int count = 0;
+            const ClusterDrawRange* ranges = culler->getRanges(item, count);
+            triangles += RenderMeshRanges(i, shaderProgram, ranges, count);
+            continue;
+        }
+        triangles += RenderMesh(i, shaderProgram, SelectLod(i, pixelsPerUnit, pixelError));
+    }
+    return triangles;
+}
+
+int Model::AddClusterItems(CClusterCuller& culler, const glm::mat4& world, float pixelsPerUnit, float pixelError) const {
+    int first = culler.getItemCount();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        bool clustered = !IsTransparent(meshes[i]) && SelectLod(i, pixelsPerUnit, pixelError) == 0;
+        culler.add(clustered ? &meshes[i].clusters : nullptr, world);
+    }
+    return first;
+}
+
+// LOD 的誤差（模型空間的距離）乘上每單位的像素數即為螢幕上的誤差
+int Model::SelectLod(size_t meshIndex, float pixelsPerUnit, float pixelError) const {
+    if (pixelsPerUnit <= 0.0f) return 0;
+    const std::vector<MeshLod>& lods = meshes[meshIndex].lods;
+    for (int k = static_cast<int>(lods.size()) - 1; k > 0; --k) {
+        if (lods[k].error * pixelsPerUnit <= pixelError) return k;
+    }
+    return 0;
+}
+
+size_t Model::GetOpaqueTriangleCount() const {
+    size_t triangles = 0;
+    for (const Mesh& mesh : meshes) {
+        if (!IsTransparent(mesh)) triangles += mesh.indices.size() / 3;
+    }
+    return triangles;
+}
+
+bool Model::IsTransparent(const Mesh& mesh) const {
+    if (mesh.materialIndex >= 0 && mesh.materialIndex < materials.size()) {
+        const Material& material = materials[mesh.materialIndex];
+        return (material.alpha < 1.0f) || (material.alphaTexture != 0);
+    }
+    return false;
+}
+
+void Model::RenderDepth() {
+    // mxModel 與光源矩陣由呼叫端（CShadowManager）設定
+    for (const Mesh& mesh : meshes) {
+        if (IsTransparent(mesh)) continue;
+        glBindVertexArray(mesh.VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), mesh.indexType, 0);
+    }
+    glBindVertexArray(0);
+}
+
+void Model::RenderProxy(GLuint shaderProgram) {
+    // mxModel 與 view/proj 由呼叫端（CReflectionProbe）設定
+    GLint diffuseLoc = glGetUniformLocation(shaderProgram, "uDiffuseColor");
+    GLint hasTexLoc = glGetUniformLocation(shaderProgram, "uHasDiffuseTexture");
+    glActiveTexture(GL_TEXTURE0);
+    for (const Mesh& mesh : meshes) {
+        if (IsTransparent(mesh)) continue;
         if (mesh.materialIndex >= 0 && mesh.materialIndex < materials.size()) {
             const Material& material = materials[mesh.materialIndex];
-            isTransparent = (material.alpha < 1.0f) || (material.alphaTexture != 0);
-        }
-        
-        if (isTransparent) {
-            transparentMeshes.push_back(i);
+            glUniform3f(diffuseLoc, material.diffuse[0], material.diffuse[1], material.diffuse[2]);
+            glUniform1i(hasTexLoc, material.diffuseTexture != 0 ? 1 : 0);
+            glBindTexture(GL_TEXTURE_2D, material.diffuseTexture);
         } else {
-            opaqueMeshes.push_back(i);
+            glUniform3f(diffuseLoc, 0.8f, 0.8f, 0.8f);
+            glUniform1i(hasTexLoc, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
         }
+        glBindVertexArray(mesh.VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), mesh.indexType, 0);
     }
-    // 如果有透明物體，需要啟用混合
-    glDisable(GL_BLEND);
-    glDepthMask(GL_TRUE);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+size_t Model::RenderMesh(size_t meshIndex, GLuint shaderProgram, int lod) {
+    const Mesh& mesh = meshes[meshIndex];
+    BindMaterial(mesh.materialIndex, shaderProgram);
     
-    for (size_t i : opaqueMeshes) {
-        RenderMesh(i, shaderProgram);
+    // 渲染：LOD 的索引在 EBO 中接在原本的索引之後
+    size_t indexStart = 0, indexCount = mesh.indices.size();
+    if (lod > 0 && lod < static_cast<int>(mesh.lods.size())) {
+        indexStart = mesh.lods[lod].indexStart;
+        indexCount = mesh.lods[lod].indexCount;
     }
+    glBindVertexArray(mesh.VAO);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indexCount), mesh.indexType,
+                   (void*)(indexStart * mesh.indexSize()));
+    glBindVertexArray(0);
     
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDepthMask(GL_FALSE);  // 禁止寫入深度緩衝區，但仍進行深度測試
-    
-    for (size_t i : transparentMeshes) {
-        RenderMesh(i, shaderProgram);
+    // 檢查 OpenGL 錯誤
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        std::cerr << "  OpenGL error during rendering: " << error << std::endl;
     }
-
-    glDepthMask(GL_TRUE);
-    glDisable(GL_BLEND);
+    
+    UnbindTextures();
+    return indexCount / 3;
 }
 
-void Model::RenderMesh(size_t meshIndex, GLuint shaderProgram) {
+size_t Model::RenderMeshRanges(size_t meshIndex, GLuint shaderProgram, const ClusterDrawRange* ranges, int count) {
+    // 所有叢集都被剔除時不需要綁定材質
+    if (count <= 0) return 0;
     const Mesh& mesh = meshes[meshIndex];
+    BindMaterial(mesh.materialIndex, shaderProgram);
+    
+    _rangeCounts.resize(count);
+    _rangeOffsets.resize(count);
+    size_t indexCount = 0;
+    for (int r = 0; r < count; ++r) {
+        _rangeCounts[r] = static_cast<GLsizei>(ranges[r].indexCount);
+        _rangeOffsets[r] = (const void*)(ranges[r].indexStart * mesh.indexSize());
+        indexCount += ranges[r].indexCount;
+    }
+    glBindVertexArray(mesh.VAO);
+    glMultiDrawElements(GL_TRIANGLES, _rangeCounts.data(), mesh.indexType, _rangeOffsets.data(), count);
+    glBindVertexArray(0);
     
+    UnbindTextures();
+    return indexCount / 3;
+}
+
+void Model::BindMaterial(int materialIndex, GLuint shaderProgram) {
     // 重置紋理單元
     for (int i = 0; i < 6; i++) {
         glActiveTexture(GL_TEXTURE0 + i);
@@ -496,12 +971,8 @@ void Model::RenderMesh(size_t meshIndex, GLuint shaderProgram) {
     glUniform1f(glGetUniformLocation(shaderProgram, "uMaterial.reflectivity"), 0.0f);
     
         // 綁定材質
-        if (mesh.materialIndex >= 0 && mesh.materialIndex < materials.size()) {
-            const Material& material = materials[mesh.materialIndex];
-            std::cout << "EnvMap: " << material.environmentMapTexture << ", hasEnv: " << material.hasEnvironmentMap << std::endl;
-
-            std::cout << "  Applying material: " << material.name << std::endl;
-
+        if (materialIndex >= 0 && materialIndex < materials.size()) {
+            const Material& material = materials[materialIndex];
             // 設定材質屬性 uniform 變數
             GLint ambientLoc = glGetUniformLocation(shaderProgram, "uMaterial.ambient");
             GLint diffuseLoc = glGetUniformLocation(shaderProgram, "uMaterial.diffuse");
@@ -536,7 +1007,6 @@ void Model::RenderMesh(size_t meshIndex, GLuint shaderProgram) {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasDiffuseTexture"), 1); // 重要！
             } else {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasDiffuseTexture"), 0);
-                std::cout << "    No diffuse texture" << std::endl;
             }
 
             // 綁定法線貼圖
@@ -547,7 +1017,6 @@ void Model::RenderMesh(size_t meshIndex, GLuint shaderProgram) {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasNormalTexture"), 1);
             } else {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasNormalTexture"), 0);
-                std::cout << "    No normal texture" << std::endl;
             }
 
             // 綁定鏡面反射貼圖
@@ -558,7 +1027,6 @@ void Model::RenderMesh(size_t meshIndex, GLuint shaderProgram) {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasSpecularTexture"), 1);
             } else {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasSpecularTexture"), 0);
-                std::cout << "    No specular texture" << std::endl;
             }
             // 綁定透明度貼圖
             if (material.alphaTexture != 0) {
@@ -566,10 +1034,8 @@ void Model::RenderMesh(size_t meshIndex, GLuint shaderProgram) {
                 glBindTexture(GL_TEXTURE_2D, material.alphaTexture);
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.alphaTexture"), 3);
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasAlphaTexture"), 1);  // 添加這行！
-                std::cout << "    Using alpha texture" << std::endl;
             } else {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasAlphaTexture"), 0);  // 添加這行！
-                std::cout << "    No alpha texture" << std::endl;
             }
             if (material.lightMapTexture != 0) {
                 glActiveTexture(GL_TEXTURE4);
@@ -578,49 +1044,34 @@ void Model::RenderMesh(size_t meshIndex, GLuint shaderProgram) {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasLightMap"), 1);
                 glUniform1f(glGetUniformLocation(shaderProgram, "uMaterial.lightMapIntensity"), material.lightMapIntensity);
                 
-               glUniform1f(glGetUniformLocation(shaderProgram, "uLightMapGamma"), 1.0f);
-               glUniform1i(glGetUniformLocation(shaderProgram, "uLightMapBlendMode"), 1);  // 0=Multiply
+               if (material.lightMapBaked) {
+                   // 烘焙的光照以 gamma 2.2 儲存，在 shader 中乘上材質顏色後加到動態光源的結果
+                   glUniform1f(glGetUniformLocation(shaderProgram, "uLightMapGamma"), 2.2f);
+                   glUniform1i(glGetUniformLocation(shaderProgram, "uLightMapBlendMode"), 4);  // 4=Baked lighting
+               } else {
+                   glUniform1f(glGetUniformLocation(shaderProgram, "uLightMapGamma"), 1.0f);
+                   glUniform1i(glGetUniformLocation(shaderProgram, "uLightMapBlendMode"), 1);  // 0=Multiply
+               }
                glUniform1i(glGetUniformLocation(shaderProgram, "uUseLightMapAO"), 0);      // 或 1 如果要用作 AO
-                std::cout << "    Using light map texture (ID: " << material.lightMapTexture << ")" << std::endl;
             } else {
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasLightMap"), 0);
             }
             
             if (material.environmentMapTexture != 0) {
                 glActiveTexture(GL_TEXTURE5);
-                
-                GLint boundTexture;
-                glGetIntegerv(GL_TEXTURE_BINDING_CUBE_MAP, &boundTexture);
-                std::cout << "    Bound cube map texture ID: " << boundTexture << std::endl;
                 glBindTexture(GL_TEXTURE_CUBE_MAP, material.environmentMapTexture);
                 
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.environmentMap"), 5);
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasEnvironmentMap"), 1);
                 glUniform1f(glGetUniformLocation(shaderProgram, "uMaterial.reflectivity"), material.reflectivity); // 傳遞反射強度
-                
-                std::cout << "    Using environment map texture (ID: " << material.environmentMapTexture
-                                      << "), Reflectivity: " << material.reflectivity << std::endl;
             } else {
                 glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
                 glUniform1i(glGetUniformLocation(shaderProgram, "uMaterial.hasEnvironmentMap"), 0);
             }
-
-        } else {
-            std::cout << "  Mesh has no material assigned" << std::endl;
         }
-    
-    // 渲染
-    glBindVertexArray(mesh.VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-    
-    // 檢查 OpenGL 錯誤
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cerr << "  OpenGL error during rendering: " << error << std::endl;
-    }
-    
-    // 清理紋理綁定
+}
+
+void Model::UnbindTextures() {
     for (int i = 0; i < 6; i++) {
         glActiveTexture(GL_TEXTURE0 + i);
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -643,8 +1094,22 @@ void Model::Cleanup() {
         if (material.lightMapTexture != 0) glDeleteTextures(1, &material.lightMapTexture);
     }
     
+    if (fractureVAO != 0) glDeleteVertexArrays(1, &fractureVAO);
+    if (fractureVBO != 0) glDeleteBuffers(1, &fractureVBO);
+    if (fractureEBO != 0) glDeleteBuffers(1, &fractureEBO);
+    fractureVAO = fractureVBO = fractureEBO = 0;
+    if (_decodeVBO != 0) glDeleteBuffers(1, &_decodeVBO);
+    _decodeVBO = 0;
+    _vertexDecodes.clear();
+    
     meshes.clear();
     materials.clear();
+    collisionProxies.clear();
+    meshBVHs.clear();
+    fractureChunks.clear();
+    fractureIndexOffsets.clear();
+    _boundsMin = glm::vec3(FLT_MAX);
+    _boundsMax = glm::vec3(-FLT_MAX);
 }
 
 const Material& Model::GetMaterial(size_t index) const {
@@ -852,6 +1317,24 @@ void Model::SetLightMap(const std::string& materialName, const std::string& ligh
     }
 }
 
+bool Model::SetBakedLightMap(const std::string& materialName, const std::string& lightMapPath, float intensity) {
+    for (auto& mat : materials) {
+        if (mat.name == materialName) {
+            GLuint texture = LoadTexture(lightMapPath);
+            if (texture == 0) return false;
+            if (mat.lightMapTexture != 0) glDeleteTextures(1, &mat.lightMapTexture);
+            mat.lightMapTexPath = lightMapPath;
+            mat.lightMapTexture = texture;
+            mat.hasLightMap = true;
+            mat.lightMapBaked = true;
+            mat.lightMapIntensity = intensity;
+            std::cout << "Set baked light map for material '" << materialName << "': " << lightMapPath << std::endl;
+            return true;
+        }
+    }
+    return false;
+}
+
 void Model::SetEnvironmentMap(const std::string& materialName, const std::string& environmentMapPath, float reflectivity) {
     for (auto& mat : materials) {
         if (mat.name == materialName) {
@@ -894,6 +1377,26 @@ void Model::SetEnvironmentMapFromFiles(const std::string& materialName, const st
     }
 }
 
+void Model::SetEnvironmentMapTexture(const std::string& materialName, GLuint cubeMapTexture, float reflectivity) {
+    for (auto& mat : materials) {
+        if (mat.name == materialName) {
+            // 原本從檔案載入的 cube map 不再使用
+            if (mat.environmentMapTexture != 0 && !mat.environmentMapPath.empty()) {
+                glDeleteTextures(1, &mat.environmentMapTexture);
+            }
+            mat.environmentMapPath = "";
+            mat.environmentMapTexture = cubeMapTexture;
+            mat.hasEnvironmentMap = (cubeMapTexture != 0);
+            mat.reflectivity = glm::clamp(reflectivity, 0.0f, 1.0f);
+            
+            std::cout << "Set dynamic environment map for material '" << materialName
+                      << "' (Texture ID: " << cubeMapTexture
+                      << ", Reflectivity: " << mat.reflectivity << ")" << std::endl;
+            break;
+        }
+    }
+}
+
 GLuint Model::LoadCubeMapFromSingleImage(const std::string& path) {
     // 檢查檔案是否存在
     std::ifstream file(path);
@@ -11,8 +11,19 @@
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <cfloat>
 
 #include "../models/CShape.h"
+#include "CollisionProxy.h"
+#include "CTriangleBVH.h"
+#include "CMeshFracture.h"
+#include "CMeshSimplify.h"
+#include "CMeshCluster.h"
+#include "CClusterCuller.h"
+#include "CVertexQuantize.h"
+#include "IndexWidth.h"
+#include "CDebrisPool.h"
+#include "BillboardType.h"
 // 需要包含 tiny_obj_loader.h
 //#define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
@@ -33,6 +44,9 @@ struct Vertex {
     }
 };
 
+// 實體的模型矩陣（mat4）佔用的頂點屬性位置 4 ~ 7，與 v_phong.glsl 的 aInstanceModel 相同
+#define INSTANCE_MATRIX_LOCATION 4
+
 // 材質結構
 struct Material {
     std::string name;
@@ -66,6 +80,7 @@ struct Material {
     
     bool hasLightMap;           // 是否有 Light Map
     float lightMapIntensity;    //Light Map 強度控制
+    bool lightMapBaked = false; // 由 LightmapBaker 產生（儲存烘焙的光照，而不是疊加的顏色）
     
     Material() : shininess(32.0f), alpha(1.0f),
                  diffuseTexture(0), normalTexture(0), specularTexture(0), alphaTexture(0),
@@ -84,16 +99,38 @@ struct Mesh {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
     int materialIndex;
+    glm::vec3 boundsMin, boundsMax;  // 模型空間的包圍盒（透明網格排序用）
+    // LOD（Model::BuildLods）：lods[0] 為原本的 indices，其餘的索引在 lodIndices，EBO 中接在 indices 之後
+    std::vector<unsigned int> lodIndices;
+    std::vector<MeshLod> lods;
+    // 叢集（CMeshCluster）：indices 已依叢集排列，CClusterCuller 剔除後以索引範圍描繪（只用於 LOD 0）
+    std::vector<MeshCluster> clusters;
     
     GLuint VAO, VBO, EBO;
+    VertexFormat vertexFormat;       // VBO 目前的格式（要求 QUANTIZED 但誤差超過上限時為 FLOAT）
+    GLenum indexType;                // EBO 的索引寬度（IndexWidth.h）：GL_UNSIGNED_SHORT 或 GL_UNSIGNED_INT
     
-    Mesh() : materialIndex(-1), VAO(0), VBO(0), EBO(0) {}
+    Mesh() : materialIndex(-1), boundsMin(FLT_MAX), boundsMax(-FLT_MAX), VAO(0), VBO(0), EBO(0),
+             vertexFormat(VertexFormat::FLOAT), indexType(GL_UNSIGNED_INT) {}
+    // EBO 中一個索引的 byte 數（indexStart 轉成 glDrawElements 的位移）
+    size_t indexSize() const { return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int); }
+};
+
+// Model::Raycast 的結果（世界座標）
+struct ModelRayHit {
+    float t = 0.0f;           // origin + t * dir
+    int   mesh = -1;
+    int   triangle = -1;      // 網格 indices 中的第幾個三角形
+    glm::vec3 point = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);  // 面向射線的一側
 };
 
-enum class BillboardType {
-    SPHERICAL,    // 完全面向攝影機（所有軸都對齊）
-    CYLINDRICAL,  // 只繞Y軸旋轉（保持直立）
-    SCREEN_ALIGNED // 與螢幕平面對齊
+// Model::ClosestPoint 的結果（世界座標）
+struct ModelSphereHit {
+    float distance = 0.0f;
+    int   mesh = -1;
+    int   triangle = -1;
+    glm::vec3 point = glm::vec3(0.0f);
 };
 
 // 主要的模型類別
@@ -101,7 +138,25 @@ class Model : public CShape {
 private:
     std::vector<Mesh> meshes;
     std::vector<Material> materials;
+    std::vector<CollisionProxy> collisionProxies;  // 與 meshes 一一對應（模型空間）
+    std::vector<CTriangleBVH> meshBVHs;            // 與 meshes 一一對應，三角形層級的精確查詢
     std::string directory;
+    std::string sourcePath;   // LoadModel 的 .obj 路徑（碎片快取用）
+    
+    // 預先破碎的碎片（LoadFracture），所有碎片共用一組緩衝區，索引已加上碎片頂點的起點
+    std::vector<FractureChunk> fractureChunks;
+    std::vector<unsigned int> fractureIndexOffsets;   // 每個碎片的索引在 fractureEBO 中的起點
+    GLuint fractureVAO = 0, fractureVBO = 0, fractureEBO = 0;
+    GLenum fractureIndexType = GL_UNSIGNED_INT;
+    
+    // 量化頂點的還原參數（CVertexQuantize），每個網格一筆，VAO 以 divisor 1 讀取自己的那一筆
+    static VertexFormat s_defaultVertexFormat;
+    std::vector<VertexDecode> _vertexDecodes;
+    GLuint _decodeVBO = 0;
+    
+    // RenderMeshRanges 的 glMultiDrawElements 參數（重複使用，不在每個 frame 配置）
+    std::vector<GLsizei> _rangeCounts;
+    std::vector<const void*> _rangeOffsets;
     
     // 載入紋理的輔助函數
     GLuint LoadTexture(const std::string& path);
@@ -114,12 +169,33 @@ private:
                      const tinyobj::shape_t& shape,
                      const std::vector<tinyobj::material_t>& objMaterials);
     
-    // 設置網格的 OpenGL 緩衝區
+    // 設置網格的 OpenGL 緩衝區（VAO 與 EBO，頂點在所有網格載入後由 UploadVertices 上傳）
     void SetupMesh(Mesh& mesh);
+    void UploadVertices(size_t meshIndex, VertexFormat format);
+    // indices 與 lodIndices 依最大的索引以 16 或 32 bits 寫入 EBO
+    void UploadIndices(Mesh& mesh);
+    void SetupFracture();
+    
+    // 產生（或從 .lcache 讀取）每個網格的 LOD，並把 LOD 的索引加到網格的 EBO 中（LoadModel 結束前呼叫）
+    void BuildLods();
+    
+    // 綁定材質的 uniform 與貼圖（RenderMesh 與 RenderFractureInstanced 共用）
+    void BindMaterial(int materialIndex, GLuint shaderProgram);
+    void UnbindTextures();
     
     // 從檔案路徑中提取目錄
     std::string GetDirectory(const std::string& filepath);
     
+    // 每個網格建立 CTriangleBVH（LoadModel 結束前呼叫）
+    void BuildMeshBVHs();
+    
+    // 網格是否需要以透明方式描繪（材質 alpha < 1 或有 alpha 貼圖）
+    bool IsTransparent(const Mesh& mesh) const;
+    
+    // 模型空間的 AABB（在 ProcessMesh 中累計）
+    glm::vec3 _boundsMin = glm::vec3(FLT_MAX);
+    glm::vec3 _boundsMax = glm::vec3(-FLT_MAX);
+    
     bool  _bautoRotate = false;
     float _clock = 0.0f;
     glm::mat4 _modelMatrix = glm::mat4(1.0f);
@@ -146,17 +222,66 @@ public:
     Model() = default;
     ~Model();
     
-    // 載入模型
+    // 載入模型（有最新的 .mcache 時不解析 OBJ）
     bool LoadModel(const std::string& filepath);
     
-    // 渲染模型
+    // 渲染模型（不透明網格後接著以 alpha blending 描繪本模型的透明網格）
     void Render(GLuint shaderProgram);
+    // 只描繪不透明網格，透明網格交給 COITRenderer 跨模型一起處理
+    // pixelsPerUnit 為模型空間每單位在螢幕上的像素數，每個網格使用誤差不超過 pixelError 像素的最粗略的 LOD，
+    // 0 時使用原本的網格；回傳描繪的三角形數量
+    // culler 不為 nullptr 時，第 i 個網格使用 culler 中第 firstItem + i 個項目剔除後的範圍（AddClusterItems 加入的項目）
+    size_t RenderOpaque(GLuint shaderProgram, float pixelsPerUnit = 0.0f, float pixelError = 1.0f,
+                        const CClusterCuller* culler = nullptr, int firstItem = -1);
+    // 每個網格加入一個剔除項目（透明或使用 LOD 的網格不剔除），回傳第一個項目的編號；參數與 RenderOpaque 相同
+    int AddClusterItems(CClusterCuller& culler, const glm::mat4& world, float pixelsPerUnit = 0.0f,
+                        float pixelError = 1.0f) const;
     
-    void RenderMesh(size_t meshIndex, GLuint shaderProgram);
+    // 回傳描繪的三角形數量
+    size_t RenderMesh(size_t meshIndex, GLuint shaderProgram, int lod = 0);
+    // 只描繪 ranges 中的索引範圍（glMultiDrawElements），回傳描繪的三角形數量
+    size_t RenderMeshRanges(size_t meshIndex, GLuint shaderProgram, const ClusterDrawRange* ranges, int count);
+    const std::vector<MeshCluster>& GetMeshClusters(size_t meshIndex) const { return meshes[meshIndex].clusters; }
+    
+    int SelectLod(size_t meshIndex, float pixelsPerUnit, float pixelError) const;
+    const std::vector<MeshLod>& GetMeshLods(size_t meshIndex) const { return meshes[meshIndex].lods; }
+    // 不透明網格原本（LOD 0）的三角形數量
+    size_t GetOpaqueTriangleCount() const;
+    
+    bool IsMeshTransparent(size_t meshIndex) const { return IsTransparent(meshes[meshIndex]); }
+    glm::vec3 GetMeshCenter(size_t meshIndex) const {
+        return (meshes[meshIndex].boundsMin + meshes[meshIndex].boundsMax) * 0.5f;
+    }
+    
+    // 頂點格式：QUANTIZED 的網格誤差超過 CVertexQuantize 的上限時仍使用 FLOAT；載入後切換會重新上傳頂點緩衝區
+    // SetDefaultVertexFormat 影響之後載入的模型
+    static void SetDefaultVertexFormat(VertexFormat format) { s_defaultVertexFormat = format; }
+    void SetVertexFormat(VertexFormat format);
+    void SetMeshVertexFormat(size_t meshIndex, VertexFormat format);
+    VertexFormat GetMeshVertexFormat(size_t meshIndex) const { return meshes[meshIndex].vertexFormat; }
+    // 頂點緩衝區目前的大小，與全部使用 float 頂點時的大小（bytes）
+    size_t GetVertexBufferBytes() const;
+    size_t GetFloatVertexBufferBytes() const;
+    // 索引緩衝區（含 LOD）目前的大小，與全部使用 32-bit 索引時的大小（bytes）
+    size_t GetIndexBufferBytes() const;
+    size_t GetUint32IndexBufferBytes() const;
+    
+    // 只輸出深度（陰影貼圖用），不綁定任何材質，透明網格不投射陰影
+    void RenderDepth();
+    
+    // 簡化描繪（反射探針用）：只使用漫反射顏色與漫反射貼圖，不輸出除錯訊息
+    void RenderProxy(GLuint shaderProgram);
     
     // 清理資源
     void Cleanup();
     
+    // 預先破碎：有最新的 .fcache 時直接讀取，否則以 CMeshFracture 分割所有網格後寫入快取，並建立碎片的緩衝區
+    bool LoadFracture(int pieces, unsigned seed = 1);
+    const std::vector<FractureChunk>& GetFractureChunks() const { return fractureChunks; }
+    // 以 instanced draw 描繪碎片：ranges 每個碎片一個（CDebrisPool::getRanges），
+    // 實體的模型矩陣在 instanceBuffer 中；每個網格的材質只綁定一次
+    void RenderFractureInstanced(GLuint shaderProgram, GLuint instanceBuffer, const DebrisInstanceRange* ranges);
+    
     // 取得材質數量
     size_t GetMaterialCount() const { return materials.size(); }
     
@@ -168,6 +293,21 @@ public:
     
     // 檢查是否成功載入
     bool IsLoaded() const { return !meshes.empty(); }
+    
+    // 三角形層級的查詢（點選、子彈命中），world 為此實體的模型矩陣，BVH 仍在模型空間
+    // 射線的 t 以 dir 為單位；找不到回傳 false
+    bool Raycast(const glm::mat4& world, const glm::vec3& origin, const glm::vec3& dir, float maxT,
+                 ModelRayHit& hit) const;
+    // 距離 center 在 radius 以內最近的三角形上的點（等比例縮放時為精確值）
+    bool ClosestPoint(const glm::mat4& world, const glm::vec3& center, float radius, ModelSphereHit& hit) const;
+    const CTriangleBVH& GetMeshBVH(size_t meshIndex) const { return meshBVHs[meshIndex]; }
+    
+    // 每個網格的碰撞代理形狀（模型空間），由 CollisionManager::addModelProxies 轉成障礙物
+    const std::vector<CollisionProxy>& GetCollisionProxies() const { return collisionProxies; }
+    
+    // 模型空間的包圍盒
+    glm::vec3 getBoundsMin() const { return _boundsMin; }
+    glm::vec3 getBoundsMax() const { return _boundsMax; }
     void setAutoRotate();
     void update(float dt);
     void setRotate(float angle, const glm::vec3& axis) {
@@ -201,8 +341,12 @@ public:
     bool isSelfRotating() const { return _bSelfRotate; }
     
     void SetLightMap(const std::string& materialName, const std::string& lightMapPath, float intensity);
+    // tools/LightmapBaker 輸出的 Light Map，intensity 為烘焙時 exposure 的倒數
+    bool SetBakedLightMap(const std::string& materialName, const std::string& lightMapPath, float intensity);
     void SetEnvironmentMap(const std::string& materialName, const std::string& environmentMapPath, float reflectivity);
     void SetEnvironmentMapFromFiles(const std::string& materialName, const std::string& environmentMapPath, float reflectivity);
+    // 使用外部建立的 cube map（例如 CReflectionProbe），貼圖由建立者負責釋放
+    void SetEnvironmentMapTexture(const std::string& materialName, GLuint cubeMapTexture, float reflectivity);
     
     GLuint LoadCubeMapFromSingleImage(const std::string& path);
     GLuint LoadCubeMapFromFiles(const std::string& basePath);
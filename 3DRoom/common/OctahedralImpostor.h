@@ -0,0 +1,72 @@
+//  OctahedralImpostor.h
+//  八面體 impostor 的視角排列與混合，CImpostorRenderer、impostor_vtxshader.glsl 與 ImpostorBenchmark 共用
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// y >= 0 的單位向量 -> [0,1]²（y < 0 的方向視為水平方向）
+inline glm::vec2 hemiOctEncode(const glm::vec3& dir) {
+    glm::vec3 d(dir.x, std::max(dir.y, 0.0f), dir.z);
+    float sum = std::fabs(d.x) + d.y + std::fabs(d.z);
+    if (sum <= 0.0f) return glm::vec2(0.5f);
+    float px = d.x / sum, pz = d.z / sum;
+    return glm::vec2(px + pz, px - pz) * 0.5f + glm::vec2(0.5f);
+}
+
+inline glm::vec3 hemiOctDecode(const glm::vec2& uv) {
+    glm::vec2 f = uv * 2.0f - glm::vec2(1.0f);
+    float px = (f.x + f.y) * 0.5f, pz = (f.x - f.y) * 0.5f;
+    glm::vec3 d(px, 1.0f - std::fabs(px) - std::fabs(pz), pz);
+    return glm::normalize(d);
+}
+
+// 第 (x, y) 個視角的方向（從物體中心指向攝影機）
+inline glm::vec3 impostorFrameDirection(int x, int y, int framesPerSide) {
+    float scale = 1.0f / static_cast<float>(framesPerSide - 1);
+    return hemiOctDecode(glm::vec2(x * scale, y * scale));
+}
+
+// 視角畫面的兩個軸：right 為世界的 y 軸與方向的外積，正上方時改用 z 軸
+inline void impostorFrameBasis(const glm::vec3& dir, glm::vec3& right, glm::vec3& up) {
+    glm::vec3 reference = (std::fabs(dir.y) > 0.999f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    right = glm::normalize(glm::cross(reference, dir));
+    up = glm::cross(dir, right);
+}
+
+// 三個視角的編號（y * framesPerSide + x）與權重，權重的總和為 1
+struct ImpostorFrameBlend {
+    int frames[3];
+    float weights[3];
+};
+
+inline ImpostorFrameBlend impostorFrameBlend(const glm::vec3& dir, int framesPerSide) {
+    float cells = static_cast<float>(framesPerSide - 1);
+    glm::vec2 grid = hemiOctEncode(dir) * cells;
+    int cx = std::min(static_cast<int>(grid.x), framesPerSide - 2);
+    int cy = std::min(static_cast<int>(grid.y), framesPerSide - 2);
+    float fx = grid.x - cx, fy = grid.y - cy;
+    auto frame = [framesPerSide](int x, int y) { return y * framesPerSide + x; };
+    ImpostorFrameBlend blend;
+    if (fx + fy <= 1.0f) {
+        blend.frames[0] = frame(cx, cy);         blend.weights[0] = 1.0f - fx - fy;
+        blend.frames[1] = frame(cx + 1, cy);     blend.weights[1] = fx;
+        blend.frames[2] = frame(cx, cy + 1);     blend.weights[2] = fy;
+    } else {
+        blend.frames[0] = frame(cx + 1, cy + 1); blend.weights[0] = fx + fy - 1.0f;
+        blend.frames[1] = frame(cx, cy + 1);     blend.weights[1] = 1.0f - fx;
+        blend.frames[2] = frame(cx + 1, cy);     blend.weights[2] = 1.0f - fy;
+    }
+    return blend;
+}
+
+// 兩張 RGBA8 貼圖集（顏色 + 覆蓋率、法向量 + 深度），mipLevels 層 mipmap（1 為只有原本的大小）
+inline size_t impostorMemoryBytes(int framesPerSide, int frameSize, int mipLevels) {
+    size_t size = static_cast<size_t>(framesPerSide) * frameSize;
+    size_t bytes = 0;
+    for (int level = 0; level < mipLevels && size > 0; ++level, size /= 2) bytes += size * size * 4 * 2;
+    return bytes;
+}
@@ -0,0 +1,203 @@
+#ifndef ROOM_GRID_H
+#define ROOM_GRID_H
+
+// 程序產生的 cols x rows 房間格子，用來測試碰撞與描繪隨建築大小的變化
+// 每個房間的牆由 CollisionManager::addRoomWalls 建立（與 initializeWalls 相同的拱門），
+// 相鄰房間背對背的牆、同一列連在一起的牆等共平面且相接的牆段會合併成一個 AABB，減少碰撞器數量
+// 可以在房間內隨機擺放家具實體（不擋住門口），Homework 的 --room-grid 與 tools/CollisionBenchmark 共用
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "CollisionManager.h"
+
+struct RoomGridConfig {
+    int cols = 3;
+    int rows = 2;
+    glm::vec3 origin = glm::vec3(-26.0f, 0.0f, -12.0f);  // 第一個房間（col 0, row 0）地板的中心，預設與 initializeWalls 的 Room 1 重合
+    float roomX = 26.0f, roomY = 20.0f, roomZ = 24.0f;
+    float wallThickness = 1.5f;
+    float doorWidth = 8.0f, doorHeight = 18.0f, postWidth = 2.0f, lintelHeight = 2.0f;
+    float doorChance = 1.0f;       // 1：相鄰的房間都有門；小於 1 時先以隨機生成樹連通所有房間，其餘相鄰的牆以這個機率開門
+    bool mergeWalls = true;
+    float maxMergedLength = 30.0f;  // 合併後最長的牆段（約一個房間）：整排的長牆會讓 BVH 節點大量重疊，查詢反而變慢
+    int furniturePerRoom = 0;
+    unsigned seed = 1;
+};
+
+// 可以擺放的家具：模型空間的包圍盒與擺放時的縮放（與 computeModelMatrix 相同的 0.7）
+struct FurnitureFootprint {
+    int model = -1;                // 呼叫端自訂的模型編號（例如 models[] 的索引）
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    float scale = 0.7f;
+};
+
+struct FurnitureInstance {
+    int model = -1;
+    int room = -1;
+    glm::mat4 world = glm::mat4(1.0f);
+    glm::vec3 worldMin = glm::vec3(0.0f), worldMax = glm::vec3(0.0f);
+};
+
+struct RoomGrid {
+    std::vector<AABB> walls;
+    std::vector<glm::vec3> roomCenters;            // 房間中心（y 為半高）
+    std::vector<std::pair<int, int>> doors;        // 以門相連的兩個房間（roomCenters 的索引）
+    std::vector<FurnitureInstance> furniture;
+    size_t unmergedWallCount = 0;
+};
+
+// 兩個軸的範圍相同、第三個軸相接或重疊的 AABB 合併成一個（合併後的聯集仍是 AABB），回傳減少的數量
+// 合併後的牆沿用第一段的名稱，沿合併方向的長度不超過 maxLength
+inline size_t mergeCoplanarWalls(std::vector<AABB>& walls, float maxLength = FLT_MAX) {
+    size_t before = walls.size();
+    const float epsilon = 1e-4f;
+    auto quantize = [](float v) { return static_cast<long long>(std::llround(v * 1024.0f)); };
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int axis = 0; axis < 3; ++axis) {
+            int a1 = (axis + 1) % 3, a2 = (axis + 2) % 3;
+            auto key = [&](const AABB& w) {
+                return std::make_tuple(quantize(w.min[a1]), quantize(w.max[a1]), quantize(w.min[a2]), quantize(w.max[a2]));
+            };
+            std::stable_sort(walls.begin(), walls.end(), [&](const AABB& l, const AABB& r) {
+                auto kl = key(l), kr = key(r);
+                return (kl != kr) ? (kl < kr) : (l.min[axis] < r.min[axis]);
+            });
+            std::vector<AABB> out;
+            out.reserve(walls.size());
+            for (const AABB& w : walls) {
+                if (!out.empty() && key(out.back()) == key(w) && w.min[axis] <= out.back().max[axis] + epsilon &&
+                    std::max(out.back().max[axis], w.max[axis]) - out.back().min[axis] <= maxLength) {
+                    out.back().max[axis] = std::max(out.back().max[axis], w.max[axis]);
+                    merged = true;
+                } else {
+                    out.push_back(w);
+                }
+            }
+            walls.swap(out);
+        }
+    }
+    return before - walls.size();
+}
+
+inline RoomGrid generateRoomGrid(const RoomGridConfig& config,
+                                 const std::vector<FurnitureFootprint>& footprints = std::vector<FurnitureFootprint>()) {
+    RoomGrid grid;
+    int cols = std::max(config.cols, 1), rows = std::max(config.rows, 1);
+    int roomCount = cols * rows;
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+
+    // 相鄰房間之間的牆：先打亂後以 union-find 選出生成樹（保證連通），其餘依機率開門
+    struct Edge { int a, b; };
+    std::vector<Edge> edges;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            int room = row * cols + col;
+            if (col + 1 < cols) edges.push_back({ room, room + 1 });
+            if (row + 1 < rows) edges.push_back({ room, room + cols });
+        }
+    }
+    std::shuffle(edges.begin(), edges.end(), rng);
+    std::vector<int> parent(roomCount);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    };
+    std::vector<char> doorRight(roomCount, 0), doorBack(roomCount, 0);
+    for (const Edge& e : edges) {
+        int ra = find(e.a), rb = find(e.b);
+        bool open = (ra != rb) || config.doorChance >= 1.0f || u01(rng) < config.doorChance;
+        if (ra != rb) parent[ra] = rb;
+        if (!open) continue;
+        if (e.b == e.a + 1) doorRight[e.a] = 1;
+        else doorBack[e.a] = 1;
+        grid.doors.push_back({ e.a, e.b });
+    }
+
+    float doorCenterY = config.origin.y + config.doorHeight / 2.0f;
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            int room = row * cols + col;
+            glm::vec3 center = config.origin + glm::vec3(col * config.roomX, config.roomY / 2.0f, row * config.roomZ);
+            grid.roomCenters.push_back(center);
+            auto door = [&](bool open, const glm::vec3& doorCenter) {
+                DoorwayConfig door;
+                if (open) door = { true, doorCenter, config.doorWidth, config.doorHeight, config.postWidth, config.lintelHeight };
+                return door;
+            };
+            DoorwayConfig front = door(row > 0 && doorBack[room - cols],
+                                       glm::vec3(center.x, doorCenterY, center.z - config.roomZ / 2.0f));
+            DoorwayConfig back = door(doorBack[room], glm::vec3(center.x, doorCenterY, center.z + config.roomZ / 2.0f));
+            DoorwayConfig left = door(col > 0 && doorRight[room - 1],
+                                      glm::vec3(center.x - config.roomX / 2.0f, doorCenterY, center.z));
+            DoorwayConfig right = door(doorRight[room], glm::vec3(center.x + config.roomX / 2.0f, doorCenterY, center.z));
+            CollisionManager::addRoomWalls(grid.walls, room + 1, center, config.roomX, config.roomY, config.roomZ,
+                                           config.wallThickness, front, back, left, right);
+
+            // 家具：隨機選模型與 90 度倍數的方向，不與其他家具及門口前方的通道重疊，最多嘗試 16 次
+            if (footprints.empty() || config.furniturePerRoom <= 0) continue;
+            // 相鄰房間的牆在房間外側，厚度會伸進這個房間，留下牆厚再加 0.5 的間隔
+            const float margin = config.wallThickness + 0.5f, doorClearance = 4.0f;
+            glm::vec2 interiorMin(center.x - config.roomX / 2.0f + margin, center.z - config.roomZ / 2.0f + margin);
+            glm::vec2 interiorMax(center.x + config.roomX / 2.0f - margin, center.z + config.roomZ / 2.0f - margin);
+            std::vector<glm::vec4> blocked;   // xz 平面的矩形 (minX, minZ, maxX, maxZ)
+            float halfDoor = config.doorWidth / 2.0f + config.postWidth;
+            if (front.hasDoor) blocked.push_back(glm::vec4(center.x - halfDoor, interiorMin.y - margin, center.x + halfDoor, interiorMin.y + doorClearance));
+            if (back.hasDoor) blocked.push_back(glm::vec4(center.x - halfDoor, interiorMax.y - doorClearance, center.x + halfDoor, interiorMax.y + margin));
+            if (left.hasDoor) blocked.push_back(glm::vec4(interiorMin.x - margin, center.z - halfDoor, interiorMin.x + doorClearance, center.z + halfDoor));
+            if (right.hasDoor) blocked.push_back(glm::vec4(interiorMax.x - doorClearance, center.z - halfDoor, interiorMax.x + margin, center.z + halfDoor));
+
+            for (int k = 0; k < config.furniturePerRoom; ++k) {
+                for (int attempt = 0; attempt < 16; ++attempt) {
+                    const FurnitureFootprint& fp = footprints[rng() % footprints.size()];
+                    int quarter = static_cast<int>(rng() % 4);
+                    glm::vec3 size = (fp.boundsMax - fp.boundsMin) * fp.scale;
+                    glm::vec2 extent = (quarter % 2) ? glm::vec2(size.z, size.x) : glm::vec2(size.x, size.z);
+                    glm::vec2 room2 = interiorMax - interiorMin;
+                    if (extent.x > room2.x || extent.y > room2.y) continue;
+                    glm::vec2 pos(interiorMin.x + extent.x / 2.0f + u01(rng) * (room2.x - extent.x),
+                                  interiorMin.y + extent.y / 2.0f + u01(rng) * (room2.y - extent.y));
+                    glm::vec4 rect(pos.x - extent.x / 2.0f, pos.y - extent.y / 2.0f, pos.x + extent.x / 2.0f, pos.y + extent.y / 2.0f);
+                    bool overlaps = false;
+                    for (const glm::vec4& b : blocked) {
+                        if (rect.x < b.z && rect.z > b.x && rect.y < b.w && rect.w > b.y) { overlaps = true; break; }
+                    }
+                    if (overlaps) continue;
+                    blocked.push_back(rect);
+
+                    // 模型底部中心移到原點，縮放、旋轉後放到地板上的 pos
+                    glm::vec3 anchor((fp.boundsMin.x + fp.boundsMax.x) * 0.5f, fp.boundsMin.y, (fp.boundsMin.z + fp.boundsMax.z) * 0.5f);
+                    FurnitureInstance instance;
+                    instance.model = fp.model;
+                    instance.room = room;
+                    instance.world = glm::translate(glm::mat4(1.0f), glm::vec3(pos.x, config.origin.y, pos.y));
+                    instance.world = glm::rotate(instance.world, glm::radians(90.0f * quarter), glm::vec3(0.0f, 1.0f, 0.0f));
+                    instance.world = glm::scale(instance.world, glm::vec3(fp.scale));
+                    instance.world = glm::translate(instance.world, -anchor);
+                    instance.worldMin = glm::vec3(rect.x, config.origin.y, rect.y);
+                    instance.worldMax = glm::vec3(rect.z, config.origin.y + size.y, rect.w);
+                    grid.furniture.push_back(instance);
+                    break;
+                }
+            }
+        }
+    }
+
+    grid.unmergedWallCount = grid.walls.size();
+    if (config.mergeWalls) mergeCoplanarWalls(grid.walls, config.maxMergedLength);
+    return grid;
+}
+
+#endif // ROOM_GRID_H
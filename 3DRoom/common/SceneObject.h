@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+class Model;
+
+// 場景中每個要描繪的 Model 實體（每個 frame 由 Homework.cpp 的 update() 重建）
+// 陰影、反射探針等子系統共用這份清單，不需要各自再計算 model matrix
+struct SceneObject {
+    Model* model = nullptr;
+    glm::mat4 world = glm::mat4(1.0f);      // 實體的世界矩陣
+    glm::vec3 worldMin = glm::vec3(0.0f);    // 世界座標 AABB
+    glm::vec3 worldMax = glm::vec3(0.0f);
+    bool isStatic = true;                    // false : 會移動的物件（機器人、電風扇、Billboard）
+    int  id = -1;                            // 對應 models[] 的索引
+    float lodPixelsPerUnit = 0.0f;           // 模型空間每單位在螢幕上的像素數（選擇網格的 LOD），0 表示使用原本的網格
+    int  impostor = -1;                      // CImpostorRenderer 的編號，-1 表示沒有 impostor
+};
+
+// 將模型空間的 AABB 經由 world 矩陣轉成世界座標 AABB（Arvo 的方法，不需要轉換八個角點）
+inline void transformAABB(const glm::vec3& localMin, const glm::vec3& localMax, const glm::mat4& world,
+                          glm::vec3& outMin, glm::vec3& outMax)
+{
+    glm::vec3 center = glm::vec3(world[3]);
+    outMin = center; outMax = center;
+    for (int col = 0; col < 3; col++) {
+        for (int row = 0; row < 3; row++) {
+            float a = world[col][row] * localMin[col];
+            float b = world[col][row] * localMax[col];
+            outMin[row] += (a < b) ? a : b;
+            outMax[row] += (a < b) ? b : a;
+        }
+    }
+}
+
+// 球體與 AABB 是否重疊
+inline bool sphereOverlapsAABB(const glm::vec3& center, float radius, const glm::vec3& bmin, const glm::vec3& bmax)
+{
+    glm::vec3 closest = glm::clamp(center, bmin, bmax);
+    glm::vec3 d = center - closest;
+    return glm::dot(d, d) <= radius * radius;
+}
+
+// AABB 是否與 viewProj 的視錐相交（Gribb-Hartmann 取出六個平面，保守判斷）
+inline bool aabbInFrustum(const glm::mat4& viewProj, const glm::vec3& bmin, const glm::vec3& bmax)
+{
+    glm::vec4 row0(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    glm::vec4 row1(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    glm::vec4 row2(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    glm::vec4 row3(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+    const glm::vec4 planes[6] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+    for (const glm::vec4& p : planes) {
+        // 取在平面法向量方向上最遠的角點
+        glm::vec3 v(p.x >= 0.0f ? bmax.x : bmin.x,
+                    p.y >= 0.0f ? bmax.y : bmin.y,
+                    p.z >= 0.0f ? bmax.z : bmin.z);
+        if (p.x * v.x + p.y * v.y + p.z * v.z + p.w < 0.0f) return false;
+    }
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef SIMD_MATH_H
+#define SIMD_MATH_H
+
+// 4 個 float 的 SIMD 包裝：x86 使用 SSE2，Apple Silicon 等 ARM 使用 NEON，其他平台以一般程式碼代替
+// 只提供碰撞查詢需要的運算，資料以 SoA（每個分量一個陣列）排列時一次處理 4 筆
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_MATH_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_MATH_NEON 1
+#endif
+
+#if defined(SIMD_MATH_SSE)
+
+struct Float4 {
+    __m128 v;
+    Float4() = default;
+    explicit Float4(__m128 value) : v(value) {}
+    static Float4 set1(float a) { return Float4(_mm_set1_ps(a)); }
+    static Float4 load(const float* p) { return Float4(_mm_loadu_ps(p)); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+struct Mask4 {
+    __m128 v;
+    Mask4() = default;
+    explicit Mask4(__m128 value) : v(value) {}
+    // bit i 對應第 i 個 lane
+    int bits() const { return _mm_movemask_ps(v); }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return Float4(_mm_add_ps(a.v, b.v)); }
+inline Float4 operator-(Float4 a, Float4 b) { return Float4(_mm_sub_ps(a.v, b.v)); }
+inline Float4 operator*(Float4 a, Float4 b) { return Float4(_mm_mul_ps(a.v, b.v)); }
+inline Float4 min4(Float4 a, Float4 b) { return Float4(_mm_min_ps(a.v, b.v)); }
+inline Float4 max4(Float4 a, Float4 b) { return Float4(_mm_max_ps(a.v, b.v)); }
+inline Mask4 operator<=(Float4 a, Float4 b) { return Mask4(_mm_cmple_ps(a.v, b.v)); }
+inline Mask4 operator<(Float4 a, Float4 b) { return Mask4(_mm_cmplt_ps(a.v, b.v)); }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return Mask4(_mm_and_ps(a.v, b.v)); }
+inline Float4 select4(Mask4 m, Float4 a, Float4 b) {
+    return Float4(_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)));
+}
+inline Mask4 laneMask(int bits) {
+    return Mask4(_mm_castsi128_ps(_mm_set_epi32((bits & 8) ? -1 : 0, (bits & 4) ? -1 : 0,
+                                                (bits & 2) ? -1 : 0, (bits & 1) ? -1 : 0)));
+}
+
+#elif defined(SIMD_MATH_NEON)
+
+struct Float4 {
+    float32x4_t v;
+    Float4() = default;
+    explicit Float4(float32x4_t value) : v(value) {}
+    static Float4 set1(float a) { return Float4(vdupq_n_f32(a)); }
+    static Float4 load(const float* p) { return Float4(vld1q_f32(p)); }
+    void store(float* p) const { vst1q_f32(p, v); }
+};
+
+struct Mask4 {
+    uint32x4_t v;
+    Mask4() = default;
+    explicit Mask4(uint32x4_t value) : v(value) {}
+    int bits() const {
+        return static_cast<int>((vgetq_lane_u32(v, 0) & 1u) | (vgetq_lane_u32(v, 1) & 2u) |
+                                (vgetq_lane_u32(v, 2) & 4u) | (vgetq_lane_u32(v, 3) & 8u));
+    }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return Float4(vaddq_f32(a.v, b.v)); }
+inline Float4 operator-(Float4 a, Float4 b) { return Float4(vsubq_f32(a.v, b.v)); }
+inline Float4 operator*(Float4 a, Float4 b) { return Float4(vmulq_f32(a.v, b.v)); }
+inline Float4 min4(Float4 a, Float4 b) { return Float4(vminq_f32(a.v, b.v)); }
+inline Float4 max4(Float4 a, Float4 b) { return Float4(vmaxq_f32(a.v, b.v)); }
+inline Mask4 operator<=(Float4 a, Float4 b) { return Mask4(vcleq_f32(a.v, b.v)); }
+inline Mask4 operator<(Float4 a, Float4 b) { return Mask4(vcltq_f32(a.v, b.v)); }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return Mask4(vandq_u32(a.v, b.v)); }
+inline Float4 select4(Mask4 m, Float4 a, Float4 b) { return Float4(vbslq_f32(m.v, a.v, b.v)); }
+inline Mask4 laneMask(int bits) {
+    const uint32_t lanes[4] = { (bits & 1) ? 0xFFFFFFFFu : 0u, (bits & 2) ? 0xFFFFFFFFu : 0u,
+                                (bits & 4) ? 0xFFFFFFFFu : 0u, (bits & 8) ? 0xFFFFFFFFu : 0u };
+    return Mask4(vld1q_u32(lanes));
+}
+
+#else
+
+struct Float4 {
+    float v[4];
+    static Float4 set1(float a) { Float4 r; for (int i = 0; i < 4; i++) r.v[i] = a; return r; }
+    static Float4 load(const float* p) { Float4 r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+    void store(float* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+};
+
+struct Mask4 {
+    int m;
+    int bits() const { return m; }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+inline Float4 operator-(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+inline Float4 operator*(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+inline Float4 min4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] = std::min(a.v[i], b.v[i]); return a; }
+inline Float4 max4(Float4 a, Float4 b) { for (int i = 0; i < 4; i++) a.v[i] = std::max(a.v[i], b.v[i]); return a; }
+inline Mask4 operator<=(Float4 a, Float4 b) {
+    Mask4 r = { 0 };
+    for (int i = 0; i < 4; i++) if (a.v[i] <= b.v[i]) r.m |= (1 << i);
+    return r;
+}
+inline Mask4 operator<(Float4 a, Float4 b) {
+    Mask4 r = { 0 };
+    for (int i = 0; i < 4; i++) if (a.v[i] < b.v[i]) r.m |= (1 << i);
+    return r;
+}
+inline Mask4 operator&(Mask4 a, Mask4 b) { return Mask4{ a.m & b.m }; }
+inline Float4 select4(Mask4 m, Float4 a, Float4 b) {
+    for (int i = 0; i < 4; i++) if (!(m.m & (1 << i))) a.v[i] = b.v[i];
+    return a;
+}
+inline Mask4 laneMask(int bits) { return Mask4{ bits & 0xF }; }
+
+#endif
+
+#endif // SIMD_MATH_H
@@ -17,6 +17,8 @@
 #include "../common/CButton.h"
 #include "../common/Model.h"
 #include "CollisionManager.h"
+#include "CShadowManager.h"
+#include "COITRenderer.h"
 
 //#define SPOT_TARGET  // Example 2
 
@@ -41,6 +43,17 @@ extern std::array<CButton, 6> g_button;
 extern std::vector<std::unique_ptr<Model>> models;
 
 extern CMaterial g_matWaterGreen;
+extern void breakPropInFront();
+extern void breakManyFurniture();
+extern void fireProjectile();
+extern void fireProjectileStress();
+extern void spawnDecalStress();
+extern void spawnParticleStress();
+extern void toggleBillboardStress();
+extern void cycleLodThreshold();
+extern void toggleImpostors();
+extern void cycleClusterCulling();
+extern void toggleVertexFormat();
 extern CSphere  g_sphere;
 
 #ifdef SPOT_TARGET
@@ -48,6 +61,9 @@ extern CCube g_spotTarget;
 #endif
 
 extern CollisionManager g_collisionManager;
+extern CShadowManager g_shadowManager;
+extern COITRenderer g_oitRenderer;
+void printRenderStats();
 Arcball g_arcball;
 
 // 新增：計算攝影機的前方、右方、上方向量
@@ -274,6 +290,11 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
             if (action == GLFW_PRESS) { glfwSetWindowShouldClose(window, true); }
             break;
         case GLFW_KEY_SPACE:
+            if (action == GLFW_PRESS) breakPropInFront();
+            break;
+        case GLFW_KEY_1:
+            // 切換模型的頂點格式（量化 / float），輸出之後的 frame 時間
+            if (action == GLFW_PRESS) toggleVertexFormat();
             break;
 #ifdef SPOT_TARGET
         case 262:
@@ -493,6 +514,71 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
                                 largeBoundary = !largeBoundary;
                             }
                             break;
+                        case 'I':
+                        case 'i':
+                            // 輸出描繪統計（陰影面的重畫/沿用數量等）
+                            printRenderStats();
+                            break;
+                        case 'H':
+                        case 'h':
+                            // 切換陰影貼圖解析度 256 -> 512 -> 1024 -> 2048
+                            {
+                                int res = g_shadowManager.getResolution() * 2;
+                                if (res > 2048) res = 256;
+                                g_shadowManager.setResolution(res);
+                                std::cout << "Shadow map resolution: " << res << std::endl;
+                            }
+                            break;
+                        case 'K':
+                        case 'k':
+                            // 同時打壞最多 50 個家具，輸出之後的 frame 時間
+                            breakManyFurniture();
+                            break;
+                        case 'F':
+                        case 'f':
+                            // 沿視線方向發射子彈
+                            fireProjectile();
+                            break;
+                        case 'J':
+                        case 'j':
+                            // 一次發射 100000 個投射物，輸出之後的 frame 時間
+                            fireProjectileStress();
+                            break;
+                        case 'U':
+                        case 'u':
+                            // 在視線周圍的表面一次加入 10000 個貼花，輸出之後的 frame 時間
+                            spawnDecalStress();
+                            break;
+                        case 'V':
+                        case 'v':
+                            // 在視線前方一次產生 200000 個火花粒子，輸出之後的 frame 時間
+                            spawnParticleStress();
+                            break;
+                        case 'Y':
+                        case 'y':
+                            // 切換一萬個以 vertex shader 展開的告示牌（一次 instanced draw），輸出之後的 frame 時間
+                            toggleBillboardStress();
+                            break;
+                        case 'M':
+                        case 'm':
+                            // 切換網格 LOD 的螢幕誤差門檻（2 像素、4 像素、關閉），輸出之後的 frame 時間
+                            cycleLodThreshold();
+                            break;
+                        case 'X':
+                        case 'x':
+                            // 切換遠處家具的 impostor，輸出之後的 frame 時間
+                            toggleImpostors();
+                            break;
+                        case 'Z':
+                        case 'z':
+                            // 切換叢集剔除（視錐 + 背面、只有視錐、關閉），輸出之後的 frame 時間
+                            cycleClusterCulling();
+                            break;
+                        case 'T':
+                        case 't':
+                            // 切換透明網格的描繪方式（Weighted Blended OIT / 排序後 alpha blending）
+                            g_oitRenderer.toggleMode();
+                            break;
                     }
                 }
             }
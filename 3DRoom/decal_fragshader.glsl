@@ -0,0 +1,57 @@
+// decal_fragshader.glsl
+// 由深度貼圖還原世界座標，轉到貼花的方塊空間；方塊外或與投影方向夾角太大的表面捨棄
+// 輸出以 dst * src * 2 混合：0.5 不改變畫面，底下表面原本的光照（normal map、陰影）保留，
+// 貼花的 normal map 依主要光源相對於平坦表面的明暗比例調整
+#version 330 core
+
+flat in vec4 vToDecal0;
+flat in vec4 vToDecal1;
+flat in vec4 vToDecal2;
+flat in vec4 vAtlas;
+flat in vec4 vParams;       // x = opacity
+flat in vec3 vTangent;
+flat in vec3 vAxis;
+
+uniform sampler2D uDepth;
+uniform sampler2D uDecalAtlas;
+uniform sampler2D uDecalNormal;
+uniform mat4 uInvViewProj;
+uniform vec4 uViewport;     // x, y, 寬, 高
+uniform vec3 uViewPos;
+uniform vec3 uLightPos;
+
+out vec4 FragColor;
+
+void main() {
+    float depth = texelFetch(uDepth, ivec2(gl_FragCoord.xy), 0).r;
+    vec2 ndc = (gl_FragCoord.xy - uViewport.xy) / uViewport.zw * 2.0 - 1.0;
+    vec4 world = uInvViewProj * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+    world /= world.w;
+    vec3 local = vec3(dot(vToDecal0, world), dot(vToDecal1, world), dot(vToDecal2, world));
+    vec2 uv = vAtlas.xy + (local.xy + 0.5) * vAtlas.zw;
+
+    // 導數必須在 discard 之前計算；取樣用 textureGrad，避免方塊邊緣的 mipmap 跳到最小層
+    vec3 dx = dFdx(world.xyz);
+    vec3 dy = dFdy(world.xyz);
+    vec2 uvDx = dFdx(uv);
+    vec2 uvDy = dFdy(uv);
+    if (any(greaterThan(abs(local), vec3(0.5)))) discard;
+
+    vec3 surfaceNormal = normalize(cross(dx, dy));
+    if (dot(surfaceNormal, uViewPos - world.xyz) < 0.0) surfaceNormal = -surfaceNormal;
+    float facing = dot(surfaceNormal, vAxis);
+    if (facing < 0.3) discard;   // 牆角、家具側面等與投影方向接近垂直的表面
+
+    vec4 albedo = textureGrad(uDecalAtlas, uv, uvDx, uvDy);
+    vec3 tn = textureGrad(uDecalNormal, uv, uvDx, uvDy).xyz * 2.0 - 1.0;
+    vec3 tangent = normalize(vTangent - surfaceNormal * dot(vTangent, surfaceNormal));
+    vec3 bitangent = cross(surfaceNormal, tangent);
+    vec3 normal = normalize(tangent * tn.x + bitangent * tn.y + surfaceNormal * tn.z);
+
+    vec3 L = normalize(uLightPos - world.xyz);
+    float flatLight = 0.4 + 0.6 * max(dot(surfaceNormal, L), 0.0);
+    float bumpLight = 0.4 + 0.6 * max(dot(normal, L), 0.0);
+    float alpha = albedo.a * vParams.x * smoothstep(0.3, 0.5, facing);
+    vec3 color = mix(vec3(1.0), albedo.rgb * (bumpLight / flatLight), alpha);
+    FragColor = vec4(color * 0.5, 1.0);
+}
@@ -0,0 +1,36 @@
+// decal_vtxshader.glsl
+// 每個貼花一個單位方塊，instance attribute 為 CDecalBuffer.h 的 DecalInstance
+#version 330 core
+
+layout(location = 0) in vec3 aPos;          // [-0.5, 0.5]^3
+layout(location = 1) in vec4 aToWorld0;
+layout(location = 2) in vec4 aToWorld1;
+layout(location = 3) in vec4 aToWorld2;
+layout(location = 4) in vec4 aToDecal0;
+layout(location = 5) in vec4 aToDecal1;
+layout(location = 6) in vec4 aToDecal2;
+layout(location = 7) in vec4 aAtlas;
+layout(location = 8) in vec4 aParams;
+
+uniform mat4 uViewProj;
+
+flat out vec4 vToDecal0;
+flat out vec4 vToDecal1;
+flat out vec4 vToDecal2;
+flat out vec4 vAtlas;
+flat out vec4 vParams;
+flat out vec3 vTangent;     // 貼圖 u 方向
+flat out vec3 vAxis;        // 投影方向（表面的法向量）
+
+void main() {
+    vec4 local = vec4(aPos, 1.0);
+    vec3 world = vec3(dot(aToWorld0, local), dot(aToWorld1, local), dot(aToWorld2, local));
+    vToDecal0 = aToDecal0;
+    vToDecal1 = aToDecal1;
+    vToDecal2 = aToDecal2;
+    vAtlas = aAtlas;
+    vParams = aParams;
+    vTangent = normalize(vec3(aToWorld0.x, aToWorld1.x, aToWorld2.x));
+    vAxis = normalize(vec3(aToWorld0.z, aToWorld1.z, aToWorld2.z));
+    gl_Position = uViewProj * vec4(world, 1.0);
+}
@@ -31,11 +31,23 @@ struct LightSource {
     float exponent;
     int type; // 0 = POINT, 1 = SPOT, 2 = DIRECTIONAL
     bool enabled;
+    bool baked;       // 已烘焙到 Light Map（tools/LightmapBaker）的固定光源
+    // Shadow（由 CShadowManager 設定）
+    int shadowIndex;  // -1 = 不投射陰影，點光源對應 uShadowCube，聚光燈對應 uSpotShadowMap
+    float shadowFar;  // 深度貼圖中距離的正規化範圍
 };
 
 uniform LightSource uLights[MAX_LIGHTS];
 uniform int uNumLights;
 
+#define MAX_SHADOW_CUBES 6  // 需與 CShadowManager.h 相同
+#define MAX_SHADOW_SPOTS 2
+uniform samplerCube uShadowCube[MAX_SHADOW_CUBES];
+uniform sampler2D uSpotShadowMap[MAX_SHADOW_SPOTS];
+uniform mat4 uSpotShadowMatrix[MAX_SHADOW_SPOTS];
+uniform bool uShadowsEnabled = false;
+uniform float uShadowBias = 0.02;
+
 struct Material {
     vec4 ambient;   // ka
     vec4 diffuse;   // kd
@@ -64,14 +76,24 @@ struct Material {
 uniform Material uMaterial;
 
 uniform float uLightMapGamma = 2.2;      // Light Map 的 Gamma 值
-uniform int uLightMapBlendMode = 0;      // 混合模式：0=Multiply, 1=Add, 2=Screen, 3=Overlay
+uniform int uLightMapBlendMode = 0;      // 混合模式：0=Multiply, 1=Add, 2=Screen, 3=Overlay, 4=Baked lighting
+#define LIGHTMAP_BAKED 4
 uniform bool uUseLightMapAO = false;     // 是否將 Light Map 用作環境光遮蔽
 
+// Irradiance Volume：移動物件使用物件中心內插出的 L2 球諧係數（已與餘弦核心卷積）
+// 取代環境光與已烘焙光源的 diffuse
+uniform bool uUseIrradianceSH = false;
+uniform vec3 uSH[9];
+
 uniform float uNormalStrength = 2.0;
 uniform float uSpecularStrength = 3.0;
 uniform float uSpecularPower = 1.5;
 
-out vec4 FragColor;
+// Weighted Blended OIT：uOITPass 時輸出到 COITRenderer 的兩個累積貼圖
+uniform bool uOITPass = false;
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 FragOITWeight;
 
 vec3 blendLightMap(vec3 baseColor, vec3 lightMap, int blendMode) {
     switch(blendMode) {
@@ -107,6 +129,74 @@ vec3 blendLightMap(vec3 baseColor, vec3 lightMap, int blendMode) {
     }
 }
 
+// GLSL 3.30 的 sampler 陣列只能用常數索引
+float sampleShadowCube(int index, vec3 dir) {
+    if (index == 0) return texture(uShadowCube[0], dir).r;
+    if (index == 1) return texture(uShadowCube[1], dir).r;
+    if (index == 2) return texture(uShadowCube[2], dir).r;
+    if (index == 3) return texture(uShadowCube[3], dir).r;
+    if (index == 4) return texture(uShadowCube[4], dir).r;
+    return texture(uShadowCube[5], dir).r;
+}
+
+float sampleSpotShadow(int index, vec2 uv) {
+    if (index == 0) return texture(uSpotShadowMap[0], uv).r;
+    return texture(uSpotShadowMap[1], uv).r;
+}
+
+vec3 evalIrradianceSH(vec3 n) {
+    return uSH[0] * 0.282095
+         + uSH[1] * 0.488603 * n.y
+         + uSH[2] * 0.488603 * n.z
+         + uSH[3] * 0.488603 * n.x
+         + uSH[4] * 1.092548 * n.x * n.y
+         + uSH[5] * 1.092548 * n.y * n.z
+         + uSH[6] * 0.315392 * (3.0 * n.z * n.z - 1.0)
+         + uSH[7] * 1.092548 * n.x * n.z
+         + uSH[8] * 0.546274 * (n.x * n.x - n.y * n.y);
+}
+
+// 回傳 0（完全在陰影中）~ 1（完全受光）
+float computeShadow(int i, vec3 N, vec3 L) {
+    int index = uLights[i].shadowIndex;
+    if (!uShadowsEnabled || index < 0 || uLights[i].type == 2) return 1.0;
+
+    vec3 toFrag = v3Pos - uLights[i].position;
+    float current = length(toFrag) / uLights[i].shadowFar;
+    if (current >= 1.0) return 1.0;
+    // 斜面使用較大的 bias 避免 shadow acne
+    float bias = uShadowBias * (1.0 + 2.0 * (1.0 - max(dot(N, L), 0.0))) / uLights[i].shadowFar;
+
+    float lit = 0.0;
+    if (uLights[i].type == 0) {
+        if (index >= MAX_SHADOW_CUBES) return 1.0;
+        // 4-tap PCF，沿著與方向垂直的平面偏移
+        vec3 dir = normalize(toFrag);
+        vec3 up = abs(dir.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+        vec3 t = normalize(cross(up, dir));
+        vec3 b = cross(dir, t);
+        float r = 0.01;
+        lit += (current - bias <= sampleShadowCube(index, dir + ( t + b) * r)) ? 1.0 : 0.0;
+        lit += (current - bias <= sampleShadowCube(index, dir + ( t - b) * r)) ? 1.0 : 0.0;
+        lit += (current - bias <= sampleShadowCube(index, dir + (-t + b) * r)) ? 1.0 : 0.0;
+        lit += (current - bias <= sampleShadowCube(index, dir + (-t - b) * r)) ? 1.0 : 0.0;
+        return lit * 0.25;
+    }
+
+    if (index >= MAX_SHADOW_SPOTS) return 1.0;
+    mat4 m = (index == 0) ? uSpotShadowMatrix[0] : uSpotShadowMatrix[1];
+    vec4 clip = m * vec4(v3Pos, 1.0);
+    if (clip.w <= 0.0) return 1.0;
+    vec2 uv = clip.xy / clip.w * 0.5 + 0.5;
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) return 1.0;
+    vec2 texel = vec2(1.0) / vec2(textureSize(uSpotShadowMap[0], 0));
+    lit += (current - bias <= sampleSpotShadow(index, uv + vec2( 0.5,  0.5) * texel)) ? 1.0 : 0.0;
+    lit += (current - bias <= sampleSpotShadow(index, uv + vec2( 0.5, -0.5) * texel)) ? 1.0 : 0.0;
+    lit += (current - bias <= sampleSpotShadow(index, uv + vec2(-0.5,  0.5) * texel)) ? 1.0 : 0.0;
+    lit += (current - bias <= sampleSpotShadow(index, uv + vec2(-0.5, -0.5) * texel)) ? 1.0 : 0.0;
+    return lit * 0.25;
+}
+
 void main() {
 
     if( uShadingMode == 1) { FragColor = vec4(vColor, 1.0);  return; }
@@ -195,8 +285,11 @@ void main() {
     vec4 totalDiffuse = vec4(0.0);
     vec4 totalSpecular = vec4(0.0);
     
+    bool bakedLightMap = uMaterial.hasLightMap && uLightMapBlendMode == LIGHTMAP_BAKED;
     for (int i = 0; i < min(uNumLights, MAX_LIGHTS); i++) {
         if (!uLights[i].enabled) continue;
+        // 這個光源的直接光與間接光已經在 Light Map 中
+        if ((bakedLightMap || uUseIrradianceSH) && uLights[i].baked) continue;
         
         vec3 L;
         float attenuation = 1.0;
@@ -226,12 +319,13 @@ void main() {
         }
         
         vec3 H = normalize(L + V);
+        float shadow = computeShadow(i, N, L);
         
         // first Ambient
 //        if (i == 0) {
 //            totalAmbient += uLights[i].ambient * uMaterial.ambient * texDiffuse * attenuation * 1.0;
 //        }
-        if (i == 0) {
+        if (i == 0 && !uUseIrradianceSH) {
             vec4 ambient = uLights[i].ambient * uMaterial.ambient * texDiffuse * attenuation;
             // 應用 AO 到環境光
             if(uUseLightMapAO) {
@@ -242,22 +336,29 @@ void main() {
         
         // Diffuse
         float diff = max(dot(N, L), 0.0);
-        totalDiffuse += uLights[i].diffuse * diff * uMaterial.diffuse * texDiffuse * attenuation;
+        totalDiffuse += uLights[i].diffuse * diff * uMaterial.diffuse * texDiffuse * attenuation * shadow;
         
         // Specular
         float spec = pow(max(dot(N, H), 0.0), uMaterial.shininess * uSpecularPower);
         vec4 specularColor = uLights[i].specular * spec * uMaterial.specular * texSpecular * uSpecularStrength;
         float fresnel = pow(1.0 - max(dot(N, V), 0.0), 2.0);
         specularColor *= (1.0 + fresnel * 0.5);
-        totalSpecular += specularColor * attenuation;
+        totalSpecular += specularColor * attenuation * shadow;
     }
     
     finalColor = totalAmbient + totalDiffuse + totalSpecular;
     
-    if(uMaterial.hasLightMap) {
+    if(bakedLightMap) {
+        // Light Map 儲存的是表面收到的光，與動態光源的 diffuse 相同方式乘上材質顏色
+        finalColor.rgb += uMaterial.diffuse.rgb * texDiffuse.rgb * lightMapColor;
+    } else if(uMaterial.hasLightMap) {
         finalColor.rgb = blendLightMap(finalColor.rgb, lightMapColor, uLightMapBlendMode);
     }
     
+    if(uUseIrradianceSH) {
+        finalColor.rgb += uMaterial.diffuse.rgb * texDiffuse.rgb * max(evalIrradianceSH(N), vec3(0.0));
+    }
+    
     if (uMaterial.hasEnvironmentMap && uMaterial.reflectivity > 0.0) {
         // 計算正確的反射向量：觀察方向是從片元指向攝影機
         vec3 viewDir = normalize(-vView); // 從片元指向攝影機的向量
@@ -292,6 +393,15 @@ void main() {
 //    finalColor.rgb = pow(finalColor.rgb, vec3(1.0/2.2)); // Gamma correction
     finalColor = clamp(finalColor, 0.0, 1.0);
     finalColor.a = finalAlpha;
+    
+    if (uOITPass) {
+        // McGuire & Bavoil 的深度權重，越靠近攝影機、越不透明的片元權重越大
+        float a = finalAlpha;
+        float w = clamp(pow(min(1.0, a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+        FragColor = vec4(finalColor.rgb * a * w, a);
+        FragOITWeight = vec4(a * w, 0.0, 0.0, 0.0);
+        return;
+    }
     FragColor = finalColor;
     
 }
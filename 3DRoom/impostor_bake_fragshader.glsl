@@ -0,0 +1,23 @@
+// impostor_bake_fragshader.glsl
+// 輸出不含光照的顏色（alpha 為覆蓋率）與模型空間的法向量 + 正交投影的深度（0 為包圍球的最前端）
+// uDiffuseColor、uDiffuseTexture 由 Model::RenderProxy 設定
+#version 330 core
+in vec3 vNormal;
+in vec2 vTexCoord;
+
+uniform vec3 uDiffuseColor;
+uniform sampler2D uDiffuseTexture;
+uniform bool uHasDiffuseTexture;
+
+layout(location = 0) out vec4 Albedo;
+layout(location = 1) out vec4 NormalDepth;
+
+void main() {
+    vec3 albedo = uDiffuseColor;
+    if (uHasDiffuseTexture) albedo *= texture(uDiffuseTexture, vTexCoord).rgb;
+    vec3 N = normalize(vNormal);
+    // 雙面的網格從背面看時法向量朝向視角
+    if (!gl_FrontFacing) N = -N;
+    Albedo = vec4(albedo, 1.0);
+    NormalDepth = vec4(N * 0.5 + 0.5, gl_FragCoord.z);
+}
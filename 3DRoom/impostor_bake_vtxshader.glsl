@@ -0,0 +1,22 @@
+// impostor_bake_vtxshader.glsl
+// CImpostorRenderer::bake：模型空間的網格以各視角的正交投影畫到貼圖集的一格
+#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=2) in vec3 aNormal;
+layout(location=3) in vec2 aTex;
+layout(location=8) in vec4 aPosScale;        // 量化頂點的還原參數，與 v_phong.glsl 相同
+layout(location=9) in vec3 aPosOffset;
+layout(location=10) in vec4 aTexScaleOffset;
+
+uniform mat4 mxModel;
+uniform mat4 mxViewProj;   // 視角的 ortho * lookAt
+
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+void main() {
+    vNormal = mat3(mxModel) * aNormal;
+    vTexCoord = mix(aTex * aTexScaleOffset.xy + aTexScaleOffset.zw, aTex, aPosScale.w);
+    vec3 pos = mix(aPos * aPosScale.xyz + aPosOffset, aPos, aPosScale.w);
+    gl_Position = mxViewProj * mxModel * vec4(pos, 1.0);
+}
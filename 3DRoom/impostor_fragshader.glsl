@@ -0,0 +1,51 @@
+// impostor_fragshader.glsl
+// 三個視角的顏色、法向量與深度依權重（乘上覆蓋率）混合，覆蓋率不到一半的像素捨棄
+// 深度：從四邊形沿視線往攝影機移動烘焙時記錄的距離，得到表面的位置後寫入 gl_FragDepth
+// 光照只有主要光源的漫反射與固定的環境光（遠處的物件）
+#version 330 core
+
+in vec3 vWorldPos;
+in vec2 vFrameUV[3];
+flat in vec2 vFrame[3];
+flat in vec3 vWeights;
+flat in mat3 vRotation;
+flat in float vWorldRadius;
+
+uniform sampler2D uAlbedo;
+uniform sampler2D uNormalDepth;
+uniform int uFramesPerSide;
+uniform mat4 uViewProj;
+uniform vec3 uViewPos;
+uniform vec3 uLightPos;
+
+out vec4 FragColor;
+
+void main() {
+    vec3 color = vec3(0.0);
+    vec4 normalDepth = vec4(0.0);
+    float coverage = 0.0;
+    float total = 0.0;
+    for (int k = 0; k < 3; k++) {
+        vec2 uv = vFrameUV[k];
+        if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) continue;
+        vec2 atlasUV = (vFrame[k] + uv) / float(uFramesPerSide);
+        vec4 albedo = texture(uAlbedo, atlasUV);
+        float w = vWeights[k] * albedo.a;
+        color += albedo.rgb * w;
+        normalDepth += texture(uNormalDepth, atlasUV) * w;
+        coverage += w;
+        total += vWeights[k];
+    }
+    if (total <= 0.0 || coverage < 0.5 * total) discard;
+    color /= coverage;
+    normalDepth /= coverage;
+
+    vec3 toCamera = normalize(uViewPos - vWorldPos);
+    vec3 surface = vWorldPos + toCamera * vWorldRadius * (1.0 - 2.0 * normalDepth.a);
+    vec4 clip = uViewProj * vec4(surface, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    vec3 N = normalize(vRotation * (normalDepth.xyz * 2.0 - 1.0));
+    float diffuse = max(dot(N, normalize(uLightPos - surface)), 0.0);
+    FragColor = vec4(color * (0.35 + 0.65 * diffuse), 1.0);
+}
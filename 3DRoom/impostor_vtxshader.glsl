@@ -0,0 +1,78 @@
+// impostor_vtxshader.glsl
+// CImpostorRenderer：每個實體一個面向攝影機、涵蓋包圍球的四邊形（triangle strip 的 4 個頂點由 gl_VertexID 產生）
+// 視線方向轉到模型空間後選出三個視角與權重（與 OctahedralImpostor.h 的 impostorFrameBlend 相同），
+// 四邊形上的點投影到各視角的畫面上，得到三組貼圖座標
+#version 330 core
+
+layout(location = 0) in mat4 aWorld;         // 位置 0 ~ 3
+
+uniform mat4 uViewProj;
+uniform vec3 uViewPos;
+uniform vec3 uCameraRight;   // view matrix 的第一列
+uniform vec3 uCameraUp;      // view matrix 的第二列
+uniform vec3 uCenter;        // 模型空間的包圍球
+uniform float uRadius;
+uniform int uFramesPerSide;
+
+out vec3 vWorldPos;
+out vec2 vFrameUV[3];                 // 各視角畫面中的位置（0 ~ 1，超出範圍為畫面外）
+flat out vec2 vFrame[3];              // 各視角在貼圖集中的格子
+flat out vec3 vWeights;
+flat out mat3 vRotation;              // 模型空間的法向量轉到世界座標（不含縮放）
+flat out float vWorldRadius;
+
+vec2 hemiOctEncode(vec3 d) {
+    d.y = max(d.y, 0.0);
+    float sum = abs(d.x) + d.y + abs(d.z);
+    if (sum <= 0.0) return vec2(0.5);
+    vec2 p = d.xz / sum;
+    return vec2(p.x + p.y, p.x - p.y) * 0.5 + 0.5;
+}
+
+vec3 hemiOctDecode(vec2 uv) {
+    vec2 f = uv * 2.0 - 1.0;
+    float px = (f.x + f.y) * 0.5;
+    float pz = (f.x - f.y) * 0.5;
+    return normalize(vec3(px, 1.0 - abs(px) - abs(pz), pz));
+}
+
+// 與 impostorFrameBasis 相同
+void frameBasis(vec3 dir, out vec3 right, out vec3 up) {
+    vec3 reference = (abs(dir.y) > 0.999) ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    right = normalize(cross(reference, dir));
+    up = cross(dir, right);
+}
+
+void main() {
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    mat3 linear = mat3(aWorld);
+    float scale = max(length(linear[0]), max(length(linear[1]), length(linear[2])));
+    vec3 center = (aWorld * vec4(uCenter, 1.0)).xyz;
+    vWorldRadius = uRadius * scale;
+    vRotation = linear / scale;
+
+    vec3 world = center + (uCameraRight * (corner.x * 2.0 - 1.0) + uCameraUp * (corner.y * 2.0 - 1.0)) * vWorldRadius;
+    vWorldPos = world;
+    gl_Position = uViewProj * vec4(world, 1.0);
+
+    // 視線方向（物體中心指向攝影機）與四邊形上的點轉到模型空間（等比例縮放）
+    vec3 toCamera = normalize(transpose(vRotation) * (uViewPos - center));
+    vec3 local = transpose(vRotation) * (world - center) / scale;
+
+    float cells = float(uFramesPerSide - 1);
+    vec2 grid = hemiOctEncode(toCamera) * cells;
+    vec2 cell = min(floor(grid), vec2(cells - 1.0));
+    vec2 f = grid - cell;
+    if (f.x + f.y <= 1.0) {
+        vFrame[0] = cell;                 vFrame[1] = cell + vec2(1.0, 0.0); vFrame[2] = cell + vec2(0.0, 1.0);
+        vWeights = vec3(1.0 - f.x - f.y, f.x, f.y);
+    } else {
+        vFrame[0] = cell + vec2(1.0, 1.0); vFrame[1] = cell + vec2(0.0, 1.0); vFrame[2] = cell + vec2(1.0, 0.0);
+        vWeights = vec3(f.x + f.y - 1.0, 1.0 - f.x, 1.0 - f.y);
+    }
+    for (int k = 0; k < 3; k++) {
+        vec3 right, up;
+        frameBasis(hemiOctDecode(vFrame[k] / cells), right, up);
+        vFrameUV[k] = vec2(dot(local, right), dot(local, up)) / (2.0 * uRadius) + 0.5;
+    }
+}
@@ -25,7 +25,7 @@ void CBottle::draw() {
     glBindVertexArray(_vao);
     glUniform1i(_shadingModeLoc, _uShadingMode);
     if (_bObjColor) glUniform4fv(_colorLoc, 1, glm::value_ptr(_color));
-    glDrawElements(GL_TRIANGLES, _idxCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, _idxCount, _idxType, 0);
     glBindVertexArray(0);
 }
 
@@ -34,7 +34,7 @@ void CBottle::drawRaw() {
     glBindVertexArray(_vao);
     glUniform1i(_shadingModeLoc, _uShadingMode);
     if (_bObjColor) glUniform4fv(_colorLoc, 1, glm::value_ptr(_color));
-    glDrawElements(GL_TRIANGLES, _idxCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, _idxCount, _idxType, 0);
     glBindVertexArray(0);
 }
 
@@ -86,7 +86,7 @@ void CCube::draw()
 	glBindVertexArray(_vao);
 	glUniform1i(_shadingModeLoc, _uShadingMode);
 	if ( _bObjColor ) glUniform4fv(_colorLoc, 1, glm::value_ptr(_color));
-	glDrawElements(GL_TRIANGLES, _idxCount, GL_UNSIGNED_INT, 0);
+	glDrawElements(GL_TRIANGLES, _idxCount, _idxType, 0);
 	glBindVertexArray(0);
 }
 
@@ -96,7 +96,7 @@ void CCube::drawRaw()
 	glBindVertexArray(_vao);
 	glUniform1i(_shadingModeLoc, _uShadingMode);
 	if (_bObjColor) glUniform4fv(_colorLoc, 1, glm::value_ptr(_color));
-	glDrawElements(GL_TRIANGLES, _idxCount, GL_UNSIGNED_INT, 0);
+	glDrawElements(GL_TRIANGLES, _idxCount, _idxType, 0);
 	glBindVertexArray(0);
 }
 
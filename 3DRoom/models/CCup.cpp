@@ -26,7 +26,7 @@ void CCup::draw() {
     glBindVertexArray(_vao);
     glUniform1i(_shadingModeLoc, _uShadingMode);
     if (_bObjColor) glUniform4fv(_colorLoc, 1, glm::value_ptr(_color));
-    glDrawElements(GL_TRIANGLES, _idxCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, _idxCount, _idxType, 0);
     glBindVertexArray(0);
 }
 
@@ -35,7 +35,7 @@ void CCup::drawRaw() {
     glBindVertexArray(_vao);
     glUniform1i(_shadingModeLoc, _uShadingMode);
     if (_bObjColor) glUniform4fv(_colorLoc, 1, glm::value_ptr(_color));
-    glDrawElements(GL_TRIANGLES, _idxCount, GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, _idxCount, _idxType, 0);
     glBindVertexArray(0);
 }
 
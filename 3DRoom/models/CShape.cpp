@@ -1,12 +1,23 @@
 #include <glm/gtc/type_ptr.hpp>
+#include <cfloat>
+#include <vector>
 
 #include "CShape.h"
 #include "../common/typedefs.h"
 
+VertexFormat CShape::s_defaultVertexFormat = VertexFormat::QUANTIZED;
+size_t CShape::s_uploadedVertexBytes = 0;
+size_t CShape::s_uploadedFloatVertexBytes = 0;
+size_t CShape::s_uploadedIndexBytes = 0;
+size_t CShape::s_uploadedUint32IndexBytes = 0;
+
 CShape::CShape()
 {
 	_vtxCount = _vtxAttrCount = _idxCount = 0;
 	_vao = 0; _vbo = 0; _ebo = 0;
+	_idxType = GL_UNSIGNED_INT;
+	_decodeVbo = 0;
+	_vertexFormat = s_defaultVertexFormat;
 	_shaderProg = 0;
 	_scale = glm::vec3(1.0f, 1.0f, 1.0f);
 	_color = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
@@ -29,7 +40,7 @@ CShape::CShape()
 
 CShape::~CShape()
 {
-
+	if (_decodeVbo != 0) glDeleteBuffers(1, &_decodeVbo);
 }
 
 void CShape::setupVertexAttributes()
@@ -42,13 +53,94 @@ void CShape::setupVertexAttributes()
 	// Bind the Vertex Array Object first, then bind and set vertex buffer(s) and attribute pointer(s).
 	glBindVertexArray(_vao);
 
+	// ]w EBOA޳p 65536 ɥH 16-bit WǡAyøɨϥ _idxType
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+	if (fitsIndex16(_idx, _idxCount)) {
+		std::vector<uint16_t> narrow;
+		narrowIndices(_idx, _idxCount, narrow);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrow.size() * sizeof(uint16_t), narrow.data(), GL_STATIC_DRAW);
+		_idxType = GL_UNSIGNED_SHORT;
+		s_uploadedIndexBytes += narrow.size() * sizeof(uint16_t);
+	}
+	else {
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, _idxCount * sizeof(GLuint), _idx, GL_STATIC_DRAW);
+		_idxType = GL_UNSIGNED_INT;
+		s_uploadedIndexBytes += _idxCount * sizeof(GLuint);
+	}
+	s_uploadedUint32IndexBytes += _idxCount * sizeof(GLuint);
+	glBindVertexArray(0); // Ѱ VAO jw
+
+	s_uploadedFloatVertexBytes += _vtxCount * _vtxAttrCount * sizeof(float);
+	uploadVertices(s_defaultVertexFormat);
+}
+
+void CShape::setVertexFormat(VertexFormat format)
+{
+	if (_vao == 0) return;
+	s_uploadedVertexBytes -= vertexBufferBytes();
+	uploadVertices(format);
+}
+
+size_t CShape::vertexBufferBytes() const
+{
+	if (_vertexFormat == VertexFormat::QUANTIZED) return _vtxCount * sizeof(PackedVertex);
+	return _vtxCount * _vtxAttrCount * sizeof(float);
+}
+
+// W VBO ó]wIݩʡAP Model::UploadVertices ۦP
+void CShape::uploadVertices(VertexFormat format)
+{
+	// IY PackedVertex]mHΪ]򲰶qơ^Av_phong.glsl SϥΪC⤣W
+	std::vector<PackedVertex> packed;
+	VertexDecode decode;
+	if (format == VertexFormat::QUANTIZED) {
+		glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+		for (int i = 0; i < _vtxCount; i++) {
+			glm::vec3 p(_points[i * _vtxAttrCount], _points[i * _vtxAttrCount + 1], _points[i * _vtxAttrCount + 2]);
+			boundsMin = glm::min(boundsMin, p);
+			boundsMax = glm::max(boundsMax, p);
+		}
+		QuantizeError error = CVertexQuantize::pack(_points, _vtxCount, _vtxAttrCount, 6, 9, boundsMin, boundsMax, packed, decode);
+		if (!CVertexQuantize::acceptable(error)) format = VertexFormat::FLOAT;
+	}
+	_vertexFormat = format;
+
 	// ]w VBO
+	glBindVertexArray(_vao);
 	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, _vtxCount * _vtxAttrCount * sizeof(float), _points, GL_STATIC_DRAW);
-
-	// ]w EBO
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, _idxCount * sizeof(GLuint), _idx, GL_STATIC_DRAW);
+	if (_vertexFormat == VertexFormat::QUANTIZED) {
+		glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+	}
+	else {
+		glBufferData(GL_ARRAY_BUFFER, _vtxCount * _vtxAttrCount * sizeof(float), _points, GL_STATIC_DRAW);
+	}
+	s_uploadedVertexBytes += vertexBufferBytes();
+
+	if (_vertexFormat == VertexFormat::QUANTIZED) {
+		// mPKϮyЬ unorm16BkVq snorm 10:10:10AP Model::UploadVertices ۦP
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), BUFFER_OFFSET(offsetof(PackedVertex, position)));
+		glEnableVertexAttribArray(0);
+		glDisableVertexAttribArray(1);
+		glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), BUFFER_OFFSET(offsetof(PackedVertex, normal)));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(3, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), BUFFER_OFFSET(offsetof(PackedVertex, texCoords)));
+		glEnableVertexAttribArray(3);
+
+		// ٭Ѽơ]divisor 1AyøŪߤ@@^
+		if (_decodeVbo == 0) glGenBuffers(1, &_decodeVbo);
+		glBindBuffer(GL_ARRAY_BUFFER, _decodeVbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(VertexDecode), &decode, GL_STATIC_DRAW);
+		glVertexAttribPointer(VERTEX_DECODE_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(VertexDecode), BUFFER_OFFSET(offsetof(VertexDecode, positionScale)));
+		glVertexAttribPointer(VERTEX_DECODE_LOCATION + 1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexDecode), BUFFER_OFFSET(offsetof(VertexDecode, positionOffset)));
+		glVertexAttribPointer(VERTEX_DECODE_LOCATION + 2, 4, GL_FLOAT, GL_FALSE, sizeof(VertexDecode), BUFFER_OFFSET(offsetof(VertexDecode, texCoordScaleOffset)));
+		for (int k = 0; k < 3; k++) {
+			glVertexAttribDivisor(VERTEX_DECODE_LOCATION + k, 1);
+			glEnableVertexAttribArray(VERTEX_DECODE_LOCATION + k);
+		}
+		glBindVertexArray(0); // Ѱ VAO jw
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return;
+	}
 
 	// mݩ
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, _vtxAttrCount * sizeof(float), BUFFER_OFFSET(0));
@@ -65,7 +157,11 @@ void CShape::setupVertexAttributes()
 	//KϮyݩ
 	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, _vtxAttrCount * sizeof(float), BUFFER_OFFSET(9 * sizeof(float)));
 	glEnableVertexAttribArray(3);
+
+	// Sҥ٭ѼƮŪ (0,0,0,1)Ashader ϥ float 
+	for (int k = 0; k < 3; k++) glDisableVertexAttribArray(VERTEX_DECODE_LOCATION + k);
 	glBindVertexArray(0); // Ѱ VAO jw
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void CShape::setShaderID(GLuint shaderID, int shadeingmode)
@@ -2,6 +2,8 @@
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 #include "../common/CMaterial.h"
+#include "../common/CVertexQuantize.h"
+#include "../common/IndexWidth.h"
 
 class CShape
 {
@@ -12,7 +14,22 @@ public:
 	virtual void drawRaw(); //ϥ shader
 	virtual void reset();
 	virtual void update(float dt);
-	void setupVertexAttributes();
+	void setupVertexAttributes(); // IH setDefaultVertexFormat 榡W
+	// wWǪΪHs榡sWǳIA٨SWǮɨS@
+	void setVertexFormat(VertexFormat format);
+	VertexFormat getVertexFormat() const { return _vertexFormat; }
+	// Is setupVertexAttributes ΪϥΪ榡Aw] QUANTIZED
+	static void setDefaultVertexFormat(VertexFormat format) { s_defaultVertexFormat = format; }
+	// Ҧ CShape WǪIwİϤjpAPϥ 11  float ɪjp]bytes^
+	static size_t getUploadedVertexBytes() { return s_uploadedVertexBytes; }
+	static size_t getUploadedFloatVertexBytes() { return s_uploadedFloatVertexBytes; }
+	// Ҧ CShape WǪ޽wİϤjpAPϥ 32-bit ޮɪjp]bytes^
+	static size_t getUploadedIndexBytes() { return s_uploadedIndexBytes; }
+	static size_t getUploadedUint32IndexBytes() { return s_uploadedUint32IndexBytes; }
+	// غcɲͪIƻP 32-bit ޡ]setupVertexAttributes  fitsIndex16 MwWǪeס^
+	int getVertexCount() const { return _vtxCount; }
+	int getIndexCount() const { return _idxCount; }
+	const GLuint* getIndices() const { return _idx; }
 	void setShaderID(GLuint shaderID, int shadeingmode = 1); // w]ϥζǤJ vertex color
 	void setColor(glm::vec4 vColor); // ]wҫC
 	void setScale(glm::vec3 vScale); // ]wҫY
@@ -36,6 +53,14 @@ protected:
 	GLfloat* _points;
 	GLuint* _idx;
 	GLuint _vao, _vbo, _ebo;
+	GLenum _idxType; // EBO ޼eסAIWL 65536 Ӯɬ GL_UNSIGNED_SHORT
+	GLuint _decodeVbo; // qƳI٭Ѽơ]@ VertexDecode^
+	VertexFormat _vertexFormat; // VBO ثe榡]nD QUANTIZED ~tWLWɬ FLOAT^
+	static VertexFormat s_defaultVertexFormat;
+	void uploadVertices(VertexFormat format);
+	size_t vertexBufferBytes() const;
+	static size_t s_uploadedVertexBytes, s_uploadedFloatVertexBytes;
+	static size_t s_uploadedIndexBytes, s_uploadedUint32IndexBytes;
 	GLuint _shaderProg;
 	GLint _modelMxLoc;
 	GLint _shadingModeLoc, _uShadingMode; //WҦiJI, WҦ
@@ -0,0 +1,19 @@
+// oit_fragshader.glsl
+// Weighted Blended OIT 的合成：把累積的顏色除以權重總和，再依 revealage 疊到不透明的畫面上
+#version 330 core
+
+uniform sampler2D uAccum;   // rgb = sum(color * alpha * w), a = prod(1 - alpha)
+uniform sampler2D uWeight;  // r = sum(alpha * w)
+
+out vec4 FragColor;
+
+void main() {
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    vec4 accum = texelFetch(uAccum, coord, 0);
+    float revealage = accum.a;
+    if (revealage >= 0.9999) discard;   // 這個像素沒有透明物體
+
+    float weight = max(texelFetch(uWeight, coord, 0).r, 1e-5);
+    // 混合方式為 (ONE_MINUS_SRC_ALPHA, SRC_ALPHA)：dst = color * (1 - revealage) + dst * revealage
+    FragColor = vec4(accum.rgb / weight, revealage);
+}
@@ -0,0 +1,8 @@
+// oit_vtxshader.glsl
+#version 330 core
+// 以 gl_VertexID 產生涵蓋整個畫面的三角形，不需要頂點資料
+
+void main() {
+    vec2 pos = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
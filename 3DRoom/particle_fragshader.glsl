@@ -0,0 +1,17 @@
+// particle_fragshader.glsl
+// 圓形、邊緣漸淡的粒子，輸出 premultiplied alpha；additive 的粒子 alpha 為 0（只加上顏色）
+#version 330 core
+
+in vec2 vCorner;
+in vec4 vColor;
+in float vAdditive;
+
+out vec4 FragColor;
+
+void main() {
+    float r2 = dot(vCorner, vCorner);
+    if (r2 >= 1.0) discard;
+    float falloff = (1.0 - r2) * (1.0 - r2);
+    float alpha = vColor.a * falloff;
+    FragColor = vec4(vColor.rgb * alpha, alpha * (1.0 - vAdditive));
+}
@@ -0,0 +1,45 @@
+// particle_vtxshader.glsl
+// 每個粒子一個四邊形（triangle strip 的 4 個頂點由 gl_VertexID 產生），面向攝影機
+#version 330 core
+
+#define MAX_STYLES 8
+
+layout(location = 0) in float aX;
+layout(location = 1) in float aY;
+layout(location = 2) in float aZ;
+layout(location = 3) in float aAge;     // 0 為剛出生，1 為死亡
+layout(location = 4) in uint aStyle;
+
+uniform mat4 uViewProj;
+uniform vec3 uViewPos;
+uniform vec4 uColorStart[MAX_STYLES];
+uniform vec4 uColorEnd[MAX_STYLES];
+uniform vec2 uSize[MAX_STYLES];          // 出生與死亡時的邊長
+uniform float uAdditive[MAX_STYLES];
+
+out vec2 vCorner;
+out vec4 vColor;
+out float vAdditive;
+
+void main() {
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0 - 1.0;
+    vec3 center = vec3(aX, aY, aZ);
+    int style = int(aStyle);
+
+    // 與 Model::calculateSphericalBillboard 相同：forward 指向攝影機，right = worldUp x forward，up = forward x right
+    // 攝影機在粒子正上方或正下方時 right 退化，改用 x 軸
+    vec3 forward = uViewPos - center;
+    float distance = length(forward);
+    forward = (distance > 1e-5) ? forward / distance : vec3(0.0, 0.0, 1.0);
+    vec3 right = cross(vec3(0.0, 1.0, 0.0), forward);
+    float rightLength = length(right);
+    right = (rightLength > 1e-4) ? right / rightLength : vec3(1.0, 0.0, 0.0);
+    vec3 up = cross(forward, right);
+
+    float size = mix(uSize[style].x, uSize[style].y, aAge);
+    vec3 world = center + (right * corner.x + up * corner.y) * (0.5 * size);
+    vCorner = corner;
+    vColor = mix(uColorStart[style], uColorEnd[style], aAge);
+    vAdditive = uAdditive[style];
+    gl_Position = uViewProj * vec4(world, 1.0);
+}
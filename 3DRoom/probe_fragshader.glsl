@@ -0,0 +1,36 @@
+// probe_fragshader.glsl
+// 反射探針用的簡化光照：只有漫反射與環境光，沒有法線、鏡面、Light Map
+#version 330 core
+in vec3 vWorldPos;
+in vec3 vNormal;
+in vec2 vTexCoord;
+
+#define MAX_PROBE_LIGHTS 8
+
+uniform vec3 uLightPos[MAX_PROBE_LIGHTS];
+uniform vec3 uLightDiffuse[MAX_PROBE_LIGHTS];
+uniform vec3 uLightAmbient[MAX_PROBE_LIGHTS];
+uniform vec3 uLightAtten[MAX_PROBE_LIGHTS];   // constant, linear, quadratic
+uniform int  uNumLights;
+
+uniform vec3 uDiffuseColor;
+uniform sampler2D uDiffuseTexture;
+uniform bool uHasDiffuseTexture;
+
+out vec4 FragColor;
+
+void main() {
+    vec3 albedo = uDiffuseColor;
+    if (uHasDiffuseTexture) albedo *= texture(uDiffuseTexture, vTexCoord).rgb;
+
+    vec3 N = normalize(vNormal);
+    vec3 color = vec3(0.0);
+    for (int i = 0; i < min(uNumLights, MAX_PROBE_LIGHTS); i++) {
+        vec3 toLight = uLightPos[i] - vWorldPos;
+        float dist = length(toLight);
+        float atten = 1.0 / (uLightAtten[i].x + uLightAtten[i].y * dist + uLightAtten[i].z * dist * dist);
+        float diff = max(dot(N, toLight / dist), 0.0);
+        color += (uLightAmbient[i] * 0.2 + uLightDiffuse[i] * diff * atten) * albedo;
+    }
+    FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
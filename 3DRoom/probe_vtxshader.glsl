@@ -0,0 +1,23 @@
+// probe_vtxshader.glsl
+#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=2) in vec3 aNormal;
+layout(location=3) in vec2 aTex;
+layout(location=8) in vec4 aPosScale;        // Model 的量化頂點（CVertexQuantize）
+layout(location=9) in vec3 aPosOffset;
+layout(location=10) in vec4 aTexScaleOffset;
+
+uniform mat4 mxModel;
+uniform mat4 mxViewProj;   // 探針某一面的 proj * view
+
+out vec3 vWorldPos;
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+void main() {
+    vec4 worldPos = mxModel * vec4(mix(aPos * aPosScale.xyz + aPosOffset, aPos, aPosScale.w), 1.0);
+    vWorldPos = worldPos.xyz;
+    vNormal = mat3(mxModel) * aNormal;   // 反射用的低解析度畫面，不做 inverse transpose
+    vTexCoord = mix(aTex * aTexScaleOffset.xy + aTexScaleOffset.zw, aTex, aPosScale.w);
+    gl_Position = mxViewProj * worldPos;
+}
@@ -0,0 +1,11 @@
+// shadow_fragshader.glsl
+#version 330 core
+in vec3 vWorldPos;
+
+uniform vec3  uLightPos;
+uniform float uFarPlane;
+
+void main() {
+    // 點光源與聚光燈都寫入線性距離，f_phong 中用同樣的方式比較
+    gl_FragDepth = length(vWorldPos - uLightPos) / uFarPlane;
+}
@@ -0,0 +1,17 @@
+// shadow_vtxshader.glsl
+#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=8) in vec4 aPosScale;    // 量化頂點的位置還原（CVertexQuantize），float 頂點為 (0,0,0,1)
+layout(location=9) in vec3 aPosOffset;
+
+uniform mat4 mxModel;
+uniform mat4 uLightSpace;   // 光源某一面的 proj * view
+
+out vec3 vWorldPos;
+
+void main() {
+    vec3 pos = mix(aPos * aPosScale.xyz + aPosOffset, aPos, aPosScale.w);
+    vec4 worldPos = mxModel * vec4(pos, 1.0);
+    vWorldPos = worldPos.xyz;
+    gl_Position = uLightSpace * worldPos;
+}
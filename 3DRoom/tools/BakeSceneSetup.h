@@ -0,0 +1,54 @@
+//  BakeSceneSetup.h
+//  烘焙工具共用的場景設定：與 Homework.cpp 相同的靜態模型、世界矩陣與固定光源
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/CBakeScene.h"
+
+#define BAKE_STATIC_MODELS 9   // models[0] ~ models[8]
+
+// 與 Homework.cpp 的 computeModelMatrix() 相同
+inline glm::mat4 staticModelMatrix(int i)
+{
+    glm::mat4 m = glm::scale(glm::mat4(1.0f), glm::vec3(0.7f));
+    if (i == 7) {
+        m = glm::translate(m, glm::vec3(-1.0f, 1.5f, -6.0f));
+        m = glm::scale(m, glm::vec3(1.3f));
+    } else if (i == 8) {
+        m = glm::translate(m, glm::vec3(3.0f, 1.5f, -6.0f));
+        m = glm::scale(m, glm::vec3(1.3f));
+        m = glm::rotate(m, glm::radians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+    return m;
+}
+
+// 載入靜態模型與固定光源並建立 BVH，instances[i] 為 models[i] 的 instance id
+// 機器人、電風扇、Billboard 會移動，不參與烘焙
+inline void setupStaticBakeScene(CBakeScene& scene, int instances[BAKE_STATIC_MODELS])
+{
+    const char* paths[BAKE_STATIC_MODELS] = {
+        "models/Room001.obj", "models/livingRoomTable.obj", "models/sofa.obj", "models/bed.obj",
+        "models/toilet.obj", "models/desk.obj", "models/garden.obj", "models/woodCube.obj",
+        "models/woodCube.obj"
+    };
+    for (int i = 0; i < BAKE_STATIC_MODELS; i++) instances[i] = scene.addModel(paths[i], staticModelMatrix(i));
+    scene.addModel("models/Room001Window.obj", staticModelMatrix(12));
+
+    // 固定的光源：與 Homework.cpp 的 g_light2 ~ g_light6 相同（diffuse 0.6 * intensity 3）
+    // g_light 可以用 'l' 鍵啟動移動，所以仍在執行時計算
+    const glm::vec3 lightPositions[] = {
+        glm::vec3(24.0f, 8.0f, 7.0f), glm::vec3(-24.0f, 8.0f, 7.0f), glm::vec3(-24.0f, 8.0f, -7.0f),
+        glm::vec3(0.0f, 8.0f, -7.0f), glm::vec3(24.0f, 8.0f, -7.0f)
+    };
+    for (const glm::vec3& pos : lightPositions) {
+        BakeLight light;
+        light.position = pos;
+        light.diffuse = glm::vec3(0.6f * 3.0f);
+        light.constant = 1.0f; light.linear = 0.09f; light.quadratic = 0.032f;
+        scene.addLight(light);
+    }
+    scene.buildBVH();
+}
@@ -0,0 +1,324 @@
+//  ClusterBenchmark.cpp
+//  CMeshCluster / CClusterCuller：Homework 的靜態模型（models[0] ~ [8]，世界矩陣與 BakeSceneSetup.h 相同）以 Model 相同的方式
+//  合併頂點、分成叢集，攝影機站在六個房間的中央（眼睛高度 EYE_HEIGHT）各看八個方向，
+//  輸出每個房間平均送出的三角形：不分叢集（每個網格一次 glDrawElements）、只剔除視錐外的叢集、再加上背面的法向量錐，
+//  以及逐三角形判斷（正面且沒有整個在視錐的某個平面外側）的下限
+//  接著以 RoomGrid 的 --rooms 個房間（每個房間 3 個家具）比較單執行緒與多執行緒的剔除時間
+//  檢查：叢集的索引是原本三角形的重新排列、每個叢集不超過 MESH_CLUSTER_TRIANGLES 個三角形、
+//  正面且在視錐內的三角形所在的叢集都沒有被剔除（保守）、多執行緒的結果與單執行緒相同，失敗時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      ClusterBenchmark [--rooms CxR] [--repeat N]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/CClusterCuller.h"
+#include "../common/CParallel.h"
+#include "../common/RoomGrid.h"
+#include "../tiny_obj_loader.h"
+#include "BakeSceneSetup.h"
+
+#define EYE_HEIGHT 6.0f
+#define VIEW_DIRECTIONS 8
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 不透明的網格（每個 shape 一個），頂點為 8 個 float，索引相同的頂點合併（與 Model::ProcessMesh 相同）
+struct ClusteredMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<MeshCluster> clusters;
+};
+
+struct SceneModel {
+    std::vector<ClusteredMesh> meshes;
+    glm::mat4 world = glm::mat4(1.0f);
+};
+
+static bool loadOpaqueMeshes(const std::string& path, std::vector<ClusteredMesh>& meshes) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        // 與 Model::IsTransparent 相同：alpha < 1 或有 alpha 貼圖的網格交給 COITRenderer，不分叢集描繪
+        int material = shape.mesh.material_ids.empty() ? -1 : shape.mesh.material_ids[0];
+        if (material >= 0 && material < static_cast<int>(materials.size()) &&
+            (materials[material].dissolve < 1.0f || !materials[material].alpha_texname.empty())) {
+            continue;
+        }
+        ClusteredMesh mesh;
+        std::map<std::array<int, 3>, unsigned int> unique;
+        for (const auto& index : shape.mesh.indices) {
+            std::array<int, 3> key = { index.vertex_index, index.normal_index, index.texcoord_index };
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                it = unique.emplace(key, static_cast<unsigned int>(mesh.vertices.size() / 8)).first;
+                for (int k = 0; k < 3; ++k) mesh.vertices.push_back(attrib.vertices[3 * index.vertex_index + k]);
+                for (int k = 0; k < 3; ++k) {
+                    float fallback = (k == 1) ? 1.0f : 0.0f;
+                    mesh.vertices.push_back(index.normal_index >= 0 ? attrib.normals[3 * index.normal_index + k] : fallback);
+                }
+                for (int k = 0; k < 2; ++k) {
+                    mesh.vertices.push_back(index.texcoord_index >= 0 ? attrib.texcoords[2 * index.texcoord_index + k] : 0.0f);
+                }
+            }
+            mesh.indices.push_back(it->second);
+        }
+        if (!mesh.indices.empty()) meshes.push_back(std::move(mesh));
+    }
+    return true;
+}
+
+// 重新排列後三角形的集合相同（以排序後的三個索引比較，保留環繞方向：旋轉到最小的索引在前）、叢集連續且不超過上限
+static bool checkClusters(const std::vector<unsigned int>& original, const ClusteredMesh& mesh) {
+    auto canonical = [](const std::vector<unsigned int>& indices) {
+        std::vector<std::array<unsigned int, 3>> triangles;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            std::array<unsigned int, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+            std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+            triangles.push_back(t);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+    if (canonical(original) != canonical(mesh.indices)) return false;
+    uint32_t expected = 0;
+    for (const MeshCluster& cluster : mesh.clusters) {
+        if (cluster.indexStart != expected || cluster.indexCount == 0 || cluster.indexCount > 3 * MESH_CLUSTER_TRIANGLES) {
+            return false;
+        }
+        expected += cluster.indexCount;
+    }
+    return expected == mesh.indices.size();
+}
+
+// 三角形是否可能在視錐內：沒有一個平面讓三個頂點都在外側
+static bool triangleInFrustum(const glm::vec4* planes, const glm::vec3* p) {
+    for (int i = 0; i < 6; ++i) {
+        glm::vec3 n(planes[i]);
+        if (glm::dot(n, p[0]) + planes[i].w < 0.0f && glm::dot(n, p[1]) + planes[i].w < 0.0f &&
+            glm::dot(n, p[2]) + planes[i].w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void frustumPlanes(const glm::mat4& m, glm::vec4* planes) {
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    const glm::vec4 p[6] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+    for (int i = 0; i < 6; ++i) planes[i] = p[i] / glm::length(glm::vec3(p[i]));
+}
+
+// 逐三角形的下限（正面且可能在視錐內），並檢查這些三角形所在的叢集都有送出
+static size_t visibleTriangles(const SceneModel& model, const CClusterCuller& culler, int firstItem,
+                               const glm::mat4& viewProj, const glm::vec3& eye, bool& conservative) {
+    glm::vec4 planes[6];
+    frustumPlanes(viewProj, planes);
+    size_t visible = 0;
+    for (size_t m = 0; m < model.meshes.size(); ++m) {
+        const ClusteredMesh& mesh = model.meshes[m];
+        int count = 0;
+        const ClusterDrawRange* ranges = culler.getRanges(firstItem + static_cast<int>(m), count);
+        std::vector<char> submitted(mesh.indices.size() / 3, 0);
+        for (int r = 0; r < count; ++r) {
+            for (uint32_t i = ranges[r].indexStart; i < ranges[r].indexStart + ranges[r].indexCount; i += 3) submitted[i / 3] = 1;
+        }
+        for (size_t t = 0; t < mesh.indices.size() / 3; ++t) {
+            glm::vec3 p[3];
+            for (int k = 0; k < 3; ++k) {
+                const float* v = &mesh.vertices[8 * mesh.indices[3 * t + k]];
+                p[k] = glm::vec3(model.world * glm::vec4(v[0], v[1], v[2], 1.0f));
+            }
+            glm::vec3 n = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if (glm::dot(n, n) == 0.0f || glm::dot(n, p[0] - eye) >= 0.0f) continue;
+            if (!triangleInFrustum(planes, p)) continue;
+            visible++;
+            if (!submitted[t]) conservative = false;
+        }
+    }
+    return visible;
+}
+
+int main(int argc, char** argv) {
+    RoomGridConfig gridConfig;
+    gridConfig.cols = 12;
+    gridConfig.rows = 12;
+    gridConfig.furniturePerRoom = 3;
+    int repeat = 20;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--rooms" && hasValue && std::sscanf(argv[i + 1], "%dx%d", &gridConfig.cols, &gridConfig.rows) == 2) i++;
+        else if (arg == "--repeat" && hasValue) repeat = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: ClusterBenchmark [--rooms CxR] [--repeat N]" << std::endl;
+            return 1;
+        }
+    }
+
+    const char* paths[BAKE_STATIC_MODELS] = {
+        "models/Room001.obj", "models/livingRoomTable.obj", "models/sofa.obj", "models/bed.obj",
+        "models/toilet.obj", "models/desk.obj", "models/garden.obj", "models/woodCube.obj",
+        "models/woodCube.obj"
+    };
+    int failures = 0;
+    std::vector<SceneModel> scene(BAKE_STATIC_MODELS);
+    size_t totalClusters = 0, totalTriangles = 0, coneClusters = 0;
+    bool clustersOk = true;
+    double buildMs = 0.0;
+    for (int i = 0; i < BAKE_STATIC_MODELS; ++i) {
+        if (!loadOpaqueMeshes(paths[i], scene[i].meshes)) return 1;
+        scene[i].world = staticModelMatrix(i);
+        for (ClusteredMesh& mesh : scene[i].meshes) {
+            std::vector<unsigned int> original = mesh.indices;
+            buildMs += measureMs([&]() {
+                CMeshCluster::build(mesh.vertices.data(), mesh.vertices.size() / 8, 8, mesh.indices, mesh.clusters);
+            });
+            if (!checkClusters(original, mesh)) clustersOk = false;
+            totalClusters += mesh.clusters.size();
+            totalTriangles += mesh.indices.size() / 3;
+            for (const MeshCluster& cluster : mesh.clusters) {
+                if (cluster.coneCutoff < 1.0f) coneClusters++;
+            }
+        }
+    }
+    std::cout << "ClusterBenchmark: " << totalTriangles << " opaque triangles in " << totalClusters << " clusters (avg "
+              << std::fixed << std::setprecision(1) << static_cast<double>(totalTriangles) / std::max<size_t>(totalClusters, 1)
+              << " triangles, " << 100.0 * coneClusters / std::max<size_t>(totalClusters, 1)
+              << "% with a usable normal cone), build " << buildMs << " ms" << std::endl;
+    std::cout << (clustersOk ? "  ok" : "  FAILED") << std::endl;
+    if (!clustersOk) failures++;
+
+    // 每個房間：八個方向的平均
+    RoomGrid rooms = generateRoomGrid(RoomGridConfig());
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    std::cout << std::endl << "Triangles submitted per view (" << VIEW_DIRECTIONS << " directions per room, eye height "
+              << EYE_HEIGHT << "):" << std::endl;
+    std::cout << std::setw(6) << "room" << std::setw(14) << "unclustered" << std::setw(14) << "frustum" << std::setw(18)
+              << "frustum+cone" << std::setw(9) << "ratio" << std::setw(9) << "ranges" << std::setw(14) << "per-triangle"
+              << std::endl;
+    CClusterCuller culler;
+    bool conservative = true;
+    size_t sumUnclustered = 0, sumFrustum = 0, sumBoth = 0;
+    for (size_t r = 0; r < rooms.roomCenters.size(); ++r) {
+        glm::vec3 eye(rooms.roomCenters[r].x, EYE_HEIGHT, rooms.roomCenters[r].z);
+        size_t frustumOnly = 0, both = 0, ranges = 0, ideal = 0;
+        for (int d = 0; d < VIEW_DIRECTIONS; ++d) {
+            float yaw = glm::radians(360.0f * d / VIEW_DIRECTIONS);
+            glm::vec3 forward(std::cos(yaw), 0.0f, std::sin(yaw));
+            glm::mat4 viewProj = proj * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+            for (int pass = 0; pass < 2; ++pass) {
+                culler.setBackfaceCulling(pass == 1);
+                culler.begin(viewProj, eye);
+                std::vector<int> firstItems;
+                for (const SceneModel& model : scene) {
+                    firstItems.push_back(culler.getItemCount());
+                    for (const ClusteredMesh& mesh : model.meshes) culler.add(&mesh.clusters, model.world);
+                }
+                culler.cull(1);
+                if (pass == 0) {
+                    frustumOnly += culler.getStats().trianglesSubmitted;
+                    continue;
+                }
+                both += culler.getStats().trianglesSubmitted;
+                ranges += culler.getStats().ranges;
+                for (size_t i = 0; i < scene.size(); ++i) {
+                    ideal += visibleTriangles(scene[i], culler, firstItems[i], viewProj, eye, conservative);
+                }
+            }
+        }
+        size_t unclustered = totalTriangles;
+        std::cout << std::setw(6) << r + 1 << std::setw(14) << unclustered << std::setw(14) << frustumOnly / VIEW_DIRECTIONS
+                  << std::setw(18) << both / VIEW_DIRECTIONS << std::setw(8)
+                  << 100.0 * both / VIEW_DIRECTIONS / unclustered << "%" << std::setw(9) << ranges / VIEW_DIRECTIONS
+                  << std::setw(14) << ideal / VIEW_DIRECTIONS << std::endl;
+        sumUnclustered += unclustered * VIEW_DIRECTIONS;
+        sumFrustum += frustumOnly;
+        sumBoth += both;
+    }
+    std::cout << "  all rooms: frustum culling keeps " << 100.0 * sumFrustum / sumUnclustered << "%, with normal cones "
+              << 100.0 * sumBoth / sumUnclustered << "% of the unclustered triangles" << std::endl;
+    std::cout << (conservative ? "  ok" : "  FAILED (a visible triangle was culled)") << std::endl;
+    if (!conservative) failures++;
+
+    // 多執行緒：房間格子的家具實體共用 models[1] ~ [5] 的叢集
+    std::vector<FurnitureFootprint> footprints;
+    for (int i = 1; i <= 5; ++i) {
+        glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX);
+        for (const ClusteredMesh& mesh : scene[i].meshes) {
+            for (size_t v = 0; v < mesh.vertices.size(); v += 8) {
+                glm::vec3 p(mesh.vertices[v], mesh.vertices[v + 1], mesh.vertices[v + 2]);
+                bmin = glm::min(bmin, p);
+                bmax = glm::max(bmax, p);
+            }
+        }
+        footprints.push_back({ i, bmin, bmax, 0.7f });
+    }
+    RoomGrid grid = generateRoomGrid(gridConfig, footprints);
+    glm::vec3 eye(grid.roomCenters[grid.roomCenters.size() / 2].x, EYE_HEIGHT, grid.roomCenters[grid.roomCenters.size() / 2].z);
+    glm::mat4 viewProj = proj * glm::lookAt(eye, eye + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    int threads = hardwareThreadCount();
+    auto run = [&](CClusterCuller& c, int numThreads) {
+        c.begin(viewProj, eye);
+        for (const FurnitureInstance& furniture : grid.furniture) {
+            for (const ClusteredMesh& mesh : scene[furniture.model].meshes) c.add(&mesh.clusters, furniture.world);
+        }
+        c.cull(numThreads);
+    };
+    CThreadPool threadPool(threads);
+    CClusterCuller single, multi;
+    multi.setThreadPool(&threadPool);
+    run(single, 1);
+    run(multi, threads);
+    double singleMs = measureMs([&]() { for (int i = 0; i < repeat; ++i) run(single, 1); }) / repeat;
+    double multiMs = measureMs([&]() { for (int i = 0; i < repeat; ++i) run(multi, threads); }) / repeat;
+    bool same = single.getItemCount() == multi.getItemCount();
+    for (int item = 0; same && item < single.getItemCount(); ++item) {
+        int a = 0, b = 0;
+        const ClusterDrawRange* ra = single.getRanges(item, a);
+        const ClusterDrawRange* rb = multi.getRanges(item, b);
+        same = (a == b);
+        for (int k = 0; same && k < a; ++k) same = ra[k].indexStart == rb[k].indexStart && ra[k].indexCount == rb[k].indexCount;
+    }
+    const ClusterCullStats& stats = multi.getStats();
+    std::cout << std::endl << "Room grid: " << grid.roomCenters.size() << " rooms, " << grid.furniture.size()
+              << " furniture, " << stats.items << " meshes, " << stats.clusters << " clusters" << std::endl;
+    std::cout << "  submitted " << stats.trianglesSubmitted << " of " << stats.trianglesTotal << " triangles ("
+              << 100.0 * stats.trianglesSubmitted / std::max<size_t>(stats.trianglesTotal, 1) << "%) in " << stats.ranges
+              << " ranges" << std::endl;
+    std::cout << std::setprecision(3) << "  cull: " << singleMs << " ms on 1 thread, " << multiMs << " ms on " << threads
+              << " threads (avg of " << repeat << ")" << std::endl;
+    std::cout << (same ? "  ok" : "  FAILED (threaded result differs)") << std::endl;
+    if (!same) failures++;
+
+    std::cout << std::endl << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
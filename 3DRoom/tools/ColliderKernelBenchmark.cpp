@@ -0,0 +1,153 @@
+//  ColliderKernelBenchmark.cpp
+//  ColliderStore 的 SIMD 測試與一般逐一測試的吞吐量比較（每秒測試的 AABB 數）
+//    AoS scalar：目前 CollisionManager 的 AABB / Sphere（glm，結構中含 std::string）
+//    SoA scalar：與 ColliderStore 相同的陣列排列，一次一個
+//    SoA SIMD  ：ColliderStore::overlapSphere / overlapAABB，一次 4 個
+//  AABB 隨機分布，尺寸與牆壁相近；三種作法的命中數必須相同，否則回傳非 0
+//
+//      ColliderKernelBenchmark [--boxes N] [--queries N] [--seed S]
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CollisionManager.h"
+#include "../common/ColliderStore.h"
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void printRow(const char* label, double ms, double tests, long long hits) {
+    std::cout << std::setw(14) << label << std::setw(12) << std::fixed << std::setprecision(3) << ms
+              << std::setw(14) << std::setprecision(1) << (tests / (ms * 1000.0)) << std::setw(12) << hits << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int boxes = 25350;    // 與 CollisionBenchmark 的 1000 個房間相同的牆壁數
+    int queries = 2000;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--boxes" && hasValue) boxes = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--queries" && hasValue) queries = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: ColliderKernelBenchmark [--boxes N] [--queries N] [--seed S]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::mt19937 rng(seed);
+    const float worldSize = 200.0f;
+    std::uniform_real_distribution<float> upos(0.0f, worldSize), usize(0.2f, 8.0f);
+    std::vector<AABB> aos;
+    ColliderStore store;
+    aos.reserve(boxes);
+    store.reserve(boxes);
+    for (int i = 0; i < boxes; ++i) {
+        glm::vec3 bmin(upos(rng), upos(rng) * 0.1f, upos(rng));
+        glm::vec3 bmax = bmin + glm::vec3(usize(rng), usize(rng), usize(rng));
+        aos.push_back(AABB(bmin, bmax, "Room " + std::to_string(i / 25) + " Wall"));
+        store.add(bmin, bmax);
+    }
+
+    std::vector<glm::vec3> centers(queries), extents(queries);
+    std::uniform_real_distribution<float> uext(0.3f, 4.0f);
+    for (int i = 0; i < queries; ++i) {
+        centers[i] = glm::vec3(upos(rng), upos(rng) * 0.1f, upos(rng));
+        extents[i] = glm::vec3(uext(rng), uext(rng), uext(rng));
+    }
+    const float radius = 2.0f;
+    double tests = static_cast<double>(boxes) * queries;
+
+    std::cout << boxes << " boxes, " << queries << " queries ("
+#if defined(SIMD_MATH_SSE)
+              << "SSE2"
+#elif defined(SIMD_MATH_NEON)
+              << "NEON"
+#else
+              << "scalar fallback"
+#endif
+              << ")" << std::endl;
+    std::cout << std::setw(14) << "" << std::setw(12) << "ms" << std::setw(14) << "Mtests/s" << std::setw(12) << "hits"
+              << std::endl;
+
+    int failures = 0;
+    std::vector<uint8_t> masks;
+
+    // 球體
+    long long aosHits = 0, soaHits = 0, simdHits = 0;
+    double aosMs = measureMs([&] {
+        for (int q = 0; q < queries; ++q) {
+            Sphere sphere(centers[q], radius);
+            for (const auto& box : aos) aosHits += sphere.intersects(box);
+        }
+    });
+    double soaMs = measureMs([&] {
+        float r2 = radius * radius;
+        for (int q = 0; q < queries; ++q) {
+            const glm::vec3& c = centers[q];
+            for (size_t i = 0; i < store.size(); ++i) {
+                float dx = c.x - std::min(std::max(c.x, store.minX[i]), store.maxX[i]);
+                float dy = c.y - std::min(std::max(c.y, store.minY[i]), store.maxY[i]);
+                float dz = c.z - std::min(std::max(c.z, store.minZ[i]), store.maxZ[i]);
+                soaHits += (dx * dx + dy * dy + dz * dz < r2);
+            }
+        }
+    });
+    double simdMs = measureMs([&] {
+        for (int q = 0; q < queries; ++q) simdHits += store.overlapSphere(centers[q], radius, masks);
+    });
+    std::cout << "sphere vs AABB" << std::endl;
+    printRow("AoS scalar", aosMs, tests, aosHits);
+    printRow("SoA scalar", soaMs, tests, soaHits);
+    printRow("SoA SIMD", simdMs, tests, simdHits);
+    std::cout << std::setw(14) << "speedup" << std::setw(11) << std::setprecision(1) << (aosMs / simdMs) << "x"
+              << std::endl;
+    if (aosHits != soaHits || aosHits != simdHits) failures++;
+
+    // AABB
+    aosHits = soaHits = simdHits = 0;
+    aosMs = measureMs([&] {
+        for (int q = 0; q < queries; ++q) {
+            AABB query(centers[q] - extents[q], centers[q] + extents[q]);
+            for (const auto& box : aos) aosHits += query.intersects(box);
+        }
+    });
+    soaMs = measureMs([&] {
+        for (int q = 0; q < queries; ++q) {
+            glm::vec3 qmin = centers[q] - extents[q], qmax = centers[q] + extents[q];
+            for (size_t i = 0; i < store.size(); ++i) {
+                soaHits += (store.minX[i] <= qmax.x && qmin.x <= store.maxX[i]) &&
+                           (store.minY[i] <= qmax.y && qmin.y <= store.maxY[i]) &&
+                           (store.minZ[i] <= qmax.z && qmin.z <= store.maxZ[i]);
+            }
+        }
+    });
+    simdMs = measureMs([&] {
+        for (int q = 0; q < queries; ++q) {
+            simdHits += store.overlapAABB(centers[q] - extents[q], centers[q] + extents[q], masks);
+        }
+    });
+    std::cout << "AABB vs AABB" << std::endl;
+    printRow("AoS scalar", aosMs, tests, aosHits);
+    printRow("SoA scalar", soaMs, tests, soaHits);
+    printRow("SoA SIMD", simdMs, tests, simdHits);
+    std::cout << std::setw(14) << "speedup" << std::setw(11) << std::setprecision(1) << (aosMs / simdMs) << "x"
+              << std::endl;
+    if (aosHits != soaHits || aosHits != simdHits) failures++;
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL: hit counts differ") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,371 @@
+//  CollisionBenchmark.cpp
+//  比較 CollisionManager 使用 BVH 查詢與原本逐一掃描所有牆壁的效能，
+//  以及逐條 raycastHit 與 SIMD 批次 raycastBatch 的效能
+//  場景：目前的六個房間，以及 RoomGrid 產生的 cols x rows 個房間（預設 40 x 25 = 1000 個，相鄰房間之間都有門）
+//  另外對每個門口做高速移動的穿牆檢查（getSafeMovement 的連續碰撞），
+//  以及不同大小的房間格子合併共平面牆段前後的碰撞器數量與查詢時間（結果必須相同），失敗時回傳非 0
+//
+//      CollisionBenchmark [--queries N] [--seed S] [--rooms CxR] [--door-chance P] [--no-merge] [--furniture N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CollisionManager.h"
+#include "../common/RoomGrid.h"
+
+// 原本 checkCameraCollision 的逐一掃描（不輸出訊息），作為比較基準與正確性檢查
+static bool linearSphereCheck(const std::vector<AABB>& walls, const std::vector<AABB>& obstacles,
+                              const glm::vec3& p, float radius) {
+    Sphere sphere(p, radius);
+    for (const auto& wall : walls) {
+        if (sphere.intersects(wall)) return true;
+    }
+    for (const auto& obstacle : obstacles) {
+        if (sphere.intersects(obstacle)) return true;
+    }
+    return false;
+}
+
+// 原本 raycast 的 20 步逐點檢查
+static bool linearRaycast(const std::vector<AABB>& walls, const std::vector<AABB>& obstacles,
+                          const glm::vec3& origin, const glm::vec3& dir, float maxDistance, float radius) {
+    const int steps = 20;
+    float stepSize = maxDistance / steps;
+    for (int i = 1; i <= steps; ++i) {
+        if (linearSphereCheck(walls, obstacles, origin + dir * (stepSize * i), radius)) return true;
+    }
+    return false;
+}
+
+// 原本 getSafeMovement 的作法：只檢查終點，碰撞時改為逐軸移動
+static glm::vec3 linearSafeMovement(const std::vector<AABB>& walls, const std::vector<AABB>& obstacles,
+                                    const glm::vec3& move, const glm::vec3& p, float radius) {
+    if (!linearSphereCheck(walls, obstacles, p + move, radius)) return move;
+    glm::vec3 result(0.0f);
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::vec3 axisMove(0.0f);
+        axisMove[axis] = move[axis];
+        if (!linearSphereCheck(walls, obstacles, p + axisMove, radius)) result += axisMove;
+    }
+    return result;
+}
+
+struct Timing {
+    double linearMs = 0.0;
+    double bvhMs = 0.0;
+    int mismatches = 0;
+};
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void runLayout(const std::string& name, CollisionManager& manager, int queries, unsigned seed) {
+    const std::vector<AABB>& walls = manager.getWalls();
+    const std::vector<AABB>& obstacles = manager.getObstacles();
+    float radius = manager.getCameraRadius();
+
+    glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX);
+    for (const auto& wall : walls) {
+        bmin = glm::min(bmin, wall.min);
+        bmax = glm::max(bmax, wall.max);
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> ux(bmin.x, bmax.x), uy(bmin.y, bmax.y), uz(bmin.z, bmax.z);
+    std::uniform_real_distribution<float> ud(-1.0f, 1.0f);
+    std::vector<glm::vec3> points(queries), dirs(queries);
+    for (int i = 0; i < queries; ++i) {
+        points[i] = glm::vec3(ux(rng), uy(rng), uz(rng));
+        glm::vec3 d(ud(rng), ud(rng) * 0.2f, ud(rng));
+        dirs[i] = glm::length(d) > 1e-4f ? glm::normalize(d) : glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+
+    // 1. 球體重疊（checkCameraCollision）
+    Timing sphere;
+    std::vector<char> linearResult(queries), bvhResult(queries);
+    sphere.linearMs = measureMs([&] {
+        for (int i = 0; i < queries; ++i) linearResult[i] = linearSphereCheck(walls, obstacles, points[i], radius);
+    });
+    sphere.bvhMs = measureMs([&] {
+        for (int i = 0; i < queries; ++i) bvhResult[i] = manager.checkCameraCollision(points[i]);
+    });
+    for (int i = 0; i < queries; ++i) sphere.mismatches += (linearResult[i] != bvhResult[i]);
+
+    // 2. getSafeMovement：原本只檢查終點的逐軸移動與連續碰撞的 moveAndSlide，
+    //    分別以一般的 0.5 與高速的 30 單位移動，比較結束時陷入牆內的次數（起點未碰撞者）
+    Timing movement, fastMovement;
+    int linearPenetrations[2] = { 0, 0 }, sweptPenetrations[2] = { 0, 0 };
+    const float moveLengths[2] = { 0.5f, 30.0f };
+    for (int speed = 0; speed < 2; ++speed) {
+        Timing& timing = (speed == 0) ? movement : fastMovement;
+        std::vector<glm::vec3> linearEnd(queries), sweptEnd(queries);
+        timing.linearMs = measureMs([&] {
+            for (int i = 0; i < queries; ++i) {
+                linearEnd[i] = points[i] + linearSafeMovement(walls, obstacles, dirs[i] * moveLengths[speed], points[i], radius);
+            }
+        });
+        timing.bvhMs = measureMs([&] {
+            for (int i = 0; i < queries; ++i) sweptEnd[i] = points[i] + manager.getSafeMovement(dirs[i] * moveLengths[speed], points[i]);
+        });
+        for (int i = 0; i < queries; ++i) {
+            if (linearResult[i]) continue;
+            linearPenetrations[speed] += linearSphereCheck(walls, obstacles, linearEnd[i], radius);
+            sweptPenetrations[speed] += linearSphereCheck(walls, obstacles, sweptEnd[i], radius);
+        }
+    }
+
+    // 3. raycast：原本 20 步逐點檢查，BVH 版本為連續的最近交點（結果不完全相同，只比較時間）
+    Timing ray;
+    int linearHits = 0, bvhHits = 0;
+    ray.linearMs = measureMs([&] {
+        for (int i = 0; i < queries; ++i) linearHits += linearRaycast(walls, obstacles, points[i], dirs[i], 10.0f, radius);
+    });
+    ray.bvhMs = measureMs([&] {
+        glm::vec3 hit;
+        for (int i = 0; i < queries; ++i) bvhHits += manager.raycast(points[i], dirs[i], 10.0f, hit);
+    });
+
+    // 4. 批次 raycast（SoA + SIMD）與逐條 raycastHit 比較，結果應完全相同
+    Timing batch;
+    RayBatch rays;
+    for (int i = 0; i < queries; ++i) rays.add(points[i], dirs[i], 10.0f);
+    std::vector<RaycastHit> single(queries);
+    std::vector<char> singleHit(queries);
+    batch.linearMs = measureMs([&] {
+        for (int i = 0; i < queries; ++i) singleHit[i] = manager.raycastHit(points[i], dirs[i], 10.0f, radius, single[i]);
+    });
+    RayBatchHits batchHits;
+    batch.bvhMs = measureMs([&] { manager.raycastBatch(rays, radius, batchHits); });
+    for (int i = 0; i < queries; ++i) {
+        bool batchHit = batchHits.type[i] != ColliderType::NONE;
+        if (batchHit != (singleHit[i] != 0)) {
+            batch.mismatches++;
+        } else if (batchHit && (std::fabs(batchHits.distance[i] - single[i].distance) > 1e-4f ||
+                                batchHits.nx[i] != single[i].normal.x || batchHits.ny[i] != single[i].normal.y ||
+                                batchHits.nz[i] != single[i].normal.z)) {
+            batch.mismatches++;
+        }
+    }
+
+    std::cout << name << ": " << walls.size() << " walls, " << obstacles.size() << " obstacles, "
+              << queries << " queries" << std::endl;
+    std::cout << std::setw(18) << "query" << std::setw(14) << "linear ms" << std::setw(12) << "bvh ms"
+              << std::setw(10) << "speedup" << std::setw(18) << "check" << std::endl;
+    auto row = [](const char* label, const Timing& t, const std::string& check) {
+        std::cout << std::setw(18) << label << std::setw(14) << std::fixed << std::setprecision(3) << t.linearMs
+                  << std::setw(12) << t.bvhMs << std::setw(9) << std::setprecision(1) << (t.linearMs / t.bvhMs) << "x"
+                  << std::setw(18) << check << std::endl;
+    };
+    row("sphere overlap", sphere, std::to_string(sphere.mismatches));
+    auto penetrations = [&](int speed) {
+        return std::to_string(linearPenetrations[speed]) + "/" + std::to_string(sweptPenetrations[speed]) + " inside";
+    };
+    row("move 0.5", movement, penetrations(0));
+    row("move 30", fastMovement, penetrations(1));
+    std::cout << std::setw(18) << "swept moves/s" << std::setw(14) << std::setprecision(0)
+              << (queries / (movement.bvhMs / 1000.0)) << std::setw(12) << (queries / (fastMovement.bvhMs / 1000.0))
+              << std::endl;
+    row("raycast", ray, std::to_string(linearHits) + "/" + std::to_string(bvhHits) + " hits");
+    std::cout << std::setw(18) << "" << std::setw(14) << "raycastHit" << std::setw(12) << "batch" << std::endl;
+    row("batch raycast", batch, std::to_string(batch.mismatches));
+    std::cout << std::endl;
+}
+
+// 每個門口（以門楣的牆段找出）做四種單一 frame 的移動，起點在門前 5 單位：
+//   穿過門口中央（應通過）、以 200 單位高速撞門柱、撞門楣、撞門旁的牆（都應停在起點那一側）
+// 回傳失敗的數量；oldTunnels 為原本的 getSafeMovement 穿牆的次數
+static int runTunnelingTests(CollisionManager& manager, int& doorways, int& oldTunnels) {
+    const std::vector<AABB>& walls = manager.getWalls();
+    const std::vector<AABB>& obstacles = manager.getObstacles();
+    float radius = manager.getCameraRadius();
+    int failures = 0;
+    doorways = 0;
+    oldTunnels = 0;
+
+    for (const auto& lintel : walls) {
+        if (lintel.type.find("(Door Lintel)") == std::string::npos) continue;
+        glm::vec3 size = lintel.max - lintel.min;
+        int normalAxis = (size.x < size.z) ? 0 : 2;     // 牆的厚度方向
+        int sideAxis = 2 - normalAxis;
+        glm::vec3 center = (lintel.min + lintel.max) * 0.5f;
+        float doorWidth = size[sideAxis];
+        float postWidth = 2.0f;
+
+        for (int direction = -1; direction <= 1; direction += 2) {
+            doorways += (direction == 1);
+            glm::vec3 normal(0.0f);
+            normal[normalAxis] = static_cast<float>(direction);
+            // 起點那一側牆面的位置，球體必須停在這之前
+            float wallFace = (direction == 1) ? lintel.min[normalAxis] : lintel.max[normalAxis];
+
+            struct Case { const char* name; float side; float y; float distance; bool passes; };
+            const Case cases[] = {
+                { "doorway", 0.0f, 5.0f, 10.0f, true },
+                { "post", doorWidth / 2.0f + postWidth / 2.0f, 5.0f, 200.0f, false },
+                { "lintel", 0.0f, lintel.min.y + 1.0f, 200.0f, false },
+                { "wall", doorWidth / 2.0f + postWidth + 2.0f, 5.0f, 200.0f, false },
+            };
+            for (const Case& c : cases) {
+                glm::vec3 start = center;
+                start[sideAxis] += c.side;
+                start.y = c.y;
+                start -= normal * 5.0f;
+                glm::vec3 move = normal * c.distance;
+                if (linearSphereCheck(walls, obstacles, start, radius)) continue;   // 起點在其他牆內
+
+                glm::vec3 end = start + manager.getSafeMovement(move, start);
+                float endSide = (end[normalAxis] - wallFace) * direction;
+                bool ok = c.passes ? (endSide > 0.0f) : (endSide <= -radius + 1e-3f);
+                if (!ok) {
+                    failures++;
+                    std::cout << "FAIL " << lintel.type << " " << c.name << (direction > 0 ? " +" : " -")
+                              << " end " << end.x << ", " << end.y << ", " << end.z << std::endl;
+                }
+                if (!c.passes) {
+                    glm::vec3 oldEnd = start + linearSafeMovement(walls, obstacles, move, start, radius);
+                    oldTunnels += ((oldEnd[normalAxis] - wallFace) * direction > 0.0f);
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+// 斜向撞牆時應沿牆面滑動，保留平行牆面的分量
+static int runSlidingTest(CollisionManager& manager) {
+    glm::vec3 start(0.0f, 5.0f, 20.0f);            // Room 5 內，後牆在 z = 24
+    glm::vec3 move(3.0f, 0.0f, 8.0f);
+    glm::vec3 result = manager.getSafeMovement(move, start);
+    float wallDistance = 24.0f - (start.z + result.z);
+    bool ok = std::fabs(result.x - move.x) < 1e-3f && wallDistance >= manager.getCameraRadius() &&
+              wallDistance < manager.getCameraRadius() + 0.01f;
+    if (!ok) {
+        std::cout << "FAIL sliding: move " << result.x << ", " << result.y << ", " << result.z << std::endl;
+    }
+    return ok ? 0 : 1;
+}
+
+// 不同大小的房間格子：產生時間、合併前後的牆數、BVH 建立時間與球體查詢時間，合併前後的查詢結果必須相同
+static int runScaling(int queries, unsigned seed) {
+    const int sizes[][2] = { { 3, 2 }, { 10, 10 }, { 40, 25 }, { 100, 100 } };
+    std::cout << "Room grid scaling (" << queries << " sphere queries)" << std::endl;
+    std::cout << std::setw(10) << "rooms" << std::setw(12) << "gen ms" << std::setw(10) << "walls" << std::setw(10)
+              << "merged" << std::setw(12) << "build ms" << std::setw(12) << "merged ms" << std::setw(12) << "grid ms"
+              << std::setw(12) << "query us"
+              << std::setw(12) << "merged us" << std::setw(12) << "mismatches" << std::endl;
+    int failures = 0;
+    for (const auto& size : sizes) {
+        RoomGridConfig config;
+        config.cols = size[0];
+        config.rows = size[1];
+        config.mergeWalls = false;
+        RoomGrid grid;
+        double genMs = measureMs([&] { grid = generateRoomGrid(config); });
+        std::vector<AABB> merged = grid.walls;
+        mergeCoplanarWalls(merged, config.maxMergedLength);
+
+        CollisionManager unmergedManager, mergedManager;
+        unmergedManager.setCollisionLogging(false);
+        mergedManager.setCollisionLogging(false);
+        double buildMs = measureMs([&] { unmergedManager.setWalls(grid.walls); });
+        double mergedBuildMs = measureMs([&] { mergedManager.setWalls(merged); });
+        // 投射物使用的距離格點不在 setWalls 建立，第一次 prepareClearance 時才建立，分開計時
+        double gridMs = measureMs([&] { mergedManager.prepareClearance(); });
+
+        glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX);
+        for (const auto& wall : grid.walls) {
+            bmin = glm::min(bmin, wall.min);
+            bmax = glm::max(bmax, wall.max);
+        }
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+        std::vector<glm::vec3> points(queries);
+        for (auto& p : points) p = bmin + (bmax - bmin) * glm::vec3(u01(rng), u01(rng), u01(rng));
+        std::vector<char> unmergedHit(queries), mergedHit(queries);
+        double queryMs = measureMs([&] {
+            for (int i = 0; i < queries; ++i) unmergedHit[i] = unmergedManager.checkCameraCollision(points[i]);
+        });
+        double mergedQueryMs = measureMs([&] {
+            for (int i = 0; i < queries; ++i) mergedHit[i] = mergedManager.checkCameraCollision(points[i]);
+        });
+        int mismatches = 0;
+        for (int i = 0; i < queries; ++i) mismatches += (unmergedHit[i] != mergedHit[i]);
+        failures += mismatches;
+
+        std::cout << std::setw(10) << (std::to_string(size[0]) + "x" + std::to_string(size[1])) << std::setw(12)
+                  << std::setprecision(2) << genMs << std::setw(10) << grid.walls.size() << std::setw(10)
+                  << merged.size() << std::setw(12) << buildMs << std::setw(12) << mergedBuildMs << std::setw(12)
+                  << gridMs << std::setw(12) << std::setprecision(3) << (queryMs * 1000.0 / queries) << std::setw(12)
+                  << (mergedQueryMs * 1000.0 / queries) << std::setw(12) << mismatches << std::endl;
+    }
+    std::cout << std::endl;
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    int queries = 5000;   // 1000 個房間時逐一掃描的 raycast 每次約 10 ms
+    unsigned seed = 1;
+    RoomGridConfig gridConfig;
+    gridConfig.cols = 40;
+    gridConfig.rows = 25;
+    gridConfig.origin = glm::vec3(0.0f);
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--queries" && hasValue) queries = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--rooms" && hasValue && std::sscanf(argv[i + 1], "%dx%d", &gridConfig.cols, &gridConfig.rows) == 2) i++;
+        else if (arg == "--door-chance" && hasValue) gridConfig.doorChance = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--no-merge") gridConfig.mergeWalls = false;
+        else if (arg == "--furniture" && hasValue) gridConfig.furniturePerRoom = std::max(0, std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: CollisionBenchmark [--queries N] [--seed S] [--rooms CxR] [--door-chance P] [--no-merge] "
+                         "[--furniture N]" << std::endl;
+            return 1;
+        }
+    }
+
+    CollisionManager manager;
+    manager.setCollisionLogging(false);
+    // 與 wmhandler 相同的兩個障礙物
+    manager.addObstacle(AABB(glm::vec3(-1.0f, -2.0f, -1.0f), glm::vec3(1.0f, 0.0f, 1.0f)));
+    manager.addObstacle(AABB(glm::vec3(2.0f, -2.0f, -2.0f), glm::vec3(3.0f, 0.0f, -1.0f)));
+    runLayout("6 rooms", manager, queries, seed);
+
+    int doorways = 0, oldTunnels = 0;
+    int failures = runTunnelingTests(manager, doorways, oldTunnels) + runSlidingTest(manager);
+    std::cout << "tunneling: " << doorways << " doorways x 2 directions, old getSafeMovement tunneled "
+              << oldTunnels << " times" << std::endl;
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << " (" << failures << " failures)" << std::endl << std::endl;
+
+    // 家具以桌子、沙發、床大小的方塊代替（不需要載入模型），每個實體的世界座標 AABB 加入障礙物
+    std::vector<FurnitureFootprint> footprints = {
+        { 1, glm::vec3(-3.0f, 0.0f, -2.0f), glm::vec3(3.0f, 2.5f, 2.0f), 0.7f },
+        { 2, glm::vec3(-8.0f, 0.0f, -3.5f), glm::vec3(8.0f, 7.0f, 3.5f), 0.7f },
+        { 3, glm::vec3(-6.0f, 0.0f, -8.0f), glm::vec3(6.0f, 5.0f, 8.0f), 0.7f },
+    };
+    RoomGrid grid = generateRoomGrid(gridConfig, footprints);
+    manager.setWalls(grid.walls);
+    manager.clearObstacles();
+    for (const auto& furniture : grid.furniture) manager.addObstacle(AABB(furniture.worldMin, furniture.worldMax, "Furniture"));
+    std::cout << grid.roomCenters.size() << " rooms, " << grid.doors.size() << " doors, " << grid.unmergedWallCount
+              << " wall segments -> " << grid.walls.size() << " colliders, " << grid.furniture.size() << " furniture"
+              << std::endl;
+    runLayout(std::to_string(grid.roomCenters.size()) + " rooms", manager, queries, seed);
+
+    failures += runScaling(queries, seed);
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << " (" << failures << " failures)" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+//  DecalBenchmark.cpp
+//  CDecalBuffer：在房間的牆面上一次加入 --count 個貼花（預設 10000，與 Homework 的 'u' 鍵相同），再加入同樣數量使環狀緩衝區繞回
+//  輸出每個貼花的 add 時間，以及每個 frame 只加入幾個彈孔時需要上傳的資料量（相對於每次上傳整個緩衝區）
+//  檢查：加入時不配置記憶體、滿了之後覆蓋最舊的格子、改變的範圍（上傳的兩段）正確、
+//  toDecal 為 toWorld 的反矩陣且貼花的位置在方塊中心，以及加入 --count 個貼花的時間在 60 Hz 的 frame 內，失敗時回傳非 0
+//
+//      DecalBenchmark [--count N] [--capacity C] [--seed S]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CDecalBuffer.h"
+
+// 計算配置次數，確認加入貼花時不配置記憶體
+static std::atomic<long> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 20 x 6 x 20 的房間的六個面上的隨機位置，法向量朝向房間內
+static void makeDescs(std::vector<DecalDesc>& descs, int count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    const glm::vec3 half(10.0f, 3.0f, 10.0f);
+    descs.resize(count);
+    for (DecalDesc& desc : descs) {
+        int axis = static_cast<int>(rng() % 3);
+        float side = (rng() & 1) ? 1.0f : -1.0f;
+        desc.position = (glm::vec3(u01(rng), u01(rng), u01(rng)) * 2.0f - 1.0f) * half;
+        desc.position[axis] = half[axis] * side;
+        desc.normal = glm::vec3(0.0f);
+        desc.normal[axis] = -side;
+        desc.type = static_cast<DecalType>(rng() % 4);
+        desc.size = 0.1f + 0.5f * u01(rng);
+        desc.rotation = u01(rng) * 6.2831853f;
+    }
+}
+
+static float transformRow(const glm::vec4& row, const glm::vec3& p) {
+    return row.x * p.x + row.y * p.y + row.z * p.z + row.w;
+}
+
+// 每個使用中的貼花：方塊的角轉到世界再轉回來不變、貼花的位置在方塊中心、方塊的 z 軸為法向量
+// bySlot 為每個格子目前的貼花
+static int checkMatrices(const CDecalBuffer& decals, const std::vector<DecalDesc>& bySlot) {
+    float worstRoundTrip = 0.0f, worstCenter = 0.0f, worstAxis = 0.0f;
+    for (int slot = 0; slot < decals.getLiveCount(); ++slot) {
+        const DecalInstance& instance = decals.getInstances()[slot];
+        const DecalDesc& desc = bySlot[slot];
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 local((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f);
+            glm::vec3 world, back;
+            for (int r = 0; r < 3; ++r) world[r] = transformRow(instance.toWorld[r], local);
+            for (int r = 0; r < 3; ++r) back[r] = transformRow(instance.toDecal[r], world);
+            worstRoundTrip = std::max(worstRoundTrip, glm::length(back - local));
+        }
+        glm::vec3 center;
+        for (int r = 0; r < 3; ++r) center[r] = transformRow(instance.toDecal[r], desc.position);
+        worstCenter = std::max(worstCenter, glm::length(center));
+        glm::vec3 axis(instance.toWorld[0].z, instance.toWorld[1].z, instance.toWorld[2].z);
+        worstAxis = std::max(worstAxis, 1.0f - glm::dot(glm::normalize(axis), desc.normal));
+    }
+    bool ok = worstRoundTrip < 1e-4f && worstCenter < 1e-4f && worstAxis < 1e-5f;
+    std::cout << "  matrices: round trip error " << worstRoundTrip << ", center error " << worstCenter
+              << ", axis error " << worstAxis << (ok ? "  ok" : "  FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+static bool sameRanges(const CDecalBuffer& decals, int expectedCount, const DecalRange* expected) {
+    DecalRange ranges[2];
+    int count = decals.getDirtyRanges(ranges);
+    if (count != expectedCount) return false;
+    for (int i = 0; i < count; ++i) {
+        if (ranges[i].first != expected[i].first || ranges[i].count != expected[i].count) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int count = 10000;
+    int capacity = DECAL_DEFAULT_CAPACITY;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--count" && hasValue) count = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--capacity" && hasValue) capacity = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: DecalBenchmark [--count N] [--capacity C] [--seed S]" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "DecalBenchmark: " << count << " decals per batch, capacity " << capacity << ", "
+              << sizeof(DecalInstance) << " bytes per instance" << std::endl;
+
+    std::mt19937 rng(seed);
+    std::vector<DecalDesc> descs;
+    makeDescs(descs, count * 2, rng);
+    CDecalBuffer decals(capacity);
+    int failures = 0;
+
+    // 第一批：依序使用前 count 個格子
+    std::vector<int> slots(count * 2);
+    long allocationsBefore = g_allocations.load();
+    double firstMs = measureMs([&] {
+        for (int i = 0; i < count; ++i) slots[i] = decals.add(descs[i]);
+    });
+    int firstLive = decals.getLiveCount();
+    DecalRange firstExpected[1] = { { 0, std::min(count, capacity) } };
+    bool firstOk = sameRanges(decals, 1, firstExpected);
+    decals.clearDirty();
+
+    // 第二批：繞回開頭，覆蓋最舊的貼花
+    double secondMs = measureMs([&] {
+        for (int i = count; i < count * 2; ++i) slots[i] = decals.add(descs[i]);
+    });
+    long allocations = g_allocations.load() - allocationsBefore;
+
+    bool slotsOk = true;
+    for (int i = 0; i < count * 2; ++i) slotsOk = slotsOk && (slots[i] == i % capacity);
+    int expectedLive = std::min(count * 2, capacity);
+    long long expectedRecycled = count * 2 - expectedLive;
+    bool ringOk = slotsOk && firstLive == std::min(count, capacity) && decals.getLiveCount() == expectedLive &&
+                  decals.getRecycledCount() == expectedRecycled && decals.getAddedCount() == count * 2;
+    std::cout << std::setw(10) << "batch" << std::setw(10) << "live" << std::setw(12) << "recycled"
+              << std::setw(10) << "ms" << std::setw(12) << "ns/decal" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(10) << 1 << std::setw(10) << firstLive << std::setw(12) << 0 << std::setw(10) << firstMs
+              << std::setw(12) << firstMs * 1e6 / count << std::endl;
+    std::cout << std::setw(10) << 2 << std::setw(10) << decals.getLiveCount() << std::setw(12)
+              << decals.getRecycledCount() << std::setw(10) << secondMs << std::setw(12) << secondMs * 1e6 / count
+              << std::endl;
+    std::cout << "  ring buffer: slots " << (slotsOk ? "in order" : "out of order") << ", " << allocations
+              << " allocations while adding" << (ringOk && allocations == 0 ? "  ok" : "  FAILED") << std::endl;
+    if (!ringOk || allocations != 0) failures++;
+
+    // 第二批改變的範圍：從第一批的結尾到緩衝區的結尾，以及繞回之後的開頭
+    if (count <= capacity && count * 2 > capacity) {
+        DecalRange expected[2] = { { count, capacity - count }, { 0, count * 2 - capacity } };
+        bool rangesOk = firstOk && sameRanges(decals, 2, expected);
+        std::cout << "  dirty ranges: [" << expected[0].first << ", " << capacity << ") + [0, " << expected[1].count
+                  << ")" << (rangesOk ? "  ok" : "  FAILED") << std::endl;
+        if (!rangesOk) failures++;
+    }
+    decals.clearDirty();
+
+    // 第 i 個貼花在第 i % capacity 格，較晚加入的覆蓋較早的
+    std::vector<DecalDesc> bySlot(decals.getLiveCount());
+    for (int i = 0; i < count * 2; ++i) bySlot[i % capacity] = descs[i];
+    failures += checkMatrices(decals, bySlot);
+
+    // 每個 frame 加入 4 個彈孔：只上傳改變的格子
+    const int perFrame = 4;
+    long long uploaded = 0;
+    const int frames = 600;
+    for (int f = 0; f < frames; ++f) {
+        for (int k = 0; k < perFrame; ++k) decals.add(descs[(f * perFrame + k) % descs.size()]);
+        DecalRange ranges[2];
+        int n = decals.getDirtyRanges(ranges);
+        for (int i = 0; i < n; ++i) uploaded += ranges[i].count * static_cast<long long>(sizeof(DecalInstance));
+        decals.clearDirty();
+    }
+    long long fullUpload = static_cast<long long>(decals.getLiveCount()) * sizeof(DecalInstance);
+    bool uploadOk = uploaded == static_cast<long long>(frames) * perFrame * sizeof(DecalInstance);
+    std::cout << "  " << perFrame << " decals per frame: " << uploaded / frames << " bytes uploaded per frame (full buffer "
+              << fullUpload << " bytes)" << (uploadOk ? "  ok" : "  FAILED") << std::endl;
+    if (!uploadOk) failures++;
+
+    const double frameBudgetMs = 1000.0 / 60.0;
+    if (std::max(firstMs, secondMs) > frameBudgetMs) {
+        std::cout << "  adding " << count << " decals exceeds the 60 Hz frame budget (" << frameBudgetMs << " ms)  FAILED"
+                  << std::endl;
+        failures++;
+    }
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,345 @@
+//  FractureBenchmark.cpp
+//  CMeshFracture 與 CDebrisPool：每個模型以 Voronoi 分割的時間、碎片與三角形數量，
+//  原本封閉的網格分割後每個碎片也必須封閉（每條邊都有反方向的邊），碎片體積的總和與原本相同（1% 以內）
+//  接著在一個房間（RoomGrid 的 1 x 1）內同時打壞 --breaks 個物件：打壞時（breakObject、第一次 buildInstances）
+//  與之後的每個 frame 都不可以配置記憶體，並輸出每個 frame 剛體與碎片矩陣的時間；失敗時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      FractureBenchmark [--pieces N] [--seed S] [--breaks N] [obj ...]
+//      （預設 models/woodCube.obj models/livingRoomTable.obj models/sofa.obj）
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../common/CDebrisPool.h"
+#include "../common/CMeshFracture.h"
+#include "../common/CParallel.h"
+#include "../common/CRigidBodyPool.h"
+#include "../common/CollisionManager.h"
+#include "../common/RoomGrid.h"
+#include "../tiny_obj_loader.h"
+
+// 計算配置次數，確認打壞物件與之後的 frame 不配置記憶體
+// 所有的 operator new / delete（含陣列、nothrow 與對齊的版本）都經由 countedAlloc 與 countedFree，
+// 兩者不 inline，編譯器不會把 free 與 operator new 配對而警告
+static std::atomic<long> g_allocations(0);
+
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+static BENCH_NOINLINE void* countedAlloc(size_t size, size_t alignment) {
+    g_allocations++;
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, alignment);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+#endif
+}
+
+static BENCH_NOINLINE void countedFree(void* p, size_t alignment) noexcept {
+#if defined(_MSC_VER)
+    if (alignment > alignof(std::max_align_t)) { _aligned_free(p); return; }
+#endif
+    (void)alignment;
+    std::free(p);
+}
+
+static void* countedNew(size_t size, size_t alignment) {
+    if (void* p = countedAlloc(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return countedNew(size, 0); }
+void* operator new[](size_t size) { return countedNew(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+void* operator new(size_t size, std::align_val_t al) { return countedNew(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return countedNew(size, static_cast<size_t>(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<size_t>(al));
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return countedAlloc(size, static_cast<size_t>(al));
+}
+void operator delete(void* p) noexcept { countedFree(p, 0); }
+void operator delete[](void* p) noexcept { countedFree(p, 0); }
+void operator delete(void* p, size_t) noexcept { countedFree(p, 0); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p, 0); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p, 0); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p, 0); }
+void operator delete(void* p, std::align_val_t al) noexcept { countedFree(p, static_cast<size_t>(al)); }
+void operator delete[](void* p, std::align_val_t al) noexcept { countedFree(p, static_cast<size_t>(al)); }
+void operator delete(void* p, size_t, std::align_val_t al) noexcept { countedFree(p, static_cast<size_t>(al)); }
+void operator delete[](void* p, size_t, std::align_val_t al) noexcept { countedFree(p, static_cast<size_t>(al)); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept {
+    countedFree(p, static_cast<size_t>(al));
+}
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept {
+    countedFree(p, static_cast<size_t>(al));
+}
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 每個 shape 一個網格，頂點與 Model 的 Vertex 相同的 8 個 float（不合併重複的頂點）
+struct LoadedMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static bool loadMeshes(const std::string& path, std::vector<LoadedMesh>& meshes) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        LoadedMesh mesh;
+        for (const auto& index : shape.mesh.indices) {
+            for (int k = 0; k < 3; ++k) mesh.vertices.push_back(attrib.vertices[3 * index.vertex_index + k]);
+            for (int k = 0; k < 3; ++k) {
+                mesh.vertices.push_back(index.normal_index >= 0 ? attrib.normals[3 * index.normal_index + k] : 0.0f);
+            }
+            for (int k = 0; k < 2; ++k) {
+                mesh.vertices.push_back(index.texcoord_index >= 0 ? attrib.texcoords[2 * index.texcoord_index + k] : 0.0f);
+            }
+            mesh.indices.push_back(static_cast<unsigned int>(mesh.indices.size()));
+        }
+        if (!mesh.indices.empty()) meshes.push_back(std::move(mesh));
+    }
+    return !meshes.empty();
+}
+
+// 沒有反方向邊的有向邊數量（以位置比較）；0 表示封閉的網格（切面的共線點會留下面積為 0 的三角形）
+static size_t countOpenEdges(const std::vector<const float*>& vertexArrays, const std::vector<const unsigned int*>& indexArrays,
+                             const std::vector<size_t>& indexCounts, const std::vector<size_t>& indexStarts) {
+    std::map<std::array<float, 6>, int> edges;
+    for (size_t m = 0; m < vertexArrays.size(); ++m) {
+        for (size_t i = indexStarts[m]; i + 2 < indexStarts[m] + indexCounts[m]; i += 3) {
+            for (int e = 0; e < 3; ++e) {
+                const float* a = vertexArrays[m] + 8 * indexArrays[m][i + e];
+                const float* b = vertexArrays[m] + 8 * indexArrays[m][i + (e + 1) % 3];
+                std::array<float, 6> forward = { a[0], a[1], a[2], b[0], b[1], b[2] };
+                std::array<float, 6> backward = { b[0], b[1], b[2], a[0], a[1], a[2] };
+                if (forward == backward) continue;   // 退化三角形長度為 0 的邊
+                auto it = edges.find(backward);
+                if (it != edges.end() && --it->second == 0) edges.erase(it);
+                else if (it == edges.end()) edges[forward]++;
+            }
+        }
+    }
+    size_t open = 0;
+    for (const auto& edge : edges) open += edge.second;
+    return open;
+}
+
+static double signedVolume(const float* vertices, const unsigned int* indices, size_t start, size_t count) {
+    double volume = 0.0;
+    for (size_t i = start; i + 2 < start + count; i += 3) {
+        glm::vec3 a = glm::make_vec3(vertices + 8 * indices[i]);
+        glm::vec3 b = glm::make_vec3(vertices + 8 * indices[i + 1]);
+        glm::vec3 c = glm::make_vec3(vertices + 8 * indices[i + 2]);
+        volume += glm::dot(a, glm::cross(b, c)) / 6.0;
+    }
+    return volume;
+}
+
+struct FracturedModel {
+    std::string path;
+    std::vector<FractureChunk> chunks;
+    glm::vec3 boundsMin = glm::vec3(FLT_MAX), boundsMax = glm::vec3(-FLT_MAX);
+};
+
+static int runModel(const std::string& path, const FractureOptions& options, FracturedModel& result) {
+    std::vector<LoadedMesh> meshes;
+    if (!loadMeshes(path, meshes)) return 1;
+    std::vector<FractureInput> inputs;
+    std::vector<const float*> vertexArrays;
+    std::vector<const unsigned int*> indexArrays;
+    std::vector<size_t> counts, starts;
+    size_t triangles = 0;
+    double volume = 0.0;
+    for (const LoadedMesh& mesh : meshes) {
+        FractureInput input;
+        input.vertices = mesh.vertices.data();
+        input.vertexCount = mesh.vertices.size() / 8;
+        input.indices = mesh.indices.data();
+        input.indexCount = mesh.indices.size();
+        inputs.push_back(input);
+        vertexArrays.push_back(input.vertices);
+        indexArrays.push_back(input.indices);
+        counts.push_back(input.indexCount);
+        starts.push_back(0);
+        triangles += input.indexCount / 3;
+        volume += signedVolume(input.vertices, input.indices, 0, input.indexCount);
+        for (size_t v = 0; v < input.vertexCount; ++v) {
+            result.boundsMin = glm::min(result.boundsMin, glm::make_vec3(input.vertices + 8 * v));
+            result.boundsMax = glm::max(result.boundsMax, glm::make_vec3(input.vertices + 8 * v));
+        }
+    }
+    size_t inputOpen = countOpenEdges(vertexArrays, indexArrays, counts, starts);
+
+    result.path = path;
+    double ms = measureMs([&] { CMeshFracture::fracture(inputs, options, result.chunks); });
+    size_t outTriangles = 0, outOpen = 0;
+    double outVolume = 0.0;
+    for (const FractureChunk& chunk : result.chunks) {
+        std::vector<const float*> chunkVertices;
+        std::vector<const unsigned int*> chunkIndices;
+        std::vector<size_t> chunkCounts, chunkStarts;
+        for (const FractureSection& section : chunk.sections) {
+            chunkVertices.push_back(chunk.vertices[0].position);
+            chunkIndices.push_back(chunk.indices.data());
+            chunkCounts.push_back(section.indexCount);
+            chunkStarts.push_back(section.indexStart);
+            outVolume += signedVolume(chunk.vertices[0].position, chunk.indices.data(), section.indexStart,
+                                      section.indexCount);
+        }
+        outTriangles += chunk.indices.size() / 3;
+        outOpen += countOpenEdges(chunkVertices, chunkIndices, chunkCounts, chunkStarts);
+    }
+
+    bool closed = inputOpen == 0;
+    double volumeError = (std::fabs(volume) > 0.0) ? std::fabs(outVolume / volume - 1.0) : 0.0;
+    bool ok = !result.chunks.empty() && (!closed || (outOpen == 0 && volumeError < 0.01));
+    std::cout << std::setw(28) << path << std::setw(10) << triangles << std::setw(8) << result.chunks.size()
+              << std::setw(10) << outTriangles << std::setw(10) << std::fixed << std::setprecision(1) << ms
+              << std::setw(10) << inputOpen << std::setw(10) << outOpen << std::setw(10) << std::setprecision(4)
+              << volume << std::setw(10) << outVolume << (ok ? "  ok" : "  FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    FractureOptions options;
+    options.threads = hardwareThreadCount();
+    int breaks = 50;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--pieces" && hasValue) options.pieces = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) options.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--breaks" && hasValue) breaks = std::max(1, std::atoi(argv[++i]));
+        else if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".obj") paths.push_back(arg);
+        else {
+            std::cout << "Usage: FractureBenchmark [--pieces N] [--seed S] [--breaks N] [obj ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) paths = { "models/woodCube.obj", "models/livingRoomTable.obj", "models/sofa.obj" };
+
+    std::cout << "FractureBenchmark: " << options.pieces << " pieces, " << options.threads << " threads" << std::endl;
+    std::cout << std::setw(28) << "model" << std::setw(10) << "tris" << std::setw(8) << "chunks" << std::setw(10)
+              << "out tris" << std::setw(10) << "ms" << std::setw(10) << "open in" << std::setw(10) << "open out"
+              << std::setw(10) << "volume" << std::setw(10) << "chunks V" << std::endl;
+    int failures = 0;
+    std::vector<FracturedModel> models(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) failures += runModel(paths[i], options, models[i]);
+
+    // 房間地板上排成格子的物件（與 Homework 相同的 0.7 縮放），全部在同一個 frame 打壞
+    RoomGridConfig config;
+    config.cols = 1;
+    config.rows = 1;
+    RoomGrid grid = generateRoomGrid(config);
+    CollisionManager world;
+    world.setWalls(grid.walls);
+    glm::vec3 center = grid.roomCenters[0];
+    glm::vec3 floor(center.x, center.y - config.roomY * 0.5f, center.z);
+
+    CRigidBodyPool bodies;
+    CDebrisPool debris;
+    std::vector<int> sources;
+    for (const FracturedModel& model : models) sources.push_back(debris.addSource(model.chunks));
+    std::vector<glm::mat4> worlds(breaks);
+    std::vector<glm::vec3> impacts(breaks);
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(breaks))));
+    const float spacing = std::min(config.roomX, config.roomZ) * 0.8f / side;
+    for (int i = 0; i < breaks; ++i) {
+        const FracturedModel& model = models[i % models.size()];
+        glm::vec3 size = (model.boundsMax - model.boundsMin) * 0.7f;
+        float scale = 0.7f * std::min(1.0f, spacing * 0.8f / std::max(size.x, size.z));   // 大的家具縮小以放進格子
+        glm::vec3 anchor((model.boundsMin.x + model.boundsMax.x) * 0.5f, model.boundsMin.y,
+                         (model.boundsMin.z + model.boundsMax.z) * 0.5f);
+        glm::vec3 pos = floor + glm::vec3((i % side - (side - 1) * 0.5f) * spacing, 0.01f,
+                                          (i / side - (side - 1) * 0.5f) * spacing);
+        worlds[i] = glm::translate(glm::mat4(1.0f), pos) * glm::scale(glm::mat4(1.0f), glm::vec3(scale)) *
+                    glm::translate(glm::mat4(1.0f), -anchor);
+        impacts[i] = pos + glm::vec3(0.3f, 0.2f, 0.0f);
+    }
+
+    int pieces = 0;
+    long before = g_allocations.load();
+    double breakMs = measureMs([&] {
+        for (int i = 0; i < breaks; ++i) pieces += debris.breakObject(sources[i % sources.size()], worlds[i], impacts[i], 4.0f, bodies);
+        debris.buildInstances(bodies);
+    });
+    long breakAllocations = g_allocations.load() - before;
+    std::cout << "  " << breaks << " objects broken in one frame: " << pieces << " pieces, " << std::setprecision(3)
+              << breakMs << " ms, " << breakAllocations << " allocations" << std::endl;
+    if (breakAllocations != 0 || pieces == 0) failures++;
+
+    // 之後每個 frame：固定步長的剛體與碎片的模型矩陣（描繪時上傳的資料）
+    std::cout << std::setw(10) << "frames" << std::setw(10) << "awake" << std::setw(12) << "avg ms" << std::setw(10)
+              << "max ms" << std::setw(10) << "allocs" << std::endl;
+    const int framesPerSecond = 60;
+    for (int second = 0; second < 5; ++second) {
+        double total = 0.0, peak = 0.0;
+        long start = g_allocations.load();
+        for (int f = 0; f < framesPerSecond; ++f) {
+            double ms = measureMs([&] {
+                bodies.update(1.0f / framesPerSecond, world);
+                debris.buildInstances(bodies);
+            });
+            total += ms;
+            peak = std::max(peak, ms);
+        }
+        long frameAllocations = g_allocations.load() - start;
+        std::cout << std::setw(5) << second * framesPerSecond << "-" << std::setw(4) << (second + 1) * framesPerSecond
+                  << std::setw(10) << bodies.getStats().awake << std::setw(12) << total / framesPerSecond
+                  << std::setw(10) << peak << std::setw(10) << frameAllocations << std::endl;
+        if (frameAllocations != 0) failures++;
+    }
+    int escaped = 0;
+    glm::vec3 roomMin = center - glm::vec3(config.roomX, config.roomY, config.roomZ) * 0.5f;
+    glm::vec3 roomMax = center + glm::vec3(config.roomX, config.roomY, config.roomZ) * 0.5f;
+    for (int body : bodies.getActiveBodies()) {
+        glm::vec3 p = bodies.getPosition(body);
+        for (int k = 0; k < 3; ++k) {
+            if (p[k] < roomMin[k] - 0.1f || p[k] > roomMax[k] + 0.1f) { escaped++; break; }
+        }
+    }
+    std::cout << "  escaped " << escaped << std::endl;
+    if (escaped > 0) failures++;
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+//  ImpostorBenchmark.cpp
+//  八面體 impostor（OctahedralImpostor.h、CImpostorRenderer）：
+//  1. 視角排列的檢查：半球八面體映射的來回誤差、混合權重（不為負、總和為 1、視角編號在範圍內）、
+//     視線方向正好是某個視角時只使用那個視角、每個視角畫面的兩個軸與方向互相垂直
+//  2. 每個 impostor 的記憶體（兩張 RGBA8 貼圖集含 mipmap）在不同視角數量與畫面大小下的比較
+//  3. 規模測試：RoomGrid 的 --rooms 個房間、每個房間最多 --furniture 個家具（預設 12 x 12 個房間，約三百個家具），
+//     家具的大小與三角形數量由 OBJ 讀入（Homework 的 models[1] ~ [5]），攝影機依序站在每個房間的中央往四個方向看，
+//     以 Homework 相同的規則（視錐與 100 公尺的遠平面剔除，包圍球上最近的點比遠平面的 40% 遠時使用 impostor）
+//     比較視錐內的實體送出的三角形數量；另外以六個房間的場景（家具在 OBJ 的位置）檢查至少有一個家具使用 impostor，
+//     失敗時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      ImpostorBenchmark [--rooms CxR] [--furniture N] [--samples N]
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/CImpostorRenderer.h"
+#include "../common/RoomGrid.h"
+#include "../common/SceneObject.h"
+#include "../tiny_obj_loader.h"
+
+#define SCREEN_HEIGHT_PIXELS 800.0f
+#define FIELD_OF_VIEW_DEGREES 45.0f     // 800 x 800 的視窗，長寬比為 1
+#define NEAR_PLANE 0.1f
+#define FAR_PLANE 100.0f                // Homework 的 CAMERA_FAR_PLANE
+#define SWITCH_DISTANCE (FAR_PLANE * 0.4f)   // Homework 的 IMPOSTOR_SWITCH_DISTANCE
+#define EYE_HEIGHT 4.0f
+#define START_EYE glm::vec3(-28.0f, 6.0f, 10.0f)    // Homework 的 g_eyeloc 與一開始看的位置
+#define START_CENTER glm::vec3(0.0f, 4.0f, 0.0f)
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Homework 的家具：models[] 的索引與 OBJ
+struct FurnitureModel {
+    int index;
+    const char* path;
+    glm::vec3 boundsMin = glm::vec3(0.0f), boundsMax = glm::vec3(0.0f);
+    size_t triangles = 0;
+};
+
+static bool loadFurniture(FurnitureModel& model) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string path = model.path;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str()) ||
+        attrib.vertices.empty()) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    model.boundsMin = glm::vec3(FLT_MAX);
+    model.boundsMax = glm::vec3(-FLT_MAX);
+    for (size_t v = 0; v + 2 < attrib.vertices.size(); v += 3) {
+        glm::vec3 p(attrib.vertices[v], attrib.vertices[v + 1], attrib.vertices[v + 2]);
+        model.boundsMin = glm::min(model.boundsMin, p);
+        model.boundsMax = glm::max(model.boundsMax, p);
+    }
+    for (const auto& shape : shapes) model.triangles += shape.mesh.indices.size() / 3;
+    return true;
+}
+
+// 場景中的一個家具實體
+struct SweepInstance {
+    glm::vec3 worldMin, worldMax;
+    size_t triangles;
+};
+
+// 所有視角的合計；三角形數量只計算視錐內的實體
+struct SweepResult {
+    size_t views = 0, visible = 0, impostors = 0;
+    size_t minImpostors = SIZE_MAX, maxImpostors = 0;
+    size_t meshTriangles = 0, impostorTriangles = 0;
+};
+
+// 與 Homework 相同：視錐（含遠平面）外的實體不描繪，包圍球上最近的點比 SWITCH_DISTANCE 遠時以 impostor 描繪
+static void sweepView(const std::vector<SweepInstance>& instances, const glm::vec3& eye, const glm::vec3& center,
+                      SweepResult& result) {
+    glm::mat4 viewProj = glm::perspective(glm::radians(FIELD_OF_VIEW_DEGREES), 1.0f, NEAR_PLANE, FAR_PLANE) *
+                         glm::lookAt(eye, center, glm::vec3(0.0f, 1.0f, 0.0f));
+    size_t impostors = 0;
+    for (const SweepInstance& instance : instances) {
+        if (!aabbInFrustum(viewProj, instance.worldMin, instance.worldMax)) continue;
+        glm::vec3 middle = (instance.worldMin + instance.worldMax) * 0.5f;
+        float radius = glm::length(instance.worldMax - instance.worldMin) * 0.5f;
+        result.visible++;
+        result.meshTriangles += instance.triangles;
+        if (glm::length(middle - eye) - radius > SWITCH_DISTANCE) {
+            result.impostorTriangles += 2;
+            impostors++;
+        } else {
+            result.impostorTriangles += instance.triangles;
+        }
+    }
+    result.views++;
+    result.impostors += impostors;
+    result.minImpostors = std::min(result.minImpostors, impostors);
+    result.maxImpostors = std::max(result.maxImpostors, impostors);
+}
+
+// 站在 eye 往 +x、-x、+z、-z 四個水平方向看
+static void sweepRoom(const std::vector<SweepInstance>& instances, const glm::vec3& eye, SweepResult& result) {
+    const glm::vec3 directions[4] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+    for (const glm::vec3& direction : directions) sweepView(instances, eye, eye + direction, result);
+}
+
+static void printSweep(const SweepResult& result, size_t instanceCount) {
+    double views = static_cast<double>(std::max<size_t>(result.views, 1));
+    std::cout << std::setprecision(1) << "  visible per view: avg " << result.visible / views << " of " << instanceCount
+              << ", impostors avg " << result.impostors / views << " (" << result.minImpostors << " ~ "
+              << result.maxImpostors << "), " << 100.0 * result.impostors / std::max<size_t>(result.visible, 1)
+              << "% of visible" << std::endl;
+    std::cout << "  visible triangles per view: " << static_cast<size_t>(result.meshTriangles / views)
+              << " meshes only, " << static_cast<size_t>(result.impostorTriangles / views) << " with impostors ("
+              << 100.0 * result.impostorTriangles / std::max<size_t>(result.meshTriangles, 1) << "%)" << std::endl;
+}
+
+static glm::vec3 randomUpperDirection(std::mt19937& rng) {
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    glm::vec3 d(normal(rng), std::fabs(normal(rng)), normal(rng));
+    return glm::length(d) > 1e-6f ? glm::normalize(d) : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+static bool checkFrameLayout(int samples) {
+    const int n = IMPOSTOR_FRAMES_PER_SIDE;
+    std::mt19937 rng(7);
+    float worstRoundTrip = 0.0f, worstWeightSum = 0.0f, worstBasis = 0.0f;
+    bool rangeOk = true;
+    for (int i = 0; i < samples; ++i) {
+        glm::vec3 dir = randomUpperDirection(rng);
+        worstRoundTrip = std::max(worstRoundTrip, glm::length(hemiOctDecode(hemiOctEncode(dir)) - dir));
+        ImpostorFrameBlend blend = impostorFrameBlend(dir, n);
+        float sum = 0.0f;
+        for (int k = 0; k < 3; ++k) {
+            if (blend.frames[k] < 0 || blend.frames[k] >= n * n || blend.weights[k] < -1e-5f) rangeOk = false;
+            sum += blend.weights[k];
+        }
+        worstWeightSum = std::max(worstWeightSum, std::fabs(sum - 1.0f));
+    }
+
+    // 視線方向正好是視角方向時，那個視角的權重為 1
+    int exactMisses = 0;
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            glm::vec3 dir = impostorFrameDirection(x, y, n);
+            ImpostorFrameBlend blend = impostorFrameBlend(dir, n);
+            float weight = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                if (blend.frames[k] == y * n + x) weight += blend.weights[k];
+            }
+            if (weight < 0.999f) exactMisses++;
+            glm::vec3 right, up;
+            impostorFrameBasis(dir, right, up);
+            worstBasis = std::max({ worstBasis, std::fabs(glm::dot(right, up)), std::fabs(glm::dot(right, dir)),
+                                    std::fabs(glm::dot(up, dir)), std::fabs(glm::length(up) - 1.0f) });
+        }
+    }
+
+    bool ok = rangeOk && worstRoundTrip < 1e-4f && worstWeightSum < 1e-4f && exactMisses == 0 && worstBasis < 1e-4f;
+    std::cout << "Frame layout: " << n << " x " << n << " views, " << samples << " random directions" << std::endl;
+    std::cout << std::scientific << std::setprecision(2) << "  octahedral round trip " << worstRoundTrip
+              << ", weight sum error " << worstWeightSum << ", basis error " << worstBasis << std::fixed << std::endl;
+    std::cout << "  weights / frame range " << (rangeOk ? "ok" : "out of range") << ", " << exactMisses
+              << " grid directions not reproduced exactly" << std::endl;
+    std::cout << (ok ? "  ok" : "  FAILED") << std::endl;
+    return ok;
+}
+
+static void printMemoryTable() {
+    std::cout << std::endl << "Memory per impostor (albedo + normal/depth RGBA8 atlases):" << std::endl;
+    std::cout << std::setw(8) << "views" << std::setw(8) << "frame" << std::setw(10) << "atlas" << std::setw(12) << "no mips"
+              << std::setw(12) << "mips" << std::endl;
+    for (int n : { 4, 8, 12, 16 }) {
+        for (int size : { 32, 64, 128 }) {
+            bool current = (n == IMPOSTOR_FRAMES_PER_SIDE && size == IMPOSTOR_FRAME_SIZE);
+            std::cout << std::setw(5) << n << " x" << n << std::setw(n < 10 ? 7 : 6) << size << std::setw(10)
+                      << n * size << std::setw(10) << impostorMemoryBytes(n, size, 1) / 1024 << "KB" << std::setw(10)
+                      << impostorMemoryBytes(n, size, IMPOSTOR_MIP_LEVELS) / 1024 << "KB" << (current ? "  <- current" : "")
+                      << std::endl;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    RoomGridConfig config;
+    config.cols = 12;
+    config.rows = 12;
+    config.furniturePerRoom = 3;
+    int samples = 100000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--rooms" && hasValue && std::sscanf(argv[i + 1], "%dx%d", &config.cols, &config.rows) == 2) i++;
+        else if (arg == "--furniture" && hasValue) config.furniturePerRoom = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--samples" && hasValue) samples = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: ImpostorBenchmark [--rooms CxR] [--furniture N] [--samples N]" << std::endl;
+            return 1;
+        }
+    }
+
+    int failures = 0;
+    if (!checkFrameLayout(samples)) failures++;
+    printMemoryTable();
+
+    std::vector<FurnitureModel> models = {
+        { 1, "models/livingRoomTable.obj" }, { 2, "models/sofa.obj" }, { 3, "models/bed.obj" },
+        { 4, "models/toilet.obj" },          { 5, "models/desk.obj" },
+    };
+    std::vector<FurnitureFootprint> footprints;
+    for (FurnitureModel& model : models) {
+        if (!loadFurniture(model)) return 1;
+        footprints.push_back({ model.index, model.boundsMin, model.boundsMax, 0.7f });
+    }
+
+    // 家具在切換距離時投影後的包圍球半徑，與 impostor 畫面（IMPOSTOR_FRAME_SIZE / 2 像素）相比的放大倍數
+    float focal = SCREEN_HEIGHT_PIXELS * 0.5f / std::tan(glm::radians(FIELD_OF_VIEW_DEGREES) * 0.5f);
+    std::cout << std::endl << std::setprecision(0) << "Furniture (scale 0.7, impostor beyond " << SWITCH_DISTANCE << " m, far plane "
+              << FAR_PLANE << " m):" << std::endl;
+    std::cout << std::setw(28) << "model" << std::setw(12) << "triangles" << std::setw(10) << "radius" << std::setw(14)
+              << "px at switch" << std::setw(12) << "magnified" << std::endl;
+    for (const FurnitureModel& model : models) {
+        float radius = glm::length(model.boundsMax - model.boundsMin) * 0.5f * 0.7f;
+        float pixels = focal * radius / SWITCH_DISTANCE;
+        std::cout << std::setw(28) << model.path << std::setw(12) << model.triangles << std::setw(9)
+                  << std::setprecision(2) << radius << "m" << std::setw(14) << std::setprecision(1) << pixels
+                  << std::setw(11) << pixels / (IMPOSTOR_FRAME_SIZE * 0.5f) << "x" << std::endl;
+    }
+
+    // 六個房間的場景：家具以 OBJ 的位置縮放 0.7（Homework 的 modelMatrices 為單位矩陣），
+    // 攝影機在起始的位置與 initializeWalls 的每個房間（與預設的 RoomGridConfig 重合）
+    std::vector<SweepInstance> props;
+    for (const FurnitureModel& model : models) props.push_back({ model.boundsMin * 0.7f, model.boundsMax * 0.7f, model.triangles });
+    RoomGrid sixRooms = generateRoomGrid(RoomGridConfig(), {});
+    SweepResult sixRoomResult;
+    sweepView(props, START_EYE, START_CENTER, sixRoomResult);
+    for (const glm::vec3& room : sixRooms.roomCenters) sweepRoom(props, glm::vec3(room.x, EYE_HEIGHT, room.z), sixRoomResult);
+    std::cout << std::endl << "Six rooms: " << props.size() << " furniture, start view and " << sixRooms.roomCenters.size()
+              << " rooms x 4 directions" << std::endl;
+    printSweep(sixRoomResult, props.size());
+    // 起始的場景中至少有一個家具在 impostor 的切換距離之外、而且在視錐內
+    bool sixRoomOk = sixRoomResult.impostors > 0;
+    std::cout << (sixRoomOk ? "  ok" : "  FAILED: no furniture switches to an impostor") << std::endl;
+    if (!sixRoomOk) failures++;
+
+    RoomGrid grid = generateRoomGrid(config, footprints);
+    std::vector<SweepInstance> instances;
+    for (const FurnitureInstance& furniture : grid.furniture) {
+        for (const FurnitureModel& model : models) {
+            if (model.index == furniture.model) instances.push_back({ furniture.worldMin, furniture.worldMax, model.triangles });
+        }
+    }
+
+    // 攝影機站在每個房間的中央，往四個方向看
+    SweepResult gridResult;
+    double selectMs = measureMs([&]() {
+        for (const glm::vec3& room : grid.roomCenters) {
+            sweepRoom(instances, glm::vec3(room.x, config.origin.y + EYE_HEIGHT, room.z), gridResult);
+        }
+    });
+    std::cout << std::endl << "Room grid: " << grid.roomCenters.size() << " rooms, " << grid.furniture.size()
+              << " furniture, " << grid.roomCenters.size() << " rooms x 4 directions (" << std::setprecision(2)
+              << selectMs << " ms to cull and select)" << std::endl;
+    printSweep(gridResult, instances.size());
+    size_t memory = impostorMemoryBytes(IMPOSTOR_FRAMES_PER_SIDE, IMPOSTOR_FRAME_SIZE, IMPOSTOR_MIP_LEVELS);
+    std::cout << "  impostor memory: " << models.size() << " x " << memory / 1024 << " KB = "
+              << models.size() * memory / 1024 << " KB" << std::endl;
+
+    // 數百個家具的場景中視錐內仍有許多遠處的實體，impostor 必須減少送出的三角形
+    bool sceneOk = grid.furniture.size() < 100 ||
+                   (gridResult.impostors > 0 && gridResult.impostorTriangles < gridResult.meshTriangles);
+    std::cout << (sceneOk ? "  ok" : "  FAILED") << std::endl;
+    if (!sceneOk) failures++;
+
+    std::cout << std::endl << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
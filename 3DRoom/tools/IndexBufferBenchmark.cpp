@@ -0,0 +1,224 @@
+//  IndexBufferBenchmark.cpp
+//  IndexWidth：每個模型的網格以 Model 相同的方式處理（頂點依 OBJ 的索引合併、CMeshCluster 分叢集、
+//  CMeshOptimize 最佳化、CMeshSimplify 產生 LOD），以 Model::UploadIndices 相同的規則選擇索引寬度，
+//  輸出索引緩衝區（原本的索引接著 LOD 的索引）全部使用 32-bit 與依網格選擇寬度時的大小
+//  檢查：所有索引都小於頂點數、頂點不超過 65536 個的網格選擇 16-bit、16-bit 的緩衝區還原後與原本的索引完全相同、
+//  叢集與 LOD 的範圍以實際的索引寬度換算成 byte 位移後仍在緩衝區內
+//  CShape 的子類別以建構時產生的索引做相同的檢查（與 CShape::setupVertexAttributes 相同的規則），失敗時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      IndexBufferBenchmark [obj ...]
+//      （預設為 models/ 下所有的模型）
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../common/CMeshCluster.h"
+#include "../common/CMeshOptimize.h"
+#include "../common/CMeshSimplify.h"
+#include "../common/IndexWidth.h"
+#include "../models/CBottle.h"
+#include "../models/CBox.h"
+#include "../models/CCapsule.h"
+#include "../models/CCube.h"
+#include "../models/CCup.h"
+#include "../models/CCylinder.h"
+#include "../models/CDonut.h"
+#include "../models/CQuad.h"
+#include "../models/CSphere.h"
+#include "../models/CTeapot.h"
+#include "../models/CTorusKnot.h"
+#include "../tiny_obj_loader.h"
+
+#define VERTEX_FLOATS 8
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 每個 shape 一個網格，頂點為 8 個 float（位置、法向量、貼圖座標），索引相同的頂點合併
+struct LoadedMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static bool loadMeshes(const std::string& path, std::vector<LoadedMesh>& meshes) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        LoadedMesh mesh;
+        std::map<std::array<int, 3>, unsigned int> unique;
+        for (const auto& index : shape.mesh.indices) {
+            std::array<int, 3> key = { index.vertex_index, index.normal_index, index.texcoord_index };
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                it = unique.emplace(key, static_cast<unsigned int>(mesh.vertices.size() / VERTEX_FLOATS)).first;
+                for (int k = 0; k < 3; ++k) mesh.vertices.push_back(attrib.vertices[3 * index.vertex_index + k]);
+                for (int k = 0; k < 3; ++k) {
+                    mesh.vertices.push_back(index.normal_index >= 0 ? attrib.normals[3 * index.normal_index + k] : 0.0f);
+                }
+                for (int k = 0; k < 2; ++k) {
+                    mesh.vertices.push_back(index.texcoord_index >= 0 ? attrib.texcoords[2 * index.texcoord_index + k] : 0.0f);
+                }
+            }
+            mesh.indices.push_back(it->second);
+        }
+        if (!mesh.indices.empty()) meshes.push_back(std::move(mesh));
+    }
+    return !meshes.empty();
+}
+
+// 所有索引都小於 vertexCount、寬度的選擇與頂點數一致、16-bit 的索引還原後與原本的索引相同
+static bool checkIndexWidth(const unsigned int* indices, size_t count, size_t vertexCount, bool& narrow,
+                            double& narrowMs) {
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= vertexCount) ok = false;
+    }
+    narrow = fitsIndex16(indices, count);
+    if (narrow != (vertexCount <= INDEX16_LIMIT)) ok = false;
+    if (narrow) {
+        std::vector<uint16_t> narrowed;
+        narrowMs += measureMs([&]() { narrowIndices(indices, count, narrowed); });
+        for (size_t i = 0; i < count; ++i) {
+            if (narrowed[i] != indices[i]) ok = false;
+        }
+    }
+    return ok;
+}
+
+// [indexStart, indexStart + indexCount) 以 indexSize 換算成 byte 後在 bufferBytes 之內
+static bool rangeInBuffer(size_t indexStart, size_t indexCount, size_t indexSize, size_t bufferBytes) {
+    return (indexStart + indexCount) * indexSize <= bufferBytes;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".obj") paths.push_back(arg);
+        else {
+            std::cout << "Usage: IndexBufferBenchmark [obj ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) {
+        paths = { "models/Room001.obj", "models/livingRoomTable.obj", "models/sofa.obj", "models/bed.obj",
+                  "models/toilet.obj", "models/desk.obj", "models/garden.obj", "models/woodCube.obj",
+                  "models/robot.obj", "models/fan.obj", "models/sign.obj", "models/Room001Window.obj",
+                  "models/Bear.obj", "models/House.obj", "models/Light.obj", "models/cube.obj" };
+    }
+
+    std::cout << "IndexBufferBenchmark: 16-bit indices below " << INDEX16_LIMIT << " vertices per mesh" << std::endl;
+    std::cout << std::setw(24) << std::left << "model" << std::right << std::setw(8) << "meshes" << std::setw(10)
+              << "max verts" << std::setw(10) << "indices" << std::setw(11) << "32-bit KB" << std::setw(11) << "chosen KB"
+              << std::setw(9) << "16-bit" << std::endl;
+
+    int failures = 0;
+    size_t total32 = 0, totalChosen = 0, totalMeshes = 0, totalNarrow = 0;
+    double narrowMs = 0.0;
+    for (const std::string& path : paths) {
+        std::vector<LoadedMesh> meshes;
+        if (!loadMeshes(path, meshes)) {
+            failures++;
+            continue;
+        }
+        size_t bytes32 = 0, chosenBytes = 0, indexCount = 0, maxVertices = 0, narrowMeshes = 0;
+        bool ok = true;
+        for (LoadedMesh& mesh : meshes) {
+            size_t vertexCount = mesh.vertices.size() / VERTEX_FLOATS;
+            std::vector<MeshCluster> clusters;
+            CMeshCluster::build(mesh.vertices.data(), vertexCount, VERTEX_FLOATS, mesh.indices, clusters);
+            CMeshOptimize::optimize(mesh.vertices.data(), vertexCount, VERTEX_FLOATS * sizeof(float), mesh.indices, clusters);
+            std::vector<unsigned int> lodIndices;
+            std::vector<MeshLod> lods;
+            CMeshSimplify::buildLods(mesh.vertices.data(), vertexCount, VERTEX_FLOATS, mesh.indices.data(),
+                                     mesh.indices.size(), MESH_LOD_MAX, lodIndices, lods);
+
+            // 與 Model::UploadIndices 相同：原本的索引之後接著 LOD 的索引
+            std::vector<unsigned int> combined(mesh.indices);
+            combined.insert(combined.end(), lodIndices.begin(), lodIndices.end());
+            bool narrow = false;
+            if (!checkIndexWidth(combined.data(), combined.size(), vertexCount, narrow, narrowMs)) ok = false;
+            size_t indexSize = narrow ? sizeof(uint16_t) : sizeof(unsigned int);
+            size_t bufferBytes = combined.size() * indexSize;
+            if (narrow) narrowMeshes++;
+            for (const MeshCluster& cluster : clusters) {
+                if (!rangeInBuffer(cluster.indexStart, cluster.indexCount, indexSize, bufferBytes)) ok = false;
+            }
+            for (const MeshLod& lod : lods) {
+                if (!rangeInBuffer(lod.indexStart, lod.indexCount, indexSize, bufferBytes)) ok = false;
+            }
+
+            bytes32 += combined.size() * sizeof(unsigned int);
+            chosenBytes += bufferBytes;
+            indexCount += combined.size();
+            maxVertices = std::max(maxVertices, vertexCount);
+        }
+
+        total32 += bytes32;
+        totalChosen += chosenBytes;
+        totalMeshes += meshes.size();
+        totalNarrow += narrowMeshes;
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        std::cout << std::setw(24) << std::left << (name + (ok ? "" : " FAILED")) << std::right << std::setw(8)
+                  << meshes.size() << std::setw(10) << maxVertices << std::setw(10) << indexCount << std::fixed
+                  << std::setprecision(1) << std::setw(11) << bytes32 / 1024.0 << std::setw(11) << chosenBytes / 1024.0
+                  << std::setw(9) << narrowMeshes << std::defaultfloat << std::endl;
+        if (!ok) failures++;
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << "total: " << totalNarrow << "/" << totalMeshes
+              << " meshes 16-bit, " << total32 / 1024.0 << " KB -> " << totalChosen / 1024.0 << " KB ("
+              << 100.0 * (1.0 - double(totalChosen) / std::max<size_t>(1, total32)) << "% saved), narrow "
+              << std::setprecision(2) << narrowMs << " ms" << std::endl;
+
+    // CShape 的子類別：建構時只產生頂點與索引，不呼叫 GL；最後一個球超過 65536 個頂點，檢查 32-bit 的情況
+    // 解構時會釋放 VAO/VBO/EBO，沒有 GL context 時不能呼叫，所以形狀不釋放
+    std::vector<std::pair<std::string, CShape*>> shapes = {
+        { "CBottle", new CBottle() }, { "CBox", new CBox() }, { "CCapsule", new CCapsule() },
+        { "CCube", new CCube() }, { "CCup", new CCup() }, { "CCylinder", new CCylinder() },
+        { "CDonut", new CDonut() }, { "CQuad", new CQuad() }, { "CSphere", new CSphere() },
+        { "CTeapot", new CTeapot() }, { "CTorusKnot", new CTorusKnot() },
+        { "CSphere 400x400", new CSphere(1.0f, 400, 400) } };
+    std::cout << std::setw(24) << std::left << "shape" << std::right << std::setw(10) << "verts" << std::setw(10)
+              << "indices" << std::setw(11) << "32-bit KB" << std::setw(11) << "chosen KB" << std::setw(9) << "16-bit"
+              << std::endl;
+    size_t shapes32 = 0, shapesChosen = 0;
+    for (const auto& entry : shapes) {
+        const CShape* shape = entry.second;
+        size_t vertexCount = static_cast<size_t>(shape->getVertexCount());
+        size_t indexCount = static_cast<size_t>(shape->getIndexCount());
+        bool narrow = false;
+        bool ok = checkIndexWidth(shape->getIndices(), indexCount, vertexCount, narrow, narrowMs);
+        if (indexCount == 0 || indexCount % 3 != 0) ok = false;
+        size_t chosenBytes = indexCount * (narrow ? sizeof(uint16_t) : sizeof(unsigned int));
+        shapes32 += indexCount * sizeof(unsigned int);
+        shapesChosen += chosenBytes;
+        std::cout << std::setw(24) << std::left << (entry.first + (ok ? "" : " FAILED")) << std::right
+                  << std::setw(10) << vertexCount << std::setw(10) << indexCount << std::fixed << std::setprecision(1)
+                  << std::setw(11) << indexCount * sizeof(unsigned int) / 1024.0 << std::setw(11)
+                  << chosenBytes / 1024.0 << std::setw(9) << (narrow ? "yes" : "no") << std::defaultfloat << std::endl;
+        if (!ok) failures++;
+    }
+    std::cout << std::fixed << std::setprecision(1) << "shapes: " << shapes32 / 1024.0 << " KB -> "
+              << shapesChosen / 1024.0 << " KB" << std::defaultfloat << std::endl;
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
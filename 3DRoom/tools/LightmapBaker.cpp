@@ -0,0 +1,246 @@
+//  LightmapBaker.cpp
+//  離線烘焙 Light Map：載入與 Homework.cpp 相同的靜態模型與固定光源，
+//  在每個目標網格的 UV 空間中，以路徑追蹤計算直接光 + 間接光，使用所有 CPU 核心
+//  輸出 <name>_baked.png（執行時用 Model::SetBakedLightMap 讀取）與 <name>_baked.hdr（線性數值）
+//
+//  在 3DRoom 目錄下執行：
+//      LightmapBaker [--threads N] [--samples S] [--bounces B] [--size R] [--exposure E] [--scaling]
+//  --scaling 會以 1, 2, 4 ... N 個執行緒各烘焙一次並列出時間
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CBakeScene.h"
+#include "../common/CImageWriter.h"
+#include "../common/CParallel.h"
+#include "BakeSceneSetup.h"
+
+struct BakeSettings {
+    int   threads = hardwareThreadCount();
+    int   samples = 64;      // 每個 texel 的間接光取樣數
+    int   bounces = 2;       // 間接光最多反彈次數
+    int   size = 512;        // Light Map 解析度
+    float exposure = 0.5f;   // PNG 儲存 E * exposure，執行時 intensity = 1 / exposure
+    bool  scaling = false;
+};
+
+struct BakeTarget {
+    int instance;
+    std::string materialName;
+    std::string outputBase;  // 不含副檔名
+};
+
+// 每個 texel 對應到的表面點
+struct Texel {
+    int index;               // y * size + x
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 faceNormal;
+};
+
+// 在 UV 空間中光柵化目標材質的三角形，找出每個 texel 的位置與法向量
+static std::vector<Texel> rasterizeTarget(const CBakeScene& scene, int material, int size) {
+    std::vector<int> owner(static_cast<size_t>(size) * size, -1);
+    std::vector<Texel> texels;
+    for (const BakeTriangle& tri : scene.getTriangles()) {
+        if (tri.material != material) continue;
+        // texel 空間（y 向下，與 PNG 的列順序相同；Model::LoadTexture 讀取時會上下翻轉）
+        glm::vec2 t[3];
+        for (int i = 0; i < 3; i++) t[i] = glm::vec2(tri.uv[i].x * size, (1.0f - tri.uv[i].y) * size);
+        float area = (t[1].x - t[0].x) * (t[2].y - t[0].y) - (t[2].x - t[0].x) * (t[1].y - t[0].y);
+        if (std::fabs(area) < 1e-8f) continue;
+
+        int x0 = (int)std::floor(std::min(t[0].x, std::min(t[1].x, t[2].x)) - 1.0f);
+        int x1 = (int)std::ceil(std::max(t[0].x, std::max(t[1].x, t[2].x)) + 1.0f);
+        int y0 = (int)std::floor(std::min(t[0].y, std::min(t[1].y, t[2].y)) - 1.0f);
+        int y1 = (int)std::ceil(std::max(t[0].y, std::max(t[1].y, t[2].y)) + 1.0f);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                glm::vec2 c(x + 0.5f, y + 0.5f);
+                float w1 = ((c.x - t[0].x) * (t[2].y - t[0].y) - (t[2].x - t[0].x) * (c.y - t[0].y)) / area;
+                float w2 = ((t[1].x - t[0].x) * (c.y - t[0].y) - (c.x - t[0].x) * (t[1].y - t[0].y)) / area;
+                float w0 = 1.0f - w1 - w2;
+                const float eps = -0.02f; // 稍微放寬，邊緣的 texel 也能取到樣
+                if (w0 < eps || w1 < eps || w2 < eps) continue;
+                // UV 超出 [0,1] 時與 GL_REPEAT 相同方式對應
+                int px = ((x % size) + size) % size;
+                int py = ((y % size) + size) % size;
+                int index = py * size + px;
+
+                Texel texel;
+                texel.index = index;
+                texel.position = tri.p[0] * w0 + tri.p[1] * w1 + tri.p[2] * w2;
+                texel.normal = glm::normalize(tri.n[0] * w0 + tri.n[1] * w1 + tri.n[2] * w2);
+                texel.faceNormal = tri.faceNormal;
+                if (owner[index] >= 0) {
+                    texels[owner[index]] = texel;
+                } else {
+                    owner[index] = static_cast<int>(texels.size());
+                    texels.push_back(texel);
+                }
+            }
+        }
+    }
+    return texels;
+}
+
+// 把有值的 texel 往外擴張，避免雙線性取樣時在 UV 接縫處混到黑色
+static void dilate(std::vector<float>& rgb, std::vector<unsigned char>& filled, int size, int passes) {
+    for (int pass = 0; pass < passes; pass++) {
+        std::vector<float> src = rgb;
+        std::vector<unsigned char> srcFilled = filled;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                int index = y * size + x;
+                if (srcFilled[index]) continue;
+                glm::vec3 sum(0.0f);
+                int count = 0;
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        int nx = x + dx, ny = y + dy;
+                        if (nx < 0 || ny < 0 || nx >= size || ny >= size) continue;
+                        int n = ny * size + nx;
+                        if (!srcFilled[n]) continue;
+                        sum += glm::vec3(src[n * 3], src[n * 3 + 1], src[n * 3 + 2]);
+                        count++;
+                    }
+                }
+                if (count > 0) {
+                    sum /= float(count);
+                    rgb[index * 3] = sum.x; rgb[index * 3 + 1] = sum.y; rgb[index * 3 + 2] = sum.z;
+                    filled[index] = 1;
+                }
+            }
+        }
+    }
+}
+
+// 烘焙一個目標，回傳線性的 RGB（size*size*3）
+static std::vector<float> bakeTarget(const CBakeScene& scene, const std::vector<Texel>& texels,
+                                     const BakeSettings& settings, uint32_t seed) {
+    std::vector<float> rgb(static_cast<size_t>(settings.size) * settings.size * 3, 0.0f);
+    parallelFor(0, static_cast<int>(texels.size()), settings.threads, 64, [&](int i) {
+        const Texel& texel = texels[i];
+        BakeRandom rng(seed ^ (static_cast<uint32_t>(texel.index) * 2654435761u));
+        glm::vec3 origin = texel.position + texel.faceNormal * 1e-3f;
+
+        glm::vec3 irradiance = scene.directLight(origin, texel.normal);
+        if (settings.samples > 0 && settings.bounces > 0) {
+            glm::vec3 indirect(0.0f);
+            for (int s = 0; s < settings.samples; s++) {
+                glm::vec3 dir = CBakeScene::sampleCosineHemisphere(texel.normal, rng);
+                if (glm::dot(dir, texel.faceNormal) <= 0.0f) continue;
+                indirect += scene.traceRadiance(origin, dir, settings.bounces, rng);
+            }
+            irradiance += indirect / float(settings.samples);
+        }
+        // 每個 texel 只會由一個工作寫入，不需要同步
+        rgb[texel.index * 3 + 0] = irradiance.x;
+        rgb[texel.index * 3 + 1] = irradiance.y;
+        rgb[texel.index * 3 + 2] = irradiance.z;
+    });
+    return rgb;
+}
+
+static bool writeOutputs(const BakeTarget& target, std::vector<float>& rgb,
+                         std::vector<unsigned char>& filled, const BakeSettings& settings) {
+    dilate(rgb, filled, settings.size, 4);
+
+    std::vector<unsigned char> png(static_cast<size_t>(settings.size) * settings.size * 3);
+    for (size_t i = 0; i < png.size(); i++) {
+        float v = std::pow(std::min(1.0f, std::max(0.0f, rgb[i] * settings.exposure)), 1.0f / 2.2f);
+        png[i] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+    }
+    bool ok = CImageWriter::writePNG(target.outputBase + ".png", settings.size, settings.size, 3, png);
+    ok = CImageWriter::writeHDR(target.outputBase + ".hdr", settings.size, settings.size, rgb) && ok;
+    if (ok) {
+        std::cout << "Wrote " << target.outputBase << ".png / .hdr (use intensity "
+                  << 1.0f / settings.exposure << " with SetBakedLightMap)" << std::endl;
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    BakeSettings settings;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--threads" && hasValue) settings.threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--samples" && hasValue) settings.samples = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--bounces" && hasValue) settings.bounces = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--size" && hasValue) settings.size = std::max(16, std::atoi(argv[++i]));
+        else if (arg == "--exposure" && hasValue) settings.exposure = (float)std::atof(argv[++i]);
+        else if (arg == "--scaling") settings.scaling = true;
+        else {
+            std::cout << "Usage: LightmapBaker [--threads N] [--samples S] [--bounces B] [--size R] "
+                         "[--exposure E] [--scaling]" << std::endl;
+            return 1;
+        }
+    }
+
+    CBakeScene scene;
+    int instances[BAKE_STATIC_MODELS];
+    setupStaticBakeScene(scene, instances);
+
+    std::vector<BakeTarget> targets = {
+        { instances[0], "room.001", "models/textures/Room001_baked" },
+        { instances[6], "garden",   "models/textures/garden_baked" }
+    };
+
+    std::vector<std::vector<Texel>> texels(targets.size());
+    size_t totalTexels = 0;
+    for (size_t t = 0; t < targets.size(); t++) {
+        int material = scene.findMaterial(targets[t].instance, targets[t].materialName);
+        if (material < 0) {
+            std::cerr << "Material not found: " << targets[t].materialName << std::endl;
+            continue;
+        }
+        texels[t] = rasterizeTarget(scene, material, settings.size);
+        totalTexels += texels[t].size();
+        std::cout << targets[t].materialName << ": " << texels[t].size() << " texels" << std::endl;
+    }
+
+    // 執行緒數量的列表
+    std::vector<int> threadCounts;
+    if (settings.scaling) {
+        for (int n = 1; n < settings.threads; n *= 2) threadCounts.push_back(n);
+    }
+    threadCounts.push_back(settings.threads);
+
+    std::vector<std::vector<float>> results(targets.size());
+    double baseline = 0.0;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "seconds" << std::setw(10) << "speedup"
+              << std::setw(12) << "efficiency" << std::setw(16) << "texels/s" << std::endl;
+    for (int threads : threadCounts) {
+        BakeSettings run = settings;
+        run.threads = threads;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < targets.size(); t++) {
+            results[t] = bakeTarget(scene, texels[t], run, static_cast<uint32_t>(t + 1));
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (baseline == 0.0) baseline = seconds;
+        double speedup = baseline / seconds;
+        std::cout << std::setw(8) << threads << std::setw(12) << std::fixed << std::setprecision(3) << seconds
+                  << std::setw(10) << std::setprecision(2) << speedup
+                  << std::setw(11) << std::setprecision(0) << (100.0 * speedup / threads) << "%"
+                  << std::setw(16) << (totalTexels / seconds) << std::endl;
+    }
+
+    bool ok = true;
+    for (size_t t = 0; t < targets.size(); t++) {
+        if (texels[t].empty()) continue;
+        std::vector<unsigned char> filled(static_cast<size_t>(settings.size) * settings.size, 0);
+        for (const Texel& texel : texels[t]) filled[texel.index] = 1;
+        ok = writeOutputs(targets[t], results[t], filled, settings) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+//  LodBenchmark.cpp
+//  CMeshSimplify：每個模型的每個網格以 Model 相同的方式產生 LOD（頂點依 OBJ 的索引合併，與 Model::ProcessMesh 相同），
+//  輸出每一層的三角形數量、記錄的誤差、原本的頂點到簡化後表面的實際最大距離，
+//  以及 800 像素高、45 度視角、場景的縮放 --scale、誤差門檻 --pixel-error 像素（與 Homework 預設的門檻相同）時
+//  切換到這一層的距離
+//  檢查：每一層的三角形比上一層少、誤差比上一層大而且不小於實際的距離、索引都在範圍內、
+//  以位置比較的開放邊（網格邊界）與原本完全相同（邊界固定、接縫兩側一起移動，簡化後不會出現裂縫），
+//  LOD 1 在遠平面（100 公尺）以內切換，失敗時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      LodBenchmark [--levels N] [--pixel-error P] [--scale S] [obj ...]
+//      （預設 models/Bear.obj models/sofa.obj models/bed.obj models/robot.obj）
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CMeshSimplify.h"
+#include "../common/CTriangleBVH.h"
+#include "../tiny_obj_loader.h"
+
+#define SCREEN_HEIGHT_PIXELS 800.0f
+#define FIELD_OF_VIEW_DEGREES 45.0f
+#define FAR_PLANE 100.0f               // Homework 的 updatePerspective
+#define DEFAULT_PIXEL_ERROR 2.0f       // Homework 的 g_lodPixelErrors[0]
+#define DEFAULT_SCALE 0.7f             // Homework 的 computeModelMatrix 先把所有模型縮放 0.7
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 每個 shape 一個網格，頂點為 8 個 float（位置、法向量、貼圖座標），索引相同的頂點合併
+struct LoadedMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static bool loadMeshes(const std::string& path, std::vector<LoadedMesh>& meshes) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        LoadedMesh mesh;
+        std::map<std::array<int, 3>, unsigned int> unique;
+        for (const auto& index : shape.mesh.indices) {
+            std::array<int, 3> key = { index.vertex_index, index.normal_index, index.texcoord_index };
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                it = unique.emplace(key, static_cast<unsigned int>(mesh.vertices.size() / 8)).first;
+                for (int k = 0; k < 3; ++k) mesh.vertices.push_back(attrib.vertices[3 * index.vertex_index + k]);
+                for (int k = 0; k < 3; ++k) {
+                    mesh.vertices.push_back(index.normal_index >= 0 ? attrib.normals[3 * index.normal_index + k] : 0.0f);
+                }
+                for (int k = 0; k < 2; ++k) {
+                    mesh.vertices.push_back(index.texcoord_index >= 0 ? attrib.texcoords[2 * index.texcoord_index + k] : 0.0f);
+                }
+            }
+            mesh.indices.push_back(it->second);
+        }
+        if (!mesh.indices.empty()) meshes.push_back(std::move(mesh));
+    }
+    return !meshes.empty();
+}
+
+// 以位置比較、沒有反方向邊的有向邊（網格的邊界）
+static std::map<std::array<float, 6>, int> openEdges(const float* vertices, const unsigned int* indices, size_t count) {
+    std::map<std::array<float, 6>, int> edges;
+    for (size_t i = 0; i + 2 < count; i += 3) {
+        for (int e = 0; e < 3; ++e) {
+            const float* a = vertices + 8 * indices[i + e];
+            const float* b = vertices + 8 * indices[i + (e + 1) % 3];
+            std::array<float, 6> forward = { a[0], a[1], a[2], b[0], b[1], b[2] };
+            std::array<float, 6> backward = { b[0], b[1], b[2], a[0], a[1], a[2] };
+            auto it = edges.find(backward);
+            if (it != edges.end() && --it->second == 0) edges.erase(it);
+            else if (it == edges.end()) edges[forward]++;
+        }
+    }
+    return edges;
+}
+
+// 原本的頂點到簡化後表面的最大距離
+static float measureDeviation(const LoadedMesh& mesh, const unsigned int* indices, size_t count) {
+    CTriangleBVH bvh;
+    bvh.build(mesh.vertices.data(), 8, indices, count);
+    float worst = 0.0f;
+    for (size_t v = 0; v < mesh.vertices.size() / 8; ++v) {
+        glm::vec3 p(mesh.vertices[8 * v], mesh.vertices[8 * v + 1], mesh.vertices[8 * v + 2]);
+        BVHSphereHit hit;
+        if (bvh.closestPoint(p, 1e30f, hit)) worst = std::max(worst, hit.distance);
+    }
+    return worst;
+}
+
+int main(int argc, char** argv) {
+    int levels = MESH_LOD_MAX;
+    float pixelError = DEFAULT_PIXEL_ERROR;
+    float scale = DEFAULT_SCALE;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--levels" && hasValue) levels = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--pixel-error" && hasValue) pixelError = std::max(0.01f, static_cast<float>(std::atof(argv[++i])));
+        else if (arg == "--scale" && hasValue) scale = std::max(0.001f, static_cast<float>(std::atof(argv[++i])));
+        else if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".obj") paths.push_back(arg);
+        else {
+            std::cout << "Usage: LodBenchmark [--levels N] [--pixel-error P] [--scale S] [obj ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) paths = { "models/Bear.obj", "models/sofa.obj", "models/bed.obj", "models/robot.obj" };
+
+    // 距離 d 時模型空間每單位的像素數為 pixelsAtUnitDistance / d（與 Homework 的 projectedPixelsPerUnit 相同）
+    float pixelsAtUnitDistance = SCREEN_HEIGHT_PIXELS * 0.5f / std::tan(glm::radians(FIELD_OF_VIEW_DEGREES) * 0.5f) * scale;
+    std::cout << "LodBenchmark: " << levels << " levels, ratio " << MESH_LOD_RATIO << ", threshold " << pixelError
+              << " px (" << SCREEN_HEIGHT_PIXELS << " px high, " << FIELD_OF_VIEW_DEGREES << " deg, scale " << scale
+              << ", far plane " << FAR_PLANE << " m)" << std::endl;
+
+    int failures = 0;
+    for (const std::string& path : paths) {
+        std::vector<LoadedMesh> meshes;
+        if (!loadMeshes(path, meshes)) {
+            failures++;
+            continue;
+        }
+        std::vector<std::vector<unsigned int>> lodIndices(meshes.size());
+        std::vector<std::vector<MeshLod>> lods(meshes.size());
+        double buildMs = measureMs([&]() {
+            for (size_t m = 0; m < meshes.size(); ++m) {
+                CMeshSimplify::buildLods(meshes[m].vertices.data(), meshes[m].vertices.size() / 8, 8,
+                                         meshes[m].indices.data(), meshes[m].indices.size(), levels, lodIndices[m], lods[m]);
+            }
+        });
+        std::cout << std::endl << path << ": " << meshes.size() << " meshes, LOD build " << std::fixed
+                  << std::setprecision(1) << buildMs << " ms" << std::endl;
+        std::cout << std::setw(6) << "LOD" << std::setw(12) << "triangles" << std::setw(9) << "ratio" << std::setw(12)
+                  << "error" << std::setw(12) << "deviation" << std::setw(12) << "switch at" << std::endl;
+
+        // 沒有這一層的網格使用它最後一層
+        size_t baseTriangles = 0;
+        for (const LoadedMesh& mesh : meshes) baseTriangles += mesh.indices.size() / 3;
+        bool ok = true;
+        for (int level = 0; level < levels; ++level) {
+            size_t triangles = 0;
+            float error = 0.0f, deviation = 0.0f;
+            bool present = false;
+            for (size_t m = 0; m < meshes.size(); ++m) {
+                int k = std::min(level, static_cast<int>(lods[m].size()) - 1);
+                if (k == level) present = true;
+                const MeshLod& lod = lods[m][k];
+                std::vector<unsigned int> combined(meshes[m].indices);
+                combined.insert(combined.end(), lodIndices[m].begin(), lodIndices[m].end());
+                const unsigned int* indices = combined.data() + lod.indexStart;
+                triangles += lod.indexCount / 3;
+                error = std::max(error, lod.error);
+                if (level == 0 || k != level) continue;
+
+                size_t vertexCount = meshes[m].vertices.size() / 8;
+                for (uint32_t i = 0; i < lod.indexCount; ++i) {
+                    if (indices[i] >= vertexCount) ok = false;
+                }
+                if (lod.indexCount >= lods[m][k - 1].indexCount) ok = false;
+                if (lod.error <= lods[m][k - 1].error) {
+                    std::cout << "  mesh " << m << " LOD " << level << ": error does not increase" << std::endl;
+                    ok = false;
+                }
+                if (openEdges(meshes[m].vertices.data(), indices, lod.indexCount) !=
+                    openEdges(meshes[m].vertices.data(), meshes[m].indices.data(), meshes[m].indices.size())) {
+                    std::cout << "  mesh " << m << " LOD " << level << ": open edges changed" << std::endl;
+                    ok = false;
+                }
+                float measured = measureDeviation(meshes[m], indices, lod.indexCount);
+                if (measured > lod.error * 1.0001f) {
+                    std::cout << "  mesh " << m << " LOD " << level << ": error " << lod.error << " below deviation "
+                              << measured << std::endl;
+                    ok = false;
+                }
+                deviation = std::max(deviation, measured);
+            }
+            if (!present) break;
+            float switchDistance = error * pixelsAtUnitDistance / pixelError;
+            if (level == 1 && switchDistance >= FAR_PLANE) {
+                std::cout << "  LOD 1 switches at " << switchDistance << " m, beyond the far plane" << std::endl;
+                ok = false;
+            }
+            std::cout << std::setw(6) << level << std::setw(12) << triangles << std::setw(8) << std::setprecision(1)
+                      << 100.0 * triangles / baseTriangles << "%" << std::setprecision(4) << std::setw(12) << error
+                      << std::setw(12) << deviation << std::setw(11) << std::setprecision(2)
+                      << switchDistance << "m" << std::endl;
+        }
+        std::cout << (ok ? "  ok" : "  FAILED") << std::endl;
+        if (!ok) failures++;
+    }
+
+    std::cout << std::endl << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,310 @@
+//  OBBBenchmark.cpp
+//  OBB（CollisionOBB.h）的測試吞吐量與旋轉家具的貼合程度
+//    吞吐量：OBB 對球體、OBB 對 AABB、OBB 對 OBB（分離軸定理），與 AABB 對球體比較
+//    貼合度：家具以 0.7 縮放並旋轉 30 度（與 Homework 相同），在包圍範圍內隨機放置攝影機大小的球體，
+//            以三角形 BVH 求出真正碰到網格表面的球，比較世界座標 AABB 與 OBB 的誤判（false positive）比例
+//    CollisionManager：旋轉的木頭方塊以 OBB 加入後，moveAndSlide 不應穿入，射線應停在 OBB 表面
+//  OBB 漏掉真正的接觸、誤判比 AABB 多，或結果與參考值不同時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      OBBBenchmark [--boxes N] [--queries N] [--samples N] [obj ...]
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/CollisionManager.h"
+#include "../common/CollisionOBB.h"
+#include "../common/CollisionProxy.h"
+#include "../common/CTriangleBVH.h"
+#include "../tiny_obj_loader.h"
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void printRow(const char* label, double ms, double tests, long long hits) {
+    std::cout << std::setw(16) << label << std::setw(12) << std::fixed << std::setprecision(3) << ms
+              << std::setw(14) << std::setprecision(1) << (tests / (ms * 1000.0)) << std::setw(12) << hits << std::endl;
+}
+
+static glm::mat3 randomRotation(std::mt19937& rng) {
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f), angle(0.0f, 6.2831853f);
+    glm::vec3 axis(u(rng), u(rng), u(rng));
+    if (glm::length(axis) < 1e-3f) axis = glm::vec3(0.0f, 1.0f, 0.0f);
+    return glm::mat3(glm::rotate(glm::mat4(1.0f), angle(rng), glm::normalize(axis)));
+}
+
+static int runThroughput(int boxes, int queries, unsigned seed) {
+    std::mt19937 rng(seed);
+    const float worldSize = 200.0f;
+    std::uniform_real_distribution<float> upos(0.0f, worldSize), usize(0.2f, 4.0f), uradius(0.3f, 2.0f);
+    std::vector<OBB> obbs(boxes);
+    std::vector<AABB> aabbs(boxes);
+    for (int i = 0; i < boxes; ++i) {
+        glm::vec3 center(upos(rng), upos(rng) * 0.1f, upos(rng));
+        obbs[i] = OBB(center, randomRotation(rng), glm::vec3(usize(rng), usize(rng), usize(rng)));
+        glm::vec3 bmin, bmax;
+        obbs[i].bounds(bmin, bmax);
+        aabbs[i] = AABB(bmin, bmax);
+    }
+    std::vector<Sphere> spheres(queries);
+    std::vector<OBB> queryBoxes(queries);
+    std::vector<AABB> queryAABBs(queries);
+    for (int q = 0; q < queries; ++q) {
+        glm::vec3 center(upos(rng), upos(rng) * 0.1f, upos(rng));
+        spheres[q] = Sphere(center, uradius(rng) * 4.0f);
+        queryBoxes[q] = OBB(center, randomRotation(rng), glm::vec3(usize(rng), usize(rng), usize(rng)) * 2.0f);
+        queryAABBs[q] = AABB(center - glm::vec3(usize(rng)) * 2.0f, center + glm::vec3(usize(rng)) * 2.0f);
+    }
+
+    double tests = static_cast<double>(boxes) * queries;
+    std::cout << "Throughput: " << boxes << " boxes x " << queries << " queries" << std::endl;
+    std::cout << std::setw(16) << "test" << std::setw(12) << "ms" << std::setw(14) << "Mtests/s" << std::setw(12)
+              << "hits" << std::endl;
+    long long aabbSphereHits = 0, obbSphereHits = 0, obbAABBHits = 0, obbOBBHits = 0;
+    double ms = measureMs([&] {
+        for (const Sphere& s : spheres)
+            for (const AABB& box : aabbs) aabbSphereHits += s.intersects(box);
+    });
+    printRow("AABB-sphere", ms, tests, aabbSphereHits);
+    ms = measureMs([&] {
+        for (const Sphere& s : spheres)
+            for (const OBB& box : obbs) obbSphereHits += box.intersectsSphere(s.center, s.radius);
+    });
+    printRow("OBB-sphere", ms, tests, obbSphereHits);
+    ms = measureMs([&] {
+        for (const AABB& q : queryAABBs)
+            for (const OBB& box : obbs) obbAABBHits += box.intersectsAABB(q.min, q.max);
+    });
+    printRow("OBB-AABB", ms, tests, obbAABBHits);
+    ms = measureMs([&] {
+        for (const OBB& q : queryBoxes)
+            for (const OBB& box : obbs) obbOBBHits += box.intersects(q);
+    });
+    printRow("OBB-OBB", ms, tests, obbOBBHits);
+
+    // 參考值：軸對齊的 OBB 必須與 AABB / Sphere 的結果相同；
+    // 一個盒子的角落在另一個盒子內時 SAT 必須回報相交；同時旋轉兩個形狀結果不變
+    int failures = 0;
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    for (int i = 0; i < 20000; ++i) {
+        const AABB& a = aabbs[i % boxes];
+        const AABB& b = queryAABBs[i % queries];
+        const Sphere& s = spheres[i % queries];
+        OBB oa = OBB::fromAABB(a.min, a.max);
+        if (oa.intersectsAABB(b.min, b.max) != a.intersects(b)) failures++;
+        glm::vec3 closest = glm::clamp(s.center, a.min, a.max);
+        float d = glm::length(s.center - closest);
+        if (std::fabs(d - s.radius) > 1e-3f && oa.intersectsSphere(s.center, s.radius) != s.intersects(a)) failures++;
+
+        const OBB& ob = obbs[i % boxes];
+        OBB oq = queryBoxes[i % queries];
+        oq.center = ob.center + (glm::vec3(u01(rng), u01(rng), u01(rng)) * 2.0f - 1.0f) * 4.0f;
+        bool sat = ob.intersects(oq);
+        for (int corner = 0; corner < 8 && !sat; ++corner) {
+            glm::vec3 local((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+            glm::vec3 p = oq.toWorld(local * oq.halfExtents * 0.999f);
+            glm::vec3 l = glm::abs(ob.toLocal(p));
+            if (l.x < ob.halfExtents.x && l.y < ob.halfExtents.y && l.z < ob.halfExtents.z) failures++;
+        }
+        if (sat != oq.intersects(ob)) failures++;
+        glm::mat4 spin = glm::rotate(glm::mat4(1.0f), 0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+        OBB ra = ob.transformed(spin), rb = oq.transformed(spin);
+        glm::vec3 rc = glm::vec3(spin * glm::vec4(s.center, 1.0f));
+        if (ra.intersects(rb) != sat && std::fabs(glm::length(ob.center - oq.center)) > 1e-3f) {
+            // 只在接近接觸的邊界上容許浮點誤差：把查詢盒縮放 1% 後兩者必須一致
+            OBB shrink = oq;
+            shrink.halfExtents *= 0.99f;
+            OBB grow = oq;
+            grow.halfExtents *= 1.01f;
+            if (ob.intersects(shrink) || !ob.intersects(grow)) failures++;
+        }
+        glm::vec3 local = ob.toLocal(s.center);
+        float distance = glm::length(local - glm::clamp(local, -ob.halfExtents, ob.halfExtents));
+        if (std::fabs(distance - s.radius) > 1e-3f && ra.intersectsSphere(rc, s.radius) != ob.intersectsSphere(s.center, s.radius))
+            failures++;
+    }
+    std::cout << "reference checks: " << failures << " mismatches" << std::endl << std::endl;
+    return failures;
+}
+
+// 所有 shape 的頂點與三角形
+static bool loadMesh(const std::string& path, std::vector<float>& vertices, std::vector<glm::vec3>& triangles) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            const tinyobj::real_t* p = &attrib.vertices[3 * index.vertex_index];
+            vertices.insert(vertices.end(), { static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]) });
+            triangles.push_back(glm::vec3(p[0], p[1], p[2]));
+        }
+    }
+    return !triangles.empty();
+}
+
+// 與 Homework::computeModelMatrix 相同的 0.7 縮放；木頭方塊繞 x 軸、其他家具繞 y 軸旋轉 30 度
+static glm::mat4 furnitureWorld(const std::string& path) {
+    glm::vec3 axis = (path.find("woodCube") != std::string::npos) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    return glm::rotate(glm::scale(glm::mat4(1.0f), glm::vec3(0.7f)), glm::radians(30.0f), axis);
+}
+
+struct FitResult {
+    long long aabbHits = 0, obbHits = 0, contacts = 0, misses = 0;
+};
+
+static int runFit(const std::vector<std::string>& paths, int samples) {
+    std::cout << "Rotated furniture fit: " << samples << " spheres (radius 0.3) per model" << std::endl;
+    std::cout << std::setw(26) << "model" << std::setw(10) << "OBB/AABB" << std::setw(10) << "contacts" << std::setw(11)
+              << "AABB hits" << std::setw(10) << "OBB hits" << std::setw(9) << "AABB FP" << std::setw(9) << "OBB FP"
+              << std::endl;
+    const float radius = 0.3f;
+    int failures = 0;
+    FitResult total;
+    for (const std::string& path : paths) {
+        std::vector<float> vertices;
+        std::vector<glm::vec3> triangles;
+        if (!loadMesh(path, vertices, triangles)) {
+            failures++;
+            continue;
+        }
+        CollisionProxy proxy;
+        proxy.build(vertices.data(), vertices.size() / 3, 3);
+        CTriangleBVH bvh;
+        bvh.build(triangles);
+
+        glm::mat4 world = furnitureWorld(path);
+        glm::mat4 invWorld = glm::inverse(world);
+        glm::vec3 bmin, bmax;
+        proxy.worldBounds(world, bmin, bmax);
+        AABB worldBox(bmin, bmax);
+        OBB worldOBB = proxy.box.transformed(world);
+        glm::vec3 size = bmax - bmin;
+        float fill = worldOBB.volume() / (size.x * size.y * size.z);
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+        glm::vec3 lo = bmin - glm::vec3(radius), hi = bmax + glm::vec3(radius);
+        FitResult result;
+        for (int i = 0; i < samples; ++i) {
+            glm::vec3 c = lo + (hi - lo) * glm::vec3(u01(rng), u01(rng), u01(rng));
+            bool aabbHit = Sphere(c, radius).intersects(worldBox);
+            bool obbHit = worldOBB.intersectsSphere(c, radius);
+            BVHSphereHit surface;
+            bool contact = bvh.closestPointInstance(world, invWorld, c, radius, surface) && surface.distance < radius;
+            result.aabbHits += aabbHit;
+            result.obbHits += obbHit;
+            result.contacts += contact;
+            // OBB 必須保守：碰到表面的球一定與 OBB 相交（容許接觸邊界上的誤差）
+            if (contact && !obbHit && surface.distance < radius - 1e-3f) result.misses++;
+        }
+        double aabbFP = result.aabbHits ? double(result.aabbHits - result.contacts) / result.aabbHits : 0.0;
+        double obbFP = result.obbHits ? double(result.obbHits - result.contacts) / result.obbHits : 0.0;
+        std::cout << std::setw(26) << path << std::setw(10) << std::setprecision(2) << fill << std::setw(10)
+                  << result.contacts << std::setw(11) << result.aabbHits << std::setw(10) << result.obbHits
+                  << std::setw(8) << std::setprecision(1) << aabbFP * 100.0 << "%" << std::setw(8) << obbFP * 100.0
+                  << "%" << std::endl;
+        if (result.misses > 0) {
+            std::cout << "  OBB missed " << result.misses << " surface contacts" << std::endl;
+            failures++;
+        }
+        if (result.obbHits > result.aabbHits) failures++;
+        total.aabbHits += result.aabbHits;
+        total.obbHits += result.obbHits;
+        total.contacts += result.contacts;
+    }
+    double aabbFP = total.aabbHits ? double(total.aabbHits - total.contacts) / total.aabbHits : 0.0;
+    double obbFP = total.obbHits ? double(total.obbHits - total.contacts) / total.obbHits : 0.0;
+    std::cout << "false positives: AABB " << std::setprecision(1) << aabbFP * 100.0 << "%, OBB " << obbFP * 100.0
+              << "% (" << (total.aabbHits - total.obbHits) << " fewer narrow-phase candidates)" << std::endl << std::endl;
+    if (total.obbHits >= total.aabbHits) failures++;
+    return failures;
+}
+
+// 旋轉 45 度的方塊：moveAndSlide 從四周射向中心，最後的位置不可與 OBB 重疊；射線交點必須在 OBB 擴張 radius 的表面上
+static int runManager(int moves) {
+    CollisionManager manager;
+    manager.setCollisionLogging(false);
+    manager.setWalls({});
+    glm::mat3 rotation(glm::rotate(glm::mat4(1.0f), glm::radians(45.0f), glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f))));
+    OBB cube(glm::vec3(0.0f, 2.0f, 0.0f), rotation, glm::vec3(2.0f, 1.0f, 1.5f));
+    manager.addObstacle(cube, "Rotated Cube");
+
+    const float radius = manager.getCameraRadius();
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    int penetrations = 0, rayErrors = 0, rayHits = 0;
+    for (int i = 0; i < moves; ++i) {
+        glm::vec3 dir(u(rng), u(rng), u(rng));
+        if (glm::length(dir) < 1e-3f) continue;
+        dir = glm::normalize(dir);
+        glm::vec3 start = cube.center + dir * 8.0f;
+        glm::vec3 target = cube.center + glm::vec3(u(rng), u(rng), u(rng)) * 0.5f;
+        glm::vec3 end = start + manager.moveAndSlide(start, (target - start) * 1.5f, radius);
+        if (cube.intersectsSphere(end, radius - 1e-3f)) penetrations++;
+
+        RaycastHit hit;
+        glm::vec3 rayDir = glm::normalize(target - start);
+        if (manager.raycastHit(start, rayDir, 100.0f, radius, hit)) {
+            rayHits++;
+            glm::vec3 local = glm::abs(cube.toLocal(hit.point));
+            glm::vec3 h = cube.halfExtents + glm::vec3(radius);
+            float surface = std::max(local.x - h.x, std::max(local.y - h.y, local.z - h.z));
+            if (hit.type != ColliderType::ORIENTED_OBSTACLE || std::fabs(surface) > 1e-3f) rayErrors++;
+        } else {
+            rayErrors++;
+        }
+    }
+    std::cout << "CollisionManager: " << moves << " moves into a rotated box, " << penetrations << " penetrations; "
+              << rayHits << " ray hits, " << rayErrors << " off-surface" << std::endl << std::endl;
+    return penetrations + rayErrors;
+}
+
+int main(int argc, char** argv) {
+    int boxes = 4096;
+    int queries = 1000;
+    int samples = 200000;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--boxes" && hasValue) boxes = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--queries" && hasValue) queries = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--samples" && hasValue) samples = std::max(1, std::atoi(argv[++i]));
+        else if (!arg.empty() && arg[0] != '-') paths.push_back(arg);
+        else {
+            std::cout << "Usage: OBBBenchmark [--boxes N] [--queries N] [--samples N] [obj ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) {
+        paths = { "models/livingRoomTable.obj", "models/sofa.obj", "models/bed.obj", "models/toilet.obj",
+                  "models/desk.obj", "models/woodCube.obj" };
+    }
+
+    int failures = runThroughput(boxes, queries, 1);
+    failures += runFit(paths, samples);
+    failures += runManager(2000);
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+//  ParticleBenchmark.cpp
+//  CParticleSystem：粒子數從 --min（預設 1000）每次乘 10 到 --max（預設 1000000），
+//  以一個每秒補充粒子的發射器維持數量（壽命 1 ~ 3 秒，一半受重力並在地面反彈），每個數量更新 --frames 個 frame
+//  輸出一般程式碼、SIMD 單執行緒、SIMD 多執行緒每次 update 的時間、每秒更新的粒子數，
+//  以及 CParticleRenderer 每個 frame 需要上傳的資料量
+//  檢查：SIMD 與一般程式碼、單執行緒與多執行緒的結果相同，以及 update 時不配置記憶體，失敗時回傳非 0
+//
+//      ParticleBenchmark [--min N] [--max N] [--frames F] [--threads T]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CParallel.h"
+#include "../common/CParticleSystem.h"
+
+// 計算配置次數，確認 update 時不配置記憶體
+static std::atomic<long> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 兩個發射器：受重力的火花與漂浮的灰塵，每秒補充的數量使總數維持在 count 附近
+static void setupSystem(CParticleSystem& system, int count) {
+    system.setFloor(0.0f, 0.4f, 0.7f);
+    ParticleEmitterDesc sparks;
+    sparks.position = glm::vec3(0.0f, 2.0f, 0.0f);
+    sparks.spread = 1.0f;
+    sparks.speedMin = 1.0f;
+    sparks.speedMax = 6.0f;
+    sparks.lifetimeMin = 1.0f;
+    sparks.lifetimeMax = 3.0f;
+    sparks.rate = count * 0.25f;
+    ParticleEmitterDesc dust = sparks;
+    dust.positionJitter = 3.0f;
+    dust.gravityScale = 0.0f;
+    dust.damping = 0.5f;
+    dust.speedMax = 0.5f;
+    dust.style = 1;
+    system.addStyle(ParticleStyle());
+    system.addStyle(ParticleStyle());
+    system.addEmitter(sparks);
+    system.addEmitter(dust);
+    system.emitBurst(sparks, count / 2);
+    system.emitBurst(dust, count - count / 2);
+}
+
+// 比較兩個系統的所有粒子
+static bool sameParticles(const CParticleSystem& a, const CParticleSystem& b, float& worst) {
+    worst = 0.0f;
+    if (a.getCount() != b.getCount()) return false;
+    for (int i = 0; i < a.getCount(); ++i) {
+        worst = std::max(worst, glm::length(a.getPosition(i) - b.getPosition(i)));
+        worst = std::max(worst, std::fabs(a.getAge()[i] - b.getAge()[i]));
+    }
+    return worst < 1e-4f;
+}
+
+static int checkResults(int threads) {
+    const int count = 20000;
+    CThreadPool threadPool(threads);
+    CParticleSystem scalar(count), simd(count), parallel(count);
+    scalar.setSimdEnabled(false);
+    scalar.setThreadCount(1);
+    simd.setThreadCount(1);
+    parallel.setThreadPool(&threadPool);
+    parallel.setThreadCount(threads);
+    for (CParticleSystem* system : { &scalar, &simd, &parallel }) {
+        setupSystem(*system, count);
+        for (int f = 0; f < 180; ++f) system->update(1.0f / 60.0f);
+    }
+    float simdError = 0.0f, threadError = 0.0f;
+    bool simdOk = sameParticles(scalar, simd, simdError);
+    bool threadOk = sameParticles(simd, parallel, threadError);
+    bool aboveFloor = true;
+    for (int i = 0; i < simd.getCount(); ++i) aboveFloor = aboveFloor && simd.getPosition(i).y >= 0.0f;
+    bool ok = simdOk && threadOk && aboveFloor;
+    std::cout << "  3 s with " << count << " particles: " << simd.getCount() << " alive, SIMD vs scalar error "
+              << simdError << ", 1 vs " << threads << " threads error " << threadError
+              << (aboveFloor ? "" : ", particles below the floor") << (ok ? "  ok" : "  FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// 回傳平均每次 update 的毫秒數
+static double runFrames(CParticleSystem& system, int frames, long& allocations) {
+    long before = g_allocations.load();
+    double ms = measureMs([&] {
+        for (int f = 0; f < frames; ++f) system.update(1.0f / 60.0f);
+    });
+    allocations += g_allocations.load() - before;
+    return ms / frames;
+}
+
+int main(int argc, char** argv) {
+    int minCount = 1000, maxCount = 1000000, frames = 120;
+    int threads = hardwareThreadCount();
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--min" && hasValue) minCount = std::max(4, std::atoi(argv[++i]));
+        else if (arg == "--max" && hasValue) maxCount = std::max(4, std::atoi(argv[++i]));
+        else if (arg == "--frames" && hasValue) frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: ParticleBenchmark [--min N] [--max N] [--frames F] [--threads T]" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "ParticleBenchmark: " << frames << " frames per size, " << threads << " threads" << std::endl;
+
+    // 單執行緒與多執行緒的比較至少使用 2 個執行緒，單核心的機器上也會走過多執行緒的路徑
+    int failures = checkResults(std::max(2, threads));
+
+    std::cout << std::setw(10) << "particles" << std::setw(12) << "scalar ms" << std::setw(10) << "SIMD ms"
+              << std::setw(10) << "speedup" << std::setw(12) << "threads ms" << std::setw(14) << "M particles/s"
+              << std::setw(12) << "upload KB" << std::endl;
+    CThreadPool threadPool(threads);
+    long allocations = 0;
+    for (long long size = minCount; size <= maxCount; size *= 10) {
+        int count = static_cast<int>(size);
+        CParticleSystem scalar(count), simd(count), parallel(count);
+        scalar.setSimdEnabled(false);
+        scalar.setThreadCount(1);
+        simd.setThreadCount(1);
+        parallel.setThreadPool(&threadPool);
+        parallel.setThreadCount(threads);
+        setupSystem(scalar, count);
+        setupSystem(simd, count);
+        setupSystem(parallel, count);
+        double scalarMs = runFrames(scalar, frames, allocations);
+        double simdMs = runFrames(simd, frames, allocations);
+        double parallelMs = runFrames(parallel, frames, allocations);
+        double best = std::min(simdMs, parallelMs);
+        // 位置、年齡各 4 位元組，style 1 位元組
+        double uploadKB = simd.getCount() * (4.0 * 4.0 + 1.0) / 1024.0;
+        std::cout << std::setw(10) << count << std::fixed << std::setprecision(3) << std::setw(12) << scalarMs
+                  << std::setw(10) << simdMs << std::setw(10) << std::setprecision(2) << scalarMs / simdMs
+                  << std::setw(12) << std::setprecision(3) << parallelMs << std::setw(14) << std::setprecision(1)
+                  << simd.getCount() / (best * 1000.0) << std::setw(12) << uploadKB << std::endl;
+    }
+    std::cout << "  " << allocations << " allocations during updates" << (allocations == 0 ? "  ok" : "  FAILED") << std::endl;
+    if (allocations != 0) failures++;
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+//  ProbeBaker.cpp
+//  烘焙 Irradiance Volume：在房間的包圍盒內每隔 spacing 放一個探針，
+//  以路徑追蹤取得各方向的光（與 LightmapBaker 相同的固定光源與間接光），投影到 L2 球諧函數
+//  輸出 models/irradiance.irr，執行時由 CIrradianceVolume 讀取，給移動的物件使用
+//
+//  在 3DRoom 目錄下執行：
+//      ProbeBaker [--threads N] [--samples S] [--bounces B] [--spacing D] [--out path]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "../common/CBakeScene.h"
+#include "../common/CIrradianceVolume.h"
+#include "../common/CParallel.h"
+#include "BakeSceneSetup.h"
+
+#define MAX_GRID_DIM 64
+
+struct ProbeSettings {
+    int   threads = hardwareThreadCount();
+    int   samples = 256;        // 每個探針的方向取樣數
+    int   bounces = 2;
+    float spacing = 2.0f;       // 探針間距（世界座標）
+    std::string output = "models/irradiance.irr";
+};
+
+// 探針 p 的球諧係數；超過 1/4 的光線打到背面時，視為在牆壁或物體內部
+static void bakeProbe(const CBakeScene& scene, const glm::vec3& p, const ProbeSettings& settings,
+                      uint32_t seed, IrradianceProbe& out) {
+    BakeRandom rng(seed);
+    float basis[SH_COEFF_COUNT];
+    glm::vec3 sh[SH_COEFF_COUNT];
+    for (int i = 0; i < SH_COEFF_COUNT; i++) sh[i] = glm::vec3(0.0f);
+
+    // 1. 間接光：球面上均勻取樣，每個方向看到的表面輻射度
+    //    Light Map 的間接光是以餘弦平均（E / pi）儲存的，這裡同樣除以 pi
+    int backfaces = 0;
+    float weight = 4.0f * 3.141593f / settings.samples / 3.141593f;
+    for (int s = 0; s < settings.samples; s++) {
+        float z = 1.0f - 2.0f * rng.nextFloat();
+        float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        float phi = 6.2831853f * rng.nextFloat();
+        glm::vec3 dir(r * std::cos(phi), r * std::sin(phi), z);
+
+        BVHHit hit;
+        int tri;
+        if (scene.intersect(p, dir, 1e30f, hit, tri) &&
+            glm::dot(scene.getTriangles()[tri].faceNormal, dir) > 0.0f) {
+            backfaces++;
+            continue;
+        }
+        glm::vec3 radiance = scene.traceRadiance(p, dir, settings.bounces, rng);
+        CIrradianceVolume::evalBasis(dir, basis);
+        for (int i = 0; i < SH_COEFF_COUNT; i++) sh[i] += radiance * (basis[i] * weight);
+    }
+
+    // 2. 直接光：點光源視為方向上的 delta，卷積後 E(n) = diffuse * atten * max(0, n.L)，與 f_phong 相同
+    for (const BakeLight& light : scene.getLights()) {
+        glm::vec3 toLight = light.position - p;
+        float dist = glm::length(toLight);
+        if (dist < 1e-4f) continue;
+        glm::vec3 L = toLight / dist;
+        if (scene.getBVH().occluded(p, L, dist - 1e-3f)) continue;
+        float attenuation = 1.0f / (light.constant + light.linear * dist + light.quadratic * dist * dist);
+        CIrradianceVolume::evalBasis(L, basis);
+        for (int i = 0; i < SH_COEFF_COUNT; i++) sh[i] += light.diffuse * (attenuation * basis[i]);
+    }
+
+    CIrradianceVolume::convolveCosine(sh);
+    for (int i = 0; i < SH_COEFF_COUNT; i++) out.sh[i] = sh[i];
+    out.valid = (backfaces < settings.samples / 4);
+}
+
+int main(int argc, char** argv) {
+    ProbeSettings settings;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--threads" && hasValue) settings.threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--samples" && hasValue) settings.samples = std::max(16, std::atoi(argv[++i]));
+        else if (arg == "--bounces" && hasValue) settings.bounces = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--spacing" && hasValue) settings.spacing = std::max(0.25f, (float)std::atof(argv[++i]));
+        else if (arg == "--out" && hasValue) settings.output = argv[++i];
+        else {
+            std::cout << "Usage: ProbeBaker [--threads N] [--samples S] [--bounces B] [--spacing D] [--out path]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    CBakeScene scene;
+    int instances[BAKE_STATIC_MODELS];
+    setupStaticBakeScene(scene, instances);
+
+    // 格點範圍：房間（models[0]）的包圍盒
+    glm::vec3 bmin(1e30f), bmax(-1e30f);
+    for (const BakeTriangle& tri : scene.getTriangles()) {
+        if (tri.instance != instances[0]) continue;
+        for (int i = 0; i < 3; i++) {
+            bmin = glm::min(bmin, tri.p[i]);
+            bmax = glm::max(bmax, tri.p[i]);
+        }
+    }
+    if (bmin.x > bmax.x) {
+        std::cerr << "Room model not loaded" << std::endl;
+        return 1;
+    }
+    glm::vec3 extent = bmax - bmin;
+    glm::ivec3 dims(std::min(MAX_GRID_DIM, (int)std::ceil(extent.x / settings.spacing) + 1),
+                    std::min(MAX_GRID_DIM, (int)std::ceil(extent.y / settings.spacing) + 1),
+                    std::min(MAX_GRID_DIM, (int)std::ceil(extent.z / settings.spacing) + 1));
+    // 維度被限制時加大間距，仍然覆蓋整個範圍
+    float spacing = settings.spacing;
+    for (int a = 0; a < 3; a++) {
+        if (dims[a] > 1) spacing = std::max(spacing, extent[a] / (dims[a] - 1));
+    }
+
+    CIrradianceVolume volume;
+    volume.create(dims, bmin, spacing);
+    int count = volume.getProbeCount();
+    std::cout << "Probe grid " << dims.x << "x" << dims.y << "x" << dims.z << " = " << count
+              << " probes, spacing " << spacing << ", " << settings.samples << " samples, "
+              << settings.threads << " threads" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    parallelFor(0, count, settings.threads, 4, [&](int i) {
+        int x = i % dims.x;
+        int y = (i / dims.x) % dims.y;
+        int z = i / (dims.x * dims.y);
+        bakeProbe(scene, volume.probePosition(x, y, z), settings,
+                  static_cast<uint32_t>(i) * 2654435761u + 1u, volume.probe(x, y, z));
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int valid = 0;
+    for (int z = 0; z < dims.z; z++)
+        for (int y = 0; y < dims.y; y++)
+            for (int x = 0; x < dims.x; x++)
+                if (volume.probe(x, y, z).valid) valid++;
+    std::cout << "Baked " << count << " probes (" << valid << " valid) in " << seconds << " s" << std::endl;
+
+    if (!volume.save(settings.output)) return 1;
+    std::cout << "Wrote " << settings.output << " (" << (24 + count * (2 + SH_COEFF_COUNT * 3 * 2))
+              << " bytes)" << std::endl;
+    return 0;
+}
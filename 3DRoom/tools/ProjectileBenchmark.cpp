@@ -0,0 +1,256 @@
+//  ProjectileBenchmark.cpp
+//  CProjectilePool：RoomGrid 的 4 x 4 個房間（有門、家具的 AABB 與旋轉的柱子 OBB）內維持 --count 個投射物（預設 100000），
+//  每個 frame 以 1/60 秒前進、取出打中的事件，並補上被移除的投射物；每秒輸出投射物數、每個 frame 的事件數與 update 的時間
+//  檢查：30 步的結果與逐條 raycastHit 相同（高速的投射物也不會穿過牆壁）、單執行緒與多執行緒的結果相同、
+//  沒有投射物飛出房間、事件佇列沒有丟棄，以及每一秒 update 的平均時間與所有 update 的 99 百分位數
+//  都在 60 Hz 的 frame 內（16.7 ms），失敗時回傳非 0；距離格點在計時之前建立，另外輸出建立的時間
+//
+//      ProjectileBenchmark [--count N] [--seconds S] [--threads T] [--seed S]
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/CollisionManager.h"
+#include "../common/CParallel.h"
+#include "../common/CProjectilePool.h"
+#include "../common/RoomGrid.h"
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 在隨機的房間內（不貼著牆）以隨機方向發射，一半受重力
+struct Spawner {
+    const RoomGrid& grid;
+    const RoomGridConfig& config;
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> u01{ 0.0f, 1.0f };
+    uint32_t nextTag = 0;
+
+    Spawner(const RoomGrid& g, const RoomGridConfig& c, unsigned seed) : grid(g), config(c), rng(seed) {}
+
+    ProjectileDesc next(float minSpeed, float maxSpeed) {
+        glm::vec3 center = grid.roomCenters[rng() % grid.roomCenters.size()];
+        glm::vec3 extent(config.roomX, config.roomY, config.roomZ);
+        ProjectileDesc desc;
+        desc.position = center + (glm::vec3(u01(rng), u01(rng), u01(rng)) - 0.5f) * extent * 0.7f;
+        float z = u01(rng) * 2.0f - 1.0f, a = u01(rng) * 6.2831853f, r = std::sqrt(1.0f - z * z);
+        desc.velocity = glm::vec3(r * std::cos(a), z, r * std::sin(a)) * (minSpeed + (maxSpeed - minSpeed) * u01(rng));
+        desc.lifetime = 5.0f;
+        desc.gravityScale = (u01(rng) < 0.5f) ? 0.0f : 1.0f;
+        desc.tag = nextTag++;
+        return desc;
+    }
+};
+
+// 與逐條 raycastHit 比對 30 步：打中的投射物要在同一步產生相同碰撞體、位置的事件，其餘的投射物前進完整的一步
+// （離碰撞體很遠、跳過碰撞偵測的投射物之後也要在同一步打中）
+static int checkAgainstScalar(CollisionManager& world, Spawner& spawner, int threads) {
+    const int count = 8192, steps = 30;
+    const float dt = 1.0f / 60.0f;
+    CThreadPool threadPool(threads);
+    CProjectilePool pool(count);
+    pool.setThreadPool(&threadPool);
+    pool.setThreadCount(threads);
+    pool.setGravity(glm::vec3(0.0f));
+    std::vector<glm::vec3> position(count), move(count);
+    std::vector<bool> alive(count, true);
+    for (int i = 0; i < count; ++i) {
+        // 最快 300 m/s：一步 5 m，超過牆的厚度
+        ProjectileDesc desc = spawner.next(10.0f, 300.0f);
+        desc.tag = static_cast<uint32_t>(i);
+        position[i] = desc.position;
+        move[i] = desc.velocity * dt;
+        pool.spawn(desc);
+    }
+
+    std::vector<int> expectedId(count);
+    std::vector<ColliderType> expectedType(count);
+    std::vector<glm::vec3> expectedPoint(count);
+    int expectedHits = 0, events = 0, mismatched = 0;
+    for (int step = 0; step < steps; ++step) {
+        pool.update(dt, world);
+        std::fill(expectedId.begin(), expectedId.end(), -1);
+        std::fill(expectedType.begin(), expectedType.end(), ColliderType::NONE);
+        for (int i = 0; i < count; ++i) {
+            if (!alive[i]) continue;
+            RaycastHit hit;
+            if (!world.raycastHit(position[i], move[i], 1.0f, 0.0f, hit)) {
+                position[i] += move[i];
+                continue;
+            }
+            expectedId[i] = hit.colliderId;
+            expectedType[i] = hit.type;
+            expectedPoint[i] = hit.point;
+            alive[i] = false;
+            expectedHits++;
+        }
+        ProjectileHit hit;
+        while (pool.popHit(hit)) {
+            events++;
+            int i = static_cast<int>(hit.tag);
+            if (hit.type != expectedType[i] || hit.colliderId != expectedId[i] ||
+                glm::length(hit.position - expectedPoint[i]) > 1e-3f) {
+                mismatched++;
+            }
+        }
+    }
+    bool ok = events == expectedHits && mismatched == 0 && pool.getCount() == count - expectedHits;
+    std::cout << "  vs raycastHit: " << expectedHits << " hits of " << count << " in " << steps << " steps, " << events
+              << " events, " << mismatched << " mismatched, " << pool.getCount() << " left" << (ok ? "  ok" : "  FAILED")
+              << std::endl;
+    return ok ? 0 : 1;
+}
+
+// 相同的投射物以 1 個與 threads 個執行緒各前進 2 秒，剩下的投射物（位置）與事件數要相同
+static int checkThreads(CollisionManager& world, const RoomGrid& grid, const RoomGridConfig& config,
+                        unsigned seed, int threads) {
+    CThreadPool threadPool(std::max(2, threads));
+    CProjectilePool single(50000), multi(50000);
+    single.setThreadCount(1);
+    multi.setThreadPool(&threadPool);
+    multi.setThreadCount(threadPool.getThreadCount());
+    Spawner a(grid, config, seed), b(grid, config, seed);
+    for (int i = 0; i < 50000; ++i) {
+        single.spawn(a.next(5.0f, 60.0f));
+        multi.spawn(b.next(5.0f, 60.0f));
+    }
+    int singleEvents = 0, multiEvents = 0;
+    ProjectileHit hit;
+    for (int s = 0; s < 120; ++s) {
+        single.update(1.0f / 60.0f, world);
+        multi.update(1.0f / 60.0f, world);
+        while (single.popHit(hit)) singleEvents++;
+        while (multi.popHit(hit)) multiEvents++;
+    }
+    bool same = single.getCount() == multi.getCount() && singleEvents == multiEvents;
+    for (int i = 0; same && i < single.getCount(); ++i) {
+        same = single.getPosition(i) == multi.getPosition(i);
+    }
+    std::cout << "  1 vs " << multi.getThreadCount() << " threads: " << single.getCount() << " / " << multi.getCount()
+              << " left, " << singleEvents << " / " << multiEvents << " events" << (same ? "  ok" : "  FAILED")
+              << std::endl;
+    return same ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    int count = 100000;
+    float seconds = 10.0f;
+    int threads = hardwareThreadCount();
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--count" && hasValue) count = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seconds" && hasValue) seconds = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue) seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: ProjectileBenchmark [--count N] [--seconds S] [--threads T] [--seed S]" << std::endl;
+            return 1;
+        }
+    }
+
+    // 家具以桌子、沙發、床大小的方塊代替；每個房間中央一根旋轉 45 度的柱子（OBB）
+    RoomGridConfig config;
+    config.cols = 4;
+    config.rows = 4;
+    config.furniturePerRoom = 4;
+    config.seed = seed;
+    std::vector<FurnitureFootprint> footprints = {
+        { 1, glm::vec3(-3.0f, 0.0f, -2.0f), glm::vec3(3.0f, 2.5f, 2.0f), 0.7f },
+        { 2, glm::vec3(-8.0f, 0.0f, -3.5f), glm::vec3(8.0f, 7.0f, 3.5f), 0.7f },
+        { 3, glm::vec3(-6.0f, 0.0f, -8.0f), glm::vec3(6.0f, 5.0f, 8.0f), 0.7f },
+    };
+    RoomGrid grid = generateRoomGrid(config, footprints);
+    CollisionManager world;
+    world.setWalls(grid.walls);
+    for (const auto& furniture : grid.furniture) world.addObstacle(AABB(furniture.worldMin, furniture.worldMax, "Furniture"));
+    glm::mat3 rotation(glm::rotate(glm::mat4(1.0f), glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    for (const glm::vec3& center : grid.roomCenters) world.addObstacle(OBB(center, rotation, glm::vec3(0.6f, config.roomY * 0.5f, 0.6f)), "Pillar");
+    glm::vec3 worldMin(FLT_MAX), worldMax(-FLT_MAX);
+    for (const AABB& wall : grid.walls) {
+        worldMin = glm::min(worldMin, wall.min);
+        worldMax = glm::max(worldMax, wall.max);
+    }
+    // 距離格點在第一次 update 時建立，這裡先建立並分開計時
+    double gridMs = measureMs([&] { world.prepareClearance(); });
+    std::cout << "ProjectileBenchmark: " << grid.roomCenters.size() << " rooms, " << grid.walls.size() << " walls, "
+              << world.getObstacleCount() << " obstacles, " << world.getOrientedObstacleCount() << " OBBs, "
+              << threads << " threads, distance grid " << std::fixed << std::setprecision(1) << gridMs << " ms"
+              << std::defaultfloat << std::endl;
+
+    Spawner spawner(grid, config, seed);
+    int failures = checkAgainstScalar(world, spawner, threads);
+    failures += checkThreads(world, grid, config, seed + 1, threads);
+
+    // 維持 count 個投射物：每個 frame 取出事件後補上打中或時間到的投射物
+    CThreadPool threadPool(threads);
+    CProjectilePool pool(count);
+    pool.setThreadPool(&threadPool);
+    pool.setThreadCount(threads);
+    for (int i = 0; i < count; ++i) pool.spawn(spawner.next(5.0f, 60.0f));
+    std::cout << std::setw(8) << "t (s)" << std::setw(10) << "active" << std::setw(12) << "hits/frame"
+              << std::setw(12) << "ms/update" << std::setw(10) << "max ms" << std::endl;
+    const int framesPerSecond = 60;
+    const int totalFrames = static_cast<int>(seconds * framesPerSecond);
+    double totalMs = 0.0, peakMs = 0.0, secondMs = 0.0, secondMax = 0.0, worstSecondMs = 0.0;
+    long long secondHits = 0, totalHits = 0;
+    std::vector<double> frameMs;
+    frameMs.reserve(totalFrames);
+    ProjectileHit hit;
+    for (int f = 1; f <= totalFrames; ++f) {
+        double ms = measureMs([&] { pool.update(1.0f / framesPerSecond, world); });
+        frameMs.push_back(ms);
+        totalMs += ms;
+        peakMs = std::max(peakMs, ms);
+        secondMs += ms;
+        secondMax = std::max(secondMax, ms);
+        int active = pool.getCount();
+        while (pool.popHit(hit)) secondHits++;
+        if (f % framesPerSecond == 0) {
+            std::cout << std::setw(8) << f / framesPerSecond << std::setw(10) << active << std::setw(12)
+                      << secondHits / framesPerSecond << std::setw(12) << std::fixed << std::setprecision(3)
+                      << secondMs / framesPerSecond << std::setw(10) << secondMax << std::endl;
+            totalHits += secondHits;
+            worstSecondMs = std::max(worstSecondMs, secondMs / framesPerSecond);
+            secondHits = 0;
+            secondMs = secondMax = 0.0;
+        }
+        while (pool.getCount() < count) pool.spawn(spawner.next(5.0f, 60.0f));
+    }
+
+    int escaped = 0;
+    for (int i = 0; i < pool.getCount(); ++i) {
+        glm::vec3 p = pool.getPosition(i);
+        for (int k = 0; k < 3; ++k) {
+            if (p[k] < worldMin[k] || p[k] > worldMax[k]) { escaped++; break; }
+        }
+    }
+    double avgMs = totalMs / totalFrames;
+    std::sort(frameMs.begin(), frameMs.end());
+    double p99Ms = frameMs[std::min(frameMs.size() - 1, frameMs.size() * 99 / 100)];
+    const double frameBudgetMs = 1000.0 / 60.0;
+    std::cout << "  " << count << " projectiles: avg " << std::setprecision(3) << avgMs << " ms, worst second "
+              << worstSecondMs << " ms, p99 " << p99Ms << " ms, max " << peakMs << " ms per update on "
+              << threadPool.getThreadCount() << " threads (60 Hz budget " << frameBudgetMs << " ms), " << totalHits
+              << " hits, dropped " << pool.getDroppedHits() << ", escaped " << escaped << std::endl;
+    if (escaped > 0 || pool.getDroppedHits() > 0 || worstSecondMs > frameBudgetMs || p99Ms > frameBudgetMs) failures++;
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+//  RigidBodyBenchmark.cpp
+//  CRigidBodyPool：一個封閉房間（RoomGrid 的 1 x 1）內 10000 個球與方塊從空中落下到全部靜止
+//  每秒輸出未睡眠的物體數、broadphase 配對數與每一步的時間；物體睡眠後每一步的時間應接近 0
+//  檢查 sweep-and-prune 的配對與暴力比對相同、沒有物體穿出房間、在時限內靜止，
+//  以及 spawnChunks 的碎片數與容量上限，失敗時回傳非 0
+//
+//      RigidBodyBenchmark [--bodies N] [--seconds S] [--seed S]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CollisionManager.h"
+#include "../common/CRigidBodyPool.h"
+#include "../common/RoomGrid.h"
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 暴力比對：包圍盒重疊、至少一個未睡眠的配對
+static void bruteForcePairs(const CRigidBodyPool& pool, std::vector<std::pair<int, int>>& pairs) {
+    pairs.clear();
+    const std::vector<int>& active = pool.getActiveBodies();
+    std::vector<glm::vec3> bmin(active.size()), bmax(active.size());
+    for (size_t i = 0; i < active.size(); ++i) pool.getBounds(active[i], bmin[i], bmax[i]);
+    for (size_t i = 0; i < active.size(); ++i) {
+        for (size_t j = i + 1; j < active.size(); ++j) {
+            if (pool.isSleeping(active[i]) && pool.isSleeping(active[j])) continue;
+            bool overlap = true;
+            for (int k = 0; k < 3; ++k) overlap = overlap && bmin[i][k] <= bmax[j][k] && bmin[j][k] <= bmax[i][k];
+            if (overlap) {
+                pairs.push_back({ std::min(active[i], active[j]), std::max(active[i], active[j]) });
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+}
+
+static int checkPairs(CRigidBodyPool& pool, const char* label) {
+    std::vector<std::pair<int, int>> sap, brute;
+    pool.findPairs(sap);
+    bruteForcePairs(pool, brute);
+    bool same = (sap == brute);
+    std::cout << "  broadphase (" << label << "): " << sap.size() << " pairs, brute force " << brute.size()
+              << (same ? "  ok" : "  MISMATCH") << std::endl;
+    return same ? 0 : 1;
+}
+
+// 物體中心都在房間內（留一點穿透的容許量）
+static int countEscaped(const CRigidBodyPool& pool, const glm::vec3& roomMin, const glm::vec3& roomMax) {
+    int escaped = 0;
+    for (int body : pool.getActiveBodies()) {
+        glm::vec3 p = pool.getPosition(body);
+        for (int k = 0; k < 3; ++k) {
+            if (p[k] < roomMin[k] - 0.1f || p[k] > roomMax[k] + 0.1f) { escaped++; break; }
+        }
+    }
+    return escaped;
+}
+
+int main(int argc, char** argv) {
+    int bodies = 10000;
+    float seconds = 20.0f;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--bodies" && hasValue) bodies = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--seconds" && hasValue) seconds = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        else if (arg == "--seed" && hasValue) seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else {
+            std::cout << "Usage: RigidBodyBenchmark [--bodies N] [--seconds S] [--seed S]" << std::endl;
+            return 1;
+        }
+    }
+
+    // 單一房間沒有門，物體不會滾到別的房間
+    RoomGridConfig config;
+    config.cols = 1;
+    config.rows = 1;
+    RoomGrid grid = generateRoomGrid(config);
+    CollisionManager world;
+    world.setWalls(grid.walls);
+    glm::vec3 center = grid.roomCenters[0];
+    glm::vec3 roomMin = center - glm::vec3(config.roomX, config.roomY, config.roomZ) * 0.5f;
+    glm::vec3 roomMax = center + glm::vec3(config.roomX, config.roomY, config.roomZ) * 0.5f;
+
+    // 物體排成 25 x 25 的格子一層一層往上疊，大小與形狀隨機，帶一點水平速度
+    CRigidBodyPool pool(bodies + 64);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    const int side = 25;
+    const float spacing = 0.9f;
+    for (int i = 0; i < bodies; ++i) {
+        int x = i % side, z = (i / side) % side, layer = i / (side * side);
+        RigidBodyDesc desc;
+        desc.shape = (u01(rng) < 0.5f) ? RigidBodyShape::SPHERE : RigidBodyShape::BOX;
+        desc.halfExtents = glm::vec3(0.15f + 0.15f * u01(rng), 0.15f + 0.15f * u01(rng), 0.15f + 0.15f * u01(rng));
+        desc.position = glm::vec3(center.x + (x - side / 2) * spacing, roomMin.y + 1.0f + layer * spacing,
+                                  center.z + (z - side / 2) * spacing);
+        desc.velocity = glm::vec3(u01(rng) - 0.5f, 0.0f, u01(rng) - 0.5f) * 2.0f;
+        desc.mass = 8.0f * desc.halfExtents.x * desc.halfExtents.y * desc.halfExtents.z;
+        pool.spawn(desc);
+    }
+    std::cout << "RigidBodyBenchmark: " << pool.getActiveCount() << " bodies, room " << grid.walls.size()
+              << " walls" << std::endl;
+
+    int failures = checkPairs(pool, "spawn");
+    std::cout << std::setw(8) << "t (s)" << std::setw(10) << "awake" << std::setw(10) << "pairs" << std::setw(10)
+              << "contacts" << std::setw(10) << "world" << std::setw(12) << "ms/step" << std::setw(10) << "max ms"
+              << std::endl;
+    const int stepsPerSecond = 60;
+    const int totalSteps = static_cast<int>(seconds * stepsPerSecond);
+    const int settledAwake = std::max(1, bodies / 100);
+    double peakMs = 0.0, secondMs = 0.0, secondMax = 0.0;
+    float settleTime = -1.0f;
+    for (int s = 1; s <= totalSteps; ++s) {
+        double ms = measureMs([&] { pool.step(RIGID_BODY_TIME_STEP, world); });
+        peakMs = std::max(peakMs, ms);
+        secondMs += ms;
+        secondMax = std::max(secondMax, ms);
+        const RigidBodyStats& stats = pool.getStats();
+        if (s == 30) failures += checkPairs(pool, "falling");
+        if (settleTime < 0.0f && stats.awake < settledAwake) settleTime = s / static_cast<float>(stepsPerSecond);
+        if (s % stepsPerSecond == 0) {
+            std::cout << std::setw(8) << s / stepsPerSecond << std::setw(10) << stats.awake << std::setw(10)
+                      << stats.pairs << std::setw(10) << stats.contacts << std::setw(10) << stats.worldContacts
+                      << std::setw(12) << std::fixed << std::setprecision(3) << secondMs / stepsPerSecond
+                      << std::setw(10) << secondMax << std::endl;
+            secondMs = secondMax = 0.0;
+        }
+        if (settleTime >= 0.0f && stats.awake == 0) break;
+    }
+    failures += checkPairs(pool, "settled");
+
+    // 全部（或幾乎全部）睡眠之後的花費
+    double idleMs = measureMs([&] {
+        for (int s = 0; s < stepsPerSecond; ++s) pool.step(RIGID_BODY_TIME_STEP, world);
+    }) / stepsPerSecond;
+    int escaped = countEscaped(pool, roomMin, roomMax);
+    bool settled = settleTime >= 0.0f;
+    bool idleCheap = idleMs < peakMs * 0.05;
+    std::cout << "  settled (< " << settledAwake << " awake): " << (settled ? std::to_string(settleTime) + " s" : "no")
+              << ", idle " << std::setprecision(4) << idleMs << " ms/step vs peak " << peakMs << " ms, escaped "
+              << escaped << std::endl;
+    if (!settled || !idleCheap || escaped > 0) failures++;
+
+    // 打壞家具：地板上 2 x 1 x 1 的箱子切成 4 x 2 x 4 個碎片，從中心向外飛散，落在靜止的物體上並喚醒附近的物體
+    int before = pool.getActiveCount();
+    glm::vec3 propMin(center.x - 1.0f, roomMin.y + 1.0f, center.z - 0.5f), propMax = propMin + glm::vec3(2.0f, 1.0f, 1.0f);
+    glm::vec3 propCenter = (propMin + propMax) * 0.5f;
+    int chunks = pool.spawnChunks(propMin, propMax, glm::ivec3(4, 2, 4), propCenter, 3.0f);
+    int woken = pool.wakeInRadius(propCenter, 2.0f);
+    for (int s = 0; s < 5 * stepsPerSecond; ++s) pool.step(RIGID_BODY_TIME_STEP, world);
+    int chunkEscaped = countEscaped(pool, roomMin, roomMax);
+    CRigidBodyPool small(10);
+    int partial = small.spawnChunks(glm::vec3(0.0f), glm::vec3(1.0f), glm::ivec3(4), glm::vec3(0.5f), 1.0f);
+    bool chunksOk = chunks == 32 && pool.getActiveCount() == before + 32 && pool.getStats().awake < settledAwake &&
+                    chunkEscaped == 0 && partial == 10 && small.spawn(RigidBodyDesc()) == -1;
+    std::cout << "  spawnChunks: " << chunks << " chunks, woke " << woken << ", awake after 5 s "
+              << pool.getStats().awake << ", escaped " << chunkEscaped
+              << ", full pool " << partial << "/64" << (chunksOk ? "  ok" : "  FAILED") << std::endl;
+    if (!chunksOk) failures++;
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+//  TriangleBVHBenchmark.cpp
+//  CTriangleBVH 的建立時間與查詢吞吐量：中位數切開與分箱 SAH、單執行緒與多執行緒建立
+//  射線從模型包圍球外射向包圍盒內的隨機點（與 Model::Raycast 相同，以實體矩陣在查詢時轉換），
+//  球體查詢以包圍盒內的隨機點為球心；SAH 與中位數的結果必須相同，否則回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      TriangleBVHBenchmark [--rays N] [--threads N] [obj ...]    （預設 models/robot.obj models/sofa.obj）
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../common/CParallel.h"
+#include "../common/CTriangleBVH.h"
+#include "../tiny_obj_loader.h"
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 所有 shape 的三角形（每三個頂點一個）
+static bool loadTriangles(const std::string& path, std::vector<glm::vec3>& positions) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            const float* p = &attrib.vertices[3 * index.vertex_index];
+            positions.push_back(glm::vec3(p[0], p[1], p[2]));
+        }
+    }
+    return !positions.empty();
+}
+
+static int runModel(const std::string& path, int rays, int threads) {
+    std::vector<glm::vec3> positions;
+    if (!loadTriangles(path, positions)) return 1;
+    glm::vec3 bmin(FLT_MAX), bmax(-FLT_MAX);
+    for (const auto& p : positions) {
+        bmin = glm::min(bmin, p);
+        bmax = glm::max(bmax, p);
+    }
+
+    std::cout << path << ": " << positions.size() / 3 << " triangles" << std::endl;
+    std::cout << std::setw(22) << "build" << std::setw(10) << "ms" << std::setw(10) << "nodes" << std::setw(8)
+              << "depth" << std::endl;
+    CTriangleBVH median, sah, sahThreaded;
+    struct Row { std::string label; CTriangleBVH* bvh; BVHBuildOptions options; };
+    Row builds[] = {
+        { "median, 1 thread", &median, { BVHSplitMethod::MEDIAN, 1 } },
+        { "SAH, 1 thread", &sah, { BVHSplitMethod::SAH, 1 } },
+        { "SAH, " + std::to_string(threads) + " threads", &sahThreaded, { BVHSplitMethod::SAH, threads } },
+    };
+    for (Row& row : builds) {
+        double ms = measureMs([&] { row.bvh->build(positions, row.options); });
+        const std::string& label = row.label;
+        std::cout << std::setw(22) << label << std::setw(10) << std::fixed << std::setprecision(2) << ms
+                  << std::setw(10) << row.bvh->getNodeCount() << std::setw(8) << row.bvh->getDepth() << std::endl;
+    }
+
+    // 實體矩陣：與 Homework 的家具相同的 0.7 縮放，再旋轉 30 度
+    glm::mat4 world = glm::rotate(glm::scale(glm::mat4(1.0f), glm::vec3(0.7f)), glm::radians(30.0f),
+                                  glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 invWorld = glm::inverse(world);
+    glm::vec3 worldMin(FLT_MAX), worldMax(-FLT_MAX);
+    for (int corner = 0; corner < 8; ++corner) {
+        glm::vec3 p((corner & 1) ? bmax.x : bmin.x, (corner & 2) ? bmax.y : bmin.y, (corner & 4) ? bmax.z : bmin.z);
+        glm::vec3 w = glm::vec3(world * glm::vec4(p, 1.0f));
+        worldMin = glm::min(worldMin, w);
+        worldMax = glm::max(worldMax, w);
+    }
+    glm::vec3 center = (worldMin + worldMax) * 0.5f;
+    float radius = glm::length(worldMax - worldMin) * 0.5f;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    std::vector<glm::vec3> origins(rays), dirs(rays), sphereCenters(rays);
+    for (int i = 0; i < rays; ++i) {
+        float z = u01(rng) * 2.0f - 1.0f, a = u01(rng) * 6.2831853f;
+        float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        origins[i] = center + glm::vec3(r * std::cos(a), z, r * std::sin(a)) * (radius * 1.5f);
+        glm::vec3 target = worldMin + (worldMax - worldMin) * glm::vec3(u01(rng), u01(rng), u01(rng));
+        dirs[i] = glm::normalize(target - origins[i]);
+        sphereCenters[i] = worldMin + (worldMax - worldMin) * glm::vec3(u01(rng), u01(rng), u01(rng));
+    }
+    float queryRadius = radius * 0.05f;
+
+    std::cout << std::setw(22) << "query" << std::setw(10) << "ms" << std::setw(12) << "Mquery/s" << std::setw(10)
+              << "hits" << std::endl;
+    auto printRow = [&](const char* label, double ms, int hits) {
+        std::cout << std::setw(22) << label << std::setw(10) << std::setprecision(2) << ms << std::setw(12)
+                  << std::setprecision(3) << (rays / (ms * 1000.0)) << std::setw(10) << hits << std::endl;
+    };
+
+    int failures = 0;
+    std::vector<BVHHit> medianHits(rays), sahHits(rays);
+    std::vector<char> medianFound(rays), sahFound(rays);
+    double ms = measureMs([&] {
+        for (int i = 0; i < rays; ++i)
+            medianFound[i] = median.intersectInstance(invWorld, origins[i], dirs[i], FLT_MAX, medianHits[i]);
+    });
+    printRow("ray, median", ms, static_cast<int>(std::count(medianFound.begin(), medianFound.end(), 1)));
+    ms = measureMs([&] {
+        for (int i = 0; i < rays; ++i)
+            sahFound[i] = sah.intersectInstance(invWorld, origins[i], dirs[i], FLT_MAX, sahHits[i]);
+    });
+    printRow("ray, SAH", ms, static_cast<int>(std::count(sahFound.begin(), sahFound.end(), 1)));
+    for (int i = 0; i < rays; ++i) {
+        if (medianFound[i] != sahFound[i] ||
+            (sahFound[i] && std::fabs(medianHits[i].t - sahHits[i].t) > 1e-4f * (1.0f + sahHits[i].t))) {
+            failures++;
+        }
+    }
+
+    std::vector<BVHSphereHit> medianSphere(rays), sahSphere(rays);
+    ms = measureMs([&] {
+        for (int i = 0; i < rays; ++i)
+            medianFound[i] = median.closestPointInstance(world, invWorld, sphereCenters[i], queryRadius, medianSphere[i]);
+    });
+    printRow("sphere, median", ms, static_cast<int>(std::count(medianFound.begin(), medianFound.end(), 1)));
+    ms = measureMs([&] {
+        for (int i = 0; i < rays; ++i)
+            sahFound[i] = sah.closestPointInstance(world, invWorld, sphereCenters[i], queryRadius, sahSphere[i]);
+    });
+    printRow("sphere, SAH", ms, static_cast<int>(std::count(sahFound.begin(), sahFound.end(), 1)));
+    for (int i = 0; i < rays; ++i) {
+        if (medianFound[i] != sahFound[i] ||
+            (sahFound[i] && std::fabs(medianSphere[i].distance - sahSphere[i].distance) > 1e-4f)) {
+            failures++;
+        }
+    }
+
+    // 多執行緒建立的樹應與單執行緒的 SAH 得到相同的交點
+    for (int i = 0; i < rays; ++i) {
+        BVHHit h;
+        bool found = sahThreaded.intersectInstance(invWorld, origins[i], dirs[i], FLT_MAX, h);
+        bool expected = sahHits[i].triangle >= 0;
+        if (found != expected || (found && std::fabs(h.t - sahHits[i].t) > 1e-4f * (1.0f + h.t))) failures++;
+    }
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << " (" << failures << " mismatches)" << std::endl << std::endl;
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    int rays = 100000;
+    int threads = hardwareThreadCount();
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--rays" && hasValue) rays = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (!arg.empty() && arg[0] != '-') paths.push_back(arg);
+        else {
+            std::cout << "Usage: TriangleBVHBenchmark [--rays N] [--threads N] [obj ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) paths = { "models/robot.obj", "models/sofa.obj" };
+
+    int failures = 0;
+    for (const auto& path : paths) failures += runModel(path, rays, threads);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+//  VertexCacheBenchmark.cpp
+//  CMeshOptimize：每個模型的網格以 Model::ProcessMesh 相同的方式處理（頂點依 OBJ 的索引合併、CMeshCluster 分叢集、
+//  CMeshOptimize 最佳化），輸出 16 個頂點的 FIFO 快取模擬的 ACMR / ATVR：
+//      obj        OBJ 原本的順序
+//      clustered  CMeshCluster 重新排列之後
+//      optimized  叢集內 Forsyth + 叢集 overdraw 排序 + 頂點讀取順序之後（實際上傳的順序）
+//      whole      不分叢集、整個網格做 Forsyth（叢集限制下可以達到的參考值）
+//  檢查：最佳化後的三角形（以頂點內容比較，含環繞方向）與原本完全相同、每個叢集的三角形集合不變、
+//  叢集連續覆蓋所有索引、頂點依第一次使用的順序編號、ACMR 不比 clustered 差，失敗時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      VertexCacheBenchmark [obj ...]
+//      （預設為場景使用的所有模型）
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../common/CMeshCluster.h"
+#include "../common/CMeshOptimize.h"
+#include "../tiny_obj_loader.h"
+
+#define VERTEX_FLOATS 8
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 每個 shape 一個網格，頂點為 8 個 float（位置、法向量、貼圖座標），索引相同的頂點合併
+struct LoadedMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static bool loadMeshes(const std::string& path, std::vector<LoadedMesh>& meshes) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        LoadedMesh mesh;
+        std::map<std::array<int, 3>, unsigned int> unique;
+        for (const auto& index : shape.mesh.indices) {
+            std::array<int, 3> key = { index.vertex_index, index.normal_index, index.texcoord_index };
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                it = unique.emplace(key, static_cast<unsigned int>(mesh.vertices.size() / VERTEX_FLOATS)).first;
+                for (int k = 0; k < 3; ++k) mesh.vertices.push_back(attrib.vertices[3 * index.vertex_index + k]);
+                for (int k = 0; k < 3; ++k) {
+                    mesh.vertices.push_back(index.normal_index >= 0 ? attrib.normals[3 * index.normal_index + k] : 0.0f);
+                }
+                for (int k = 0; k < 2; ++k) {
+                    mesh.vertices.push_back(index.texcoord_index >= 0 ? attrib.texcoords[2 * index.texcoord_index + k] : 0.0f);
+                }
+            }
+            mesh.indices.push_back(it->second);
+        }
+        if (!mesh.indices.empty()) meshes.push_back(std::move(mesh));
+    }
+    return !meshes.empty();
+}
+
+// 三角形的頂點內容，從最小的頂點開始旋轉（保留環繞方向），排序後可以比較兩個索引順序是否為相同的三角形集合
+typedef std::array<float, 3 * VERTEX_FLOATS> TriangleKey;
+
+static std::vector<TriangleKey> triangleKeys(const std::vector<float>& vertices, const unsigned int* indices, size_t count) {
+    std::vector<TriangleKey> keys;
+    keys.reserve(count / 3);
+    for (size_t i = 0; i + 2 < count; i += 3) {
+        std::array<std::array<float, VERTEX_FLOATS>, 3> corners;
+        for (int c = 0; c < 3; ++c) {
+            std::copy(vertices.begin() + VERTEX_FLOATS * indices[i + c],
+                      vertices.begin() + VERTEX_FLOATS * (indices[i + c] + 1), corners[c].begin());
+        }
+        int first = static_cast<int>(std::min_element(corners.begin(), corners.end()) - corners.begin());
+        TriangleKey key;
+        for (int c = 0; c < 3; ++c) {
+            std::copy(corners[(first + c) % 3].begin(), corners[(first + c) % 3].end(), key.begin() + c * VERTEX_FLOATS);
+        }
+        keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+struct Totals {
+    size_t triangles = 0;
+    size_t vertices = 0;
+    double misses[4] = { 0.0, 0.0, 0.0, 0.0 };
+};
+
+static void printRow(const std::string& name, size_t triangles, size_t vertices, const VertexCacheStats stats[4]) {
+    std::cout << std::setw(24) << std::left << name << std::right << std::setw(8) << triangles << std::setw(8) << vertices;
+    for (int k = 0; k < 4; ++k) std::cout << std::setw(7) << stats[k].acmr << std::setw(6) << stats[k].atvr;
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".obj") paths.push_back(arg);
+        else {
+            std::cout << "Usage: VertexCacheBenchmark [obj ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) {
+        paths = { "models/Room001.obj", "models/livingRoomTable.obj", "models/sofa.obj", "models/bed.obj",
+                  "models/toilet.obj", "models/desk.obj", "models/garden.obj", "models/woodCube.obj",
+                  "models/robot.obj", "models/fan.obj", "models/sign.obj", "models/Room001Window.obj" };
+    }
+
+    std::cout << "VertexCacheBenchmark: ACMR / ATVR with a " << VERTEX_CACHE_ANALYZE_SIZE << "-entry FIFO, Forsyth scoring "
+              << VERTEX_CACHE_SIZE << " entries, clusters of " << MESH_CLUSTER_TRIANGLES << " triangles" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(24) << std::left << "model" << std::right << std::setw(8) << "tris" << std::setw(8) << "verts"
+              << std::setw(13) << "obj" << std::setw(13) << "clustered" << std::setw(13) << "optimized"
+              << std::setw(13) << "whole" << std::endl;
+
+    int failures = 0;
+    Totals totals;
+    double optimizeMs = 0.0;
+    for (const std::string& path : paths) {
+        std::vector<LoadedMesh> meshes;
+        if (!loadMeshes(path, meshes)) {
+            failures++;
+            continue;
+        }
+        size_t triangles = 0, vertexCount = 0;
+        size_t misses[4] = { 0, 0, 0, 0 };
+        bool ok = true;
+        for (LoadedMesh& mesh : meshes) {
+            size_t count = mesh.vertices.size() / VERTEX_FLOATS;
+            VertexCacheStats stats[4];
+            stats[0] = CMeshOptimize::analyze(mesh.indices.data(), mesh.indices.size(), count);
+            std::vector<TriangleKey> original = triangleKeys(mesh.vertices, mesh.indices.data(), mesh.indices.size());
+
+            std::vector<unsigned int> whole = mesh.indices;
+            CMeshOptimize::optimizeVertexCache(whole.data(), whole.size(), count);
+            stats[3] = CMeshOptimize::analyze(whole.data(), whole.size(), count);
+
+            std::vector<MeshCluster> clusters;
+            CMeshCluster::build(mesh.vertices.data(), count, VERTEX_FLOATS, mesh.indices, clusters, MESH_CLUSTER_TRIANGLES);
+            stats[1] = CMeshOptimize::analyze(mesh.indices.data(), mesh.indices.size(), count);
+            std::map<std::array<float, 4>, std::vector<TriangleKey>> clusterTriangles;
+            for (const MeshCluster& cluster : clusters) {
+                std::array<float, 4> id = { cluster.center.x, cluster.center.y, cluster.center.z, cluster.radius };
+                clusterTriangles[id] = triangleKeys(mesh.vertices, mesh.indices.data() + cluster.indexStart, cluster.indexCount);
+            }
+
+            optimizeMs += measureMs([&]() {
+                CMeshOptimize::optimize(mesh.vertices.data(), count, VERTEX_FLOATS * sizeof(float), mesh.indices, clusters);
+            });
+            stats[2] = CMeshOptimize::analyze(mesh.indices.data(), mesh.indices.size(), count);
+
+            // 三角形與叢集都不變
+            if (triangleKeys(mesh.vertices, mesh.indices.data(), mesh.indices.size()) != original) ok = false;
+            uint32_t expectedStart = 0;
+            for (const MeshCluster& cluster : clusters) {
+                if (cluster.indexStart != expectedStart) ok = false;
+                expectedStart += cluster.indexCount;
+                std::array<float, 4> id = { cluster.center.x, cluster.center.y, cluster.center.z, cluster.radius };
+                auto it = clusterTriangles.find(id);
+                if (it == clusterTriangles.end() ||
+                    it->second != triangleKeys(mesh.vertices, mesh.indices.data() + cluster.indexStart, cluster.indexCount)) {
+                    ok = false;
+                }
+            }
+            if (expectedStart != mesh.indices.size()) ok = false;
+            // 頂點依第一次使用的順序編號
+            unsigned int next = 0;
+            for (unsigned int index : mesh.indices) {
+                if (index > next) ok = false;
+                if (index == next) next++;
+            }
+            if (stats[2].acmr > stats[1].acmr + 1e-6f) ok = false;
+
+            triangles += mesh.indices.size() / 3;
+            vertexCount += count;
+            for (int k = 0; k < 4; ++k) misses[k] += static_cast<size_t>(stats[k].acmr * (mesh.indices.size() / 3) + 0.5f);
+        }
+
+        VertexCacheStats modelStats[4];
+        for (int k = 0; k < 4; ++k) {
+            modelStats[k].acmr = static_cast<float>(misses[k]) / triangles;
+            modelStats[k].atvr = static_cast<float>(misses[k]) / vertexCount;
+            totals.misses[k] += misses[k];
+        }
+        totals.triangles += triangles;
+        totals.vertices += vertexCount;
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        printRow(name + (ok ? "" : " FAILED"), triangles, vertexCount, modelStats);
+        if (!ok) failures++;
+    }
+
+    VertexCacheStats totalStats[4];
+    for (int k = 0; k < 4; ++k) {
+        totalStats[k].acmr = static_cast<float>(totals.misses[k] / std::max<size_t>(1, totals.triangles));
+        totalStats[k].atvr = static_cast<float>(totals.misses[k] / std::max<size_t>(1, totals.vertices));
+    }
+    printRow("total", totals.triangles, totals.vertices, totalStats);
+    std::cout << "Vertex transforms: " << std::setprecision(0) << totals.misses[0] << " -> " << totals.misses[2]
+              << std::setprecision(1) << " (" << 100.0 * (1.0 - totals.misses[2] / std::max(1.0, totals.misses[0]))
+              << "% fewer), optimize " << std::setprecision(2) << optimizeMs << " ms" << std::endl;
+
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+//  VertexQuantizeBenchmark.cpp
+//  CVertexQuantize：每個模型的網格以 Model 相同的方式壓縮（頂點依 OBJ 的索引合併，位置以模型的包圍盒量化），
+//  輸出頂點緩衝區的大小（float 與壓縮後）、位置 / 法向量角度 / 貼圖座標的最大誤差，以及超過誤差上限、改用 float 的網格
+//  檢查：PackedVertex 為 16 bytes、壓縮的網格誤差在上限以內、法向量誤差小於 0.2 度、
+//  不同網格中位置相同的頂點還原後仍然完全相同（不會出現裂縫），失敗時回傳非 0
+//
+//  在 3DRoom 目錄下執行：
+//      VertexQuantizeBenchmark [obj ...]
+//      （預設為場景使用的所有模型）
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../common/CVertexQuantize.h"
+#include "../tiny_obj_loader.h"
+
+#define VERTEX_FLOATS 8
+#define MAX_NORMAL_ERROR_DEGREES 0.2f
+
+template <typename Func>
+static double measureMs(Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 每個 shape 一個網格，頂點為 8 個 float（位置、法向量、貼圖座標），索引相同的頂點合併
+struct LoadedMesh {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static bool loadMeshes(const std::string& path, std::vector<LoadedMesh>& meshes) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), directory.c_str())) {
+        std::cerr << "Failed to load " << path << " " << err << std::endl;
+        return false;
+    }
+    for (const auto& shape : shapes) {
+        LoadedMesh mesh;
+        std::map<std::array<int, 3>, unsigned int> unique;
+        for (const auto& index : shape.mesh.indices) {
+            std::array<int, 3> key = { index.vertex_index, index.normal_index, index.texcoord_index };
+            auto it = unique.find(key);
+            if (it == unique.end()) {
+                it = unique.emplace(key, static_cast<unsigned int>(mesh.vertices.size() / VERTEX_FLOATS)).first;
+                for (int k = 0; k < 3; ++k) mesh.vertices.push_back(attrib.vertices[3 * index.vertex_index + k]);
+                for (int k = 0; k < 3; ++k) {
+                    mesh.vertices.push_back(index.normal_index >= 0 ? attrib.normals[3 * index.normal_index + k] : 0.0f);
+                }
+                for (int k = 0; k < 2; ++k) {
+                    mesh.vertices.push_back(index.texcoord_index >= 0 ? attrib.texcoords[2 * index.texcoord_index + k] : 0.0f);
+                }
+            }
+            mesh.indices.push_back(it->second);
+        }
+        if (!mesh.indices.empty()) meshes.push_back(std::move(mesh));
+    }
+    return !meshes.empty();
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".obj") paths.push_back(arg);
+        else {
+            std::cout << "Usage: VertexQuantizeBenchmark [obj ...]" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty()) {
+        paths = { "models/Room001.obj", "models/livingRoomTable.obj", "models/sofa.obj", "models/bed.obj",
+                  "models/toilet.obj", "models/desk.obj", "models/garden.obj", "models/woodCube.obj",
+                  "models/robot.obj", "models/fan.obj", "models/sign.obj", "models/Room001Window.obj" };
+    }
+
+    std::cout << "VertexQuantizeBenchmark: " << sizeof(float) * VERTEX_FLOATS << " -> " << sizeof(PackedVertex)
+              << " bytes per vertex, limits position " << VERTEX_QUANTIZE_MAX_POSITION_ERROR << ", uv "
+              << VERTEX_QUANTIZE_MAX_TEXCOORD_ERROR << std::endl;
+    std::cout << std::setw(24) << std::left << "model" << std::right << std::setw(8) << "verts" << std::setw(11)
+              << "float KB" << std::setw(11) << "packed KB" << std::setw(12) << "pos err" << std::setw(10) << "n deg"
+              << std::setw(12) << "uv err" << std::setw(10) << "fallback" << std::endl;
+
+    int failures = 0;
+    if (sizeof(PackedVertex) != 16) {
+        std::cout << "PackedVertex is " << sizeof(PackedVertex) << " bytes" << std::endl;
+        failures++;
+    }
+    size_t totalFloat = 0, totalPacked = 0, totalVertices = 0;
+    double packMs = 0.0;
+    for (const std::string& path : paths) {
+        std::vector<LoadedMesh> meshes;
+        if (!loadMeshes(path, meshes)) {
+            failures++;
+            continue;
+        }
+        glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+        size_t vertexCount = 0;
+        for (const LoadedMesh& mesh : meshes) {
+            for (size_t v = 0; v < mesh.vertices.size(); v += VERTEX_FLOATS) {
+                glm::vec3 p(mesh.vertices[v], mesh.vertices[v + 1], mesh.vertices[v + 2]);
+                boundsMin = glm::min(boundsMin, p);
+                boundsMax = glm::max(boundsMax, p);
+            }
+            vertexCount += mesh.vertices.size() / VERTEX_FLOATS;
+        }
+
+        QuantizeError worst;
+        size_t packedBytes = 0, fallback = 0;
+        bool ok = true;
+        // 原本的位置 -> 還原後的位置（只比較壓縮的網格）
+        std::map<std::array<float, 3>, std::array<float, 3>> decodedAt;
+        for (const LoadedMesh& mesh : meshes) {
+            size_t count = mesh.vertices.size() / VERTEX_FLOATS;
+            std::vector<PackedVertex> packed;
+            VertexDecode decode;
+            QuantizeError error;
+            packMs += measureMs([&]() {
+                error = CVertexQuantize::pack(mesh.vertices.data(), count, VERTEX_FLOATS, 3, 6, boundsMin, boundsMax,
+                                              packed, decode);
+            });
+            if (!CVertexQuantize::acceptable(error)) {
+                fallback++;
+                packedBytes += count * sizeof(float) * VERTEX_FLOATS;
+                continue;
+            }
+            packedBytes += count * sizeof(PackedVertex);
+            worst.position = std::max(worst.position, error.position);
+            worst.normalDegrees = std::max(worst.normalDegrees, error.normalDegrees);
+            worst.texCoord = std::max(worst.texCoord, error.texCoord);
+            if (error.normalDegrees > MAX_NORMAL_ERROR_DEGREES) ok = false;
+            for (size_t v = 0; v < count; ++v) {
+                float position[3], normal[3], texCoords[2];
+                CVertexQuantize::unpack(packed[v], decode, position, normal, texCoords);
+                const float* source = mesh.vertices.data() + v * VERTEX_FLOATS;
+                std::array<float, 3> key = { source[0], source[1], source[2] };
+                std::array<float, 3> value = { position[0], position[1], position[2] };
+                auto it = decodedAt.emplace(key, value).first;
+                if (it->second != value) ok = false;
+            }
+        }
+
+        size_t floatBytes = vertexCount * sizeof(float) * VERTEX_FLOATS;
+        totalFloat += floatBytes;
+        totalPacked += packedBytes;
+        totalVertices += vertexCount;
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        std::cout << std::setw(24) << std::left << (name + (ok ? "" : " FAILED")) << std::right << std::setw(8)
+                  << vertexCount << std::fixed << std::setprecision(1) << std::setw(11) << floatBytes / 1024.0
+                  << std::setw(11) << packedBytes / 1024.0 << std::scientific << std::setprecision(2) << std::setw(12)
+                  << worst.position << std::fixed << std::setprecision(3) << std::setw(10) << worst.normalDegrees
+                  << std::scientific << std::setprecision(2) << std::setw(12) << worst.texCoord << std::setw(10)
+                  << fallback << std::defaultfloat << std::endl;
+        if (!ok) failures++;
+    }
+
+    std::cout << std::fixed << std::setprecision(1) << "total: " << totalVertices << " vertices, " << totalFloat / 1024.0
+              << " KB -> " << totalPacked / 1024.0 << " KB (" << 100.0 * (1.0 - double(totalPacked) / std::max<size_t>(1, totalFloat))
+              << "% saved), pack " << std::setprecision(2) << packMs << " ms" << std::endl;
+    std::cout << (failures == 0 ? "PASS" : "FAIL") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -4,8 +4,14 @@ layout(location=0) in vec3 aPos;
 //layout(location=1) in vec3 aColor;
 layout(location=2) in vec3 aNormal;
 layout(location=3) in vec2 aTex;    // Texture Coordinates
+layout(location=4) in mat4 aInstanceModel;  // 4 ~ 7：instanced draw 的模型矩陣（Model::RenderFractureInstanced）
+// 8 ~ 10：量化頂點的還原參數（CVertexQuantize），float 頂點沒有啟用，讀到 (0,0,0,1)
+layout(location=8) in vec4 aPosScale;
+layout(location=9) in vec3 aPosOffset;
+layout(location=10) in vec4 aTexScaleOffset;
 
 uniform mat4 mxModel;
+uniform bool uInstanced;            // true 時以 aInstanceModel 取代 mxModel
 uniform mat4 mxView;
 uniform mat4 mxProj;
 
@@ -24,29 +30,32 @@ out vec3 vTangent;
 out vec3 vBitangent;
 
 void main() {
-    vec4 worldPos = mxModel * vec4(aPos, 1.0);
+    mat4 model = uInstanced ? aInstanceModel : mxModel;
+    vec3 pos = mix(aPos * aPosScale.xyz + aPosOffset, aPos, aPosScale.w);
+    vec2 tex = mix(aTex * aTexScaleOffset.xy + aTexScaleOffset.zw, aTex, aPosScale.w);
+    vec4 worldPos = model * vec4(pos, 1.0);
     v3Pos   = worldPos.xyz;
-    vNormal = normalize((mat3(mxModel) * aNormal));
+    vNormal = normalize((mat3(model) * aNormal));
 //    vNormal = normalize(aNormal); 
     vLight  = normalize(lightPos - v3Pos);
     vView   = normalize(viewPos - v3Pos);
 //    vColor   = aColor;
     vColor = vec3(1.0, 1.0, 1.0);
-    vTexCoord = aTex;
+    vTexCoord = tex;
     gl_Position = mxProj * mxView * worldPos;
     
     // Calculate Tangent and Bitangent (Simple Method - Requires UVs)
-    vec3 edge1 = vec3(mxModel * vec4(aPos, 1.0) - mxModel * vec4(aPos - vec3(0.1, 0.0, 0.0), 1.0)); // Approximate
-    vec3 edge2 = vec3(mxModel * vec4(aPos, 1.0) - mxModel * vec4(aPos - vec3(0.0, 0.1, 0.0), 1.0)); // Approximate
-    vec2 deltaUV1 = vec2(aTex.x - (aTex.x - 0.1), aTex.y - aTex.y); // Approximate
-    vec2 deltaUV2 = vec2(aTex.x - aTex.x, aTex.y - (aTex.y - 0.1)); // Approximate
+    vec3 edge1 = vec3(model * vec4(pos, 1.0) - model * vec4(pos - vec3(0.1, 0.0, 0.0), 1.0)); // Approximate
+    vec3 edge2 = vec3(model * vec4(pos, 1.0) - model * vec4(pos - vec3(0.0, 0.1, 0.0), 1.0)); // Approximate
+    vec2 deltaUV1 = vec2(tex.x - (tex.x - 0.1), tex.y - tex.y); // Approximate
+    vec2 deltaUV2 = vec2(tex.x - tex.x, tex.y - (tex.y - 0.1)); // Approximate
 
     float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
 
-    vTangent = normalize(vec3(mxModel * vec4(f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x), 0.0, 0.0, 0.0)));
-    vBitangent = normalize(vec3(mxModel * vec4(f * (deltaUV1.x * edge2.x - deltaUV2.x * edge1.x), 0.0, 0.0, 0.0)));
+    vTangent = normalize(vec3(model * vec4(f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x), 0.0, 0.0, 0.0)));
+    vBitangent = normalize(vec3(model * vec4(f * (deltaUV1.x * edge2.x - deltaUV2.x * edge1.x), 0.0, 0.0, 0.0)));
 
-    vNormal = normalize(mat3(transpose(inverse(mxModel))) * aNormal); // Correct Normal Transformation
+    vNormal = normalize(mat3(transpose(inverse(model))) * aNormal); // Correct Normal Transformation
 }
 
 